@@ -72,7 +72,7 @@ bool managed_log(struct pid_stat *p, PID_LOG log, bool status) {
 static inline bool incrementally_read_pid_stat(struct pid_stat *p, void *ptr) {
     p->last_stat_collected_usec = p->stat_collected_usec;
     p->stat_collected_usec = now_monotonic_usec();
-    calls_counter++;
+    __atomic_add_fetch(&calls_counter, 1, __ATOMIC_RELAXED);
 
     if(!OS_FUNCTION(apps_os_read_pid_stat)(p, ptr))
         return 0;
@@ -83,7 +83,7 @@ static inline bool incrementally_read_pid_stat(struct pid_stat *p, void *ptr) {
 static inline int incrementally_read_pid_io(struct pid_stat *p, void *ptr) {
     p->last_io_collected_usec = p->io_collected_usec;
     p->io_collected_usec = now_monotonic_usec();
-    calls_counter++;
+    __atomic_add_fetch(&calls_counter, 1, __ATOMIC_RELAXED);
 
     bool ret = OS_FUNCTION(apps_os_read_pid_io)(p, ptr);
 
@@ -92,9 +92,9 @@ static inline int incrementally_read_pid_io(struct pid_stat *p, void *ptr) {
 
 // --------------------------------------------------------------------------------------------------------------------
 
-int incrementally_collect_data_for_pid_stat(struct pid_stat *p, void *ptr) {
-    if(unlikely(p->read)) return 0;
-
+// the first part of the collection of a pid, reading its stat, io and status
+// it touches only the pid itself, so that many pids can be read in parallel
+bool incrementally_collect_data_for_pid_stat_begin(struct pid_stat *p, void *ptr) {
     pid_collection_started(p);
 
     // --------------------------------------------------------------------
@@ -103,7 +103,7 @@ int incrementally_collect_data_for_pid_stat(struct pid_stat *p, void *ptr) {
     if(unlikely(!managed_log(p, PID_LOG_STAT, incrementally_read_pid_stat(p, ptr)))) {
         // there is no reason to proceed if we cannot get its status
         pid_collection_failed(p);
-        return 0;
+        return false;
     }
 
     // check its parent pid
@@ -121,9 +121,15 @@ int incrementally_collect_data_for_pid_stat(struct pid_stat *p, void *ptr) {
     if(unlikely(!managed_log(p, PID_LOG_STATUS, OS_FUNCTION(apps_os_read_pid_status)(p, ptr)))) {
         // there is no reason to proceed if we cannot get its status
         pid_collection_failed(p);
-        return 0;
+        return false;
     }
 
+    return true;
+}
+
+// the second part of the collection of a pid, reading its files
+// it updates the global file descriptors index, so it runs on one thread
+void incrementally_collect_data_for_pid_stat_end(struct pid_stat *p, void *ptr) {
     // --------------------------------------------------------------------
     // /proc/<pid>/fd
 
@@ -148,7 +154,15 @@ int incrementally_collect_data_for_pid_stat(struct pid_stat *p, void *ptr) {
 #endif
 
     pid_collection_completed(p);
+}
+
+int incrementally_collect_data_for_pid_stat(struct pid_stat *p, void *ptr) {
+    if(unlikely(p->read)) return 0;
+
+    if(unlikely(!incrementally_collect_data_for_pid_stat_begin(p, ptr)))
+        return 0;
 
+    incrementally_collect_data_for_pid_stat_end(p, ptr);
     return 1;
 }
 
@@ -169,7 +183,7 @@ int incrementally_collect_data_for_pid(pid_t pid, void *ptr) {
 
 #if (PROCESSES_HAVE_CMDLINE == 1)
 int read_proc_pid_cmdline(struct pid_stat *p) {
-    static char cmdline[MAX_CMDLINE];
+    static __thread char cmdline[MAX_CMDLINE];
 
     if(unlikely(!OS_FUNCTION(apps_os_get_pid_cmdline)(p, cmdline, sizeof(cmdline))))
         goto cleanup;
@@ -10,6 +10,20 @@
 int max_fds_cache_seconds = 60;
 kernel_uint_t system_uptime_secs;
 
+// 0 = automatic, 1 = read all pids on the main thread
+int collection_threads = 0;
+struct apps_collection_phases collection_phases = { 0 };
+
+// when collecting in parallel, the readers get this as their ptr,
+// to open the files of the pid relative to its /proc/PID directory
+struct proc_pid_dir {
+    int fd;
+};
+
+static inline int proc_pid_dirfd(void *ptr) {
+    return ptr ? ((struct proc_pid_dir *)ptr)->fd : -1;
+}
+
 void apps_os_init_linux(void) {
     ;
 }
@@ -24,6 +38,13 @@ struct arl_callback_ptr {
 };
 
 bool apps_os_read_pid_fds_linux(struct pid_stat *p, void *ptr __maybe_unused) {
+    // a process that has not run since we last read its files, has the same files
+    kernel_uint_t activity = p->raw[PDF_UTIME] + p->raw[PDF_STIME] + p->raw[PDF_VOLCTX] + p->raw[PDF_NVOLCTX];
+    if(p->fds_collected && p->fds_starttime == p->starttime && p->fds_activity == activity) {
+        collection_phases.fds_skipped++;
+        return true;
+    }
+
     if(unlikely(!p->fds_dirname)) {
         char dirname[FILENAME_MAX+1];
         snprintfz(dirname, FILENAME_MAX, "%s/proc/%d/fd", netdata_configured_host_prefix, p->pid);
@@ -152,6 +173,10 @@ bool apps_os_read_pid_fds_linux(struct pid_stat *p, void *ptr __maybe_unused) {
 
     closedir(fds);
 
+    p->fds_starttime = p->starttime;
+    p->fds_activity = activity;
+    p->fds_collected = true;
+
     return true;
 }
 
@@ -221,17 +246,21 @@ bool apps_os_get_pid_cmdline_linux(struct pid_stat *p, char *cmdline, size_t byt
 // --------------------------------------------------------------------------------------------------------------------
 // /proc/pid/io
 
-bool apps_os_read_pid_io_linux(struct pid_stat *p, void *ptr __maybe_unused) {
-    static procfile *ff = NULL;
+bool apps_os_read_pid_io_linux(struct pid_stat *p, void *ptr) {
+    static __thread procfile *ff = NULL;
 
-    if(unlikely(!p->io_filename)) {
+    int dirfd = proc_pid_dirfd(ptr);
+    if(unlikely(dirfd == -1 && !p->io_filename)) {
         char filename[FILENAME_MAX + 1];
         snprintfz(filename, FILENAME_MAX, "%s/proc/%d/io", netdata_configured_host_prefix, p->pid);
         p->io_filename = strdupz(filename);
     }
 
     // open the file
-    ff = procfile_reopen(ff, p->io_filename, NULL, PROCFILE_FLAG_NO_ERROR_ON_FILE_IO);
+    if(dirfd != -1)
+        ff = procfile_reopenat(ff, dirfd, "io", NULL, PROCFILE_FLAG_NO_ERROR_ON_FILE_IO);
+    else
+        ff = procfile_reopen(ff, p->io_filename, NULL, PROCFILE_FLAG_NO_ERROR_ON_FILE_IO);
     if(unlikely(!ff)) goto cleanup;
 
     ff = procfile_readall(ff);
@@ -473,9 +502,9 @@ void arl_callback_status_nonvoluntary_ctxt_switches(const char *name, uint32_t h
     pid_incremental_rate(stat, PDF_NVOLCTX, str2kernel_uint_t(procfile_lineword(aptr->ff, aptr->line, 1)));
 }
 
-bool apps_os_read_pid_status_linux(struct pid_stat *p, void *ptr __maybe_unused) {
-    static struct arl_callback_ptr arl_ptr;
-    static procfile *ff = NULL;
+bool apps_os_read_pid_status_linux(struct pid_stat *p, void *ptr) {
+    static __thread struct arl_callback_ptr arl_ptr;
+    static __thread procfile *ff = NULL;
 
     if(unlikely(!p->status_arl)) {
         p->status_arl = arl_create("/proc/pid/status", NULL, 60);
@@ -490,19 +519,23 @@ bool apps_os_read_pid_status_linux(struct pid_stat *p, void *ptr __maybe_unused)
         arl_expect_custom(p->status_arl, "nonvoluntary_ctxt_switches", arl_callback_status_nonvoluntary_ctxt_switches, &arl_ptr);
     }
 
-    if(unlikely(!p->status_filename)) {
+    int dirfd = proc_pid_dirfd(ptr);
+    if(unlikely(dirfd == -1 && !p->status_filename)) {
         char filename[FILENAME_MAX + 1];
         snprintfz(filename, FILENAME_MAX, "%s/proc/%d/status", netdata_configured_host_prefix, p->pid);
         p->status_filename = strdupz(filename);
     }
 
-    ff = procfile_reopen(ff, p->status_filename, (!ff)?" \t:,-()/":NULL, PROCFILE_FLAG_NO_ERROR_ON_FILE_IO);
+    if(dirfd != -1)
+        ff = procfile_reopenat(ff, dirfd, "status", (!ff)?" \t:,-()/":NULL, PROCFILE_FLAG_NO_ERROR_ON_FILE_IO);
+    else
+        ff = procfile_reopen(ff, p->status_filename, (!ff)?" \t:,-()/":NULL, PROCFILE_FLAG_NO_ERROR_ON_FILE_IO);
     if(unlikely(!ff)) return false;
 
     ff = procfile_readall(ff);
     if(unlikely(!ff)) return false;
 
-    calls_counter++;
+    __atomic_add_fetch(&calls_counter, 1, __ATOMIC_RELAXED);
 
     // let ARL use this pid
     arl_ptr.p = p;
@@ -590,29 +623,30 @@ cleanup:
 static inline void update_proc_state_count(char proc_stt) {
     switch (proc_stt) {
         case 'S':
-            proc_state_count[PROC_STATUS_SLEEPING] += 1;
+            __atomic_add_fetch(&proc_state_count[PROC_STATUS_SLEEPING], 1, __ATOMIC_RELAXED);
             break;
         case 'R':
-            proc_state_count[PROC_STATUS_RUNNING] += 1;
+            __atomic_add_fetch(&proc_state_count[PROC_STATUS_RUNNING], 1, __ATOMIC_RELAXED);
             break;
         case 'D':
-            proc_state_count[PROC_STATUS_SLEEPING_D] += 1;
+            __atomic_add_fetch(&proc_state_count[PROC_STATUS_SLEEPING_D], 1, __ATOMIC_RELAXED);
             break;
         case 'Z':
-            proc_state_count[PROC_STATUS_ZOMBIE] += 1;
+            __atomic_add_fetch(&proc_state_count[PROC_STATUS_ZOMBIE], 1, __ATOMIC_RELAXED);
             break;
         case 'T':
-            proc_state_count[PROC_STATUS_STOPPED] += 1;
+            __atomic_add_fetch(&proc_state_count[PROC_STATUS_STOPPED], 1, __ATOMIC_RELAXED);
             break;
         default:
             break;
     }
 }
 
-bool apps_os_read_pid_stat_linux(struct pid_stat *p, void *ptr __maybe_unused) {
-    static procfile *ff = NULL;
+bool apps_os_read_pid_stat_linux(struct pid_stat *p, void *ptr) {
+    static __thread procfile *ff = NULL;
 
-    if(unlikely(!p->stat_filename)) {
+    int dirfd = proc_pid_dirfd(ptr);
+    if(unlikely(dirfd == -1 && !p->stat_filename)) {
         char filename[FILENAME_MAX + 1];
         snprintfz(filename, FILENAME_MAX, "%s/proc/%d/stat", netdata_configured_host_prefix, p->pid);
         p->stat_filename = strdupz(filename);
@@ -620,7 +654,10 @@ bool apps_os_read_pid_stat_linux(struct pid_stat *p, void *ptr __maybe_unused) {
 
     bool set_quotes = (!ff) ? true : false;
 
-    ff = procfile_reopen(ff, p->stat_filename, NULL, PROCFILE_FLAG_NO_ERROR_ON_FILE_IO);
+    if(dirfd != -1)
+        ff = procfile_reopenat(ff, dirfd, "stat", NULL, PROCFILE_FLAG_NO_ERROR_ON_FILE_IO);
+    else
+        ff = procfile_reopen(ff, p->stat_filename, NULL, PROCFILE_FLAG_NO_ERROR_ON_FILE_IO);
     if(unlikely(!ff)) goto cleanup;
 
     // if(set_quotes) procfile_set_quotes(ff, "()");
@@ -654,7 +691,8 @@ bool apps_os_read_pid_stat_linux(struct pid_stat *p, void *ptr __maybe_unused) {
     // p->nice          = str2kernel_uint_t(procfile_lineword(ff, 0, 18));
     p->values[PDF_THREADS] = (int32_t) str2uint32_t(procfile_lineword(ff, 0, 19), NULL);
     // p->itrealvalue   = str2kernel_uint_t(procfile_lineword(ff, 0, 20));
-    kernel_uint_t collected_starttime = str2kernel_uint_t(procfile_lineword(ff, 0, 21)) / system_hz;
+    p->starttime = str2kernel_uint_t(procfile_lineword(ff, 0, 21));
+    kernel_uint_t collected_starttime = p->starttime / system_hz;
     p->values[PDF_UPTIME] = (system_uptime_secs > collected_starttime)?(system_uptime_secs - collected_starttime):0;
     // p->vsize         = str2kernel_uint_t(procfile_lineword(ff, 0, 22));
     // p->rss           = str2kernel_uint_t(procfile_lineword(ff, 0, 23));
@@ -710,6 +748,189 @@ cleanup:
 
 // ----------------------------------------------------------------------------
 
+// --------------------------------------------------------------------------------------------------------------------
+// parallel collection of all pids
+//
+// With many processes, reading their files one by one takes most of the iteration.
+// So, the pids found in /proc are sharded across worker threads, which read their
+// stat, io and status, opening them relative to the /proc/PID directory of each pid.
+// Their open files and limits are then read on the main thread, since they update the
+// global file descriptors index. Processes that have not run since their files were
+// last read, keep their files.
+
+#define APPS_PARALLEL_MIN_PIDS 2000     // the automatic mode reads fewer pids on the main thread
+#define APPS_PARALLEL_MAX_THREADS 16
+#define APPS_PARALLEL_BATCH 64          // the pids a worker takes at a time
+
+static struct {
+    int proc_fd;                        // the /proc directory
+    size_t threads;                     // the running workers
+
+    struct pid_stat **pids;             // the pids to read in this iteration, parents first
+    bool *ok;                           // the pids that have been read successfully
+    size_t used;
+    size_t size;
+    size_t next;                        // the next pid to be taken by a worker
+
+    struct completion start;            // a job for every iteration
+    struct completion done;             // a job for every worker, on every iteration
+    unsigned done_jobs;
+} parallel = {
+    .proc_fd = -1,
+};
+
+static void apps_parallel_read_pid(struct pid_stat *p, bool *ok) {
+    char pid_str[UINT64_MAX_LENGTH];
+    print_uint64(pid_str, p->pid);
+
+    struct proc_pid_dir dir = {
+        .fd = openat(parallel.proc_fd, pid_str, O_RDONLY | O_DIRECTORY | O_CLOEXEC),
+    };
+
+    if(unlikely(dir.fd == -1)) {
+        // it exited, since we found it
+        pid_collection_started(p);
+        pid_collection_failed(p);
+        *ok = false;
+        return;
+    }
+
+    *ok = incrementally_collect_data_for_pid_stat_begin(p, &dir);
+    close(dir.fd);
+}
+
+static void apps_parallel_worker(void *ptr) {
+    // the iterations started before this worker
+    unsigned iterations = (unsigned)(uintptr_t)ptr;
+
+    while(true) {
+        iterations = completion_wait_for_a_job(&parallel.start, iterations);
+
+        size_t start;
+        while((start = __atomic_fetch_add(&parallel.next, APPS_PARALLEL_BATCH, __ATOMIC_RELAXED)) < parallel.used) {
+            size_t end = MIN(start + APPS_PARALLEL_BATCH, parallel.used);
+            for(size_t i = start; i < end; i++)
+                apps_parallel_read_pid(parallel.pids[i], &parallel.ok[i]);
+        }
+
+        completion_mark_complete_a_job(&parallel.done);
+    }
+}
+
+static size_t apps_parallel_threads(size_t pids) {
+    if(collection_threads == 1)
+        return 1;
+
+    size_t threads = collection_threads > 0 ? (size_t)collection_threads : os_get_system_cpus_cached(true);
+
+    if(collection_threads == 0 && pids < APPS_PARALLEL_MIN_PIDS)
+        return 1;
+
+    return MAX(1, MIN(threads, APPS_PARALLEL_MAX_THREADS));
+}
+
+static bool apps_os_collect_all_pids_in_parallel_linux(size_t threads) {
+    usec_t started_ut = now_monotonic_usec();
+
+    if(parallel.proc_fd == -1) {
+        char dirname[FILENAME_MAX + 1];
+        snprintfz(dirname, FILENAME_MAX, "%s/proc", netdata_configured_host_prefix);
+        parallel.proc_fd = open(dirname, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if(parallel.proc_fd == -1)
+            return false;
+
+        completion_init(&parallel.start);
+        completion_init(&parallel.done);
+    }
+
+    // the workers are started once, and they stay around
+    while(parallel.threads < threads - 1) {
+        char tag[NETDATA_THREAD_TAG_MAX + 1];
+        snprintfz(tag, sizeof(tag), "APPS[%zu]", parallel.threads);
+        nd_thread_create(tag, NETDATA_THREAD_OPTION_DONT_LOG, apps_parallel_worker,
+                         (void *)(uintptr_t)parallel.start.completed_jobs);
+        parallel.threads++;
+    }
+
+    // ------------------------------------------------------------------------
+    // find all the pids
+
+    DIR *dir = fdopendir(dup(parallel.proc_fd));
+    if(!dir) return false;
+
+    parallel.used = 0;
+
+    struct dirent *de = NULL;
+    while((de = readdir(dir))) {
+        char *endptr = de->d_name;
+
+        if(unlikely(de->d_type != DT_DIR || de->d_name[0] < '0' || de->d_name[0] > '9'))
+            continue;
+
+        pid_t pid = (pid_t) strtoul(de->d_name, &endptr, 10);
+
+        // make sure we read a valid number
+        if(unlikely(endptr == de->d_name || *endptr != '\0' || pid < INIT_PID))
+            continue;
+
+        struct pid_stat *p = get_or_allocate_pid_entry(pid);
+        if(unlikely(!p || p->read))
+            continue;
+
+        if(unlikely(parallel.used == parallel.size)) {
+            parallel.size = parallel.size ? parallel.size * 2 : 1024;
+            parallel.pids = reallocz(parallel.pids, parallel.size * sizeof(*parallel.pids));
+            parallel.ok = reallocz(parallel.ok, parallel.size * sizeof(*parallel.ok));
+        }
+
+        parallel.pids[parallel.used++] = p;
+    }
+    closedir(dir);
+
+    // read the parents before their children, see collect_parents_before_children()
+    if(include_exited_childs)
+        sort_pids_parents_before_children(parallel.pids, parallel.used);
+
+    usec_t discovered_ut = now_monotonic_usec();
+
+    // ------------------------------------------------------------------------
+    // read stat, io and status of all pids, on all threads
+
+    parallel.next = 0;
+    completion_mark_complete_a_job(&parallel.start);
+
+    size_t start;
+    while((start = __atomic_fetch_add(&parallel.next, APPS_PARALLEL_BATCH, __ATOMIC_RELAXED)) < parallel.used) {
+        size_t end = MIN(start + APPS_PARALLEL_BATCH, parallel.used);
+        for(size_t i = start; i < end; i++)
+            apps_parallel_read_pid(parallel.pids[i], &parallel.ok[i]);
+    }
+
+    unsigned target = parallel.done_jobs + parallel.threads;
+    while(parallel.done_jobs < target)
+        parallel.done_jobs = completion_wait_for_a_job(&parallel.done, parallel.done_jobs);
+
+    usec_t read_ut = now_monotonic_usec();
+
+    // ------------------------------------------------------------------------
+    // read the files of all pids, on this thread
+
+    for(size_t i = 0; i < parallel.used; i++) {
+        if(parallel.ok[i])
+            incrementally_collect_data_for_pid_stat_end(parallel.pids[i], NULL);
+    }
+
+    usec_t files_ut = now_monotonic_usec();
+
+    collection_phases.discover_ut = discovered_ut - started_ut;
+    collection_phases.read_ut = read_ut - discovered_ut;
+    collection_phases.files_ut = files_ut - read_ut;
+
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+
 // 1. read all files in /proc
 // 2. for each numeric directory:
 //    i.   read /proc/pid/stat
@@ -732,15 +953,25 @@ bool apps_os_collect_all_pids_linux(void) {
     memset(proc_state_count, 0, sizeof proc_state_count);
 #endif
 
-    // preload the parents and then their children
-    collect_parents_before_children();
-
     static char uptime_filename[FILENAME_MAX + 1] = "";
     if(*uptime_filename == '\0')
         snprintfz(uptime_filename, FILENAME_MAX, "%s/proc/uptime", netdata_configured_host_prefix);
 
     system_uptime_secs = (kernel_uint_t)(uptime_msec(uptime_filename) / MSEC_PER_SEC);
 
+    collection_phases.fds_skipped = 0;
+    collection_phases.threads = apps_parallel_threads(all_pids_count());
+    if(collection_phases.threads > 1)
+        return apps_os_collect_all_pids_in_parallel_linux(collection_phases.threads);
+
+    // on a single thread, the phases are interleaved, so all the time is reported as reading
+    usec_t started_ut = now_monotonic_usec();
+    collection_phases.discover_ut = 0;
+    collection_phases.files_ut = 0;
+
+    // preload the parents and then their children
+    collect_parents_before_children();
+
     char dirname[FILENAME_MAX + 1];
 
     snprintfz(dirname, FILENAME_MAX, "%s/proc", netdata_configured_host_prefix);
@@ -765,6 +996,8 @@ bool apps_os_collect_all_pids_linux(void) {
     }
     closedir(dir);
 
+    collection_phases.read_ut = now_monotonic_usec() - started_ut;
+
     return true;
 }
 #endif
@@ -62,6 +62,19 @@ void send_resource_usage_to_netdata(usec_t dt) {
                 "DIMENSION new_pids 'new pids' incremental 1 1\n"
                 , update_every
         );
+
+#if defined(OS_LINUX)
+        fprintf(stdout,
+                "CHART netdata.apps_collection_phases '' 'Apps Plugin Collection Phases' 'milliseconds' apps.plugin netdata.apps_collection_phases stacked 140002 %1$d\n"
+                "DIMENSION discover '' absolute 1 1000\n"
+                "DIMENSION read '' absolute 1 1000\n"
+                "DIMENSION files '' absolute 1 1000\n"
+                "CHART netdata.apps_collection_threads '' 'Apps Plugin Collection Threads' 'threads' apps.plugin netdata.apps_collection_threads line 140003 %1$d\n"
+                "DIMENSION threads '' absolute 1 1\n"
+                "DIMENSION fds_skipped 'pids with unchanged files' absolute 1 1\n"
+                , update_every
+        );
+#endif
     }
 
     fprintf(stdout,
@@ -94,6 +107,27 @@ void send_resource_usage_to_netdata(usec_t dt) {
             , apps_groups_targets_count
             , targets_assignment_counter
     );
+
+#if defined(OS_LINUX)
+    fprintf(stdout,
+            "BEGIN netdata.apps_collection_phases %"PRIu64"\n"
+            "SET discover = %"PRIu64"\n"
+            "SET read = %"PRIu64"\n"
+            "SET files = %"PRIu64"\n"
+            "END\n"
+            "BEGIN netdata.apps_collection_threads %"PRIu64"\n"
+            "SET threads = %zu\n"
+            "SET fds_skipped = %zu\n"
+            "END\n"
+            , dt
+            , collection_phases.discover_ut
+            , collection_phases.read_ut
+            , collection_phases.files_ut
+            , dt
+            , collection_phases.threads
+            , collection_phases.fds_skipped
+    );
+#endif
 }
 
 void send_collected_data_to_netdata(struct target *root, const char *type, usec_t dt) {
@@ -198,6 +198,17 @@ static int compar_pid_sortlist(const void *a, const void *b) {
         return 1;
 }
 
+void sort_pids_parents_before_children(struct pid_stat **array, size_t count) {
+    uint32_t sortlist = 1;
+    for(size_t i = 0; i < count ; i++) {
+        // assign a sortlist id to all it and its parents
+        for (struct pid_stat *pp = array[i]; pp ; pp = pp->parent)
+            pp->sortlist = sortlist++;
+    }
+
+    qsort((void *)array, count, sizeof(struct pid_stat *), compar_pid_sortlist);
+}
+
 bool collect_parents_before_children(void) {
     if (!pids.all_pids.count) return false;
 
@@ -210,14 +221,9 @@ bool collect_parents_before_children(void) {
 
     size_t slc = 0;
     struct pid_stat *p = NULL;
-    uint32_t sortlist = 1;
-    for (p = root_of_pids(); p && slc < pids.sorted.size; p = p->next) {
+    for (p = root_of_pids(); p && slc < pids.sorted.size; p = p->next)
         pids.sorted.array[slc++] = p;
 
-        // assign a sortlist id to all it and its parents
-        for (struct pid_stat *pp = p; pp ; pp = pp->parent)
-            pp->sortlist = sortlist++;
-    }
     size_t sorted = slc;
 
     static bool logged = false;
@@ -237,7 +243,7 @@ bool collect_parents_before_children(void) {
         // its parent, it has exited and its parent
         // has accumulated its resources.
 
-        qsort((void *)pids.sorted.array, sorted, sizeof(struct pid_stat *), compar_pid_sortlist);
+        sort_pids_parents_before_children(pids.sorted.array, sorted);
 
         // we forward read all running processes
         // incrementally_collect_data_for_pid() is smart enough,
@@ -438,6 +438,17 @@ static void parse_args(int argc, char **argv)
             if(max_fds_cache_seconds < 0) max_fds_cache_seconds = 0;
             continue;
         }
+
+        if(strcmp("collection-threads", argv[i]) == 0) {
+            if(argc <= i + 1) {
+                fprintf(stderr, "Parameter 'collection-threads' requires a number as argument.\n");
+                exit(1);
+            }
+            i++;
+            collection_threads = str2i(argv[i]);
+            if(collection_threads < 0) collection_threads = 0;
+            continue;
+        }
 #endif
 
 #if (PROCESSES_HAVE_CPU_CHILDREN_TIME == 1) || (PROCESSES_HAVE_CHILDREN_FLTS == 1)
@@ -557,6 +568,11 @@ static void parse_args(int argc, char **argv)
                     "                        max given)\n"
                     "                        (default is %d seconds)\n"
                     "\n"
+                    " collection-threads N   read the processes with N threads\n"
+                    "                        0 uses all the cpus (up to 16), when there\n"
+                    "                        are more than 2000 processes, 1 disables it\n"
+                    "                        (default is 0)\n"
+                    "\n"
 #endif
                     " version or -v or -V print program version and exit\n"
                     "\n"
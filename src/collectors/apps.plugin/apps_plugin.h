@@ -149,6 +149,17 @@ struct pid_info {
 #define OS_FUNCTION(func) OS_FUNC_CONCAT(func, _linux)
 
 extern int max_fds_cache_seconds;
+extern int collection_threads;
+
+// the time spent in each phase of the last collection of all pids
+struct apps_collection_phases {
+    usec_t discover_ut;             // finding the pids in /proc
+    usec_t read_ut;                 // reading stat, io and status of all pids (in parallel)
+    usec_t files_ut;                // reading the open files and the limits of all pids
+    size_t threads;                 // the threads that read the pids
+    size_t fds_skipped;             // the pids that did not run, so their files were not read again
+};
+extern struct apps_collection_phases collection_phases;
 
 #else
 #error "Unsupported operating system"
@@ -577,6 +588,11 @@ struct pid_stat {
     usec_t last_limits_collected_usec;
 
 #if defined(OS_LINUX)
+    kernel_uint_t starttime;        // the start time of the process, in jiffies after boot
+    kernel_uint_t fds_starttime;    // the starttime, when its files were last read
+    kernel_uint_t fds_activity;     // the cpu time and the context switches, when its files were last read
+    bool fds_collected;             // its files have been read at least once
+
     ARL_BASE *status_arl;
     char *fds_dirname;              // the full directory name in /proc/PID/fd
     char *stat_filename;
@@ -670,6 +686,9 @@ void pid_collection_completed(struct pid_stat *p);
 bool collect_parents_before_children(void);
 int incrementally_collect_data_for_pid(pid_t pid, void *ptr);
 int incrementally_collect_data_for_pid_stat(struct pid_stat *p, void *ptr);
+bool incrementally_collect_data_for_pid_stat_begin(struct pid_stat *p, void *ptr);
+void incrementally_collect_data_for_pid_stat_end(struct pid_stat *p, void *ptr);
+void sort_pids_parents_before_children(struct pid_stat **array, size_t count);
 #endif
 
 // --------------------------------------------------------------------------------------------------------------------
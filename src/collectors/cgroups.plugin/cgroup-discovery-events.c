@@ -0,0 +1,337 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "cgroup-internals.h"
+
+#include <sys/inotify.h>
+
+// Event driven discovery of cgroups v2.
+//
+// The watcher keeps an inotify watch on every cgroup directory the discovery
+// would descend into. Created and removed directories are queued as added and
+// removed cgroups, and changes of 'cgroup.events' (the cgroup got or lost its
+// processes) are queued too, so that the discovery retries the cgroups it
+// could not resolve yet. The discovery thread is woken up to process only the
+// queued cgroups, instead of walking the whole hierarchy.
+//
+// When the kernel queue overflows, or a directory is renamed, all the watches
+// are set up again and a full scan is requested. When the watches cannot be
+// set up (e.g. fs.inotify.max_user_watches is reached), the watcher exits and
+// the discovery falls back to the periodic full scans.
+
+#define CGROUP_EVENTS_WATCH_MASK (IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_MODIFY | IN_ONLYDIR | IN_EXCL_UNLINK)
+
+bool cgroup_discovery_use_inotify = true;
+int cgroup_full_scan_every = 300;
+
+static struct {
+    ND_THREAD *thread;
+    bool running;                           // atomic, the watches are in place
+
+    int fd;
+    Pvoid_t JudyL;                          // watch descriptor -> relative path of the cgroup
+    size_t watches;
+
+    SPINLOCK spinlock;
+    struct cgroup_event *queue;
+} cgroup_watcher = {
+    .fd = -1,
+    .spinlock = SPINLOCK_INITIALIZER,
+};
+
+// ----------------------------------------------------------------------------
+// the queue
+
+static void cgroup_watcher_queue(CGROUP_EVENT_TYPE type, const char *relative, usec_t now_ut) {
+    size_t len = strlen(relative);
+    struct cgroup_event *e = mallocz(sizeof(*e) + len + 1);
+    e->type = type;
+    e->ut = now_ut;
+    memcpy(e->path, relative, len + 1);
+
+    spinlock_lock(&cgroup_watcher.spinlock);
+    DOUBLE_LINKED_LIST_APPEND_ITEM_UNSAFE(cgroup_watcher.queue, e, prev, next);
+    spinlock_unlock(&cgroup_watcher.spinlock);
+}
+
+struct cgroup_event *cgroup_discovery_events_get(void) {
+    spinlock_lock(&cgroup_watcher.spinlock);
+    struct cgroup_event *events = cgroup_watcher.queue;
+    cgroup_watcher.queue = NULL;
+    spinlock_unlock(&cgroup_watcher.spinlock);
+
+    return events;
+}
+
+void cgroup_discovery_events_free(struct cgroup_event *events) {
+    while(events) {
+        struct cgroup_event *e = events;
+        DOUBLE_LINKED_LIST_REMOVE_ITEM_UNSAFE(events, e, prev, next);
+        freez(e);
+    }
+}
+
+bool cgroup_discovery_events_running(void) {
+    return __atomic_load_n(&cgroup_watcher.running, __ATOMIC_RELAXED);
+}
+
+// ----------------------------------------------------------------------------
+// the watches
+
+static inline int cgroup_watcher_depth(const char *relative) {
+    int depth = 0;
+    for(const char *s = relative; *s; s++)
+        depth += (*s == '/');
+
+    return depth;
+}
+
+// the discovery descends into the children of a cgroup only when its path matches
+// 'search for cgroups in subpaths matching' and the children are not too deep
+static inline bool cgroup_watcher_descend(const char *relative) {
+    if(cgroup_max_depth > 0 && strcmp(relative, "/") != 0 && cgroup_watcher_depth(relative) >= cgroup_max_depth)
+        return false;
+
+    return matches_search_cgroup_paths(relative);
+}
+
+static inline void cgroup_watcher_child_path(char *dst, size_t size, const char *relative, const char *name) {
+    if(strcmp(relative, "/") == 0)
+        snprintfz(dst, size - 1, "/%s", name);
+    else
+        snprintfz(dst, size - 1, "%s/%s", relative, name);
+}
+
+static void cgroup_watcher_del_all(void) {
+    Word_t wd = 0;
+    Pvoid_t *PValue;
+    bool first = true;
+    while((PValue = JudyLFirstThenNext(cgroup_watcher.JudyL, &wd, &first)))
+        freez(*PValue);
+
+    JudyLFreeArray(&cgroup_watcher.JudyL, PJE0);
+    cgroup_watcher.watches = 0;
+
+    if(cgroup_watcher.fd != -1) {
+        close(cgroup_watcher.fd);
+        cgroup_watcher.fd = -1;
+    }
+}
+
+// watch a cgroup and all its children, optionally queueing it as added
+// returns false when the watches cannot be added
+static bool cgroup_watcher_add_tree(const char *relative, bool queue_added, usec_t now_ut) {
+    char path[FILENAME_MAX + 1];
+    snprintfz(path, FILENAME_MAX, "%s%s", cgroup_unified_base, strcmp(relative, "/") == 0 ? "" : relative);
+
+    int wd = inotify_add_watch(cgroup_watcher.fd, path, CGROUP_EVENTS_WATCH_MASK);
+    if(wd == -1) {
+        // it has been removed meanwhile
+        if(errno == ENOENT || errno == ENOTDIR)
+            return true;
+
+        collector_error("CGROUP: cannot watch directory '%s' for new cgroups", path);
+        return false;
+    }
+
+    Pvoid_t *PValue = JudyLIns(&cgroup_watcher.JudyL, (Word_t)wd, PJE0);
+    if(!PValue || PValue == PJERR)
+        fatal("CGROUP: corrupted watches JudyL array");
+
+    if(*PValue)
+        freez(*PValue);
+    else
+        cgroup_watcher.watches++;
+
+    *PValue = strdupz(relative);
+
+    if(queue_added)
+        cgroup_watcher_queue(CGROUP_EVENT_ADDED, relative, now_ut);
+
+    if(!cgroup_watcher_descend(relative))
+        return true;
+
+    DIR *dir = opendir(path);
+    if(!dir)
+        return true;
+
+    bool ret = true;
+    struct dirent *de;
+    while(ret && (de = readdir(dir))) {
+        if(de->d_type != DT_DIR || strcmp(de->d_name, ".") == 0 || strcmp(de->d_name, "..") == 0)
+            continue;
+
+        char child[FILENAME_MAX + 1];
+        cgroup_watcher_child_path(child, sizeof(child), relative, de->d_name);
+
+        // the children are found by the discovery walking the added cgroup
+        ret = cgroup_watcher_add_tree(child, false, now_ut);
+    }
+
+    closedir(dir);
+    return ret;
+}
+
+static bool cgroup_watcher_setup(void) {
+    cgroup_watcher_del_all();
+
+    cgroup_watcher.fd = inotify_init1(IN_CLOEXEC | IN_NONBLOCK);
+    if(cgroup_watcher.fd == -1) {
+        collector_error("CGROUP: inotify_init1() failed");
+        return false;
+    }
+
+    if(!cgroup_watcher_add_tree("/", false, now_monotonic_usec())) {
+        cgroup_watcher_del_all();
+        return false;
+    }
+
+    collector_info("CGROUP: watching %zu cgroups for changes", cgroup_watcher.watches);
+
+    // reconcile whatever happened before the watches were in place
+    cgroup_discovery_request(true);
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+// the events
+
+// returns true when the watches have to be set up again
+static bool cgroup_watcher_process(const char *buf, ssize_t len, size_t *queued) {
+    usec_t now_ut = now_monotonic_usec();
+    bool rewatch = false;
+
+    for(const char *p = buf; p < buf + len; ) {
+        const struct inotify_event *ev = (const struct inotify_event *)p;
+        p += sizeof(struct inotify_event) + ev->len;
+
+        if(ev->mask & IN_Q_OVERFLOW) {
+            nd_log_limit_static_global_var(erl, 60, 0);
+            nd_log_limit(&erl, NDLS_COLLECTORS, NDLP_NOTICE, "CGROUP: the inotify queue overflowed, scanning all cgroups");
+            rewatch = true;
+            continue;
+        }
+
+        Pvoid_t *PValue = JudyLGet(cgroup_watcher.JudyL, (Word_t)ev->wd, PJE0);
+        if(!PValue)
+            continue;
+
+        const char *relative = *PValue;
+
+        if(ev->mask & IN_IGNORED) {
+            // the directory has been removed
+            freez(*PValue);
+            JudyLDel(&cgroup_watcher.JudyL, (Word_t)ev->wd, PJE0);
+            cgroup_watcher.watches--;
+            continue;
+        }
+
+        if(!ev->len)
+            continue;
+
+        if(ev->mask & IN_ISDIR) {
+            if(ev->mask & (IN_MOVED_FROM | IN_MOVED_TO)) {
+                // the paths of all the watches below it have changed
+                rewatch = true;
+                continue;
+            }
+
+            if(!cgroup_watcher_descend(relative))
+                continue;
+
+            char child[FILENAME_MAX + 1];
+            cgroup_watcher_child_path(child, sizeof(child), relative, ev->name);
+
+            if(ev->mask & IN_CREATE) {
+                if(!cgroup_watcher_add_tree(child, true, now_ut))
+                    rewatch = true;
+                (*queued)++;
+            }
+            else if(ev->mask & IN_DELETE) {
+                cgroup_watcher_queue(CGROUP_EVENT_REMOVED, child, now_ut);
+                (*queued)++;
+            }
+        }
+        else if((ev->mask & IN_MODIFY) && strcmp(ev->name, "cgroup.events") == 0) {
+            cgroup_watcher_queue(CGROUP_EVENT_CHANGED, relative, now_ut);
+            (*queued)++;
+        }
+    }
+
+    return rewatch;
+}
+
+static void cgroup_watcher_main(void *ptr __maybe_unused) {
+    if(!cgroup_watcher_setup())
+        goto cleanup;
+
+    __atomic_store_n(&cgroup_watcher.running, true, __ATOMIC_RELAXED);
+
+    char buf[64 * 1024] __attribute__((aligned(__alignof__(struct inotify_event))));
+
+    while(!nd_thread_signaled_to_cancel() && service_running(SERVICE_COLLECTORS)) {
+        struct pollfd pfd = {
+            .fd = cgroup_watcher.fd,
+            .events = POLLIN,
+        };
+
+        int rc = poll(&pfd, 1, 1000);
+        if(rc == 0 || (rc == -1 && errno == EINTR))
+            continue;
+
+        if(rc == -1) {
+            collector_error("CGROUP: cannot poll() the inotify descriptor");
+            break;
+        }
+
+        size_t queued = 0;
+        bool rewatch = false;
+
+        ssize_t len;
+        while((len = read(cgroup_watcher.fd, buf, sizeof(buf))) > 0)
+            rewatch |= cgroup_watcher_process(buf, len, &queued);
+
+        if(len == -1 && errno != EAGAIN && errno != EINTR) {
+            collector_error("CGROUP: cannot read the inotify descriptor");
+            break;
+        }
+
+        if(rewatch) {
+            if(!cgroup_watcher_setup())
+                break;
+        }
+        else if(queued)
+            cgroup_discovery_request(false);
+    }
+
+cleanup:
+    if(!nd_thread_signaled_to_cancel() && service_running(SERVICE_COLLECTORS))
+        collector_error("CGROUP: stopped watching cgroups for changes, falling back to scanning them every %d seconds",
+                        cgroup_check_for_new_every);
+
+    __atomic_store_n(&cgroup_watcher.running, false, __ATOMIC_RELAXED);
+    cgroup_watcher_del_all();
+    cgroup_discovery_events_free(cgroup_discovery_events_get());
+
+    // the discovery has to scan again, at the periodic interval
+    cgroup_discovery_request(true);
+}
+
+// ----------------------------------------------------------------------------
+
+void cgroup_discovery_events_start(void) {
+    if(!cgroup_discovery_use_inotify || !cgroup_use_unified_cgroups || !cgroup_unified_exist || cgroup_watcher.thread)
+        return;
+
+    cgroup_watcher.thread = nd_thread_create("CGWATCH", NETDATA_THREAD_OPTION_DONT_LOG, cgroup_watcher_main, NULL);
+    if(!cgroup_watcher.thread)
+        collector_error("CGROUP: cannot create the cgroups watcher thread, will scan for new cgroups periodically");
+}
+
+void cgroup_discovery_events_stop(void) {
+    if(!cgroup_watcher.thread)
+        return;
+
+    nd_thread_signal_cancel(cgroup_watcher.thread);
+    nd_thread_join(cgroup_watcher.thread);
+    cgroup_watcher.thread = NULL;
+}
@@ -14,9 +14,15 @@
 #define WORKER_DISCOVERY_COPY               8
 #define WORKER_DISCOVERY_SHARE              9
 #define WORKER_DISCOVERY_LOCK              10
+#define WORKER_DISCOVERY_EVENTS            11
 
-#if WORKER_UTILIZATION_MAX_JOB_TYPES < 11
-#error WORKER_UTILIZATION_MAX_JOB_TYPES has to be at least 11
+// discovery cgroup thread custom metrics
+#define WORKER_DISCOVERY_LATENCY           12
+#define WORKER_DISCOVERY_EVENTS_PROCESSED  13
+#define WORKER_DISCOVERY_FULL_SCAN_TIME    14
+
+#if WORKER_UTILIZATION_MAX_JOB_TYPES < 15
+#error WORKER_UTILIZATION_MAX_JOB_TYPES has to be at least 15
 #endif
 
 struct cgroup *discovered_cgroup_root = NULL;
@@ -91,6 +97,8 @@ static inline void cgroup_free(struct cgroup *cg) {
     if(cg->st_merged_ops) rrdset_is_obsolete___safe_from_collector_thread(cg->st_merged_ops);
     if(cg->st_pids) rrdset_is_obsolete___safe_from_collector_thread(cg->st_pids);
 
+    cgroup_files_close(cg);
+
     freez(cg->filename_cpuset_cpus);
     freez(cg->filename_cpu_cfs_period);
     freez(cg->filename_cpu_cfs_quota);
@@ -347,6 +355,8 @@ static inline struct cgroup *discovery_cgroup_add(const char *id) {
     cg->id = strdupz(id);
     cg->hash = simple_hash(cg->id);
 
+    cgroup_files_init(cg);
+
     cg->name = strdupz(id);
 
     cg->intermediate_id = cgroup_chart_id_strdupz(id);
@@ -1249,19 +1259,7 @@ static inline void discovery_process_cgroup(struct cgroup *cg) {
     read_cgroup_network_interfaces(cg);
 }
 
-static inline void discovery_find_all_cgroups() {
-    netdata_log_debug(D_CGROUP, "searching for cgroups");
-
-    worker_is_busy(WORKER_DISCOVERY_INIT);
-    discovery_mark_as_unavailable_all_cgroups();
-
-    worker_is_busy(WORKER_DISCOVERY_FIND);
-    if (!cgroup_use_unified_cgroups) {
-        discovery_find_all_cgroups_v1();
-    } else {
-        discovery_find_all_cgroups_v2();
-    }
-
+static inline void discovery_apply_changes() {
     for (struct cgroup *cg = discovered_cgroup_root; cg && service_running(SERVICE_COLLECTORS); cg = cg->discovered_next) {
         worker_is_busy(WORKER_DISCOVERY_PROCESS);
         discovery_process_cgroup(cg);
@@ -1283,10 +1281,99 @@ static inline void discovery_find_all_cgroups() {
 
     worker_is_busy(WORKER_DISCOVERY_SHARE);
     discovery_share_cgroups_with_ebpf();
+}
+
+static inline void discovery_find_all_cgroups() {
+    netdata_log_debug(D_CGROUP, "searching for cgroups");
+
+    usec_t started_ut = now_monotonic_usec();
+
+    worker_is_busy(WORKER_DISCOVERY_INIT);
+    discovery_mark_as_unavailable_all_cgroups();
+
+    worker_is_busy(WORKER_DISCOVERY_FIND);
+    if (!cgroup_use_unified_cgroups) {
+        discovery_find_all_cgroups_v1();
+    } else {
+        discovery_find_all_cgroups_v2();
+    }
+
+    discovery_apply_changes();
+
+    worker_set_metric(WORKER_DISCOVERY_FULL_SCAN_TIME, (NETDATA_DOUBLE)(now_monotonic_usec() - started_ut) / USEC_PER_MS);
 
     netdata_log_debug(D_CGROUP, "done searching for cgroups");
 }
 
+// ----------------------------------------------------------------------------
+// event driven discovery (cgroups v2)
+
+static inline void discovery_find_added_cgroups(const char *relative) {
+    char path[FILENAME_MAX + 1];
+    snprintfz(path, FILENAME_MAX, "%s%s", cgroup_unified_base, relative);
+
+    // it may have been removed already
+    if (access(path, F_OK) != 0)
+        return;
+
+    discovery_find_walkdir(cgroup_unified_base, path);
+}
+
+static inline void discovery_mark_as_unavailable_removed_cgroups(const char *relative) {
+    size_t len = strlen(relative);
+
+    for (struct cgroup *cg = discovered_cgroup_root; cg; cg = cg->discovered_next) {
+        if (strncmp(cg->id, relative, len) == 0 && (cg->id[len] == '\0' || cg->id[len] == '/'))
+            cg->available = 0;
+    }
+}
+
+static inline void discovery_process_events(struct cgroup_event *events) {
+    netdata_log_debug(D_CGROUP, "processing cgroup events");
+
+    usec_t oldest_ut = 0;
+    size_t count = 0;
+
+    worker_is_busy(WORKER_DISCOVERY_EVENTS);
+    for (struct cgroup_event *e = events; e; e = e->next) {
+        count++;
+        if (!oldest_ut || e->ut < oldest_ut)
+            oldest_ut = e->ut;
+
+        switch (e->type) {
+            case CGROUP_EVENT_ADDED:
+                discovery_find_added_cgroups(e->path);
+                break;
+
+            case CGROUP_EVENT_REMOVED:
+                discovery_mark_as_unavailable_removed_cgroups(e->path);
+                break;
+
+            case CGROUP_EVENT_CHANGED:
+                // the cgroups not resolved yet are retried below
+                break;
+        }
+    }
+
+    discovery_apply_changes();
+
+    // the time from the oldest event, to the cgroups being available to the collector
+    worker_set_metric(WORKER_DISCOVERY_LATENCY, (NETDATA_DOUBLE)(now_monotonic_usec() - oldest_ut) / USEC_PER_MS);
+    worker_set_metric(WORKER_DISCOVERY_EVENTS_PROCESSED, (NETDATA_DOUBLE)count);
+
+    netdata_log_debug(D_CGROUP, "done processing %zu cgroup events", count);
+}
+
+void cgroup_discovery_request(bool full_scan) {
+    uv_mutex_lock(&discovery_thread.mutex);
+    if (full_scan)
+        discovery_thread.full_scan = true;
+    else
+        discovery_thread.events = true;
+    uv_cond_signal(&discovery_thread.cond_var);
+    uv_mutex_unlock(&discovery_thread.mutex);
+}
+
 void cgroup_discovery_worker(void *ptr)
 {
     UNUSED(ptr);
@@ -1304,6 +1391,11 @@ void cgroup_discovery_worker(void *ptr)
     worker_register_job_name(WORKER_DISCOVERY_COPY,               "copy");
     worker_register_job_name(WORKER_DISCOVERY_SHARE,              "share");
     worker_register_job_name(WORKER_DISCOVERY_LOCK,               "lock");
+    worker_register_job_name(WORKER_DISCOVERY_EVENTS,             "events");
+
+    worker_register_job_custom_metric(WORKER_DISCOVERY_LATENCY,          "discovery latency", "milliseconds", WORKER_METRIC_ABSOLUTE);
+    worker_register_job_custom_metric(WORKER_DISCOVERY_EVENTS_PROCESSED, "events processed",  "events",       WORKER_METRIC_INCREMENT);
+    worker_register_job_custom_metric(WORKER_DISCOVERY_FULL_SCAN_TIME,   "full scan time",    "milliseconds", WORKER_METRIC_ABSOLUTE);
 
     entrypoint_parent_process_comm = simple_pattern_create(
             " runc:[* " // http://terenceli.github.io/%E6%8A%80%E6%9C%AF/2021/12/28/runc-internals-3)
@@ -1315,19 +1407,36 @@ void cgroup_discovery_worker(void *ptr)
 
     netdata_cgroup_ebpf_initialize_shm();
 
+    cgroup_discovery_events_start();
+
     while (service_running(SERVICE_COLLECTORS)) {
         worker_is_idle();
 
         uv_mutex_lock(&discovery_thread.mutex);
-        uv_cond_wait(&discovery_thread.cond_var, &discovery_thread.mutex);
+        while (!discovery_thread.full_scan && !discovery_thread.events && service_running(SERVICE_COLLECTORS))
+            uv_cond_wait(&discovery_thread.cond_var, &discovery_thread.mutex);
+
+        bool full_scan = discovery_thread.full_scan;
+        discovery_thread.full_scan = false;
+        discovery_thread.events = false;
         uv_mutex_unlock(&discovery_thread.mutex);
 
         if (unlikely(!service_running(SERVICE_COLLECTORS)))
             break;
 
-        discovery_find_all_cgroups();
+        // a full scan makes the queued events redundant
+        struct cgroup_event *events = cgroup_discovery_events_get();
+
+        if (full_scan || !cgroup_discovery_events_running())
+            discovery_find_all_cgroups();
+        else if (events)
+            discovery_process_events(events);
+
+        cgroup_discovery_events_free(events);
     }
 
+    cgroup_discovery_events_stop();
+
     // free all cgroups
     uv_mutex_lock(&cgroup_root_mutex);
     while(cgroup_root) {
@@ -130,6 +130,22 @@ struct cgroup_network_interface {
     struct cgroup_network_interface *next;
 };
 
+// the cgroup v2 files read every iteration, kept open and re-read with pread()
+typedef enum {
+    CGROUP_FILE_CPU_STAT = 0,
+    CGROUP_FILE_IO_STAT,
+    CGROUP_FILE_MEMORY_STAT,
+    CGROUP_FILE_MEMORY_CURRENT,
+    CGROUP_FILE_PIDS_CURRENT,
+    CGROUP_FILE_CPU_PRESSURE,
+    CGROUP_FILE_IO_PRESSURE,
+    CGROUP_FILE_MEMORY_PRESSURE,
+    CGROUP_FILE_IRQ_PRESSURE,
+
+    // terminator
+    CGROUP_FILE_MAX,
+} CGROUP_FILE_ID;
+
 enum cgroups_container_orchestrator {
     CGROUPS_ORCHESTRATOR_UNSET,
     CGROUPS_ORCHESTRATOR_UNKNOWN,
@@ -192,6 +208,8 @@ struct cgroup {
     struct pressure memory_pressure;
     struct pressure irq_pressure;
 
+    int fd[CGROUP_FILE_MAX];    // cgroup v2 files kept open, -1 when closed
+
     // Cpu
     RRDSET *st_cpu;
     RRDDIM *st_cpu_rd_user;
@@ -265,10 +283,38 @@ struct discovery_thread {
     uv_mutex_t mutex;
     uv_cond_t cond_var;
     int exited;
+
+    // protected by the mutex
+    bool full_scan;                         // the whole hierarchy has to be scanned
+    bool events;                            // the watcher has queued cgroup events
 };
 
 extern struct discovery_thread discovery_thread;
 
+void cgroup_discovery_request(bool full_scan);
+
+typedef enum {
+    CGROUP_EVENT_ADDED,                     // a cgroup directory has been created
+    CGROUP_EVENT_REMOVED,                   // a cgroup directory has been removed
+    CGROUP_EVENT_CHANGED,                   // the cgroup.events of a cgroup has been modified
+} CGROUP_EVENT_TYPE;
+
+struct cgroup_event {
+    CGROUP_EVENT_TYPE type;
+    usec_t ut;                              // monotonic time the event was received
+    struct cgroup_event *prev, *next;
+    char path[];                            // relative to cgroup_unified_base
+};
+
+extern bool cgroup_discovery_use_inotify;
+extern int cgroup_full_scan_every;
+
+void cgroup_discovery_events_start(void);
+void cgroup_discovery_events_stop(void);
+bool cgroup_discovery_events_running(void);
+struct cgroup_event *cgroup_discovery_events_get(void);
+void cgroup_discovery_events_free(struct cgroup_event *events);
+
 extern const char *cgroups_rename_script;
 extern char cgroup_chart_id_prefix[];
 extern char services_chart_id_prefix[];
@@ -276,6 +322,9 @@ extern uv_mutex_t cgroup_root_mutex;
 
 void cgroup_discovery_worker(void *ptr);
 
+void cgroup_files_init(struct cgroup *cg);
+void cgroup_files_close(struct cgroup *cg);
+
 extern bool is_inside_k8s;
 extern long system_page_size;
 
@@ -288,6 +337,7 @@ extern bool cgroup_enable_blkio;
 extern bool cgroup_enable_pressure;
 extern bool cgroup_enable_cpuacct_cpu_shares;
 
+extern bool cgroup_reuse_file_descriptors;
 extern int cgroup_check_for_new_every;
 extern int cgroup_update_every;
 
@@ -22,6 +22,7 @@ bool cgroup_enable_memory = true;
 bool cgroup_enable_cpuacct = true;
 bool cgroup_enable_cpuacct_cpu_shares = false;
 
+bool cgroup_reuse_file_descriptors = true;
 int cgroup_check_for_new_every = 10;
 int cgroup_update_every = 1;
 char *cgroup_cpuacct_base = NULL;
@@ -241,6 +242,17 @@ void read_cgroup_plugin_configuration() {
         inicfg_set_duration_seconds(&netdata_config, "plugin:cgroups", "check for new cgroups every", cgroup_check_for_new_every);
     }
 
+    cgroup_reuse_file_descriptors = inicfg_get_boolean(&netdata_config, "plugin:cgroups", "keep cgroups v2 files open", cgroup_reuse_file_descriptors);
+
+    cgroup_discovery_use_inotify = inicfg_get_boolean(&netdata_config, "plugin:cgroups", "watch cgroups for changes", cgroup_discovery_use_inotify);
+
+    // when the cgroups are watched, the full scan only reconciles the missed changes
+    cgroup_full_scan_every = (int)inicfg_get_duration_seconds(&netdata_config, "plugin:cgroups", "full scan of watched cgroups every", cgroup_full_scan_every);
+    if(cgroup_full_scan_every < cgroup_check_for_new_every) {
+        cgroup_full_scan_every = cgroup_check_for_new_every;
+        inicfg_set_duration_seconds(&netdata_config, "plugin:cgroups", "full scan of watched cgroups every", cgroup_full_scan_every);
+    }
+
     cgroup_use_unified_cgroups = inicfg_get_boolean_ondemand(&netdata_config, "plugin:cgroups", "use unified cgroups", CONFIG_BOOLEAN_AUTO);
     if (cgroup_use_unified_cgroups == CONFIG_BOOLEAN_AUTO)
         cgroup_use_unified_cgroups = (cgroups_try_detect_version() == CGROUPS_V2);
@@ -915,6 +927,332 @@ static void cgroup_read_pids_current(struct pids *pids) {
     pids->updated = !read_single_number_file(pids->filename, &pids->pids_current);
 }
 
+// ----------------------------------------------------------------------------
+// read cgroup v2 files kept open
+//
+// Every file is opened once and re-read from its beginning with pread(), so
+// each file costs one syscall per iteration, instead of open(), read() until
+// EOF and close(). The files are parsed in place, with the keys each one has,
+// instead of splitting them into words.
+
+static bool cgroup_files_keep_open = true;
+static size_t cgroup_files_opened = 0;
+
+void cgroup_files_init(struct cgroup *cg) {
+    for (size_t i = 0; i < CGROUP_FILE_MAX; i++)
+        cg->fd[i] = -1;
+}
+
+void cgroup_files_close(struct cgroup *cg) {
+    for (size_t i = 0; i < CGROUP_FILE_MAX; i++) {
+        if (cg->fd[i] != -1) {
+            close(cg->fd[i]);
+            cg->fd[i] = -1;
+        }
+    }
+}
+
+// returns the contents of the file in a buffer shared by all the files, NULL on failure
+static char *cgroup_file_read(struct cgroup *cg, CGROUP_FILE_ID id, const char *filename) {
+    static char *buf = NULL;
+    static size_t size = 0;
+
+    if (unlikely(!buf)) {
+        size = 4096;
+        buf = mallocz(size);
+    }
+
+    int *fd = &cg->fd[id];
+
+    if (unlikely(*fd == -1)) {
+        *fd = open(filename, O_RDONLY | O_CLOEXEC, 0666);
+        cgroup_files_opened++;
+        if (unlikely(*fd == -1)) {
+            if ((errno == EMFILE || errno == ENFILE) && cgroup_files_keep_open) {
+                collector_error("CGROUP: too many open files, cgroups v2 files will be reopened on every iteration");
+                cgroup_files_keep_open = false;
+            }
+            return NULL;
+        }
+    }
+
+    ssize_t r;
+    while ((r = pread(*fd, buf, size - 1, 0)) == (ssize_t)(size - 1)) {
+        // it may be bigger, read it again with a bigger buffer
+        size *= 2;
+        buf = reallocz(buf, size);
+    }
+
+    if (unlikely(r <= 0 || !cgroup_files_keep_open)) {
+        // the cgroup has been removed (ENODEV), or we cannot keep it open
+        close(*fd);
+        *fd = -1;
+
+        if (r <= 0)
+            return NULL;
+    }
+
+    buf[r] = '\0';
+    return buf;
+}
+
+// the next line of a file, NULL terminated, or NULL at the end of the file
+static inline char *cgroup_file_next_line(char **s) {
+    char *line = *s;
+    if (!*line)
+        return NULL;
+
+    char *e = strchrnul(line, '\n');
+    *s = *e ? e + 1 : e;
+    *e = '\0';
+    return line;
+}
+
+// the next 'key=value' (or 'key value') word of a line, or false at the end of the line
+static inline bool cgroup_file_next_pair(char **s, char **key, size_t *key_len, char **value) {
+    char *p = *s;
+    while (*p == ' ')
+        p++;
+
+    if (!*p)
+        return false;
+
+    *key = p;
+    while (*p && *p != '=' && *p != ' ')
+        p++;
+    *key_len = p - *key;
+
+    if (*p)
+        p++;
+
+    *value = p;
+    while (*p && *p != ' ')
+        p++;
+
+    *s = p;
+    return true;
+}
+
+#define cgroup_key_is(key, key_len, str) ((key_len) == sizeof(str) - 1 && memcmp(key, str, sizeof(str) - 1) == 0)
+
+static inline void cgroup2_read_cpu_stat_file(struct cgroup *cg) {
+    struct cpuacct_stat *cp = &cg->cpuacct_stat;
+    struct cpuacct_cpu_throttling *cpt = &cg->cpuacct_cpu_throttling;
+
+    if (unlikely(!cp->filename))
+        return;
+
+    char *s = cgroup_file_read(cg, CGROUP_FILE_CPU_STAT, cp->filename);
+    if (unlikely(!s)) {
+        cp->updated = 0;
+        cgroups_check = 1;
+        return;
+    }
+
+    unsigned long long nr_periods_last = cpt->nr_periods;
+    unsigned long long nr_throttled_last = cpt->nr_throttled;
+
+    char *line, *key, *value;
+    size_t key_len;
+    while ((line = cgroup_file_next_line(&s))) {
+        if (!cgroup_file_next_pair(&line, &key, &key_len, &value))
+            continue;
+
+        if (cgroup_key_is(key, key_len, "user_usec"))
+            cp->user = str2ull(value, NULL);
+        else if (cgroup_key_is(key, key_len, "system_usec"))
+            cp->system = str2ull(value, NULL);
+        else if (cgroup_key_is(key, key_len, "nr_periods"))
+            cpt->nr_periods = str2ull(value, NULL);
+        else if (cgroup_key_is(key, key_len, "nr_throttled"))
+            cpt->nr_throttled = str2ull(value, NULL);
+        else if (cgroup_key_is(key, key_len, "throttled_usec"))
+            cpt->throttled_time = str2ull(value, NULL) * 1000; // usec -> ns
+    }
+
+    cpt->nr_throttled_perc =
+        calc_percentage(calc_delta(cpt->nr_throttled, nr_throttled_last), calc_delta(cpt->nr_periods, nr_periods_last));
+
+    cp->updated = 1;
+    cpt->updated = 1;
+}
+
+// io.stat has both the bytes and the operations, so it is read once for both
+static inline void cgroup2_read_io_stat_file(struct cgroup *cg) {
+    struct blkio *bytes = &cg->io_service_bytes, *ops = &cg->io_serviced;
+
+    if (unlikely(!bytes->filename && !ops->filename))
+        return;
+
+    char *s = cgroup_file_read(cg, CGROUP_FILE_IO_STAT, bytes->filename ? bytes->filename : ops->filename);
+    if (unlikely(!s)) {
+        bytes->updated = 0;
+        ops->updated = 0;
+        cgroups_check = 1;
+        return;
+    }
+
+    unsigned long long rbytes = 0, wbytes = 0, rios = 0, wios = 0;
+
+    char *line, *key, *value;
+    size_t key_len;
+    while ((line = cgroup_file_next_line(&s))) {
+        // skip the device
+        line = strchrnul(line, ' ');
+
+        while (cgroup_file_next_pair(&line, &key, &key_len, &value)) {
+            if (cgroup_key_is(key, key_len, "rbytes"))
+                rbytes += str2ull(value, NULL);
+            else if (cgroup_key_is(key, key_len, "wbytes"))
+                wbytes += str2ull(value, NULL);
+            else if (cgroup_key_is(key, key_len, "rios"))
+                rios += str2ull(value, NULL);
+            else if (cgroup_key_is(key, key_len, "wios"))
+                wios += str2ull(value, NULL);
+        }
+    }
+
+    if (bytes->filename) {
+        bytes->Read = rbytes;
+        bytes->Write = wbytes;
+        bytes->updated = 1;
+    }
+
+    if (ops->filename) {
+        ops->Read = rios;
+        ops->Write = wios;
+        ops->updated = 1;
+    }
+}
+
+static inline void cgroup2_read_pressure_file(struct cgroup *cg, CGROUP_FILE_ID id, struct pressure *res) {
+    if (likely(!res->filename))
+        return;
+
+    char *s = cgroup_file_read(cg, id, res->filename);
+    if (unlikely(!s)) {
+        res->updated = 0;
+        cgroups_check = 1;
+        return;
+    }
+
+    bool did_some = false, did_full = false;
+
+    char *line, *key, *value;
+    size_t key_len;
+    while ((line = cgroup_file_next_line(&s))) {
+        // the line starts with 'some' or 'full', followed by 'avg10=0.00 avg60=0.00 avg300=0.00 total=0'
+        struct pressure_charts *pc;
+        if (strncmp(line, "some ", 5) == 0) {
+            pc = &res->some;
+            did_some = true;
+        }
+        else if (strncmp(line, "full ", 5) == 0) {
+            pc = &res->full;
+            did_full = true;
+        }
+        else
+            continue;
+
+        line += 5;
+        while (cgroup_file_next_pair(&line, &key, &key_len, &value)) {
+            if (cgroup_key_is(key, key_len, "avg10"))
+                pc->share_time.value10 = strtod(value, NULL);
+            else if (cgroup_key_is(key, key_len, "avg60"))
+                pc->share_time.value60 = strtod(value, NULL);
+            else if (cgroup_key_is(key, key_len, "avg300"))
+                pc->share_time.value300 = strtod(value, NULL);
+            else if (cgroup_key_is(key, key_len, "total"))
+                pc->total_time.value_total = str2ull(value, NULL) / 1000; // us->ms
+        }
+    }
+
+    res->updated = (did_full || did_some) ? 1 : 0;
+    res->some.available = did_some;
+    res->full.available = did_full;
+}
+
+static inline bool cgroup2_read_number_file(struct cgroup *cg, CGROUP_FILE_ID id, const char *filename, unsigned long long *value) {
+    char *s = cgroup_file_read(cg, id, filename);
+    if (unlikely(!s))
+        return false;
+
+    *value = str2ull(s, NULL);
+    return true;
+}
+
+static inline void cgroup2_read_memory_files(struct cgroup *cg) {
+    struct memory *mem = &cg->memory;
+
+    if (likely(mem->filename_detailed)) {
+        char *s = cgroup_file_read(cg, CGROUP_FILE_MEMORY_STAT, mem->filename_detailed);
+        if (unlikely(!s)) {
+            mem->updated_detailed = 0;
+            cgroups_check = 1;
+        }
+        else {
+            if (unlikely(!mem->arl_base)) {
+                mem->arl_base = arl_create("cgroup/memory", NULL, 60);
+
+                arl_expect(mem->arl_base, "anon", &mem->anon);
+                arl_expect(mem->arl_base, "kernel_stack", &mem->kernel_stack);
+                arl_expect(mem->arl_base, "slab", &mem->slab);
+                arl_expect(mem->arl_base, "sock", &mem->sock);
+                arl_expect(mem->arl_base, "anon_thp", &mem->anon_thp);
+                arl_expect(mem->arl_base, "file", &mem->total_mapped_file);
+                arl_expect(mem->arl_base, "file_writeback", &mem->total_writeback);
+                mem->arl_dirty = arl_expect(mem->arl_base, "file_dirty", &mem->total_dirty);
+                arl_expect(mem->arl_base, "pgfault", &mem->total_pgfault);
+                arl_expect(mem->arl_base, "pgmajfault", &mem->total_pgmajfault);
+                arl_expect(mem->arl_base, "inactive_file", &mem->total_inactive_file);
+            }
+
+            arl_begin(mem->arl_base);
+
+            char *line;
+            while ((line = cgroup_file_next_line(&s))) {
+                char *value = strchrnul(line, ' ');
+                if (*value)
+                    *value++ = '\0';
+
+                if (arl_check(mem->arl_base, line, value))
+                    break;
+            }
+
+            if (unlikely(mem->arl_dirty->flags & ARL_ENTRY_FLAG_FOUND))
+                mem->detailed_has_dirty = 1;
+
+            mem->updated_detailed = 1;
+        }
+    }
+
+    if (likely(mem->filename_usage_in_bytes)) {
+        mem->updated_usage_in_bytes =
+            cgroup2_read_number_file(cg, CGROUP_FILE_MEMORY_CURRENT, mem->filename_usage_in_bytes, &mem->usage_in_bytes);
+    }
+
+    if (likely(mem->updated_usage_in_bytes && mem->updated_detailed)) {
+        mem->usage_in_bytes =
+            (mem->usage_in_bytes > mem->total_inactive_file) ? (mem->usage_in_bytes - mem->total_inactive_file) : 0;
+    }
+}
+
+static inline void cgroup2_read_all_files(struct cgroup *cg) {
+    cgroup2_read_io_stat_file(cg);
+    cgroup2_read_cpu_stat_file(cg);
+    cgroup_read_cpuacct_cpu_shares(&cg->cpuacct_cpu_shares);
+    cgroup2_read_pressure_file(cg, CGROUP_FILE_CPU_PRESSURE, &cg->cpu_pressure);
+    cgroup2_read_pressure_file(cg, CGROUP_FILE_IO_PRESSURE, &cg->io_pressure);
+    cgroup2_read_pressure_file(cg, CGROUP_FILE_MEMORY_PRESSURE, &cg->memory_pressure);
+    cgroup2_read_pressure_file(cg, CGROUP_FILE_IRQ_PRESSURE, &cg->irq_pressure);
+    cgroup2_read_memory_files(cg);
+
+    cg->pids_current.updated = cg->pids_current.filename &&
+        cgroup2_read_number_file(cg, CGROUP_FILE_PIDS_CURRENT, cg->pids_current.filename, &cg->pids_current.pids_current);
+}
+
+// ----------------------------------------------------------------------------
+
 static inline void read_cgroup(struct cgroup *cg) {
     netdata_log_debug(D_CGROUP, "reading metrics for cgroups '%s'", cg->id);
     if (!(cg->options & CGROUP_OPTIONS_IS_UNIFIED)) {
@@ -930,6 +1268,8 @@ static inline void read_cgroup(struct cgroup *cg) {
         cgroup_read_blkio(&cg->io_merged);
         cgroup_read_blkio(&cg->io_queued);
         cgroup_read_pids_current(&cg->pids_current);
+    } else if (cgroup_reuse_file_descriptors) {
+        cgroup2_read_all_files(cg);
     } else {
         cgroup2_read_blkio(&cg->io_service_bytes, 0);
         cgroup2_read_blkio(&cg->io_serviced, 4);
@@ -1391,6 +1731,8 @@ void cgroups_main(void *ptr) {
     cgroup_netdev_link_init();
 
     discovery_thread.exited = 0;
+    discovery_thread.full_scan = false;
+    discovery_thread.events = false;
 
     if (uv_mutex_init(&discovery_thread.mutex)) {
         collector_error("CGROUP: cannot initialize mutex for discovery thread");
@@ -1422,7 +1764,7 @@ void cgroups_main(void *ptr) {
 
     heartbeat_t hb;
     heartbeat_init(&hb, cgroup_update_every * USEC_PER_SEC);
-    usec_t find_every = cgroup_check_for_new_every * USEC_PER_SEC, find_dt = 0;
+    usec_t find_dt = 0;
 
     while(service_running(SERVICE_COLLECTORS)) {
         worker_is_idle();
@@ -1432,11 +1774,11 @@ void cgroups_main(void *ptr) {
         if (unlikely(!service_running(SERVICE_COLLECTORS)))
             break;
 
+        usec_t find_every = (cgroup_discovery_events_running() ? cgroup_full_scan_every : cgroup_check_for_new_every) * USEC_PER_SEC;
+
         find_dt += hb_dt;
         if (unlikely(find_dt >= find_every || (!is_inside_k8s && cgroups_check))) {
-            uv_mutex_lock(&discovery_thread.mutex);
-            uv_cond_signal(&discovery_thread.cond_var);
-            uv_mutex_unlock(&discovery_thread.mutex);
+            cgroup_discovery_request(true);
             find_dt = 0;
             cgroups_check = 0;
         }
@@ -1466,3 +1808,182 @@ void cgroups_main(void *ptr) {
         uv_mutex_unlock(&cgroup_root_mutex);
     }
 }
+
+// ----------------------------------------------------------------------------
+// benchmark of reading the cgroups v2 of this system, with and without keeping the files open
+
+#define CGROUPS_BENCHMARK_MAX_CGROUPS 10000
+#define CGROUPS_BENCHMARK_ITERATIONS 20
+
+static char *cgroups_benchmark_filename(const char *dir, const char *name) {
+    char filename[FILENAME_MAX + 1];
+    snprintfz(filename, FILENAME_MAX, "%s/%s", dir, name);
+    return access(filename, R_OK) == 0 ? strdupz(filename) : NULL;
+}
+
+static void cgroups_benchmark_find(const char *dir, struct cgroup **cgroups, size_t *count) {
+    if (*count >= CGROUPS_BENCHMARK_MAX_CGROUPS)
+        return;
+
+    struct cgroup *cg = callocz(1, sizeof(*cg));
+    cg->id = strdupz(dir);
+    cg->options = CGROUP_OPTIONS_IS_UNIFIED;
+    cgroup_files_init(cg);
+
+    cg->cpuacct_stat.filename = cgroups_benchmark_filename(dir, "cpu.stat");
+    cg->memory.filename_detailed = cgroups_benchmark_filename(dir, "memory.stat");
+    cg->memory.filename_usage_in_bytes = cgroups_benchmark_filename(dir, "memory.current");
+    cg->io_service_bytes.filename = cgroups_benchmark_filename(dir, "io.stat");
+    cg->io_serviced.filename = cgroups_benchmark_filename(dir, "io.stat");
+    cg->cpu_pressure.filename = cgroups_benchmark_filename(dir, "cpu.pressure");
+    cg->io_pressure.filename = cgroups_benchmark_filename(dir, "io.pressure");
+    cg->memory_pressure.filename = cgroups_benchmark_filename(dir, "memory.pressure");
+    cg->irq_pressure.filename = cgroups_benchmark_filename(dir, "irq.pressure");
+    cg->pids_current.filename = cgroups_benchmark_filename(dir, "pids.current");
+    cgroups[(*count)++] = cg;
+
+    DIR *d = opendir(dir);
+    if (!d)
+        return;
+
+    struct dirent *de;
+    while ((de = readdir(d))) {
+        if (de->d_type != DT_DIR || strcmp(de->d_name, ".") == 0 || strcmp(de->d_name, "..") == 0)
+            continue;
+
+        char child[FILENAME_MAX + 1];
+        snprintfz(child, FILENAME_MAX, "%s/%s", dir, de->d_name);
+        cgroups_benchmark_find(child, cgroups, count);
+    }
+
+    closedir(d);
+}
+
+static void cgroups_benchmark_free(struct cgroup *cg) {
+    cgroup_files_close(cg);
+    freez(cg->cpuacct_stat.filename);
+    freez(cg->memory.filename_detailed);
+    freez(cg->memory.filename_usage_in_bytes);
+    freez(cg->io_service_bytes.filename);
+    freez(cg->io_serviced.filename);
+    freez(cg->cpu_pressure.filename);
+    freez(cg->io_pressure.filename);
+    freez(cg->memory_pressure.filename);
+    freez(cg->irq_pressure.filename);
+    freez(cg->pids_current.filename);
+    arl_free(cg->memory.arl_base);
+    freez(cg->id);
+    freez(cg);
+}
+
+static unsigned long long cgroups_benchmark_read_syscalls(void) {
+    unsigned long long syscr = 0;
+
+    procfile *ff = procfile_open("/proc/thread-self/io", " :", PROCFILE_FLAG_DEFAULT);
+    if (ff && (ff = procfile_readall(ff))) {
+        for (size_t l = 0; l < procfile_lines(ff); l++) {
+            if (strcmp(procfile_lineword(ff, l, 0), "syscr") == 0)
+                syscr = str2ull(procfile_lineword(ff, l, 1), NULL);
+        }
+    }
+    procfile_close(ff);
+
+    return syscr;
+}
+
+static usec_t cgroups_benchmark_cpu_time(void) {
+    struct rusage ru;
+    getrusage(RUSAGE_THREAD, &ru);
+    return ru.ru_utime.tv_sec * USEC_PER_SEC + ru.ru_utime.tv_usec + ru.ru_stime.tv_sec * USEC_PER_SEC + ru.ru_stime.tv_usec;
+}
+
+// a bitmap of the metrics read successfully
+static uint32_t cgroups_benchmark_updated(struct cgroup *cg) {
+    return (cg->cpuacct_stat.updated ? 1 : 0) |
+           (cg->memory.updated_detailed ? 2 : 0) |
+           (cg->memory.updated_usage_in_bytes ? 4 : 0) |
+           (cg->io_service_bytes.updated ? 8 : 0) |
+           (cg->io_serviced.updated ? 16 : 0) |
+           (cg->cpu_pressure.updated ? 32 : 0) |
+           (cg->io_pressure.updated ? 64 : 0) |
+           (cg->memory_pressure.updated ? 128 : 0) |
+           (cg->irq_pressure.updated ? 256 : 0) |
+           (cg->pids_current.updated ? 512 : 0);
+}
+
+int cgroups_read_benchmark(void) {
+    char base[FILENAME_MAX + 1];
+    snprintfz(base, FILENAME_MAX, "%s/sys/fs/cgroup", netdata_configured_host_prefix ? netdata_configured_host_prefix : "");
+
+    char filename[FILENAME_MAX + 1];
+    snprintfz(filename, FILENAME_MAX, "%s/cgroup.controllers", base);
+    if (access(filename, R_OK) != 0) {
+        fprintf(stderr, "CGROUPS: '%s' is not a cgroups v2 hierarchy, nothing to benchmark\n", base);
+        return 0;
+    }
+
+    user_usec_hash = simple_hash("user_usec");
+    system_usec_hash = simple_hash("system_usec");
+    nr_periods_hash = simple_hash("nr_periods");
+    nr_throttled_hash = simple_hash("nr_throttled");
+    throttled_usec_hash = simple_hash("throttled_usec");
+
+    struct cgroup **cgroups = mallocz(CGROUPS_BENCHMARK_MAX_CGROUPS * sizeof(*cgroups));
+    size_t count = 0;
+    cgroups_benchmark_find(base, cgroups, &count);
+
+    uint32_t *updated = callocz(count, sizeof(*updated));
+    bool reuse = cgroup_reuse_file_descriptors;
+    int errors = 0;
+
+    for (int keep_open = 0; keep_open <= 1; keep_open++) {
+        cgroup_reuse_file_descriptors = keep_open;
+
+        // the first iteration opens the files
+        for (size_t i = 0; i < count; i++)
+            read_cgroup(cgroups[i]);
+
+        size_t opened = cgroup_files_opened;
+        unsigned long long syscr = cgroups_benchmark_read_syscalls();
+        usec_t cpu_ut = cgroups_benchmark_cpu_time();
+        usec_t started_ut = now_monotonic_usec();
+
+        for (int it = 0; it < CGROUPS_BENCHMARK_ITERATIONS; it++) {
+            for (size_t i = 0; i < count; i++)
+                read_cgroup(cgroups[i]);
+        }
+
+        usec_t ended_ut = now_monotonic_usec();
+        cpu_ut = cgroups_benchmark_cpu_time() - cpu_ut;
+        syscr = cgroups_benchmark_read_syscalls() - syscr;
+        opened = cgroup_files_opened - opened;
+
+        size_t reads = count * CGROUPS_BENCHMARK_ITERATIONS;
+        fprintf(stderr, "CGROUPS: %-14s %zu cgroups x %d iterations: %0.2f usec cpu, %0.2f read syscalls, %0.2f opens per cgroup (%"PRIu64" usec total)\n",
+                keep_open ? "pread():" : "procfile:", count, CGROUPS_BENCHMARK_ITERATIONS,
+                (double)cpu_ut / (double)reads, (double)syscr / (double)reads,
+                keep_open ? (double)opened / (double)reads : NAN,
+                ended_ut - started_ut);
+
+        for (size_t i = 0; i < count; i++) {
+            uint32_t u = cgroups_benchmark_updated(cgroups[i]);
+            if (!keep_open)
+                updated[i] = u;
+            else if (updated[i] != u) {
+                fprintf(stderr, "CGROUPS: '%s' read metrics 0x%x with procfile, but 0x%x with pread()\n",
+                        cgroups[i]->id, updated[i], u);
+                errors++;
+            }
+        }
+    }
+
+    cgroup_reuse_file_descriptors = reuse;
+
+    for (size_t i = 0; i < count; i++)
+        cgroups_benchmark_free(cgroups[i]);
+
+    freez(updated);
+    freez(cgroups);
+
+    return errors;
+}
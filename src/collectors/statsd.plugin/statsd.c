@@ -20,9 +20,6 @@
 
 // --------------------------------------------------------------------------------------
 
-// DO NOT ENABLE MULTITHREADING - IT IS NOT WELL TESTED
-// #define STATSD_MULTITHREADED 1
-
 #define STATSD_DICTIONARY_OPTIONS (DICT_OPTION_DONT_OVERWRITE_VALUE | DICT_OPTION_ADD_IN_FRONT)
 #define STATSD_DECIMAL_DETAIL 1000 // floating point values get multiplied by this, with the same divisor
 
@@ -31,6 +28,7 @@
 
 typedef struct statsd_metric_gauge {
     NETDATA_DOUBLE value;
+    bool set;                       // shards only: an absolute value has been received since the last merge
 } STATSD_METRIC_GAUGE;
 
 typedef struct statsd_metric_counter { // counter and meter
@@ -60,6 +58,12 @@ typedef struct statsd_histogram_extensions {
     uint32_t size;
     uint32_t used;
     NETDATA_DOUBLE *values;   // dynamic array of values collected
+
+    // when histograms and timers use sketches, the values are summarized here instead,
+    // weighted by their sampling rate
+    TDIGEST *td;
+    NETDATA_DOUBLE td_mean;   // the weighted running mean of the values, for the stddev
+    NETDATA_DOUBLE td_m2;     // the weighted sum of the squared differences from the mean
 } STATSD_METRIC_HISTOGRAM_EXTENSIONS;
 
 typedef struct statsd_metric_histogram { // histogram and timer
@@ -108,6 +112,8 @@ typedef enum __attribute__((packed)) statsd_metric_type {
     STATSD_METRIC_TYPE_DICTIONARY
 } STATSD_METRIC_TYPE;
 
+#define STATSD_METRIC_TYPES (STATSD_METRIC_TYPE_DICTIONARY + 1)
+
 
 typedef struct statsd_metric {
     const char *name;               // the name of the metric - linked to dictionary name
@@ -143,6 +149,9 @@ typedef struct statsd_metric {
 
     // linking, used for walking through all metrics
     struct statsd_metric *next_useful;
+
+    // shards only: the metric of the global index this one is merged to
+    struct statsd_metric *merge_to;
 } STATSD_METRIC;
 
 
@@ -232,11 +241,22 @@ typedef struct statsd_app {
 // --------------------------------------------------------------------------------------------------------------------
 // global statsd data
 
+// Each collection thread aggregates the metrics it receives to its own shard,
+// without touching the global indexes. The flushing thread merges the shards
+// to the global indexes, just before flushing them.
+typedef struct statsd_shard {
+    SPINLOCK spinlock;              // held by the collection thread while processing a packet, and while merging
+    STATSD_INDEX index[STATSD_METRIC_TYPES];
+} STATSD_SHARD;
+
+static __thread STATSD_SHARD *statsd_shard = NULL;
+
 struct collection_thread_status {
     SPINLOCK spinlock;
     bool initializing;
     uint32_t max_sockets;
 
+    STATSD_SHARD *shard;
     ND_THREAD *thread;
 };
 
@@ -278,9 +298,11 @@ static struct statsd {
     uint32_t dictionary_max_unique;
     double histogram_percentile;
     char *histogram_percentile_str;
+    bool histogram_sketch;
 
     int threads;
     struct collection_thread_status *collection_threads_status;
+    STATSD_SHARD *shards;           // one per collection thread
 
     LISTEN_SOCKETS sockets;
 } statsd = {
@@ -394,9 +416,19 @@ static void dictionary_metric_delete_callback(const DICTIONARY_ITEM *item, void
     STATSD_METRIC *m = (STATSD_METRIC *)value;
 
     if(m->type == STATSD_METRIC_TYPE_HISTOGRAM || m->type == STATSD_METRIC_TYPE_TIMER) {
+        freez(m->histogram.ext->values);
+        freez(m->histogram.ext->td);
         freez(m->histogram.ext);
         m->histogram.ext = NULL;
     }
+    else if(m->type == STATSD_METRIC_TYPE_SET && m->set.dict) {
+        dictionary_destroy(m->set.dict);
+        m->set.dict = NULL;
+    }
+    else if(m->type == STATSD_METRIC_TYPE_DICTIONARY && m->dictionary.dict) {
+        dictionary_destroy(m->dictionary.dict);
+        m->dictionary.dict = NULL;
+    }
 
     freez(m->units);
     freez(m->family);
@@ -406,17 +438,10 @@ static void dictionary_metric_delete_callback(const DICTIONARY_ITEM *item, void
 static inline STATSD_METRIC *statsd_find_or_add_metric(STATSD_INDEX *index, const char *name) {
     netdata_log_debug(D_STATSD, "searching for metric '%s' under '%s'", name, index->name);
 
-#ifdef STATSD_MULTITHREADED
-    // avoid the write lock of dictionary_set() for existing metrics
-    STATSD_METRIC *m = dictionary_get(index->dict, name);
-    if(!m) m = dictionary_set(index->dict, name, NULL, sizeof(STATSD_METRIC));
-#else
-    // no locks here, go faster
     // this will call the dictionary_metric_insert_callback() if an item
     // is inserted, otherwise it will return the existing one.
     // We used the flag DICT_OPTION_DONT_OVERWRITE_VALUE to support this.
     STATSD_METRIC *m = dictionary_set(index->dict, name, NULL, sizeof(STATSD_METRIC));
-#endif
 
     index->events++;
     return m;
@@ -448,6 +473,16 @@ static inline NETDATA_DOUBLE statsd_parse_sampling_rate(const char *v) {
     return sampling_rate;
 }
 
+// histograms and timers store 1/rate copies of each value, so they are limited
+// to 100 copies, and the sketches are weighted the same way to give the same results
+#define STATSD_HISTOGRAM_MIN_SAMPLING_RATE 0.01
+
+static inline NETDATA_DOUBLE statsd_parse_histogram_sampling_rate(const char *v) {
+    NETDATA_DOUBLE sampling_rate = statsd_parse_sampling_rate(v);
+    if(unlikely(isless(sampling_rate, STATSD_HISTOGRAM_MIN_SAMPLING_RATE))) sampling_rate = STATSD_HISTOGRAM_MIN_SAMPLING_RATE;
+    return sampling_rate;
+}
+
 static inline long long statsd_parse_int(const char *v, long long def) {
     long long value;
 
@@ -505,8 +540,10 @@ static inline void statsd_process_gauge(STATSD_METRIC *m, const char *value, con
     else {
         if (unlikely(*value == '+' || *value == '-'))
             m->gauge.value += statsd_parse_float(value, 1.0) / statsd_parse_sampling_rate(sampling);
-        else
+        else {
             m->gauge.value = statsd_parse_float(value, 1.0);
+            m->gauge.set = true;
+        }
 
         metric_update_counters_and_obsoletion(m);
     }
@@ -532,6 +569,41 @@ static inline void statsd_process_counter_or_meter(STATSD_METRIC *m, const char
 #define statsd_process_counter(m, value, sampling) statsd_process_counter_or_meter(m, value, sampling)
 #define statsd_process_meter(m, value, sampling) statsd_process_counter_or_meter(m, value, sampling)
 
+static inline void statsd_histogram_sketch_reset(STATSD_METRIC_HISTOGRAM_EXTENSIONS *ext) {
+    netdata_mutex_lock(&ext->mutex);
+    if(ext->td)
+        tdigest_reset(ext->td);
+    ext->td_mean = 0;
+    ext->td_m2 = 0;
+    netdata_mutex_unlock(&ext->mutex);
+}
+
+static inline void statsd_histogram_sketch_add(STATSD_METRIC_HISTOGRAM_EXTENSIONS *ext, NETDATA_DOUBLE v, NETDATA_DOUBLE weight) {
+    netdata_mutex_lock(&ext->mutex);
+
+    if(unlikely(!ext->td)) {
+        ext->td = mallocz(sizeof(TDIGEST));
+        tdigest_reset(ext->td);
+    }
+
+    // weighted incremental mean and variance (West, 1979)
+    NETDATA_DOUBLE total = tdigest_weight(ext->td) + weight;
+    NETDATA_DOUBLE delta = v - ext->td_mean;
+    ext->td_mean += delta * weight / total;
+    ext->td_m2 += weight * delta * (v - ext->td_mean);
+
+    tdigest_add_weighted(ext->td, v, weight);
+
+    netdata_mutex_unlock(&ext->mutex);
+}
+
+static inline bool statsd_histogram_has_values(STATSD_METRIC_HISTOGRAM_EXTENSIONS *ext) {
+    if(ext->td && tdigest_weight(ext->td) > 0)
+        return true;
+
+    return ext->used > 0;
+}
+
 static inline void statsd_process_histogram_or_timer(STATSD_METRIC *m, const char *value, const char *sampling, const char *type) {
     if(!is_metric_useful_for_collection(m)) return;
 
@@ -542,19 +614,24 @@ static inline void statsd_process_histogram_or_timer(STATSD_METRIC *m, const cha
 
     if(unlikely(m->reset)) {
         m->histogram.ext->used = 0;
+        if(m->histogram.ext->td)
+            statsd_histogram_sketch_reset(m->histogram.ext);
         statsd_reset_metric(m);
     }
 
     if(unlikely(value_is_zinit(value))) {
         // magic loading of metric, without affecting anything
     }
-    else {
+    else if(statsd.histogram_sketch) {
+        // one value, weighted by the sampling rate, instead of 1/rate copies of it
         NETDATA_DOUBLE v = statsd_parse_float(value, 1.0);
-        NETDATA_DOUBLE sampling_rate = statsd_parse_sampling_rate(sampling);
-        if(unlikely(isless(sampling_rate, 0.01))) sampling_rate = 0.01;
-        if(unlikely(isgreater(sampling_rate, 1.0))) sampling_rate = 1.0;
+        statsd_histogram_sketch_add(m->histogram.ext, v, 1.0 / statsd_parse_histogram_sampling_rate(sampling));
 
-        long long samples = llrintndd(1.0 / sampling_rate);
+        metric_update_counters_and_obsoletion(m);
+    }
+    else {
+        NETDATA_DOUBLE v = statsd_parse_float(value, 1.0);
+        long long samples = llrintndd(1.0 / statsd_parse_histogram_sampling_rate(sampling));
         while(samples-- > 0) {
 
             if(unlikely(m->histogram.ext->used == m->histogram.ext->size)) {
@@ -597,13 +674,7 @@ static inline void statsd_process_set(STATSD_METRIC *m, const char *value) {
         // magic loading of metric, without affecting anything
     }
     else {
-#ifdef STATSD_MULTITHREADED
-        // avoid the write lock to check if something is already there
-        if(!dictionary_get(m->set.dict, value))
-            dictionary_set(m->set.dict, value, NULL, 0);
-#else
         dictionary_set(m->set.dict, value, NULL, 0);
-#endif
         metric_update_counters_and_obsoletion(m);
     }
 }
@@ -684,43 +755,44 @@ static void statsd_process_metric(const char *name, const char *value, const cha
     if(unlikely(!type || !*type)) type = "m";
 
     STATSD_METRIC *m = NULL;
+    STATSD_INDEX *index = statsd_shard->index;
 
     char t0 = type[0], t1 = type[1];
     if(unlikely(t0 == 'g' && t1 == '\0')) {
         statsd_process_gauge(
-            m = statsd_find_or_add_metric(&statsd.gauges, name),
+            m = statsd_find_or_add_metric(&index[STATSD_METRIC_TYPE_GAUGE], name),
             value, sampling);
     }
     else if(unlikely((t0 == 'c' || t0 == 'C') && t1 == '\0')) {
         // etsy/statsd uses 'c'
         // brubeck     uses 'C'
         statsd_process_counter(
-            m = statsd_find_or_add_metric(&statsd.counters, name),
+            m = statsd_find_or_add_metric(&index[STATSD_METRIC_TYPE_COUNTER], name),
             value, sampling);
     }
     else if(unlikely(t0 == 'm' && t1 == '\0')) {
         statsd_process_meter(
-            m = statsd_find_or_add_metric(&statsd.meters, name),
+            m = statsd_find_or_add_metric(&index[STATSD_METRIC_TYPE_METER], name),
             value, sampling);
     }
     else if(unlikely(t0 == 'h' && t1 == '\0')) {
         statsd_process_histogram(
-            m = statsd_find_or_add_metric(&statsd.histograms, name),
+            m = statsd_find_or_add_metric(&index[STATSD_METRIC_TYPE_HISTOGRAM], name),
             value, sampling);
     }
     else if(unlikely(t0 == 's' && t1 == '\0')) {
         statsd_process_set(
-            m = statsd_find_or_add_metric(&statsd.sets, name),
+            m = statsd_find_or_add_metric(&index[STATSD_METRIC_TYPE_SET], name),
             value);
     }
     else if(unlikely(t0 == 'd' && t1 == '\0')) {
         statsd_process_dictionary(
-            m = statsd_find_or_add_metric(&statsd.dictionaries, name),
+            m = statsd_find_or_add_metric(&index[STATSD_METRIC_TYPE_DICTIONARY], name),
             value);
     }
     else if(unlikely(t0 == 'm' && t1 == 's' && type[2] == '\0')) {
         statsd_process_timer(
-            m = statsd_find_or_add_metric(&statsd.timers, name),
+            m = statsd_find_or_add_metric(&index[STATSD_METRIC_TYPE_TIMER], name),
             value, sampling);
     }
     else {
@@ -771,7 +843,7 @@ static void statsd_process_metric(const char *name, const char *value, const cha
     }
 }
 
-static inline size_t statsd_process(char *buffer, size_t size, int require_newlines) {
+static inline size_t statsd_process_unsafe(char *buffer, size_t size, int require_newlines) {
     buffer[size] = '\0';
     netdata_log_debug(D_STATSD, "RECEIVED: %zu bytes: '%s'", size, buffer);
 
@@ -836,6 +908,13 @@ static inline size_t statsd_process(char *buffer, size_t size, int require_newli
     return 0;
 }
 
+static inline size_t statsd_process(char *buffer, size_t size, int require_newlines) {
+    spinlock_lock(&statsd_shard->spinlock);
+    size_t ret = statsd_process_unsafe(buffer, size, require_newlines);
+    spinlock_unlock(&statsd_shard->spinlock);
+    return ret;
+}
+
 
 // --------------------------------------------------------------------------------------------------------------------
 // statsd pollfd interface
@@ -1102,6 +1181,8 @@ static bool statsd_should_stop(void) {
 
 void statsd_collector_thread(void *ptr) {
     struct collection_thread_status *status = ptr;
+    statsd_shard = status->shard;
+
     spinlock_lock(&status->spinlock);
     status->initializing = false;
     spinlock_unlock(&status->spinlock);
@@ -1965,26 +2046,49 @@ static inline void statsd_flush_dictionary(STATSD_METRIC *m) {
     metric_check_obsoletion(m);
 }
 
-static inline void statsd_flush_timer_or_histogram(STATSD_METRIC *m, const char *dim, const char *family, const char *units) {
-    netdata_log_debug(D_STATSD, "flushing %s metric '%s'", dim, m->name);
+static inline void statsd_histogram_calculate(STATSD_METRIC *m) {
+    STATSD_METRIC_HISTOGRAM_EXTENSIONS *ext = m->histogram.ext;
 
-    int updated = 0;
-    if(unlikely(!m->reset && m->count && m->histogram.ext->used > 0)) {
-        netdata_mutex_lock(&m->histogram.ext->mutex);
+    netdata_mutex_lock(&ext->mutex);
 
-        size_t len = m->histogram.ext->used;
-        NETDATA_DOUBLE *series = m->histogram.ext->values;
+    if(ext->td && tdigest_weight(ext->td) > 0) {
+        TDIGEST *td = ext->td;
+        tdigest_compress(td);
+
+        NETDATA_DOUBLE weight = tdigest_weight(td);
+        NETDATA_DOUBLE stddev = (weight > 1.0) ? sqrtndd(ext->td_m2 / (weight - 1.0)) : td->sum;
+
+        ext->last_min = (collected_number)roundndd(td->min * statsd.decimal_detail);
+        ext->last_max = (collected_number)roundndd(td->max * statsd.decimal_detail);
+        m->last = (collected_number)roundndd(td->sum / weight * statsd.decimal_detail);
+        ext->last_stddev = (collected_number)roundndd(stddev * statsd.decimal_detail);
+        ext->last_sum = (collected_number)roundndd(td->sum * statsd.decimal_detail);
+        ext->last_median = (collected_number)roundndd(tdigest_quantile(td, 0.5) * statsd.decimal_detail);
+        ext->last_percentile = (collected_number)roundndd(tdigest_quantile(td, statsd.histogram_percentile / 100) * statsd.decimal_detail);
+    }
+    else {
+        size_t len = ext->used;
+        NETDATA_DOUBLE *series = ext->values;
         sort_series(series, len);
 
-        m->histogram.ext->last_min = (collected_number)roundndd(series[0] * statsd.decimal_detail);
-        m->histogram.ext->last_max = (collected_number)roundndd(series[len - 1] * statsd.decimal_detail);
+        ext->last_min = (collected_number)roundndd(series[0] * statsd.decimal_detail);
+        ext->last_max = (collected_number)roundndd(series[len - 1] * statsd.decimal_detail);
         m->last = (collected_number)roundndd(average(series, len) * statsd.decimal_detail);
-        m->histogram.ext->last_stddev = (collected_number)roundndd(standard_deviation(series, len) * statsd.decimal_detail);
-        m->histogram.ext->last_sum = (collected_number)roundndd(sum(series, len) * statsd.decimal_detail);
-        m->histogram.ext->last_median = (collected_number)roundndd(median_on_sorted_series(series, len) * statsd.decimal_detail);
-        m->histogram.ext->last_percentile = (collected_number)roundndd(percentile_on_sorted_series(series, len,  statsd.histogram_percentile / 100) * statsd.decimal_detail);
+        ext->last_stddev = (collected_number)roundndd(standard_deviation(series, len) * statsd.decimal_detail);
+        ext->last_sum = (collected_number)roundndd(sum(series, len) * statsd.decimal_detail);
+        ext->last_median = (collected_number)roundndd(median_on_sorted_series(series, len) * statsd.decimal_detail);
+        ext->last_percentile = (collected_number)roundndd(percentile_on_sorted_series(series, len,  statsd.histogram_percentile / 100) * statsd.decimal_detail);
+    }
+
+    netdata_mutex_unlock(&ext->mutex);
+}
 
-        netdata_mutex_unlock(&m->histogram.ext->mutex);
+static inline void statsd_flush_timer_or_histogram(STATSD_METRIC *m, const char *dim, const char *family, const char *units) {
+    netdata_log_debug(D_STATSD, "flushing %s metric '%s'", dim, m->name);
+
+    int updated = 0;
+    if(unlikely(!m->reset && m->count && statsd_histogram_has_values(m->histogram.ext))) {
+        statsd_histogram_calculate(m);
 
         netdata_log_debug(D_STATSD, "STATSD %s metric %s: min " COLLECTED_NUMBER_FORMAT ", max " COLLECTED_NUMBER_FORMAT ", last " COLLECTED_NUMBER_FORMAT ", pcent " COLLECTED_NUMBER_FORMAT ", median " COLLECTED_NUMBER_FORMAT ", stddev " COLLECTED_NUMBER_FORMAT ", sum " COLLECTED_NUMBER_FORMAT,
               dim, m->name, m->histogram.ext->last_min, m->histogram.ext->last_max, m->last, m->histogram.ext->last_percentile, m->histogram.ext->last_median, m->histogram.ext->last_stddev, m->histogram.ext->last_sum);
@@ -2309,9 +2413,233 @@ const char *statsd_metric_type_string(STATSD_METRIC_TYPE type) {
     }
 }
 
+// --------------------------------------------------------------------------------------------------------------------
+// merging the shards of the collection threads to the global indexes
+
+static inline STATSD_INDEX *statsd_index_of_type(STATSD_METRIC_TYPE type) {
+    switch(type) {
+        case STATSD_METRIC_TYPE_GAUGE: return &statsd.gauges;
+        case STATSD_METRIC_TYPE_COUNTER: return &statsd.counters;
+        case STATSD_METRIC_TYPE_METER: return &statsd.meters;
+        case STATSD_METRIC_TYPE_TIMER: return &statsd.timers;
+        case STATSD_METRIC_TYPE_HISTOGRAM: return &statsd.histograms;
+        case STATSD_METRIC_TYPE_SET: return &statsd.sets;
+        case STATSD_METRIC_TYPE_DICTIONARY: return &statsd.dictionaries;
+        default: return NULL;
+    }
+}
+
+static inline bool statsd_merge_tag(char **dst, const char *src) {
+    if(!src || (*dst && strcmp(*dst, src) == 0))
+        return false;
+
+    freez(*dst);
+    *dst = strdupz(src);
+    return true;
+}
+
+static inline void statsd_merge_histogram(STATSD_METRIC *m, STATSD_METRIC *sm) {
+    STATSD_METRIC_HISTOGRAM_EXTENSIONS *ext = m->histogram.ext, *sext = sm->histogram.ext;
+
+    netdata_mutex_lock(&ext->mutex);
+
+    if(sext->used) {
+        if(ext->used + sext->used > ext->size) {
+            ext->size = ext->used + sext->used + statsd.histogram_increase_step;
+            ext->values = reallocz(ext->values, sizeof(NETDATA_DOUBLE) * ext->size);
+        }
+        memcpy(&ext->values[ext->used], sext->values, sizeof(NETDATA_DOUBLE) * sext->used);
+        ext->used += sext->used;
+        sext->used = 0;
+    }
+
+    if(sext->td && tdigest_weight(sext->td) > 0) {
+        if(unlikely(!ext->td)) {
+            ext->td = mallocz(sizeof(TDIGEST));
+            tdigest_reset(ext->td);
+        }
+
+        // combine the running means and variances (Chan et al.)
+        NETDATA_DOUBLE wa = tdigest_weight(ext->td), wb = tdigest_weight(sext->td);
+        NETDATA_DOUBLE delta = sext->td_mean - ext->td_mean;
+        ext->td_mean += delta * wb / (wa + wb);
+        ext->td_m2 += sext->td_m2 + delta * delta * wa * wb / (wa + wb);
+
+        tdigest_merge(ext->td, sext->td);
+
+        tdigest_reset(sext->td);
+        sext->td_mean = 0;
+        sext->td_m2 = 0;
+    }
+
+    netdata_mutex_unlock(&ext->mutex);
+}
+
+static inline void statsd_merge_set(STATSD_METRIC *m, STATSD_METRIC *sm) {
+    if(!sm->set.dict)
+        return;
+
+    if(unlikely(!m->set.dict))
+        m->set.dict = dictionary_create_advanced(STATSD_DICTIONARY_OPTIONS, &dictionary_stats_category_collectors, 0);
+
+    void *t;
+    dfe_start_read(sm->set.dict, t) {
+        dictionary_set(m->set.dict, t_dfe.name, NULL, 0);
+    }
+    dfe_done(t);
+
+    dictionary_flush(sm->set.dict);
+}
+
+static inline void statsd_merge_dictionary(STATSD_METRIC *m, STATSD_METRIC *sm) {
+    if(!sm->dictionary.dict)
+        return;
+
+    if (unlikely(!m->dictionary.dict))
+        m->dictionary.dict = dictionary_create_advanced(STATSD_DICTIONARY_OPTIONS | DICT_OPTION_FIXED_SIZE, &dictionary_stats_category_collectors, sizeof(STATSD_METRIC_DICTIONARY_ITEM));
+
+    STATSD_METRIC_DICTIONARY_ITEM *st;
+    dfe_start_read(sm->dictionary.dict, st) {
+        const char *value = st_dfe.name;
+        STATSD_METRIC_DICTIONARY_ITEM *t = (STATSD_METRIC_DICTIONARY_ITEM *)dictionary_get(m->dictionary.dict, value);
+
+        if (unlikely(!t)) {
+            if(dictionary_entries(m->dictionary.dict) >= statsd.dictionary_max_unique)
+                value = "other";
+
+            t = (STATSD_METRIC_DICTIONARY_ITEM *)dictionary_set(m->dictionary.dict, value, NULL, sizeof(STATSD_METRIC_DICTIONARY_ITEM));
+        }
+
+        t->count += st->count;
+    }
+    dfe_done(st);
+
+    dictionary_flush(sm->dictionary.dict);
+}
+
+static inline void statsd_merge_metric(STATSD_INDEX *index, STATSD_METRIC *sm) {
+    if(unlikely(!sm->merge_to))
+        sm->merge_to = dictionary_set(index->dict, sm->name, NULL, sizeof(STATSD_METRIC));
+
+    STATSD_METRIC *m = sm->merge_to;
+
+    // let the collection thread know if the metric is useful
+    sm->options |= m->options & (STATSD_METRIC_OPTION_CHECKED | STATSD_METRIC_OPTION_USEFUL);
+
+    if(unlikely(sm->options & STATSD_METRIC_OPTION_UPDATED_CHART_METADATA)) {
+        bool updated = statsd_merge_tag(&m->units, sm->units);
+        updated = statsd_merge_tag(&m->dimname, sm->dimname) || updated;
+        updated = statsd_merge_tag(&m->family, sm->family) || updated;
+        if(updated)
+            m->options |= STATSD_METRIC_OPTION_UPDATED_CHART_METADATA;
+
+        sm->options &= ~STATSD_METRIC_OPTION_UPDATED_CHART_METADATA;
+    }
+
+    if(!sm->count)
+        return;
+
+    if(unlikely(m->reset)) {
+        switch(m->type) {
+            case STATSD_METRIC_TYPE_HISTOGRAM:
+            case STATSD_METRIC_TYPE_TIMER:
+                m->histogram.ext->used = 0;
+                if(m->histogram.ext->td)
+                    statsd_histogram_sketch_reset(m->histogram.ext);
+                break;
+
+            case STATSD_METRIC_TYPE_SET:
+                if(likely(m->set.dict)) {
+                    dictionary_destroy(m->set.dict);
+                    m->set.dict = NULL;
+                }
+                break;
+
+            default:
+                break;
+        }
+        statsd_reset_metric(m);
+    }
+
+    switch(m->type) {
+        case STATSD_METRIC_TYPE_GAUGE:
+            // the shard has the latest absolute value (plus any changes after it), or just the changes
+            if(sm->gauge.set)
+                m->gauge.value = sm->gauge.value;
+            else
+                m->gauge.value += sm->gauge.value;
+
+            sm->gauge.value = 0;
+            sm->gauge.set = false;
+            break;
+
+        case STATSD_METRIC_TYPE_COUNTER:
+        case STATSD_METRIC_TYPE_METER:
+            m->counter.value += sm->counter.value;
+            sm->counter.value = 0;
+            break;
+
+        case STATSD_METRIC_TYPE_HISTOGRAM:
+        case STATSD_METRIC_TYPE_TIMER:
+            statsd_merge_histogram(m, sm);
+            break;
+
+        case STATSD_METRIC_TYPE_SET:
+            statsd_merge_set(m, sm);
+            break;
+
+        case STATSD_METRIC_TYPE_DICTIONARY:
+            statsd_merge_dictionary(m, sm);
+            break;
+    }
+
+    m->events += sm->count;
+    m->count += sm->count;
+    if(sm->last_collected > m->last_collected)
+        m->last_collected = sm->last_collected;
+    m->options &= ~STATSD_METRIC_OPTION_OBSOLETE;
+
+    sm->count = 0;
+}
+
+static void statsd_merge_shards(STATSD_INDEX *index) {
+    for(int i = 0; i < statsd.threads && statsd.shards ; i++) {
+        STATSD_SHARD *shard = &statsd.shards[i];
+        STATSD_INDEX *shard_index = &shard->index[index->type];
+
+        spinlock_lock(&shard->spinlock);
+
+        STATSD_METRIC *sm;
+        dfe_start_read(shard_index->dict, sm) {
+            statsd_merge_metric(index, sm);
+        }
+        dfe_done(sm);
+
+        index->events += shard_index->events;
+        shard_index->events = 0;
+
+        spinlock_unlock(&shard->spinlock);
+    }
+}
+
+static void statsd_shards_delete_metric(STATSD_INDEX *index, STATSD_METRIC *m) {
+    for(int i = 0; i < statsd.threads && statsd.shards ; i++) {
+        STATSD_SHARD *shard = &statsd.shards[i];
+        STATSD_INDEX *shard_index = &shard->index[index->type];
+
+        spinlock_lock(&shard->spinlock);
+        if(dictionary_del(shard_index->dict, m->name))
+            shard_index->metrics--;
+        spinlock_unlock(&shard->spinlock);
+    }
+}
+
 static inline void statsd_flush_index_metrics(STATSD_INDEX *index, void (*flush_metric)(STATSD_METRIC *)) {
     STATSD_METRIC *m;
 
+    // bring in everything the collection threads have received since the last flush
+    statsd_merge_shards(index);
+
     // find the useful metrics (incremental = each time we are called, we check the new metrics only)
     dfe_start_read(index->dict, m) {
         // since we add new metrics at the beginning
@@ -2370,6 +2698,7 @@ static inline void statsd_flush_index_metrics(STATSD_INDEX *index, void (*flush_
                 index->first_useful = m->next_useful;
             else
                 m_prev->next_useful = m->next_useful;
+            statsd_shards_delete_metric(index, m);
             dictionary_del(index->dict, m->name);
             index->useful--;
             index->metrics--;
@@ -2383,6 +2712,39 @@ static inline void statsd_flush_index_metrics(STATSD_INDEX *index, void (*flush_
 // --------------------------------------------------------------------------------------
 // statsd main thread
 
+static void statsd_index_init(STATSD_INDEX *index) {
+    index->dict = dictionary_create_advanced(STATSD_DICTIONARY_OPTIONS | DICT_OPTION_FIXED_SIZE, &dictionary_stats_category_collectors, sizeof(STATSD_METRIC));
+    dictionary_register_insert_callback(index->dict, dictionary_metric_insert_callback, index);
+    dictionary_register_delete_callback(index->dict, dictionary_metric_delete_callback, index);
+}
+
+static STATSD_SHARD *statsd_shards_create(int shards) {
+    STATSD_SHARD *array = callocz((size_t)shards, sizeof(STATSD_SHARD));
+
+    for(int i = 0; i < shards ;i++) {
+        spinlock_init(&array[i].spinlock);
+
+        for(STATSD_METRIC_TYPE type = 0; type < STATSD_METRIC_TYPES ;type++) {
+            STATSD_INDEX *index = &array[i].index[type];
+            index->name = statsd_index_of_type(type)->name;
+            index->type = type;
+            index->default_options = STATSD_METRIC_OPTION_NONE;
+            statsd_index_init(index);
+        }
+    }
+
+    return array;
+}
+
+static void statsd_shards_destroy(STATSD_SHARD *shards, int count) {
+    for(int i = 0; i < count ;i++) {
+        for(STATSD_METRIC_TYPE type = 0; type < STATSD_METRIC_TYPES ;type++)
+            dictionary_destroy(shards[i].index[type].dict);
+    }
+
+    freez(shards);
+}
+
 static int statsd_listen_sockets_setup(void) {
     return listen_sockets_setup(&statsd.sockets);
 }
@@ -2410,6 +2772,11 @@ static void statsd_main_cleanup(void *pptr) {
         freez(statsd.collection_threads_status);
     }
 
+    if(statsd.shards) {
+        statsd_shards_destroy(statsd.shards, statsd.threads);
+        statsd.shards = NULL;
+    }
+
     collector_info("STATSD: closing sockets...");
     listen_sockets_close(&statsd.sockets);
 
@@ -2464,29 +2831,13 @@ void *statsd_main(void *ptr) {
     worker_register_job_name(WORKER_STATSD_FLUSH_DICTIONARIES, "dictionaries");
     worker_register_job_name(WORKER_STATSD_FLUSH_STATS, "statistics");
 
-    statsd.gauges.dict = dictionary_create_advanced(STATSD_DICTIONARY_OPTIONS | DICT_OPTION_FIXED_SIZE, &dictionary_stats_category_collectors, sizeof(STATSD_METRIC));
-    statsd.meters.dict = dictionary_create_advanced(STATSD_DICTIONARY_OPTIONS | DICT_OPTION_FIXED_SIZE, &dictionary_stats_category_collectors, sizeof(STATSD_METRIC));
-    statsd.counters.dict = dictionary_create_advanced(STATSD_DICTIONARY_OPTIONS | DICT_OPTION_FIXED_SIZE, &dictionary_stats_category_collectors, sizeof(STATSD_METRIC));
-    statsd.histograms.dict = dictionary_create_advanced(STATSD_DICTIONARY_OPTIONS | DICT_OPTION_FIXED_SIZE, &dictionary_stats_category_collectors, sizeof(STATSD_METRIC));
-    statsd.dictionaries.dict = dictionary_create_advanced(STATSD_DICTIONARY_OPTIONS | DICT_OPTION_FIXED_SIZE, &dictionary_stats_category_collectors, sizeof(STATSD_METRIC));
-    statsd.sets.dict = dictionary_create_advanced(STATSD_DICTIONARY_OPTIONS | DICT_OPTION_FIXED_SIZE, &dictionary_stats_category_collectors, sizeof(STATSD_METRIC));
-    statsd.timers.dict = dictionary_create_advanced(STATSD_DICTIONARY_OPTIONS | DICT_OPTION_FIXED_SIZE, &dictionary_stats_category_collectors, sizeof(STATSD_METRIC));
-
-    dictionary_register_insert_callback(statsd.gauges.dict, dictionary_metric_insert_callback, &statsd.gauges);
-    dictionary_register_insert_callback(statsd.meters.dict, dictionary_metric_insert_callback, &statsd.meters);
-    dictionary_register_insert_callback(statsd.counters.dict, dictionary_metric_insert_callback, &statsd.counters);
-    dictionary_register_insert_callback(statsd.histograms.dict, dictionary_metric_insert_callback, &statsd.histograms);
-    dictionary_register_insert_callback(statsd.dictionaries.dict, dictionary_metric_insert_callback, &statsd.dictionaries);
-    dictionary_register_insert_callback(statsd.sets.dict, dictionary_metric_insert_callback, &statsd.sets);
-    dictionary_register_insert_callback(statsd.timers.dict, dictionary_metric_insert_callback, &statsd.timers);
-
-    dictionary_register_delete_callback(statsd.gauges.dict, dictionary_metric_delete_callback, &statsd.gauges);
-    dictionary_register_delete_callback(statsd.meters.dict, dictionary_metric_delete_callback, &statsd.meters);
-    dictionary_register_delete_callback(statsd.counters.dict, dictionary_metric_delete_callback, &statsd.counters);
-    dictionary_register_delete_callback(statsd.histograms.dict, dictionary_metric_delete_callback, &statsd.histograms);
-    dictionary_register_delete_callback(statsd.dictionaries.dict, dictionary_metric_delete_callback, &statsd.dictionaries);
-    dictionary_register_delete_callback(statsd.sets.dict, dictionary_metric_delete_callback, &statsd.sets);
-    dictionary_register_delete_callback(statsd.timers.dict, dictionary_metric_delete_callback, &statsd.timers);
+    statsd_index_init(&statsd.gauges);
+    statsd_index_init(&statsd.meters);
+    statsd_index_init(&statsd.counters);
+    statsd_index_init(&statsd.histograms);
+    statsd_index_init(&statsd.dictionaries);
+    statsd_index_init(&statsd.sets);
+    statsd_index_init(&statsd.timers);
 
     // ----------------------------------------------------------------------------------------------------------------
     // statsd configuration
@@ -2539,6 +2890,9 @@ void *statsd_main(void *ptr) {
         statsd.histogram_percentile_str = strdupz(buffer);
     }
 
+    statsd.histogram_sketch =
+        inicfg_get_boolean(&netdata_config, CONFIG_SECTION_STATSD, "histograms and timers use sketches", statsd.histogram_sketch);
+
     statsd.dictionary_max_unique =
         inicfg_get_number(&netdata_config, CONFIG_SECTION_STATSD, "dictionaries max unique dimensions", statsd.dictionary_max_unique);
 
@@ -2575,16 +2929,12 @@ void *statsd_main(void *ptr) {
 
     size_t max_sockets = (size_t)inicfg_get_number(&netdata_config, CONFIG_SECTION_STATSD, "statsd server max TCP sockets", (long long int)(rlimit_nofile.rlim_cur / 4));
 
-#ifdef STATSD_MULTITHREADED
-    statsd.threads = (int)inicfg_get_number(&netdata_config, CONFIG_SECTION_STATSD, "threads", processors);
-    if(statsd.threads < 1) {
-        collector_error("STATSD: Invalid number of threads %d, using %d", statsd.threads, processors);
-        statsd.threads = processors;
-        inicfg_set_number(&netdata_config, CONFIG_SECTION_STATSD, "collector threads", statsd.threads);
+    statsd.threads = (int)inicfg_get_number(&netdata_config, CONFIG_SECTION_STATSD, "threads", 1);
+    if(statsd.threads < 1 || statsd.threads > (int)netdata_conf_cpus()) {
+        collector_error("STATSD: Invalid number of threads %d, using 1", statsd.threads);
+        statsd.threads = 1;
+        inicfg_set_number(&netdata_config, CONFIG_SECTION_STATSD, "threads", statsd.threads);
     }
-#else
-    statsd.threads = 1;
-#endif
 
     // read custom application definitions
     statsd_readdir(netdata_configured_user_config_dir, netdata_configured_stock_config_dir, "statsd.d");
@@ -2601,6 +2951,7 @@ void *statsd_main(void *ptr) {
     }
 
     statsd.collection_threads_status = callocz((size_t)statsd.threads, sizeof(struct collection_thread_status));
+    statsd.shards = statsd_shards_create(statsd.threads);
 
     int i;
     for(i = 0; i < statsd.threads ;i++) {
@@ -2609,6 +2960,7 @@ void *statsd_main(void *ptr) {
         snprintfz(tag, NETDATA_THREAD_TAG_MAX, "STATSD_IN[%d]", i + 1);
         spinlock_init(&statsd.collection_threads_status[i].spinlock);
         statsd.collection_threads_status[i].initializing = true;
+        statsd.collection_threads_status[i].shard = &statsd.shards[i];
         statsd.collection_threads_status[i].thread = nd_thread_create(tag, NETDATA_THREAD_OPTION_DEFAULT,
                                                                       statsd_collector_thread, &statsd.collection_threads_status[i]);
     }
@@ -2913,3 +3265,243 @@ void *statsd_main(void *ptr) {
 cleanup: ; // added semi-colon to prevent older gcc error: label at end of compound statement
     return NULL;
 }
+
+// --------------------------------------------------------------------------------------------------------------------
+// benchmark of histograms and timers: sorting all the values vs sketches
+
+static uint64_t statsd_histogram_benchmark_random(uint64_t *state) {
+    // xorshift64*
+    uint64_t x = *state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+    return x * 0x2545F4914F6CDD1DULL;
+}
+
+static usec_t statsd_histogram_benchmark_run(STATSD_METRIC *m, char (*values)[32], size_t entries, const char *sampling, size_t *bytes) {
+    m->histogram.ext = callocz(1, sizeof(STATSD_METRIC_HISTOGRAM_EXTENSIONS));
+    netdata_mutex_init(&m->histogram.ext->mutex);
+
+    usec_t started_ut = now_monotonic_high_precision_usec();
+
+    for(size_t i = 0; i < entries ;i++)
+        statsd_process_timer(m, values[i], sampling);
+
+    statsd_histogram_calculate(m);
+
+    usec_t ended_ut = now_monotonic_high_precision_usec();
+
+    *bytes = m->histogram.ext->td ? sizeof(TDIGEST) : m->histogram.ext->size * sizeof(NETDATA_DOUBLE);
+    return ended_ut - started_ut;
+}
+
+static void statsd_histogram_benchmark_free(STATSD_METRIC *m) {
+    netdata_mutex_destroy(&m->histogram.ext->mutex);
+    freez(m->histogram.ext->values);
+    freez(m->histogram.ext->td);
+    freez(m->histogram.ext);
+    m->histogram.ext = NULL;
+}
+
+int statsd_histogram_benchmark(void) {
+    const size_t entries = 200000;
+    const char *sampling = "0.01";
+    int errors = 0;
+
+    // timer values in milliseconds, exponentially distributed
+    char (*values)[32] = mallocz(entries * sizeof(*values));
+    uint64_t state = 0x9E3779B97F4A7C15ULL;
+    for(size_t i = 0; i < entries ;i++) {
+        NETDATA_DOUBLE u = (NETDATA_DOUBLE)(statsd_histogram_benchmark_random(&state) >> 11) / (NETDATA_DOUBLE)(1ULL << 53);
+        snprintfz(values[i], sizeof(values[i]), "%0.3f", (double)(-log(1.0 - u) * 50.0));
+    }
+
+    bool sketch = statsd.histogram_sketch;
+
+    STATSD_METRIC sorted = { .name = "sorted", .type = STATSD_METRIC_TYPE_TIMER };
+    statsd.histogram_sketch = false;
+    size_t sorted_bytes;
+    usec_t sorted_ut = statsd_histogram_benchmark_run(&sorted, values, entries, sampling, &sorted_bytes);
+
+    STATSD_METRIC sketched = { .name = "sketched", .type = STATSD_METRIC_TYPE_TIMER };
+    statsd.histogram_sketch = true;
+    size_t sketched_bytes;
+    usec_t sketched_ut = statsd_histogram_benchmark_run(&sketched, values, entries, sampling, &sketched_bytes);
+
+    statsd.histogram_sketch = sketch;
+
+    fprintf(stderr, "STATSD: %zu timer samples @%s, sorting: %"PRIu64" usec using %zu bytes, sketch: %"PRIu64" usec using %zu bytes\n",
+            entries, sampling, sorted_ut, sorted_bytes, sketched_ut, sketched_bytes);
+
+    STATSD_METRIC_HISTOGRAM_EXTENSIONS *a = sorted.histogram.ext, *b = sketched.histogram.ext;
+    collected_number range = a->last_max - a->last_min;
+    struct {
+        const char *name;
+        collected_number sorted;
+        collected_number sketched;
+        collected_number allowed;
+    } checks[] = {
+        { "min",    a->last_min,        b->last_min,        0 },
+        { "max",    a->last_max,        b->last_max,        0 },
+        { "avg",    sorted.last,        sketched.last,      1 },
+        { "sum",    a->last_sum,        b->last_sum,        a->last_sum / 1000000 + 1 },
+        { "stddev", a->last_stddev,     b->last_stddev,     a->last_stddev / 1000 + 1 },
+        { "median", a->last_median,     b->last_median,     range / 100 },
+        { "pcent",  a->last_percentile, b->last_percentile, range / 100 },
+    };
+
+    for(size_t i = 0; i < _countof(checks) ;i++) {
+        collected_number diff = checks[i].sorted - checks[i].sketched;
+        bool ok = (diff < 0 ? -diff : diff) <= checks[i].allowed;
+        if(!ok) errors++;
+
+        fprintf(stderr, "STATSD: %-6s sorting " COLLECTED_NUMBER_FORMAT ", sketch " COLLECTED_NUMBER_FORMAT " %s\n",
+                checks[i].name, checks[i].sorted, checks[i].sketched, ok ? "OK" : "FAILED");
+    }
+
+    statsd_histogram_benchmark_free(&sorted);
+    statsd_histogram_benchmark_free(&sketched);
+    freez(values);
+
+    return errors;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// load generator - packets/s with 1, 2, 4, ... collection threads
+
+#define STATSD_LOAD_BENCHMARK_PACKETS 64
+#define STATSD_LOAD_BENCHMARK_DURATION_UT (2 * USEC_PER_SEC)
+#define STATSD_LOAD_BENCHMARK_MERGE_EVERY_UT (100 * USEC_PER_MS)
+
+struct statsd_load_benchmark_thread {
+    STATSD_SHARD *shard;
+    char (*packets)[512];
+    bool *stop;
+    size_t packets_processed;
+    ND_THREAD *thread;
+};
+
+static void statsd_load_benchmark_thread(void *ptr) {
+    struct statsd_load_benchmark_thread *t = ptr;
+    statsd_shard = t->shard;
+
+    char buffer[512 + 1];
+    size_t i = 0;
+    while(!__atomic_load_n(t->stop, __ATOMIC_RELAXED)) {
+        // the parser modifies the buffer, so give it a copy
+        const char *packet = t->packets[i++ % STATSD_LOAD_BENCHMARK_PACKETS];
+        size_t len = strlen(packet);
+        memcpy(buffer, packet, len);
+        statsd_process(buffer, len, 0);
+        t->packets_processed++;
+    }
+}
+
+static void statsd_load_benchmark_merge(void) {
+    for(STATSD_METRIC_TYPE type = 0; type < STATSD_METRIC_TYPES ;type++) {
+        STATSD_INDEX *index = statsd_index_of_type(type);
+        statsd_merge_shards(index);
+
+        // what flushing does, without charting
+        STATSD_METRIC *m;
+        dfe_start_read(index->dict, m) {
+            if(m->count)
+                m->reset = 1;
+        }
+        dfe_done(m);
+    }
+}
+
+int statsd_load_benchmark(void) {
+    int errors = 0;
+
+    char (*packets)[512] = mallocz(STATSD_LOAD_BENCHMARK_PACKETS * sizeof(*packets));
+    for(size_t i = 0; i < STATSD_LOAD_BENCHMARK_PACKETS ;i++)
+        snprintfz(packets[i], sizeof(packets[i]),
+                  "bench.counter:1|c\n"
+                  "bench.meter.%zu:1|m\n"
+                  "bench.gauge.%zu:+%zu|g\n"
+                  "bench.timer.%zu:%zu|ms|@0.5\n"
+                  "bench.histogram:%zu|h|#units=bytes\n"
+                  "bench.set:user%zu|s\n"
+                  "bench.dictionary:value%zu|d\n",
+                  i % 4, i % 8, i, i % 16, i * 7, i * 13, i, i % 32);
+
+    size_t cpus = netdata_conf_cpus();
+    if(!cpus) cpus = 1;
+
+    bool sketch = statsd.histogram_sketch;
+    statsd.histogram_sketch = true;
+    if(!statsd.dictionary_max_unique)
+        statsd.dictionary_max_unique = 200;
+
+    for(size_t threads = 1; threads <= cpus ; threads = (threads < cpus && threads * 2 > cpus) ? cpus : threads * 2) {
+
+        for(STATSD_METRIC_TYPE type = 0; type < STATSD_METRIC_TYPES ;type++)
+            statsd_index_init(statsd_index_of_type(type));
+
+        statsd.threads = (int)threads;
+        statsd.shards = statsd_shards_create(statsd.threads);
+
+        bool stop = false;
+        struct statsd_load_benchmark_thread *t = callocz(threads, sizeof(*t));
+
+        usec_t started_ut = now_monotonic_high_precision_usec();
+        for(size_t i = 0; i < threads ;i++) {
+            t[i].shard = &statsd.shards[i];
+            t[i].packets = packets;
+            t[i].stop = &stop;
+            t[i].thread = nd_thread_create("STATSD_BENCH", NETDATA_THREAD_OPTION_DONT_LOG,
+                                           statsd_load_benchmark_thread, &t[i]);
+        }
+
+        while(now_monotonic_high_precision_usec() - started_ut < STATSD_LOAD_BENCHMARK_DURATION_UT) {
+            sleep_usec(STATSD_LOAD_BENCHMARK_MERGE_EVERY_UT);
+            statsd_load_benchmark_merge();
+        }
+
+        __atomic_store_n(&stop, true, __ATOMIC_RELAXED);
+
+        size_t packets_processed = 0;
+        for(size_t i = 0; i < threads ;i++) {
+            nd_thread_join(t[i].thread);
+            packets_processed += t[i].packets_processed;
+        }
+        usec_t ended_ut = now_monotonic_high_precision_usec();
+
+        statsd_load_benchmark_merge();
+
+        // every packet has one increment of the same counter
+        STATSD_METRIC *m = dictionary_get(statsd.counters.dict, "bench.counter");
+        bool ok = m && m->counter.value == (collected_number)packets_processed;
+        if(!ok) errors++;
+
+        double seconds = (double)(ended_ut - started_ut) / USEC_PER_SEC;
+        fprintf(stderr, "STATSD: %zu threads, %zu packets, %0.0f packets/s, %0.0f packets/s per thread, merged counter %s\n",
+                threads, packets_processed,
+                (double)packets_processed / seconds, (double)packets_processed / seconds / (double)threads,
+                ok ? "OK" : "FAILED");
+
+        freez(t);
+        statsd_shards_destroy(statsd.shards, statsd.threads);
+        statsd.shards = NULL;
+        statsd.threads = 0;
+
+        for(STATSD_METRIC_TYPE type = 0; type < STATSD_METRIC_TYPES ;type++) {
+            STATSD_INDEX *index = statsd_index_of_type(type);
+            dictionary_destroy(index->dict);
+            index->dict = NULL;
+            index->events = 0;
+            index->metrics = 0;
+        }
+
+        if(threads == cpus)
+            break;
+    }
+
+    statsd.histogram_sketch = sketch;
+    freez(packets);
+
+    return errors;
+}
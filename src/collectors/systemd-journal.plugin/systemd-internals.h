@@ -71,6 +71,9 @@ struct nd_journal_file {
     NsdId128 last_writer_id;
 
     uint64_t messages_in_file;
+
+    struct nd_journal_file_summary *summary;    // set by the summaries thread, for archived files
+    bool summary_failed;                        // reset when the file is modified
 };
 
 #define ND_SD_JF_SOURCE_ALL_NAME "all"
@@ -83,6 +86,8 @@ struct nd_journal_file {
 
 #define ND_SD_JOURNAL_OPEN_FLAGS (0)
 
+#define FACET_MAX_VALUE_LENGTH 8192
+
 #define JOURNAL_VS_REALTIME_DELTA_DEFAULT_UT (5 * USEC_PER_SEC)  // assume a 5-seconds latency
 #define JOURNAL_VS_REALTIME_DELTA_MAX_UT (2 * 60 * USEC_PER_SEC) // up to 2-minutes latency
 
@@ -141,6 +146,18 @@ void nd_sd_journal_transform_message_id(FACETS *facets, BUFFER *wb, FACETS_TRANS
 void nd_journal_watcher_main(void *arg);
 void nd_journal_watcher_restart(void);
 
+// facet summaries of archived journal files
+struct nd_journal_file_summary;
+void nd_journal_summaries_main(void *arg);
+void nd_journal_file_summary_free(struct nd_journal_file_summary *s);
+void nd_journal_file_summary_delete(const char *filename, struct nd_journal_file_summary *s);
+struct nd_journal_file_summary *
+nd_journal_file_summary_get(struct nd_journal_file *njf, FACETS *facets, usec_t after_ut, usec_t before_ut);
+void nd_journal_file_summary_to_facets(struct nd_journal_file_summary *s, FACETS *facets);
+uint64_t nd_journal_file_summary_rows(struct nd_journal_file_summary *s);
+usec_t nd_journal_file_summary_last_modified(struct nd_journal_file_summary *s);
+int nd_journal_summaries_unittest(void);
+
 static inline bool parse_journal_field(
     const char *data,
     size_t data_length,
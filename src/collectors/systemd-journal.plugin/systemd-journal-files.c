@@ -423,6 +423,9 @@ static bool files_registry_conflict_cb(
         njf_old->file_last_modified_ut = njf_new->file_last_modified_ut;
         njf_old->size = njf_new->size;
 
+        // its summary, if any, is stale, so try again
+        njf_old->summary_failed = false;
+
         njf_old->msg_last_ut = njf_old->file_last_modified_ut;
     }
 
@@ -564,6 +567,11 @@ static void files_registry_delete_cb(const DICTIONARY_ITEM *item, void *value, v
 
     internal_error(true, "removed journal file '%s'", filename);
     string_freez(njf->source);
+
+    if (njf->summary) {
+        nd_journal_file_summary_delete(filename, njf->summary);
+        nd_journal_file_summary_free(njf->summary);
+    }
 }
 
 #define EXT_DOT_JOURNAL ".journal"
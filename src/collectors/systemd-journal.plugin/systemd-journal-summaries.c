@@ -0,0 +1,1008 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "systemd-internals.h"
+
+// Facet summaries of archived journal files.
+//
+// Archived journal files never change, so the facets of their rows can be counted once.
+// A background thread scans every archived file and keeps, for every field, the number
+// of rows having each value, together with a histogram of these rows in buckets of
+// ND_SD_JOURNAL_SUMMARY_BUCKET_UT. The summaries are attached to the files registry
+// and are saved in the cache directory, so that they survive restarts of the plugin.
+//
+// Queries without filters and without full text search, whose timeframe covers the whole
+// file, add the summary to their facets and read from the file only the rows of the page.
+
+#define ND_SD_JOURNAL_SUMMARY_BUCKET_UT (60 * USEC_PER_SEC)
+#define ND_SD_JOURNAL_SUMMARY_MAX_BUCKETS (366 * 24 * 60)
+#define ND_SD_JOURNAL_SUMMARY_MAX_VALUES 5000                   // per field, above it the field is incomplete
+#define ND_SD_JOURNAL_SUMMARY_MAX_BYTES (64 * 1024 * 1024)
+#define ND_SD_JOURNAL_SUMMARY_MIN_AGE_UT (60 * USEC_PER_SEC)     // rotated files not modified since
+#define ND_SD_JOURNAL_SUMMARY_SCAN_EVERY_UT (60 * USEC_PER_SEC)
+
+#define ND_SD_JOURNAL_SUMMARY_MAGIC "NDJSUM01"
+#define ND_SD_JOURNAL_SUMMARY_VERSION 1
+
+#define ND_SD_JOURNAL_SUMMARY_KEY_INCOMPLETE (1 << 0)
+
+struct nd_journal_summary_value {
+    char *value;
+    uint32_t len;
+    uint64_t rows;
+    uint32_t entries;
+    FACETS_TIME_COUNT *histogram;
+};
+
+struct nd_journal_summary_key {
+    char *name;
+    uint32_t len;
+    uint32_t flags;
+    uint64_t rows;                      // the rows having this field
+    uint32_t values;
+    struct nd_journal_summary_value *value;
+};
+
+struct nd_journal_file_summary {
+    uint64_t size;
+    usec_t file_last_modified_ut;
+
+    usec_t first_ut;                    // the timestamps of the rows, as the queries see them
+    usec_t last_ut;
+    usec_t first_journal_ut;            // the realtime timestamps of the journal
+    usec_t last_journal_ut;
+
+    uint64_t rows;
+    uint32_t entries;                   // all the rows, per bucket
+    FACETS_TIME_COUNT *histogram;
+
+    uint32_t keys;
+    struct nd_journal_summary_key *key;
+
+    struct nd_journal_file_summary *stale;  // replaced by this one, queries may still be using it
+};
+
+static char summaries_dir[FILENAME_MAX + 1] = "";
+
+// ----------------------------------------------------------------------------
+// memory management
+
+static void nd_journal_summary_histogram_add(FACETS_TIME_COUNT **histogram, uint32_t *entries, uint32_t *size, usec_t ut) {
+    if (*entries && (*histogram)[*entries - 1].ut == ut) {
+        (*histogram)[*entries - 1].count++;
+        return;
+    }
+
+    if (*entries == *size) {
+        *size = *size ? *size * 2 : 16;
+        *histogram = reallocz(*histogram, *size * sizeof(FACETS_TIME_COUNT));
+    }
+
+    (*histogram)[*entries].ut = ut;
+    (*histogram)[*entries].count = 1;
+    (*entries)++;
+}
+
+void nd_journal_file_summary_free(struct nd_journal_file_summary *s)
+{
+    if (!s)
+        return;
+
+    for (uint32_t k = 0; k < s->keys; k++) {
+        struct nd_journal_summary_key *key = &s->key[k];
+        for (uint32_t v = 0; v < key->values; v++) {
+            freez(key->value[v].value);
+            freez(key->value[v].histogram);
+        }
+        freez(key->value);
+        freez(key->name);
+    }
+
+    freez(s->key);
+    freez(s->histogram);
+    nd_journal_file_summary_free(s->stale);
+    freez(s);
+}
+
+// ----------------------------------------------------------------------------
+// building a summary, by scanning all the rows of a file
+
+struct summary_builder_value {
+    char *value;
+    size_t len;
+    uint64_t rows;
+    FACETS_TIME_COUNT *histogram;
+    uint32_t entries;
+    uint32_t size;
+    struct summary_builder_value *next;
+};
+
+struct summary_builder_key {
+    char *name;
+    size_t len;
+    bool incomplete;
+    uint64_t rows;
+    uint64_t last_row;
+    Pvoid_t JudyHS;                     // value -> struct summary_builder_value
+    size_t values;
+    struct summary_builder_value *base;
+    struct summary_builder_key *next;
+};
+
+struct summary_builder {
+    Pvoid_t JudyHS;                     // key -> struct summary_builder_key
+    size_t keys;
+    struct summary_builder_key *base;
+    size_t bytes;
+};
+
+static inline Pvoid_t *summary_builder_judy_ins(Pvoid_t *judy, const char *s, size_t len)
+{
+    JError_t J_Error;
+    Pvoid_t *PValue = JudyHSIns(judy, (void *)s, len, &J_Error);
+    if (unlikely(PValue == PJERR))
+        fatal("JOURNAL SUMMARY: cannot insert to JudyHS, JU_ERRNO_* == %u, ID == %d", JU_ERRNO(&J_Error), JU_ERRID(&J_Error));
+    return PValue;
+}
+
+static void summary_builder_add(struct summary_builder *b, const char *key, size_t key_len, const char *value, size_t value_len, uint64_t row, usec_t bucket_ut)
+{
+    Pvoid_t *PValue = summary_builder_judy_ins(&b->JudyHS, key, key_len);
+    struct summary_builder_key *k = *PValue;
+    if (!k) {
+        k = callocz(1, sizeof(*k));
+        k->name = strndupz(key, key_len);
+        k->len = key_len;
+        k->next = b->base;
+        b->base = k;
+        b->keys++;
+        b->bytes += sizeof(*k) + key_len;
+        *PValue = k;
+    }
+
+    // the first value of a field repeated in the same row
+    if (k->rows && k->last_row == row)
+        return;
+
+    k->last_row = row;
+    k->rows++;
+
+    if (k->incomplete)
+        return;
+
+    PValue = summary_builder_judy_ins(&k->JudyHS, value, value_len);
+    struct summary_builder_value *v = *PValue;
+    if (!v) {
+        if (k->values >= ND_SD_JOURNAL_SUMMARY_MAX_VALUES) {
+            // too many values to keep, the facet of this field will be scanned by the queries
+            JudyHSDel(&k->JudyHS, (void *)value, value_len, PJE0);
+            k->incomplete = true;
+            return;
+        }
+
+        v = callocz(1, sizeof(*v));
+        v->value = mallocz(value_len + 1);
+        memcpy(v->value, value, value_len);
+        v->value[value_len] = '\0';
+        v->len = value_len;
+        v->next = k->base;
+        k->base = v;
+        k->values++;
+        b->bytes += sizeof(*v) + value_len;
+        *PValue = v;
+    }
+
+    v->rows++;
+
+    uint32_t entries = v->entries;
+    nd_journal_summary_histogram_add(&v->histogram, &v->entries, &v->size, bucket_ut);
+    if (v->entries != entries)
+        b->bytes += sizeof(FACETS_TIME_COUNT);
+}
+
+static void summary_builder_cleanup(struct summary_builder *b)
+{
+    while (b->base) {
+        struct summary_builder_key *k = b->base;
+        b->base = k->next;
+
+        while (k->base) {
+            struct summary_builder_value *v = k->base;
+            k->base = v->next;
+            freez(v->value);
+            freez(v->histogram);
+            freez(v);
+        }
+
+        JudyHSFreeArray(&k->JudyHS, PJE0);
+        freez(k->name);
+        freez(k);
+    }
+
+    JudyHSFreeArray(&b->JudyHS, PJE0);
+}
+
+// move the keys and the values of the builder to the summary
+static void summary_builder_to_summary(struct summary_builder *b, struct nd_journal_file_summary *s)
+{
+    s->keys = b->keys;
+    s->key = callocz(b->keys ? b->keys : 1, sizeof(*s->key));
+
+    size_t k_idx = 0;
+    for (struct summary_builder_key *k = b->base; k; k = k->next, k_idx++) {
+        struct nd_journal_summary_key *key = &s->key[k_idx];
+        key->name = k->name;
+        key->len = k->len;
+        key->rows = k->rows;
+        k->name = NULL;
+
+        if (k->incomplete) {
+            key->flags |= ND_SD_JOURNAL_SUMMARY_KEY_INCOMPLETE;
+            continue;
+        }
+
+        key->values = k->values;
+        key->value = callocz(k->values ? k->values : 1, sizeof(*key->value));
+
+        size_t v_idx = 0;
+        for (struct summary_builder_value *v = k->base; v; v = v->next, v_idx++) {
+            key->value[v_idx].value = v->value;
+            key->value[v_idx].len = v->len;
+            key->value[v_idx].rows = v->rows;
+            key->value[v_idx].entries = v->entries;
+            key->value[v_idx].histogram = v->histogram;
+            v->value = NULL;
+            v->histogram = NULL;
+        }
+    }
+}
+
+static inline usec_t summary_bucket_ut(usec_t ut)
+{
+    return ut - (ut % ND_SD_JOURNAL_SUMMARY_BUCKET_UT);
+}
+
+static inline usec_t summary_stat_modified_ut(struct stat *st)
+{
+    // the same way the files registry finds it
+    return st->st_mtim.tv_sec * USEC_PER_SEC + st->st_mtim.tv_nsec / NSEC_PER_USEC;
+}
+
+static struct nd_journal_file_summary *nd_journal_file_summary_build(const char *filename, struct nd_journal_file *njf)
+{
+    const char *paths[2] = {
+        [0] = filename,
+        [1] = NULL,
+    };
+
+    NsdJournal *j = NULL;
+    if (nsd_journal_open_files(&j, paths, ND_SD_JOURNAL_OPEN_FLAGS) < 0 || !j) {
+        nd_log(NDLS_COLLECTORS, NDLP_ERR, "JOURNAL SUMMARY: cannot open file '%s'", filename);
+        return NULL;
+    }
+
+    // the summary is valid only for the file it has been built from
+    struct stat st_before;
+    if (stat(filename, &st_before) != 0 || (uint64_t)st_before.st_size != njf->size ||
+        summary_stat_modified_ut(&st_before) != njf->file_last_modified_ut) {
+        nsd_journal_close(j);
+        return NULL;
+    }
+
+    struct nd_journal_file_summary *s = callocz(1, sizeof(*s));
+    s->size = njf->size;
+    s->file_last_modified_ut = njf->file_last_modified_ut;
+
+    struct summary_builder b = { 0 };
+    uint32_t histogram_size = 0;
+    bool failed = false;
+
+    if (nsd_journal_seek_head(j) < 0)
+        failed = true;
+
+    while (!failed && nsd_journal_next(j) > 0) {
+        usec_t journal_ut = 0;
+        if (nsd_journal_get_realtime_usec(j, &journal_ut) < 0 || !journal_ut)
+            continue;
+
+        // the row timestamp, the same way the queries find it
+        usec_t msg_ut = journal_ut;
+        const void *data;
+        size_t length;
+        NSD_JOURNAL_FOREACH_DATA(j, data, length)
+        {
+            const char *key, *value;
+            size_t key_length, value_length;
+
+            if (!parse_journal_field(data, length, &key, &key_length, &value, &value_length))
+                continue;
+
+            if (unlikely(
+                    key_length == sizeof("_SOURCE_REALTIME_TIMESTAMP") - 1 &&
+                    memcmp(key, "_SOURCE_REALTIME_TIMESTAMP", key_length) == 0)) {
+                char buf[value_length + 1];
+                memcpy(buf, value, value_length);
+                buf[value_length] = '\0';
+
+                usec_t ut = str2ull(buf, NULL);
+                if (ut && ut < msg_ut)
+                    msg_ut = ut;
+            }
+        }
+
+        usec_t bucket_ut = summary_bucket_ut(msg_ut);
+        uint64_t row = ++s->rows;
+
+        NSD_JOURNAL_FOREACH_DATA(j, data, length)
+        {
+            const char *key, *value;
+            size_t key_length, value_length;
+
+            if (!parse_journal_field(data, length, &key, &key_length, &value, &value_length))
+                continue;
+
+            // empty values are not added to the facets
+            if (!key_length || !value_length || !*value)
+                continue;
+
+            summary_builder_add(
+                &b,
+                key,
+                key_length,
+                value,
+                value_length <= FACET_MAX_VALUE_LENGTH ? value_length : FACET_MAX_VALUE_LENGTH,
+                row,
+                bucket_ut);
+        }
+
+        nd_journal_summary_histogram_add(&s->histogram, &s->entries, &histogram_size, bucket_ut);
+
+        if (!s->first_ut || msg_ut < s->first_ut)
+            s->first_ut = msg_ut;
+        if (msg_ut > s->last_ut)
+            s->last_ut = msg_ut;
+        if (!s->first_journal_ut || journal_ut < s->first_journal_ut)
+            s->first_journal_ut = journal_ut;
+        if (journal_ut > s->last_journal_ut)
+            s->last_journal_ut = journal_ut;
+
+        if (unlikely((row % 65536) == 0 && nd_thread_signaled_to_cancel()))
+            failed = true;
+
+        if (unlikely(b.bytes > ND_SD_JOURNAL_SUMMARY_MAX_BYTES)) {
+            nd_log(NDLS_COLLECTORS, NDLP_NOTICE, "JOURNAL SUMMARY: file '%s' is too big to be summarized", filename);
+            failed = true;
+        }
+    }
+
+    nsd_journal_close(j);
+
+    struct stat st_after;
+    if (!failed && (stat(filename, &st_after) != 0 || st_after.st_size != st_before.st_size ||
+                    summary_stat_modified_ut(&st_after) != s->file_last_modified_ut)) {
+        nd_log(NDLS_COLLECTORS, NDLP_DEBUG, "JOURNAL SUMMARY: file '%s' changed while being summarized", filename);
+        failed = true;
+    }
+
+    if (!failed && s->rows &&
+        (s->last_ut - s->first_ut) / ND_SD_JOURNAL_SUMMARY_BUCKET_UT >= ND_SD_JOURNAL_SUMMARY_MAX_BUCKETS) {
+        nd_log(NDLS_COLLECTORS, NDLP_NOTICE, "JOURNAL SUMMARY: file '%s' spans too much time to be summarized", filename);
+        failed = true;
+    }
+
+    if (failed) {
+        summary_builder_cleanup(&b);
+        nd_journal_file_summary_free(s);
+        return NULL;
+    }
+
+    summary_builder_to_summary(&b, s);
+    summary_builder_cleanup(&b);
+    return s;
+}
+
+// ----------------------------------------------------------------------------
+// saving and loading summaries
+
+// the size and the last modification time of the file are part of the name,
+// so that a file that has been modified gets a new summary
+static void summary_filename(char *dst, size_t dst_size, const char *filename, uint64_t size, usec_t last_modified_ut)
+{
+    snprintfz(
+        dst,
+        dst_size,
+        "%s/%016" PRIx64 "-%" PRIx64 "-%" PRIx64 ".summary",
+        summaries_dir,
+        (uint64_t)XXH3_64bits(filename, strlen(filename)),
+        size,
+        (uint64_t)last_modified_ut);
+}
+
+static inline void summary_put_u32(BUFFER *wb, uint32_t v)
+{
+    buffer_memcat(wb, &v, sizeof(v));
+}
+
+static inline void summary_put_u64(BUFFER *wb, uint64_t v)
+{
+    buffer_memcat(wb, &v, sizeof(v));
+}
+
+static inline void summary_put_histogram(BUFFER *wb, FACETS_TIME_COUNT *histogram, uint32_t entries)
+{
+    summary_put_u32(wb, entries);
+    for (uint32_t i = 0; i < entries; i++) {
+        summary_put_u64(wb, histogram[i].ut);
+        summary_put_u32(wb, histogram[i].count);
+    }
+}
+
+static void nd_journal_file_summary_save(const char *filename, struct nd_journal_file_summary *s)
+{
+    if (!*summaries_dir)
+        return;
+
+    CLEAN_BUFFER *wb = buffer_create(1024 * 1024, NULL);
+
+    buffer_memcat(wb, ND_SD_JOURNAL_SUMMARY_MAGIC, sizeof(ND_SD_JOURNAL_SUMMARY_MAGIC) - 1);
+    summary_put_u32(wb, ND_SD_JOURNAL_SUMMARY_VERSION);
+    summary_put_u32(wb, strlen(filename));
+    buffer_memcat(wb, filename, strlen(filename));
+    summary_put_u64(wb, s->size);
+    summary_put_u64(wb, s->file_last_modified_ut);
+    summary_put_u64(wb, s->first_ut);
+    summary_put_u64(wb, s->last_ut);
+    summary_put_u64(wb, s->first_journal_ut);
+    summary_put_u64(wb, s->last_journal_ut);
+    summary_put_u64(wb, s->rows);
+    summary_put_histogram(wb, s->histogram, s->entries);
+
+    summary_put_u32(wb, s->keys);
+    for (uint32_t k = 0; k < s->keys; k++) {
+        struct nd_journal_summary_key *key = &s->key[k];
+        summary_put_u32(wb, key->len);
+        buffer_memcat(wb, key->name, key->len);
+        summary_put_u32(wb, key->flags);
+        summary_put_u64(wb, key->rows);
+        summary_put_u32(wb, key->values);
+
+        for (uint32_t v = 0; v < key->values; v++) {
+            struct nd_journal_summary_value *value = &key->value[v];
+            summary_put_u32(wb, value->len);
+            buffer_memcat(wb, value->value, value->len);
+            summary_put_u64(wb, value->rows);
+            summary_put_histogram(wb, value->histogram, value->entries);
+        }
+    }
+
+    summary_put_u64(wb, XXH3_64bits(buffer_tostring(wb), buffer_strlen(wb)));
+
+    char path[FILENAME_MAX + 1], tmp[FILENAME_MAX + 1];
+    summary_filename(path, sizeof(path), filename, s->size, s->file_last_modified_ut);
+    snprintfz(tmp, sizeof(tmp), "%s.new", path);
+
+    FILE *fp = fopen(tmp, "w");
+    if (!fp) {
+        nd_log(NDLS_COLLECTORS, NDLP_ERR, "JOURNAL SUMMARY: cannot create file '%s'", tmp);
+        return;
+    }
+
+    bool ok = fwrite(buffer_tostring(wb), 1, buffer_strlen(wb), fp) == buffer_strlen(wb);
+    ok = (fclose(fp) == 0) && ok;
+
+    if (!ok || rename(tmp, path) != 0) {
+        nd_log(NDLS_COLLECTORS, NDLP_ERR, "JOURNAL SUMMARY: cannot save file '%s'", path);
+        unlink(tmp);
+    }
+}
+
+struct summary_reader {
+    const uint8_t *pos;
+    const uint8_t *end;
+    bool failed;
+};
+
+static inline bool summary_get(struct summary_reader *r, void *dst, size_t len)
+{
+    if (r->failed || (size_t)(r->end - r->pos) < len) {
+        r->failed = true;
+        memset(dst, 0, len);
+        return false;
+    }
+
+    memcpy(dst, r->pos, len);
+    r->pos += len;
+    return true;
+}
+
+static inline uint32_t summary_get_u32(struct summary_reader *r)
+{
+    uint32_t v;
+    summary_get(r, &v, sizeof(v));
+    return v;
+}
+
+static inline uint64_t summary_get_u64(struct summary_reader *r)
+{
+    uint64_t v;
+    summary_get(r, &v, sizeof(v));
+    return v;
+}
+
+static inline char *summary_get_string(struct summary_reader *r, uint32_t len)
+{
+    if (r->failed || (size_t)(r->end - r->pos) < len) {
+        r->failed = true;
+        return NULL;
+    }
+
+    char *s = mallocz(len + 1);
+    memcpy(s, r->pos, len);
+    s[len] = '\0';
+    r->pos += len;
+    return s;
+}
+
+static inline FACETS_TIME_COUNT *summary_get_histogram(struct summary_reader *r, uint32_t *entries)
+{
+    *entries = summary_get_u32(r);
+    if (r->failed || (size_t)(r->end - r->pos) / (sizeof(uint64_t) + sizeof(uint32_t)) < *entries) {
+        r->failed = true;
+        *entries = 0;
+        return NULL;
+    }
+
+    FACETS_TIME_COUNT *histogram = mallocz((*entries ? *entries : 1) * sizeof(*histogram));
+    for (uint32_t i = 0; i < *entries; i++) {
+        histogram[i].ut = summary_get_u64(r);
+        histogram[i].count = summary_get_u32(r);
+    }
+
+    return histogram;
+}
+
+static struct nd_journal_file_summary *nd_journal_file_summary_load(const char *filename, struct nd_journal_file *njf)
+{
+    if (!*summaries_dir)
+        return NULL;
+
+    char path[FILENAME_MAX + 1];
+    summary_filename(path, sizeof(path), filename, njf->size, njf->file_last_modified_ut);
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1)
+        return NULL;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)(sizeof(ND_SD_JOURNAL_SUMMARY_MAGIC) - 1 + sizeof(uint64_t)) ||
+        st.st_size > ND_SD_JOURNAL_SUMMARY_MAX_BYTES * 2) {
+        close(fd);
+        return NULL;
+    }
+
+    size_t size = st.st_size;
+    uint8_t *data = mallocz(size);
+    bool ok = read(fd, data, size) == (ssize_t)size;
+    close(fd);
+
+    uint64_t checksum = 0;
+    if (ok) {
+        memcpy(&checksum, &data[size - sizeof(checksum)], sizeof(checksum));
+        ok = checksum == XXH3_64bits(data, size - sizeof(checksum)) &&
+             memcmp(data, ND_SD_JOURNAL_SUMMARY_MAGIC, sizeof(ND_SD_JOURNAL_SUMMARY_MAGIC) - 1) == 0;
+    }
+
+    if (!ok) {
+        freez(data);
+        unlink(path);
+        return NULL;
+    }
+
+    struct summary_reader r = {
+        .pos = data + sizeof(ND_SD_JOURNAL_SUMMARY_MAGIC) - 1,
+        .end = data + size - sizeof(checksum),
+    };
+
+    struct nd_journal_file_summary *s = NULL;
+
+    uint32_t version = summary_get_u32(&r);
+    uint32_t filename_len = summary_get_u32(&r);
+    char *stored_filename = summary_get_string(&r, filename_len);
+
+    if (version == ND_SD_JOURNAL_SUMMARY_VERSION && stored_filename && strcmp(stored_filename, filename) == 0) {
+        s = callocz(1, sizeof(*s));
+        s->size = summary_get_u64(&r);
+        s->file_last_modified_ut = summary_get_u64(&r);
+        s->first_ut = summary_get_u64(&r);
+        s->last_ut = summary_get_u64(&r);
+        s->first_journal_ut = summary_get_u64(&r);
+        s->last_journal_ut = summary_get_u64(&r);
+        s->rows = summary_get_u64(&r);
+        s->histogram = summary_get_histogram(&r, &s->entries);
+
+        uint32_t keys = summary_get_u32(&r);
+        if (!r.failed && keys <= (size_t)(r.end - r.pos)) {
+            s->key = callocz(keys ? keys : 1, sizeof(*s->key));
+
+            for (uint32_t k = 0; k < keys && !r.failed; k++) {
+                struct nd_journal_summary_key *key = &s->key[k];
+                s->keys++;
+
+                key->len = summary_get_u32(&r);
+                key->name = summary_get_string(&r, key->len);
+                key->flags = summary_get_u32(&r);
+                key->rows = summary_get_u64(&r);
+
+                uint32_t values = summary_get_u32(&r);
+                if (r.failed || values > (size_t)(r.end - r.pos)) {
+                    r.failed = true;
+                    break;
+                }
+
+                key->value = callocz(values ? values : 1, sizeof(*key->value));
+                for (uint32_t v = 0; v < values && !r.failed; v++) {
+                    struct nd_journal_summary_value *value = &key->value[v];
+                    key->values++;
+
+                    value->len = summary_get_u32(&r);
+                    value->value = summary_get_string(&r, value->len);
+                    value->rows = summary_get_u64(&r);
+                    value->histogram = summary_get_histogram(&r, &value->entries);
+                }
+            }
+        }
+        else
+            r.failed = true;
+    }
+    else
+        r.failed = true;
+
+    freez(stored_filename);
+    freez(data);
+
+    if (r.failed || r.pos != r.end || s->size != njf->size || s->file_last_modified_ut != njf->file_last_modified_ut) {
+        nd_journal_file_summary_free(s);
+        unlink(path);
+        return NULL;
+    }
+
+    return s;
+}
+
+void nd_journal_file_summary_delete(const char *filename, struct nd_journal_file_summary *s)
+{
+    if (!*summaries_dir)
+        return;
+
+    for (; s; s = s->stale) {
+        char path[FILENAME_MAX + 1];
+        summary_filename(path, sizeof(path), filename, s->size, s->file_last_modified_ut);
+        unlink(path);
+    }
+}
+
+static inline bool nd_journal_file_summary_is_stale(struct nd_journal_file_summary *s, struct nd_journal_file *njf)
+{
+    return s->size != njf->size || s->file_last_modified_ut != njf->file_last_modified_ut;
+}
+
+// ----------------------------------------------------------------------------
+// using summaries in queries
+
+struct nd_journal_file_summary *
+nd_journal_file_summary_get(struct nd_journal_file *njf, FACETS *facets, usec_t after_ut, usec_t before_ut)
+{
+    struct nd_journal_file_summary *s = __atomic_load_n(&njf->summary, __ATOMIC_ACQUIRE);
+
+    if (!s || !s->rows || nd_journal_file_summary_is_stale(s, njf))
+        return NULL;
+
+    // all the rows of the file should be in the timeframe of the query
+    if (!after_ut || !before_ut || s->first_ut < after_ut || s->last_journal_ut > before_ut)
+        return NULL;
+
+    // and the buckets of the summary should fit exactly in the histogram slots
+    if (!facets_histogram_slots_are_multiple_of(facets, ND_SD_JOURNAL_SUMMARY_BUCKET_UT))
+        return NULL;
+
+    // the fields with too many values cannot be facets
+    for (uint32_t k = 0; k < s->keys; k++) {
+        if ((s->key[k].flags & ND_SD_JOURNAL_SUMMARY_KEY_INCOMPLETE) && facets_key_name_is_facet(facets, s->key[k].name))
+            return NULL;
+    }
+
+    return s;
+}
+
+void nd_journal_file_summary_to_facets(struct nd_journal_file_summary *s, FACETS *facets)
+{
+    usec_t first_bucket_ut = summary_bucket_ut(s->first_ut);
+    size_t buckets = (summary_bucket_ut(s->last_ut) - first_bucket_ut) / ND_SD_JOURNAL_SUMMARY_BUCKET_UT + 1;
+
+    uint32_t *rows_without_key = mallocz(buckets * sizeof(*rows_without_key));
+    FACETS_TIME_COUNT *histogram = mallocz(buckets * sizeof(*histogram));
+
+    for (uint32_t k = 0; k < s->keys; k++) {
+        struct nd_journal_summary_key *key = &s->key[k];
+        if (key->flags & ND_SD_JOURNAL_SUMMARY_KEY_INCOMPLETE)
+            continue;
+
+        bool is_facet = true;
+        for (uint32_t v = 0; v < key->values && is_facet; v++) {
+            struct nd_journal_summary_value *value = &key->value[v];
+            is_facet = facets_summarized_key_value(
+                facets, key->name, key->len, value->value, value->len, value->rows, value->histogram, value->entries);
+        }
+
+        if (!is_facet || key->rows >= s->rows)
+            continue;
+
+        // the rows without this field, per bucket
+        memset(rows_without_key, 0, buckets * sizeof(*rows_without_key));
+        for (uint32_t i = 0; i < s->entries; i++)
+            rows_without_key[(s->histogram[i].ut - first_bucket_ut) / ND_SD_JOURNAL_SUMMARY_BUCKET_UT] +=
+                s->histogram[i].count;
+
+        for (uint32_t v = 0; v < key->values; v++) {
+            struct nd_journal_summary_value *value = &key->value[v];
+            for (uint32_t i = 0; i < value->entries; i++)
+                rows_without_key[(value->histogram[i].ut - first_bucket_ut) / ND_SD_JOURNAL_SUMMARY_BUCKET_UT] -=
+                    value->histogram[i].count;
+        }
+
+        size_t entries = 0;
+        for (size_t i = 0; i < buckets; i++) {
+            if (rows_without_key[i]) {
+                histogram[entries].ut = first_bucket_ut + i * ND_SD_JOURNAL_SUMMARY_BUCKET_UT;
+                histogram[entries].count = rows_without_key[i];
+                entries++;
+            }
+        }
+
+        facets_summarized_key_value(facets, key->name, key->len, NULL, 0, s->rows - key->rows, histogram, entries);
+    }
+
+    facets_summarized_rows(facets, s->rows, s->histogram, s->entries);
+
+    freez(histogram);
+    freez(rows_without_key);
+}
+
+uint64_t nd_journal_file_summary_rows(struct nd_journal_file_summary *s)
+{
+    return s->rows;
+}
+
+usec_t nd_journal_file_summary_last_modified(struct nd_journal_file_summary *s)
+{
+    return s->last_journal_ut;
+}
+
+// ----------------------------------------------------------------------------
+// the background thread
+
+static bool nd_journal_file_is_archived(const char *filename, struct nd_journal_file *njf)
+{
+    // rotated files have an @ in their names, and corrupted files are renamed to .journal~
+    const char *s = strrchr(filename, '/');
+    s = s ? s + 1 : filename;
+
+    const char *ext = NULL;
+    if (!is_journal_file(s, -1, &ext) || (!strchr(s, '@') && strcmp(ext, ".journal~") != 0))
+        return false;
+
+    return njf->file_last_modified_ut + ND_SD_JOURNAL_SUMMARY_MIN_AGE_UT < now_realtime_usec();
+}
+
+void nd_journal_summaries_main(void *arg __maybe_unused)
+{
+    const char *cache_dir = getenv("NETDATA_CACHE_DIR");
+    if (cache_dir && *cache_dir) {
+        snprintfz(summaries_dir, sizeof(summaries_dir), "%s/systemd-journal-summaries", cache_dir);
+        if (mkdir(summaries_dir, 0775) != 0 && errno != EEXIST) {
+            nd_log(NDLS_COLLECTORS, NDLP_ERR, "JOURNAL SUMMARY: cannot create directory '%s'", summaries_dir);
+            summaries_dir[0] = '\0';
+        }
+    }
+
+    while (!nd_thread_signaled_to_cancel()) {
+        if (nd_journal_files_completed_once()) {
+            size_t files_max = dictionary_entries(nd_journal_files_registry);
+            const DICTIONARY_ITEM **items = mallocz((files_max ? files_max : 1) * sizeof(*items));
+            size_t used = 0;
+
+            struct nd_journal_file *njf;
+            dfe_start_read(nd_journal_files_registry, njf)
+            {
+                struct nd_journal_file_summary *s = __atomic_load_n(&njf->summary, __ATOMIC_RELAXED);
+                if (used < files_max && (!s || nd_journal_file_summary_is_stale(s, njf)) && !njf->summary_failed &&
+                    nd_journal_file_is_archived(njf_dfe.name, njf))
+                    items[used++] = dictionary_acquired_item_dup(nd_journal_files_registry, njf_dfe.item);
+            }
+            dfe_done(njf);
+
+            for (size_t i = 0; i < used; i++) {
+                njf = dictionary_acquired_item_value(items[i]);
+                const char *filename = dictionary_acquired_item_name(items[i]);
+
+                if (!nd_thread_signaled_to_cancel()) {
+                    struct nd_journal_file_summary *s = nd_journal_file_summary_load(filename, njf);
+                    if (!s) {
+                        usec_t started_ut = now_monotonic_usec();
+                        s = nd_journal_file_summary_build(filename, njf);
+                        if (s) {
+                            nd_journal_file_summary_save(filename, s);
+                            nd_log(
+                                NDLS_COLLECTORS,
+                                NDLP_DEBUG,
+                                "JOURNAL SUMMARY: summarized %" PRIu64 " rows of file '%s' in %.3f ms",
+                                s->rows,
+                                filename,
+                                (double)(now_monotonic_usec() - started_ut) / (double)USEC_PER_MS);
+                        }
+                    }
+
+                    if (s) {
+                        // the file has been modified since its summary was built
+                        s->stale = __atomic_load_n(&njf->summary, __ATOMIC_RELAXED);
+                        if (s->stale)
+                            nd_journal_file_summary_delete(filename, s->stale);
+
+                        __atomic_store_n(&njf->summary, s, __ATOMIC_RELEASE);
+                    }
+                    else
+                        njf->summary_failed = true;
+                }
+
+                dictionary_acquired_item_release(nd_journal_files_registry, items[i]);
+            }
+
+            freez(items);
+        }
+
+        sleep_usec(ND_SD_JOURNAL_SUMMARY_SCAN_EVERY_UT);
+    }
+}
+
+// ----------------------------------------------------------------------------
+// unittest
+
+static struct nd_journal_file_summary *summary_unittest_create(struct nd_journal_file *njf)
+{
+    struct nd_journal_file_summary *s = callocz(1, sizeof(*s));
+    s->size = njf->size;
+    s->file_last_modified_ut = njf->file_last_modified_ut;
+    s->first_ut = s->first_journal_ut = njf->file_last_modified_ut - 3600 * USEC_PER_SEC;
+    s->last_ut = s->last_journal_ut = njf->file_last_modified_ut - 60 * USEC_PER_SEC;
+    s->rows = 3;
+
+    s->entries = 2;
+    s->histogram = mallocz(s->entries * sizeof(*s->histogram));
+    s->histogram[0] = (FACETS_TIME_COUNT){ .ut = summary_bucket_ut(s->first_ut), .count = 2 };
+    s->histogram[1] = (FACETS_TIME_COUNT){ .ut = summary_bucket_ut(s->last_ut), .count = 1 };
+
+    s->keys = 1;
+    s->key = callocz(s->keys, sizeof(*s->key));
+    s->key[0].name = strdupz("PRIORITY");
+    s->key[0].len = strlen(s->key[0].name);
+    s->key[0].rows = 3;
+    s->key[0].values = 2;
+    s->key[0].value = callocz(s->key[0].values, sizeof(*s->key[0].value));
+
+    const char *values[] = { "3", "6" };
+    for (uint32_t v = 0; v < s->key[0].values; v++) {
+        struct nd_journal_summary_value *value = &s->key[0].value[v];
+        value->value = strdupz(values[v]);
+        value->len = strlen(value->value);
+        value->entries = 1;
+        value->histogram = mallocz(sizeof(*value->histogram));
+        value->histogram[0] = s->histogram[v];
+        value->rows = value->histogram[0].count;
+    }
+
+    return s;
+}
+
+static bool summary_unittest_histograms_equal(FACETS_TIME_COUNT *h1, uint32_t e1, FACETS_TIME_COUNT *h2, uint32_t e2)
+{
+    if (e1 != e2)
+        return false;
+
+    for (uint32_t i = 0; i < e1; i++) {
+        if (h1[i].ut != h2[i].ut || h1[i].count != h2[i].count)
+            return false;
+    }
+
+    return true;
+}
+
+static bool summary_unittest_equal(struct nd_journal_file_summary *s1, struct nd_journal_file_summary *s2)
+{
+    if (s1->size != s2->size || s1->file_last_modified_ut != s2->file_last_modified_ut ||
+        s1->first_ut != s2->first_ut || s1->last_ut != s2->last_ut || s1->first_journal_ut != s2->first_journal_ut ||
+        s1->last_journal_ut != s2->last_journal_ut || s1->rows != s2->rows || s1->keys != s2->keys ||
+        !summary_unittest_histograms_equal(s1->histogram, s1->entries, s2->histogram, s2->entries))
+        return false;
+
+    for (uint32_t k = 0; k < s1->keys; k++) {
+        struct nd_journal_summary_key *k1 = &s1->key[k], *k2 = &s2->key[k];
+        if (k1->len != k2->len || memcmp(k1->name, k2->name, k1->len) != 0 || k1->flags != k2->flags ||
+            k1->rows != k2->rows || k1->values != k2->values)
+            return false;
+
+        for (uint32_t v = 0; v < k1->values; v++) {
+            struct nd_journal_summary_value *v1 = &k1->value[v], *v2 = &k2->value[v];
+            if (v1->len != v2->len || memcmp(v1->value, v2->value, v1->len) != 0 || v1->rows != v2->rows ||
+                !summary_unittest_histograms_equal(v1->histogram, v1->entries, v2->histogram, v2->entries))
+                return false;
+        }
+    }
+
+    return true;
+}
+
+static int summary_unittest_load(const char *filename, struct nd_journal_file *njf, struct nd_journal_file_summary *expected, const char *test)
+{
+    struct nd_journal_file_summary *s = nd_journal_file_summary_load(filename, njf);
+    bool ok = expected ? (s && summary_unittest_equal(s, expected)) : !s;
+    nd_journal_file_summary_free(s);
+
+    if (!ok) {
+        fprintf(stderr, "JOURNAL SUMMARY: %s: the summary %s\n", test, expected ? "is not reused" : "is reused");
+        return 1;
+    }
+
+    return 0;
+}
+
+int nd_journal_summaries_unittest(void)
+{
+    int errors = 0;
+
+    char dir[] = "/tmp/netdata-journal-summaries-XXXXXX";
+    if (!mkdtemp(dir)) {
+        fprintf(stderr, "JOURNAL SUMMARY: cannot create a temporary directory\n");
+        return 1;
+    }
+    snprintfz(summaries_dir, sizeof(summaries_dir), "%s", dir);
+
+    const char *filename = "/var/log/journal/unittest/system@0000000000000001-0000000000000002.journal";
+    struct nd_journal_file njf = {
+        .size = 8 * 1024 * 1024,
+        .file_last_modified_ut = 1700000000 * USEC_PER_SEC,
+    };
+
+    struct nd_journal_file_summary *s = summary_unittest_create(&njf);
+    nd_journal_file_summary_save(filename, s);
+
+    errors += summary_unittest_load(filename, &njf, s, "same file");
+    errors += summary_unittest_load("/var/log/journal/unittest/system.journal", &njf, NULL, "another file");
+
+    njf.size += 4096;
+    errors += summary_unittest_load(filename, &njf, NULL, "size changed");
+    if (!nd_journal_file_summary_is_stale(s, &njf)) {
+        fprintf(stderr, "JOURNAL SUMMARY: size changed: the summary is not stale\n");
+        errors++;
+    }
+    njf.size -= 4096;
+
+    njf.file_last_modified_ut += USEC_PER_SEC;
+    errors += summary_unittest_load(filename, &njf, NULL, "last modification time changed");
+    if (!nd_journal_file_summary_is_stale(s, &njf)) {
+        fprintf(stderr, "JOURNAL SUMMARY: last modification time changed: the summary is not stale\n");
+        errors++;
+    }
+    njf.file_last_modified_ut -= USEC_PER_SEC;
+
+    // the lookups of the modified file should not remove the summary of the original one
+    errors += summary_unittest_load(filename, &njf, s, "same file again");
+
+    nd_journal_file_summary_delete(filename, s);
+    errors += summary_unittest_load(filename, &njf, NULL, "deleted");
+
+    nd_journal_file_summary_free(s);
+    rmdir(dir);
+    summaries_dir[0] = '\0';
+
+    fprintf(stderr, "JOURNAL SUMMARY: %d errors\n", errors);
+    return errors;
+}
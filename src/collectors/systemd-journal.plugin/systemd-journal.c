@@ -71,6 +71,8 @@ struct lqs_extension {
     size_t bytes_read;
     size_t files_matched;
     size_t file_working;
+
+    bool *stop;                             // set when another file of a parallel query has stopped
 };
 
 // prepare LQS
@@ -88,9 +90,9 @@ struct lqs_extension {
 
 #include "systemd-journal-sampling.h"
 
-#define FACET_MAX_VALUE_LENGTH 8192
 #define ND_SD_JOURNAL_DEFAULT_TIMEOUT 60
 #define ND_SD_JOURNAL_PROGRESS_EVERY_UT (250 * USEC_PER_MS)
+#define ND_SD_JOURNAL_QUERY_THREADS_MAX 16
 #define JOURNAL_KEY_ND_JOURNAL_FILE "ND_JOURNAL_FILE"
 #define JOURNAL_KEY_ND_JOURNAL_PROCESS "ND_JOURNAL_PROCESS"
 #define JOURNAL_DEFAULT_DIRECTION FACETS_ANCHOR_DIRECTION_BACKWARD
@@ -294,7 +296,7 @@ nd_sd_journal_process_row(NsdJournal *j, FACETS *facets, struct nd_journal_file
 #define FUNCTION_PROGRESS_EVERY_ROWS (1ULL << 13)
 #define FUNCTION_DATA_ONLY_CHECK_EVERY_ROWS (1ULL << 7)
 
-static inline ND_SD_JOURNAL_STATUS check_stop(const bool *cancelled, const usec_t *stop_monotonic_ut)
+static inline ND_SD_JOURNAL_STATUS check_stop(const bool *cancelled, const usec_t *stop_monotonic_ut, const bool *stop)
 {
     if (cancelled && __atomic_load_n(cancelled, __ATOMIC_RELAXED)) {
         internal_error(true, "Function has been cancelled");
@@ -306,6 +308,11 @@ static inline ND_SD_JOURNAL_STATUS check_stop(const bool *cancelled, const usec_
         return ND_SD_JOURNAL_TIMED_OUT;
     }
 
+    if (stop && __atomic_load_n(stop, __ATOMIC_RELAXED)) {
+        internal_error(true, "Function timed out on another file");
+        return ND_SD_JOURNAL_TIMED_OUT;
+    }
+
     return ND_SD_JOURNAL_OK;
 }
 
@@ -401,7 +408,7 @@ ND_SD_JOURNAL_STATUS nd_sd_journal_query_backward(
                 FUNCTION_PROGRESS_UPDATE_BYTES(fqs->c.bytes_read, bytes - last_bytes);
                 last_bytes = bytes;
 
-                status = check_stop(fqs->cancelled, fqs->stop_monotonic_ut);
+                status = check_stop(fqs->cancelled, fqs->stop_monotonic_ut, fqs->c.stop);
             }
         } else if (sample == SAMPLING_SKIP_FIELDS)
             facets_row_finished_unsampled(facets, msg_ut);
@@ -509,7 +516,7 @@ ND_SD_JOURNAL_STATUS nd_sd_journal_query_forward(
                 FUNCTION_PROGRESS_UPDATE_BYTES(fqs->c.bytes_read, bytes - last_bytes);
                 last_bytes = bytes;
 
-                status = check_stop(fqs->cancelled, fqs->stop_monotonic_ut);
+                status = check_stop(fqs->cancelled, fqs->stop_monotonic_ut, fqs->c.stop);
             }
         } else if (sample == SAMPLING_SKIP_FIELDS)
             facets_row_finished_unsampled(facets, msg_ut);
@@ -699,6 +706,186 @@ static bool jf_is_mine(struct nd_journal_file *njf, LOGS_QUERY_STATUS *fqs)
     return false;
 }
 
+// ----------------------------------------------------------------------------
+// parallel queries of many files
+//
+// Each file is queried by a worker thread into its own FACETS (created from a
+// template of the facets of the query, so it has the same keys, filters,
+// anchor and histogram), and the main thread merges them in the sorted order
+// of the files, as they complete.
+//
+// The sampling counters of the query are shared: each file starts with a
+// snapshot of them and adds its own samples back when it finishes.
+
+struct nd_sd_journal_file_query {
+    const char *filename;
+    struct nd_journal_file *njf;
+
+    bool done;                              // set by the worker, with release semantics
+    FACETS *facets;                         // NULL when the file has been skipped
+    ND_SD_JOURNAL_STATUS status;
+    bool summarized;                        // the facets came from the summary of the file
+
+    usec_t duration_ut;
+    usec_t matches_setup_ut;
+    usec_t last_modified;
+    size_t rows_read;
+    size_t rows_useful;
+    size_t bytes_read;
+    size_t fs_calls;
+    size_t fs_cached;
+    uint32_t sampled;
+    uint32_t unsampled;
+    uint32_t estimated;
+};
+
+struct nd_sd_journal_parallel_query {
+    LOGS_QUERY_STATUS *lqs;
+    FACETS *template;
+
+    SPINLOCK spinlock;                      // protects lqs->c and lqs->last_modified
+    struct completion completion;           // a job is completed for every file
+
+    size_t files_used;
+    struct nd_sd_journal_file_query *files;
+
+    size_t next;                            // the next file to be queried
+    usec_t max_duration_ut;                 // the slowest file so far
+    bool stop;                              // the query has been cancelled or timed out
+};
+
+static void nd_sd_journal_query_file_in_parallel(
+    struct nd_sd_journal_parallel_query *pq,
+    struct nd_sd_journal_file_query *fq,
+    LOGS_QUERY_STATUS *lqs,
+    struct lqs_extension *snapshot)
+{
+    usec_t started_ut = now_monotonic_usec();
+
+    if (!jf_is_mine(fq->njf, pq->lqs)) {
+        fq->status = ND_SD_JOURNAL_NOT_MODIFIED;
+        return;
+    }
+
+    // another file has been cancelled or timed out
+    if (__atomic_load_n(&pq->stop, __ATOMIC_RELAXED)) {
+        fq->status = (pq->lqs->cancelled && __atomic_load_n(pq->lqs->cancelled, __ATOMIC_RELAXED)) ?
+                         ND_SD_JOURNAL_CANCELLED : ND_SD_JOURNAL_TIMED_OUT;
+        return;
+    }
+
+    // do not even try to do the query if we expect it to pass the timeout
+    if (started_ut + __atomic_load_n(&pq->max_duration_ut, __ATOMIC_RELAXED) * 3 >= *pq->lqs->stop_monotonic_ut) {
+        fq->status = ND_SD_JOURNAL_TIMED_OUT;
+        __atomic_store_n(&pq->stop, true, __ATOMIC_RELAXED);
+        return;
+    }
+
+    fq->facets = facets_create_worker(pq->template);
+
+    spinlock_lock(&pq->spinlock);
+    *lqs = *pq->lqs;
+    spinlock_unlock(&pq->spinlock);
+
+    *snapshot = lqs->c;
+    lqs->c.stop = &pq->stop;
+    lqs->facets = fq->facets;
+    lqs->last_modified = 0;
+    lqs->c.rows_useful = 0;
+    lqs->c.rows_read = 0;
+    lqs->c.bytes_read = 0;
+    lqs->c.matches_setup_ut = 0;
+
+    size_t fs_calls = fstat_thread_calls;
+    size_t fs_cached = fstat_thread_cached_responses;
+
+    // when the whole file is in the timeframe and there are no filters, the facets
+    // and the histogram are taken from its summary, and only the rows are read
+    struct nd_journal_file_summary *summary = NULL;
+    if (!lqs->rq.filters && (!lqs->rq.query || !*lqs->rq.query) && !lqs->rq.data_only)
+        summary = nd_journal_file_summary_get(fq->njf, fq->facets, lqs->rq.after_ut, lqs->rq.before_ut);
+
+    if (summary) {
+        lqs->rq.data_only = true;
+        lqs->rq.sampling = 0;
+    }
+
+    sampling_file_init(lqs, fq->njf);
+
+    fq->status = nd_sd_journal_query_one_file(fq->filename, NULL, fq->facets, fq->njf, lqs);
+
+    // the files being queried by the other workers stop too, and the rest are skipped
+    if (fq->status == ND_SD_JOURNAL_TIMED_OUT || fq->status == ND_SD_JOURNAL_CANCELLED)
+        __atomic_store_n(&pq->stop, true, __ATOMIC_RELAXED);
+
+    if (summary && fq->status == ND_SD_JOURNAL_OK) {
+        facets_reset_counters(fq->facets);
+        nd_journal_file_summary_to_facets(summary, fq->facets);
+        fq->summarized = true;
+
+        lqs->c.rows_useful = nd_journal_file_summary_rows(summary);
+        if (nd_journal_file_summary_last_modified(summary) > lqs->last_modified)
+            lqs->last_modified = nd_journal_file_summary_last_modified(summary);
+    }
+
+    fq->fs_calls = fstat_thread_calls - fs_calls;
+    fq->fs_cached = fstat_thread_cached_responses - fs_cached;
+    fq->rows_read = lqs->c.rows_read;
+    fq->rows_useful = lqs->c.rows_useful;
+    fq->bytes_read = lqs->c.bytes_read;
+    fq->matches_setup_ut = lqs->c.matches_setup_ut;
+    fq->last_modified = lqs->last_modified;
+    fq->sampled = lqs->c.samples_per_file.sampled;
+    fq->unsampled = lqs->c.samples_per_file.unsampled;
+    fq->estimated = lqs->c.samples_per_file.estimated;
+
+    if (lqs->rq.sampling) {
+        spinlock_lock(&pq->spinlock);
+        struct lqs_extension *c = &pq->lqs->c;
+        c->samples.sampled += lqs->c.samples.sampled - snapshot->samples.sampled;
+        c->samples.unsampled += lqs->c.samples.unsampled - snapshot->samples.unsampled;
+        c->samples.estimated += lqs->c.samples.estimated - snapshot->samples.estimated;
+        for (size_t slot = 0; slot < ND_SD_JOURNAL_SAMPLING_SLOTS; slot++) {
+            c->samples_per_time_slot.sampled[slot] +=
+                lqs->c.samples_per_time_slot.sampled[slot] - snapshot->samples_per_time_slot.sampled[slot];
+            c->samples_per_time_slot.unsampled[slot] +=
+                lqs->c.samples_per_time_slot.unsampled[slot] - snapshot->samples_per_time_slot.unsampled[slot];
+        }
+        spinlock_unlock(&pq->spinlock);
+    }
+
+    fq->duration_ut = now_monotonic_usec() - started_ut;
+
+    usec_t expected = __atomic_load_n(&pq->max_duration_ut, __ATOMIC_RELAXED);
+    do {
+        if (fq->duration_ut <= expected)
+            break;
+    } while (!__atomic_compare_exchange_n(
+        &pq->max_duration_ut, &expected, fq->duration_ut, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+}
+
+static void nd_sd_journal_query_worker(void *ptr)
+{
+    struct nd_sd_journal_parallel_query *pq = ptr;
+
+    // these are big, so they are not on the stack
+    LOGS_QUERY_STATUS *lqs = mallocz(sizeof(*lqs));
+    struct lqs_extension *snapshot = mallocz(sizeof(*snapshot));
+
+    size_t f;
+    while ((f = __atomic_fetch_add(&pq->next, 1, __ATOMIC_RELAXED)) < pq->files_used) {
+        struct nd_sd_journal_file_query *fq = &pq->files[f];
+
+        nd_sd_journal_query_file_in_parallel(pq, fq, lqs, snapshot);
+
+        __atomic_store_n(&fq->done, true, __ATOMIC_RELEASE);
+        completion_mark_complete_a_job(&pq->completion);
+    }
+
+    freez(snapshot);
+    freez(lqs);
+}
+
 static int nd_sd_journal_query(BUFFER *wb, LOGS_QUERY_STATUS *lqs)
 {
     FACETS *facets = lqs->facets;
@@ -749,58 +936,80 @@ static int nd_sd_journal_query(BUFFER *wb, LOGS_QUERY_STATUS *lqs)
     }
 
     bool partial = false;
-    usec_t query_started_ut = now_monotonic_usec();
-    usec_t started_ut = query_started_ut;
-    usec_t ended_ut = started_ut;
-    usec_t duration_ut = 0, max_duration_ut = 0;
     usec_t progress_duration_ut = 0;
+    size_t fs_calls = 0, fs_cached = 0;
 
     sampling_query_init(lqs, facets);
 
+    struct nd_sd_journal_parallel_query pq = {
+        .lqs = lqs,
+        .template = facets_create_worker(facets),
+        .spinlock = SPINLOCK_INITIALIZER,
+        .files = callocz(files_used ? files_used : 1, sizeof(*pq.files)),
+        .files_used = files_used,
+    };
+    completion_init(&pq.completion);
+
+    for (size_t f = 0; f < files_used; f++) {
+        pq.files[f].filename = dictionary_acquired_item_name(file_items[f]);
+        pq.files[f].njf = dictionary_acquired_item_value(file_items[f]);
+    }
+
+    size_t threads = MIN(files_used, MIN(os_get_system_cpus_cached(true), ND_SD_JOURNAL_QUERY_THREADS_MAX));
+    ND_THREAD *workers[ND_SD_JOURNAL_QUERY_THREADS_MAX];
+    if (threads > 1) {
+        for (size_t t = 0; t < threads; t++)
+            workers[t] = nd_thread_create("SDJQUERY", NETDATA_THREAD_OPTION_DONT_LOG, nd_sd_journal_query_worker, &pq);
+    } else
+        nd_sd_journal_query_worker(&pq);
+
+    // merge the files in the order they have been sorted,
+    // so that the result does not depend on which worker finished first
+    unsigned completed = 0;
+    bool stop = false;
     buffer_json_member_add_array(wb, "_journal_files");
     for (size_t f = 0; f < files_used; f++) {
-        const char *filename = dictionary_acquired_item_name(file_items[f]);
-        njf = dictionary_acquired_item_value(file_items[f]);
+        struct nd_sd_journal_file_query *fq = &pq.files[f];
 
-        if (!jf_is_mine(njf, lqs))
-            continue;
+        while (!__atomic_load_n(&fq->done, __ATOMIC_ACQUIRE))
+            completed = completion_wait_for_a_job(&pq.completion, completed);
 
-        started_ut = ended_ut;
+        if (stop || fq->status == ND_SD_JOURNAL_NOT_MODIFIED) {
+            // not queried (it is not ours), or after the query stopped
+            facets_destroy(fq->facets);
+            fq->facets = NULL;
+            continue;
+        }
 
-        // do not even try to do the query if we expect it to pass the timeout
-        if (ended_ut + max_duration_ut * 3 >= *lqs->stop_monotonic_ut) {
+        if (!fq->facets) {
+            // skipped, we expected it to pass the timeout, or another file stopped
             partial = true;
-            status = ND_SD_JOURNAL_TIMED_OUT;
-            break;
+            status = fq->status;
+            stop = true;
+            __atomic_store_n(&pq.stop, true, __ATOMIC_RELAXED);
+            continue;
         }
 
-        lqs->c.file_working++;
-
-        size_t fs_calls = fstat_thread_calls;
-        size_t fs_cached = fstat_thread_cached_responses;
-        size_t rows_useful = lqs->c.rows_useful;
-        size_t rows_read = lqs->c.rows_read;
-        size_t bytes_read = lqs->c.bytes_read;
-        size_t matches_setup_ut = lqs->c.matches_setup_ut;
-
-        sampling_file_init(lqs, njf);
+        njf = fq->njf;
 
-        ND_SD_JOURNAL_STATUS tmp_status = nd_sd_journal_query_one_file(filename, wb, facets, njf, lqs);
+        facets_merge(facets, fq->facets);
+        facets_destroy(fq->facets);
+        fq->facets = NULL;
 
-        rows_useful = lqs->c.rows_useful - rows_useful;
-        rows_read = lqs->c.rows_read - rows_read;
-        bytes_read = lqs->c.bytes_read - bytes_read;
-        matches_setup_ut = lqs->c.matches_setup_ut - matches_setup_ut;
-        fs_calls = fstat_thread_calls - fs_calls;
-        fs_cached = fstat_thread_cached_responses - fs_cached;
-
-        ended_ut = now_monotonic_usec();
-        duration_ut = ended_ut - started_ut;
-
-        if (duration_ut > max_duration_ut)
-            max_duration_ut = duration_ut;
-
-        progress_duration_ut += duration_ut;
+        spinlock_lock(&pq.spinlock);
+        lqs->c.file_working++;
+        lqs->c.rows_useful += fq->rows_useful;
+        lqs->c.rows_read += fq->rows_read;
+        lqs->c.bytes_read += fq->bytes_read;
+        lqs->c.matches_setup_ut += fq->matches_setup_ut;
+        if (fq->last_modified > lqs->last_modified)
+            lqs->last_modified = fq->last_modified;
+        spinlock_unlock(&pq.spinlock);
+
+        fs_calls += fq->fs_calls;
+        fs_cached += fq->fs_cached;
+
+        progress_duration_ut += fq->duration_ut / (threads ? threads : 1);
         if (progress_duration_ut >= ND_SD_JOURNAL_PROGRESS_EVERY_UT) {
             progress_duration_ut = 0;
             netdata_mutex_lock(&stdout_mutex);
@@ -808,10 +1017,12 @@ static int nd_sd_journal_query(BUFFER *wb, LOGS_QUERY_STATUS *lqs)
             netdata_mutex_unlock(&stdout_mutex);
         }
 
+        usec_t duration_ut = fq->duration_ut ? fq->duration_ut : 1;
+
         buffer_json_add_array_item_object(wb); // journal file
         {
             // information about the file
-            buffer_json_member_add_string(wb, "_filename", filename);
+            buffer_json_member_add_string(wb, "_filename", fq->filename);
             buffer_json_member_add_uint64(wb, "_source_type", njf->source_type);
             buffer_json_member_add_string(wb, "_source", string2str(njf->source));
             buffer_json_member_add_uint64(wb, "_last_modified_ut", njf->file_last_modified_ut);
@@ -820,61 +1031,68 @@ static int nd_sd_journal_query(BUFFER *wb, LOGS_QUERY_STATUS *lqs)
             buffer_json_member_add_uint64(wb, "_journal_vs_realtime_delta_ut", njf->max_journal_vs_realtime_delta_ut);
 
             // information about the current use of the file
-            buffer_json_member_add_uint64(wb, "duration_ut", ended_ut - started_ut);
-            buffer_json_member_add_uint64(wb, "rows_read", rows_read);
-            buffer_json_member_add_uint64(wb, "rows_useful", rows_useful);
+            buffer_json_member_add_uint64(wb, "duration_ut", fq->duration_ut);
+            buffer_json_member_add_uint64(wb, "rows_read", fq->rows_read);
+            buffer_json_member_add_uint64(wb, "rows_useful", fq->rows_useful);
             buffer_json_member_add_double(
-                wb, "rows_per_second", (double)rows_read / (double)duration_ut * (double)USEC_PER_SEC);
-            buffer_json_member_add_uint64(wb, "bytes_read", bytes_read);
+                wb, "rows_per_second", (double)fq->rows_read / (double)duration_ut * (double)USEC_PER_SEC);
+            buffer_json_member_add_uint64(wb, "bytes_read", fq->bytes_read);
             buffer_json_member_add_double(
-                wb, "bytes_per_second", (double)bytes_read / (double)duration_ut * (double)USEC_PER_SEC);
-            buffer_json_member_add_uint64(wb, "duration_matches_ut", matches_setup_ut);
-            buffer_json_member_add_uint64(wb, "fstat_query_calls", fs_calls);
-            buffer_json_member_add_uint64(wb, "fstat_query_cached_responses", fs_cached);
+                wb, "bytes_per_second", (double)fq->bytes_read / (double)duration_ut * (double)USEC_PER_SEC);
+            buffer_json_member_add_uint64(wb, "duration_matches_ut", fq->matches_setup_ut);
+            buffer_json_member_add_uint64(wb, "fstat_query_calls", fq->fs_calls);
+            buffer_json_member_add_uint64(wb, "fstat_query_cached_responses", fq->fs_cached);
+            buffer_json_member_add_boolean(wb, "summarized", fq->summarized);
 
             if (lqs->rq.sampling) {
                 buffer_json_member_add_object(wb, "_sampling");
                 {
-                    buffer_json_member_add_uint64(wb, "sampled", lqs->c.samples_per_file.sampled);
-                    buffer_json_member_add_uint64(wb, "unsampled", lqs->c.samples_per_file.unsampled);
-                    buffer_json_member_add_uint64(wb, "estimated", lqs->c.samples_per_file.estimated);
+                    buffer_json_member_add_uint64(wb, "sampled", fq->sampled);
+                    buffer_json_member_add_uint64(wb, "unsampled", fq->unsampled);
+                    buffer_json_member_add_uint64(wb, "estimated", fq->estimated);
                 }
                 buffer_json_object_close(wb); // _sampling
             }
         }
         buffer_json_object_close(wb); // journal file
 
-        bool stop = false;
-        switch (tmp_status) {
+        switch (fq->status) {
             case ND_SD_JOURNAL_OK:
             case ND_SD_JOURNAL_NO_FILE_MATCHED:
-                status = (status == ND_SD_JOURNAL_OK) ? ND_SD_JOURNAL_OK : tmp_status;
+                status = (status == ND_SD_JOURNAL_OK) ? ND_SD_JOURNAL_OK : fq->status;
                 break;
 
             case ND_SD_JOURNAL_FAILED_TO_OPEN:
             case ND_SD_JOURNAL_FAILED_TO_SEEK:
                 partial = true;
                 if (status == ND_SD_JOURNAL_NO_FILE_MATCHED)
-                    status = tmp_status;
+                    status = fq->status;
                 break;
 
             case ND_SD_JOURNAL_CANCELLED:
             case ND_SD_JOURNAL_TIMED_OUT:
                 partial = true;
                 stop = true;
-                status = tmp_status;
+                status = fq->status;
+                __atomic_store_n(&pq.stop, true, __ATOMIC_RELAXED);
                 break;
 
             case ND_SD_JOURNAL_NOT_MODIFIED:
                 internal_fatal(true, "this should never be returned here");
                 break;
         }
-
-        if (stop)
-            break;
     }
     buffer_json_array_close(wb); // _journal_files
 
+    if (threads > 1) {
+        for (size_t t = 0; t < threads; t++)
+            nd_thread_join(workers[t]);
+    }
+
+    completion_destroy(&pq.completion);
+    facets_destroy(pq.template);
+    freez(pq.files);
+
     // release the files
     for (size_t f = 0; f < files_used; f++)
         dictionary_acquired_item_release(nd_journal_files_registry, file_items[f]);
@@ -989,8 +1207,8 @@ static int nd_sd_journal_query(BUFFER *wb, LOGS_QUERY_STATUS *lqs)
 
     buffer_json_member_add_object(wb, "_fstat_caching");
     {
-        buffer_json_member_add_uint64(wb, "calls", fstat_thread_calls);
-        buffer_json_member_add_uint64(wb, "cached", fstat_thread_cached_responses);
+        buffer_json_member_add_uint64(wb, "calls", fs_calls);
+        buffer_json_member_add_uint64(wb, "cached", fs_cached);
     }
     buffer_json_object_close(wb); // _fstat_caching
 
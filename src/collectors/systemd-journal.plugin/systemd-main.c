@@ -37,6 +37,9 @@ int main(int argc __maybe_unused, char **argv __maybe_unused)
     if (verify_netdata_host_prefix(true) == -1)
         exit(1);
 
+    if (argc == 2 && strcmp(argv[1], "summariestest") == 0)
+        exit(nd_journal_summaries_unittest() ? 1 : 0);
+
     // ------------------------------------------------------------------------
     // initialization
 
@@ -69,6 +72,11 @@ int main(int argc __maybe_unused, char **argv __maybe_unused)
 
     nd_thread_create("SDWATCH", NETDATA_THREAD_OPTION_DONT_LOG, nd_journal_watcher_main, NULL);
 
+    // ------------------------------------------------------------------------
+    // facet summaries of archived files
+
+    nd_thread_create("SDJSUMMARY", NETDATA_THREAD_OPTION_DONT_LOG, nd_journal_summaries_main, NULL);
+
     // ------------------------------------------------------------------------
     // the event loop for functions
 
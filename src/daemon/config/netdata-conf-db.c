@@ -8,6 +8,8 @@ int default_rrd_history_entries = RRD_DEFAULT_HISTORY_ENTRIES;
 
 bool dbengine_enabled = false; // will become true if and when dbengine is initialized
 bool dbengine_use_direct_io = true;
+bool dbengine_use_io_uring = true;
+bool dbengine_async_tier_rollup = false;
 static size_t storage_tiers_grouping_iterations[RRD_STORAGE_TIERS] = {1, 60, 60, 60, 60};
 static time_t storage_tiers_retention_time_s[RRD_STORAGE_TIERS] = {14 * DAYS, 90 * DAYS, 2 * 365 * DAYS, 2 * 365 * DAYS, 2 * 365 * DAYS};
 
@@ -16,6 +18,7 @@ time_t rrdhost_cleanup_orphan_to_archive_time_s = 3600;
 time_t rrdhost_free_ephemeral_time_s = 0;
 
 extern time_t dbengine_journal_v2_unmount_time;
+extern time_t dbengine_mrg_snapshot_every_s;
 
 size_t get_tier_grouping(size_t tier) {
     if(unlikely(tier >= nd_profile.storage_tiers)) tier = nd_profile.storage_tiers - 1;
@@ -50,6 +53,23 @@ static void netdata_conf_dbengine_pre_logs(void) {
         netdata_log_error("Invalid dbengine page type ''%s' given. Defaulting to 'raw'.", page_type);
     }
 
+    // ------------------------------------------------------------------------
+    // get default Database Engine page type for the higher tiers
+
+    const char *tiers_page_type = inicfg_get(&netdata_config, CONFIG_SECTION_DB, "dbengine tiers page type", "gorilla");
+    uint8_t tiers_type;
+    if (strcmp(tiers_page_type, "gorilla") == 0)
+        tiers_type = RRDENG_PAGE_TYPE_GORILLA_TIER1;
+    else if (strcmp(tiers_page_type, "raw") == 0)
+        tiers_type = RRDENG_PAGE_TYPE_ARRAY_TIER1;
+    else {
+        tiers_type = RRDENG_PAGE_TYPE_ARRAY_TIER1;
+        netdata_log_error("Invalid dbengine tiers page type '%s' given. Defaulting to 'raw'.", tiers_page_type);
+    }
+
+    for (size_t tier = 1; tier < RRD_STORAGE_TIERS; tier++)
+        tier_page_type[tier] = tiers_type;
+
     // ------------------------------------------------------------------------
     // get default Database Engine page cache size in MiB
 
@@ -178,7 +198,10 @@ void netdata_conf_dbengine_init(const char *hostname) {
     // ----------------------------------------------------------------------------------------------------------------
 
     dbengine_use_direct_io = inicfg_get_boolean(&netdata_config, CONFIG_SECTION_DB, "dbengine use direct io", dbengine_use_direct_io);
+    dbengine_use_io_uring = inicfg_get_boolean(&netdata_config, CONFIG_SECTION_DB, "dbengine use io_uring", dbengine_use_io_uring);
+    dbengine_async_tier_rollup = inicfg_get_boolean(&netdata_config, CONFIG_SECTION_DB, "dbengine async tier rollup", dbengine_async_tier_rollup);
     dbengine_journal_v2_unmount_time = inicfg_get_duration_seconds(&netdata_config, CONFIG_SECTION_DB, "dbengine journal v2 unmount time", nd_profile.dbengine_journal_v2_unmount_time);
+    dbengine_mrg_snapshot_every_s = inicfg_get_duration_seconds(&netdata_config, CONFIG_SECTION_DB, "dbengine metrics registry snapshot every", dbengine_mrg_snapshot_every_s);
 
     unsigned read_num = (unsigned)inicfg_get_number(&netdata_config, CONFIG_SECTION_DB, "dbengine pages per extent", DEFAULT_PAGES_PER_EXTENT);
     if (read_num > 0 && read_num <= DEFAULT_PAGES_PER_EXTENT)
@@ -2,6 +2,8 @@
 
 #include "netdata-conf-web.h"
 #include "daemon/static_threads.h"
+#include "web/server/web_client_compression.h"
+#include "web/api/queries/query-cache.h"
 
 size_t netdata_conf_web_query_threads(void) {
     // See https://github.com/netdata/netdata/issues/11081#issuecomment-831998240 for more details
@@ -139,6 +141,17 @@ void netdata_conf_section_web(void) {
         netdata_log_error("Invalid compression level %d. Valid levels are 1 (fastest) to 9 (best ratio). Proceeding with level 9 (best compression).", web_gzip_level);
         web_gzip_level = 9;
     }
+
+    web_enable_zstd = inicfg_get_boolean(&netdata_config, CONFIG_SECTION_WEB, "enable zstd compression", web_enable_zstd);
+    web_zstd_level = (int)inicfg_get_number_range(&netdata_config, CONFIG_SECTION_WEB, "zstd compression level", web_zstd_level, 1, 19);
+
+    web_enable_brotli = inicfg_get_boolean(&netdata_config, CONFIG_SECTION_WEB, "enable brotli compression", web_enable_brotli);
+    web_brotli_level = (int)inicfg_get_number_range(&netdata_config, CONFIG_SECTION_WEB, "brotli compression level", web_brotli_level, 0, 11);
+
+    query_cache_max_size_bytes =
+        inicfg_get_size_mb(&netdata_config, CONFIG_SECTION_WEB, "data queries cache size", query_cache_max_size_bytes / 1024 / 1024) * 1024 * 1024;
+    query_cache_max_age_s =
+        inicfg_get_duration_seconds(&netdata_config, CONFIG_SECTION_WEB, "data queries cache max age", query_cache_max_age_s);
 }
 
 void netdata_conf_web_security_init(void) {
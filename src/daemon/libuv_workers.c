@@ -34,6 +34,7 @@ static void register_libuv_worker_jobs_internal(void) {
     worker_register_job_name(UV_EVENT_DBENGINE_FIND_ROTATED_METRICS, "find rotated metrics");
     worker_register_job_name(UV_EVENT_DBENGINE_FIND_REMAINING_RETENTION, "find remaining retention");
     worker_register_job_name(UV_EVENT_DBENGINE_POPULATE_MRG, "update retention");
+    worker_register_job_name(UV_EVENT_DBENGINE_MRG_SNAPSHOT, "mrg snapshot");
 
     // other dbengine events
     worker_register_job_name(UV_EVENT_DBENGINE_EVICT_MAIN_CACHE, "evict main");
@@ -43,6 +44,7 @@ static void register_libuv_worker_jobs_internal(void) {
     worker_register_job_name(UV_EVENT_DBENGINE_FLUSH_DIRTY, "dbengine flush dirty");
     worker_register_job_name(UV_EVENT_DBENGINE_QUIESCE, "dbengine quiesce");
     worker_register_job_name(UV_EVENT_DBENGINE_SHUTDOWN, "dbengine shutdown");
+    worker_register_job_name(UV_EVENT_DBENGINE_TIER_ROLLUP, "tier rollup");
 
     // metadata
     worker_register_job_name(UV_EVENT_HOST_CONTEXT_LOAD, "metadata load host context");
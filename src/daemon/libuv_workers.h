@@ -32,6 +32,7 @@ enum event_loop_job {
     UV_EVENT_DBENGINE_FIND_ROTATED_METRICS, // find the metrics that are rotated
     UV_EVENT_DBENGINE_FIND_REMAINING_RETENTION, // find their remaining retention
     UV_EVENT_DBENGINE_POPULATE_MRG, // update mrg
+    UV_EVENT_DBENGINE_MRG_SNAPSHOT, // save the mrg of a tier
 
     // other dbengine events
     UV_EVENT_DBENGINE_EVICT_MAIN_CACHE,
@@ -41,6 +42,7 @@ enum event_loop_job {
     UV_EVENT_DBENGINE_FLUSH_DIRTY,
     UV_EVENT_DBENGINE_QUIESCE,
     UV_EVENT_DBENGINE_SHUTDOWN,
+    UV_EVENT_DBENGINE_TIER_ROLLUP,
 
     // metadata
     UV_EVENT_HOST_CONTEXT_LOAD,
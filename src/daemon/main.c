@@ -146,12 +146,14 @@ int help(int exitcode) {
             "  -W sqlite-alert-cleanup  Perform maintenance on the alerts table.\n\n"
 #ifdef ENABLE_DBENGINE
             "  -W createdataset=N       Create a DB engine dataset of N seconds and exit.\n\n"
-            "  -W stresstest=A,B,C,D,E,F,G\n"
+            "  -W stresstest=A,B,C,D,E,F,G,H\n"
             "                           Run a DB engine stress test for A seconds,\n"
             "                           with B writers and C readers, with a ramp up\n"
             "                           time of D seconds for writers, a page cache\n"
             "                           size of E MiB, an optional disk space limit\n"
-            "                           of F MiB, G libuv workers (default 16) and exit.\n\n"
+            "                           of F MiB, G libuv workers (default 16),\n"
+            "                           H=1 to roll up the higher tiers asynchronously\n"
+            "                           (default 0) and exit.\n\n"
 #endif
             "  -W set section option value\n"
             "                           set netdata.conf option from the command line.\n\n"
@@ -210,14 +212,22 @@ int buffer_unittest(void);
 int pgc_unittest(void);
 int mrg_unittest(void);
 int pluginsd_parser_unittest(void);
+int pluginsd_binary_frames_unittest(void);
 void replication_initialize(void);
 void bearer_tokens_init(void);
 int unittest_stream_compressions(void);
+int stream_sender_spill_unittest(void);
+int query_cache_unittest(void);
 int uuid_unittest(void);
 int progress_unittest(void);
 int dyncfg_unittest(void);
 int eval_unittest(void);
 int duration_unittest(void);
+int statsd_histogram_benchmark(void);
+int statsd_load_benchmark(void);
+#if defined(OS_LINUX)
+int cgroups_read_benchmark(void);
+#endif
 bool netdata_random_session_id_generate(void);
 
 #ifdef OS_WINDOWS
@@ -384,6 +394,9 @@ int netdata_main(int argc, char **argv) {
                             rrdlabels_aral_init(false);
 
                             if (pluginsd_parser_unittest()) return 1;
+                            if (pluginsd_binary_frames_unittest()) return 1;
+                            if (stream_sender_spill_unittest()) return 1;
+                            if (query_cache_unittest()) return 1;
                             if (unit_test_static_threads()) return 1;
                             if (unit_test_buffer()) return 1;
                             if (unit_test_str2ld()) return 1;
@@ -406,6 +419,8 @@ int netdata_main(int argc, char **argv) {
                             if (dyncfg_unittest()) return 1;
                             if (eval_unittest()) return 1;
                             if (duration_unittest()) return 1;
+                            if (tdigest_unittest()) return 1;
+                            if (time_grouping_options_unittest()) return 1;
                             if (unittest_waiting_queue()) return 1;
                             if (uuidmap_unittest()) return 1;
                             if (stacktrace_unittest()) return 1;
@@ -506,10 +521,22 @@ int netdata_main(int argc, char **argv) {
                             unittest_running = true;
                             return pluginsd_parser_unittest();
                         }
+                        else if(strcmp(optarg, "binaryframestest") == 0) {
+                            unittest_running = true;
+                            return pluginsd_binary_frames_unittest();
+                        }
                         else if(strcmp(optarg, "stream_compressions_test") == 0) {
                             unittest_running = true;
                             return unittest_stream_compressions();
                         }
+                        else if(strcmp(optarg, "streamspilltest") == 0) {
+                            unittest_running = true;
+                            return stream_sender_spill_unittest();
+                        }
+                        else if(strcmp(optarg, "querycachetest") == 0) {
+                            unittest_running = true;
+                            return query_cache_unittest();
+                        }
                         else if(strcmp(optarg, "progresstest") == 0) {
                             unittest_running = true;
                             return progress_unittest();
@@ -522,6 +549,28 @@ int netdata_main(int argc, char **argv) {
                             unittest_running = true;
                             return duration_unittest();
                         }
+                        else if(strcmp(optarg, "tdigesttest") == 0) {
+                            unittest_running = true;
+                            return tdigest_unittest();
+                        }
+                        else if(strcmp(optarg, "timegroupingoptionstest") == 0) {
+                            unittest_running = true;
+                            return time_grouping_options_unittest();
+                        }
+                        else if(strcmp(optarg, "statsdbench") == 0) {
+                            unittest_running = true;
+                            return statsd_histogram_benchmark();
+                        }
+                        else if(strcmp(optarg, "statsdloadbench") == 0) {
+                            unittest_running = true;
+                            return statsd_load_benchmark();
+                        }
+#if defined(OS_LINUX)
+                        else if(strcmp(optarg, "cgroupsbench") == 0) {
+                            unittest_running = true;
+                            return cgroups_read_benchmark();
+                        }
+#endif
                         else if(strcmp(optarg, "dyncfgtest") == 0) {
                             unittest_running = true;
                             if(unittest_prepare_rrd(&user))
@@ -545,7 +594,7 @@ int netdata_main(int argc, char **argv) {
                         else if(strncmp(optarg, stresstest_string, strlen(stresstest_string)) == 0) {
                             char *endptr;
                             unsigned test_duration_sec = 0, dset_charts = 0, query_threads = 0, ramp_up_seconds = 0,
-                            page_cache_mb = 0, disk_space_mb = 0, workers = 16;
+                            page_cache_mb = 0, disk_space_mb = 0, workers = 16, async_tier_rollup = 0;
 
                             optarg += strlen(stresstest_string);
                             test_duration_sec = (unsigned)strtoul(optarg, &endptr, 0);
@@ -561,6 +610,8 @@ int netdata_main(int argc, char **argv) {
                                 disk_space_mb = (unsigned)strtoul(endptr + 1, &endptr, 0);
                             if (',' == *endptr)
                                 workers = (unsigned)strtoul(endptr + 1, &endptr, 0);
+                            if (',' == *endptr)
+                                async_tier_rollup = (unsigned)strtoul(endptr + 1, &endptr, 0);
 
                             if (workers > 1024)
                                 workers = 1024;
@@ -569,7 +620,7 @@ int netdata_main(int argc, char **argv) {
                             snprintf(workers_str, 15, "%u", workers);
                             setenv("UV_THREADPOOL_SIZE", workers_str, 1);
                             dbengine_stress_test(test_duration_sec, dset_charts, query_threads, ramp_up_seconds,
-                                                 page_cache_mb, disk_space_mb);
+                                                 page_cache_mb, disk_space_mb, async_tier_rollup != 0);
                             return 0;
                         }
 #endif
@@ -981,6 +981,65 @@ void pulse_dbengine_do(bool extended) {
         rrdset_done(st_cache_hit_ratio);
     }
 
+    {
+        static RRDSET *st_query_source_hit_ratio = NULL;
+        static struct {
+            QUERY_SOURCE source;
+            const char *name;
+            RRDDIM *rd;
+            size_t hit_ratio;
+        } sources[] = {
+            { .source = QUERY_SOURCE_API_DATA,    .name = "dashboard",   .hit_ratio = 100 * 10000 },
+            { .source = QUERY_SOURCE_API_BADGE,   .name = "badges",      .hit_ratio = 100 * 10000 },
+            { .source = QUERY_SOURCE_API_WEIGHTS, .name = "weights",     .hit_ratio = 100 * 10000 },
+            { .source = QUERY_SOURCE_HEALTH,      .name = "health",      .hit_ratio = 100 * 10000 },
+            { .source = QUERY_SOURCE_ML,          .name = "ml",          .hit_ratio = 100 * 10000 },
+            { .source = QUERY_SOURCE_REPLICATION, .name = "replication", .hit_ratio = 100 * 10000 },
+            { .source = QUERY_SOURCE_UNKNOWN,     .name = "other",       .hit_ratio = 100 * 10000 },
+        };
+
+        if (unlikely(!st_query_source_hit_ratio)) {
+            st_query_source_hit_ratio = rrdset_create_localhost(
+                "netdata",
+                "dbengine_query_source_cache_hit_ratio",
+                NULL,
+                "dbengine query router",
+                NULL,
+                "Netdata Queries Main Cache Hit Ratio per Query Source",
+                "%",
+                "netdata",
+                "pulse",
+                priority,
+                localhost->rrd_update_every,
+                RRDSET_TYPE_LINE);
+
+            for(size_t i = 0; i < sizeof(sources) / sizeof(sources[0]) ; i++)
+                sources[i].rd = rrddim_add(st_query_source_hit_ratio, sources[i].name, NULL, 1, 10000, RRD_ALGORITHM_ABSOLUTE);
+        }
+        priority++;
+
+        for(size_t i = 0; i < sizeof(sources) / sizeof(sources[0]) ; i++) {
+            QUERY_SOURCE qs = sources[i].source;
+
+            size_t delta_pages_total =
+                cache_efficiency_stats.query_sources[qs].pages_total - cache_efficiency_stats_old.query_sources[qs].pages_total;
+            size_t delta_pages_from_main_cache =
+                cache_efficiency_stats.query_sources[qs].pages_from_main_cache - cache_efficiency_stats_old.query_sources[qs].pages_from_main_cache;
+
+            // keep the last ratio while this source does not query
+            if(delta_pages_total) {
+                if(delta_pages_from_main_cache > delta_pages_total)
+                    delta_pages_from_main_cache = delta_pages_total;
+
+                sources[i].hit_ratio = delta_pages_from_main_cache * 100 * 10000 / delta_pages_total;
+            }
+
+            rrddim_set_by_pointer(st_query_source_hit_ratio, sources[i].rd, (collected_number)sources[i].hit_ratio);
+        }
+
+        rrdset_done(st_query_source_hit_ratio);
+    }
+
     {
         static RRDSET *st_queries = NULL;
         static RRDDIM *rd_total = NULL;
@@ -1479,6 +1538,102 @@ void pulse_dbengine_do(bool extended) {
         rrdset_done(st_query_timings_average);
     }
 
+    {
+        static RRDSET *st_extent_reads = NULL;
+        static RRDDIM *rd_uring = NULL;
+        static RRDDIM *rd_sync = NULL;
+        static RRDDIM *rd_failed = NULL;
+
+        if (unlikely(!st_extent_reads)) {
+            st_extent_reads = rrdset_create_localhost(
+                "netdata",
+                "dbengine_extent_reads",
+                NULL,
+                "dbengine query router",
+                NULL,
+                "Netdata Query Extent Reads",
+                "extents/s",
+                "netdata",
+                "pulse",
+                priority,
+                localhost->rrd_update_every,
+                RRDSET_TYPE_STACKED);
+
+            rd_uring = rrddim_add(st_extent_reads, "io_uring", NULL, 1, 1, RRD_ALGORITHM_INCREMENTAL);
+            rd_sync = rrddim_add(st_extent_reads, "sync", NULL, 1, 1, RRD_ALGORITHM_INCREMENTAL);
+            rd_failed = rrddim_add(st_extent_reads, "io_uring failed", NULL, -1, 1, RRD_ALGORITHM_INCREMENTAL);
+        }
+        priority++;
+
+        rrddim_set_by_pointer(st_extent_reads, rd_uring, (collected_number)cache_efficiency_stats.extent_reads_uring_submitted);
+        rrddim_set_by_pointer(st_extent_reads, rd_sync, (collected_number)cache_efficiency_stats.extent_reads_sync);
+        rrddim_set_by_pointer(st_extent_reads, rd_failed, (collected_number)cache_efficiency_stats.extent_reads_uring_failed);
+
+        rrdset_done(st_extent_reads);
+    }
+
+    if(dbengine_uring_available()) {
+        static RRDSET *st_uring_queue = NULL;
+        static RRDDIM *rd_in_flight = NULL;
+        static RRDDIM *rd_batch = NULL;
+
+        if (unlikely(!st_uring_queue)) {
+            st_uring_queue = rrdset_create_localhost(
+                "netdata",
+                "dbengine_io_uring_queue_depth",
+                NULL,
+                "dbengine query router",
+                NULL,
+                "Netdata Query io_uring Queue Depth",
+                "extents",
+                "netdata",
+                "pulse",
+                priority,
+                localhost->rrd_update_every,
+                RRDSET_TYPE_LINE);
+
+            rd_in_flight = rrddim_add(st_uring_queue, "in flight", NULL, 1, 1, RRD_ALGORITHM_ABSOLUTE);
+            rd_batch = rrddim_add(st_uring_queue, "average batch", NULL, 1, 1, RRD_ALGORITHM_ABSOLUTE);
+        }
+        priority++;
+
+        size_t batches = cache_efficiency_stats.extent_reads_uring_batches - cache_efficiency_stats_old.extent_reads_uring_batches;
+        size_t submitted = cache_efficiency_stats.extent_reads_uring_submitted - cache_efficiency_stats_old.extent_reads_uring_submitted;
+
+        rrddim_set_by_pointer(st_uring_queue, rd_in_flight, (collected_number)cache_efficiency_stats.extent_reads_uring_in_flight);
+        rrddim_set_by_pointer(st_uring_queue, rd_batch, (collected_number)(batches ? submitted / batches : 0));
+
+        rrdset_done(st_uring_queue);
+    }
+
+    if(dbengine_uring_available()) {
+        static RRDSET *st_uring_latency = NULL;
+        static RRDDIM *rd_latency = NULL;
+
+        if (unlikely(!st_uring_latency)) {
+            st_uring_latency = rrdset_create_localhost(
+                "netdata",
+                "dbengine_io_uring_latency",
+                NULL,
+                "dbengine query router",
+                NULL,
+                "Netdata Query io_uring Average Read Latency",
+                "usec",
+                "netdata",
+                "pulse",
+                priority,
+                localhost->rrd_update_every,
+                RRDSET_TYPE_LINE);
+
+            rd_latency = rrddim_add(st_uring_latency, "latency", NULL, 1, 1, RRD_ALGORITHM_ABSOLUTE);
+        }
+        priority++;
+
+        rrddim_set_by_pointer(st_uring_latency, rd_latency, (collected_number)time_and_count_delta_average(&cache_efficiency_stats_old.extent_reads_uring_latency, &cache_efficiency_stats.extent_reads_uring_latency));
+
+        rrdset_done(st_uring_latency);
+    }
+
     if(netdata_rwlock_tryrdlock(&rrd_rwlock) == 0) {
         priority = 135400;
 
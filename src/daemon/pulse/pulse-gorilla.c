@@ -11,6 +11,9 @@ static struct gorilla_statistics {
     PAD64(uint64_t) gorilla_tier0_disk_actual_bytes;
     PAD64(uint64_t) gorilla_tier0_disk_optimal_bytes;
     PAD64(uint64_t) gorilla_tier0_disk_original_bytes;
+
+    PAD64(uint64_t) gorilla_tier1_disk_actual_bytes;
+    PAD64(uint64_t) gorilla_tier1_disk_original_bytes;
 } gorilla_statistics = { 0 };
 
 void pulse_gorilla_hot_buffer_added() {
@@ -27,11 +30,20 @@ void pulse_gorilla_tier0_page_flush(uint32_t actual, uint32_t optimal, uint32_t
     __atomic_fetch_add(&gorilla_statistics.gorilla_tier0_disk_original_bytes, original, __ATOMIC_RELAXED);
 }
 
+void pulse_gorilla_tier1_page_flush(uint32_t actual, uint32_t original) {
+    if(!gorilla_statistics.enabled) return;
+
+    __atomic_fetch_add(&gorilla_statistics.gorilla_tier1_disk_actual_bytes, actual, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&gorilla_statistics.gorilla_tier1_disk_original_bytes, original, __ATOMIC_RELAXED);
+}
+
 static inline void global_statistics_copy(struct gorilla_statistics *gs) {
     gs->tier0_hot_gorilla_buffers     = __atomic_load_n(&gorilla_statistics.tier0_hot_gorilla_buffers, __ATOMIC_RELAXED);
     gs->gorilla_tier0_disk_actual_bytes = __atomic_load_n(&gorilla_statistics.gorilla_tier0_disk_actual_bytes, __ATOMIC_RELAXED);
     gs->gorilla_tier0_disk_optimal_bytes = __atomic_load_n(&gorilla_statistics.gorilla_tier0_disk_optimal_bytes, __ATOMIC_RELAXED);
     gs->gorilla_tier0_disk_original_bytes = __atomic_load_n(&gorilla_statistics.gorilla_tier0_disk_original_bytes, __ATOMIC_RELAXED);
+    gs->gorilla_tier1_disk_actual_bytes = __atomic_load_n(&gorilla_statistics.gorilla_tier1_disk_actual_bytes, __ATOMIC_RELAXED);
+    gs->gorilla_tier1_disk_original_bytes = __atomic_load_n(&gorilla_statistics.gorilla_tier1_disk_original_bytes, __ATOMIC_RELAXED);
 }
 
 void pulse_gorilla_do(bool extended __maybe_unused) {
@@ -106,5 +118,38 @@ void pulse_gorilla_do(bool extended __maybe_unused) {
 
         rrdset_done(st_tier0_compression_info);
     }
+
+    if (nd_profile.storage_tiers > 1 && tier_page_type[1] == RRDENG_PAGE_TYPE_GORILLA_TIER1)
+    {
+        static RRDSET *st_tiers_compression_info = NULL;
+
+        static RRDDIM *rd_actual_bytes = NULL;
+        static RRDDIM *rd_uncompressed_bytes = NULL;
+
+        if (unlikely(!st_tiers_compression_info)) {
+            st_tiers_compression_info = rrdset_create_localhost(
+                "netdata"
+                , "tiers_gorilla_efficiency"
+                , NULL
+                , "dbengine gorilla"
+                , NULL
+                , "DBENGINE Gorilla Compression Efficiency on Higher Tiers"
+                , "bytes"
+                , "netdata"
+                , "pulse"
+                , 131006
+                , localhost->rrd_update_every
+                , RRDSET_TYPE_LINE
+            );
+
+            rd_actual_bytes = rrddim_add(st_tiers_compression_info, "actual", NULL, 1, 1, RRD_ALGORITHM_ABSOLUTE);
+            rd_uncompressed_bytes = rrddim_add(st_tiers_compression_info, "uncompressed", NULL, 1, 1, RRD_ALGORITHM_ABSOLUTE);
+        }
+
+        rrddim_set_by_pointer(st_tiers_compression_info, rd_actual_bytes, (collected_number)gs.gorilla_tier1_disk_actual_bytes);
+        rrddim_set_by_pointer(st_tiers_compression_info, rd_uncompressed_bytes, (collected_number)gs.gorilla_tier1_disk_original_bytes);
+
+        rrdset_done(st_tiers_compression_info);
+    }
 #endif
 }
@@ -7,6 +7,7 @@
 
 void pulse_gorilla_hot_buffer_added();
 void pulse_gorilla_tier0_page_flush(uint32_t actual, uint32_t optimal, uint32_t original);
+void pulse_gorilla_tier1_page_flush(uint32_t actual, uint32_t original);
 
 #if defined(PULSE_INTERNALS)
 void pulse_gorilla_do(bool extended);
@@ -0,0 +1,141 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#define PULSE_INTERNALS 1
+#include "pulse-health.h"
+
+static struct health_statistics {
+    SPINLOCK spinlock;
+
+    size_t iterations;
+    size_t hosts;
+    usec_t duration_sum_ut;
+    usec_t duration_max_ut;
+    usec_t lag_sum_ut;
+    usec_t lag_max_ut;
+} health_statistics = {
+    .spinlock = SPINLOCK_INITIALIZER,
+};
+
+void pulse_health_iteration_completed(usec_t duration_ut, usec_t lag_ut, size_t hosts) {
+    spinlock_lock(&health_statistics.spinlock);
+
+    health_statistics.iterations++;
+    health_statistics.hosts = hosts;
+
+    health_statistics.duration_sum_ut += duration_ut;
+    if(duration_ut > health_statistics.duration_max_ut)
+        health_statistics.duration_max_ut = duration_ut;
+
+    health_statistics.lag_sum_ut += lag_ut;
+    if(lag_ut > health_statistics.lag_max_ut)
+        health_statistics.lag_max_ut = lag_ut;
+
+    spinlock_unlock(&health_statistics.spinlock);
+}
+
+void pulse_health_do(bool extended __maybe_unused) {
+    static struct health_statistics last = { 0 };
+
+    // the iterations since the last run, max values are reset on every run
+    spinlock_lock(&health_statistics.spinlock);
+    struct health_statistics hs = health_statistics;
+    health_statistics.duration_max_ut = 0;
+    health_statistics.lag_max_ut = 0;
+    spinlock_unlock(&health_statistics.spinlock);
+
+    size_t iterations = hs.iterations - last.iterations;
+    usec_t duration_avg_ut = iterations ? (hs.duration_sum_ut - last.duration_sum_ut) / iterations : 0;
+    usec_t lag_avg_ut = iterations ? (hs.lag_sum_ut - last.lag_sum_ut) / iterations : 0;
+    last = hs;
+
+    if(!hs.iterations)
+        return;
+
+    {
+        static RRDSET *st = NULL;
+        static RRDDIM *rd_avg = NULL, *rd_max = NULL;
+
+        if (unlikely(!st)) {
+            st = rrdset_create_localhost(
+                "netdata"
+                , "health_iteration_duration"
+                , NULL
+                , "health"
+                , NULL
+                , "Netdata Health Iteration Duration"
+                , "milliseconds"
+                , "netdata"
+                , "pulse"
+                , 131200
+                , localhost->rrd_update_every
+                , RRDSET_TYPE_LINE
+            );
+
+            rd_avg = rrddim_add(st, "average", NULL, 1, USEC_PER_MS, RRD_ALGORITHM_ABSOLUTE);
+            rd_max = rrddim_add(st, "max", NULL, 1, USEC_PER_MS, RRD_ALGORITHM_ABSOLUTE);
+        }
+
+        rrddim_set_by_pointer(st, rd_avg, (collected_number)duration_avg_ut);
+        rrddim_set_by_pointer(st, rd_max, (collected_number)hs.duration_max_ut);
+
+        rrdset_done(st);
+    }
+
+    {
+        static RRDSET *st = NULL;
+        static RRDDIM *rd_avg = NULL, *rd_max = NULL;
+
+        if (unlikely(!st)) {
+            st = rrdset_create_localhost(
+                "netdata"
+                , "health_iteration_lag"
+                , NULL
+                , "health"
+                , NULL
+                , "Netdata Health Iteration Lag (how late iterations start)"
+                , "milliseconds"
+                , "netdata"
+                , "pulse"
+                , 131201
+                , localhost->rrd_update_every
+                , RRDSET_TYPE_LINE
+            );
+
+            rd_avg = rrddim_add(st, "average", NULL, 1, USEC_PER_MS, RRD_ALGORITHM_ABSOLUTE);
+            rd_max = rrddim_add(st, "max", NULL, 1, USEC_PER_MS, RRD_ALGORITHM_ABSOLUTE);
+        }
+
+        rrddim_set_by_pointer(st, rd_avg, (collected_number)lag_avg_ut);
+        rrddim_set_by_pointer(st, rd_max, (collected_number)hs.lag_max_ut);
+
+        rrdset_done(st);
+    }
+
+    {
+        static RRDSET *st = NULL;
+        static RRDDIM *rd_hosts = NULL;
+
+        if (unlikely(!st)) {
+            st = rrdset_create_localhost(
+                "netdata"
+                , "health_hosts"
+                , NULL
+                , "health"
+                , NULL
+                , "Netdata Health Hosts Evaluated per Iteration"
+                , "hosts"
+                , "netdata"
+                , "pulse"
+                , 131202
+                , localhost->rrd_update_every
+                , RRDSET_TYPE_LINE
+            );
+
+            rd_hosts = rrddim_add(st, "hosts", NULL, 1, 1, RRD_ALGORITHM_ABSOLUTE);
+        }
+
+        rrddim_set_by_pointer(st, rd_hosts, (collected_number)hs.hosts);
+
+        rrdset_done(st);
+    }
+}
@@ -0,0 +1,14 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef NETDATA_PULSE_HEALTH_H
+#define NETDATA_PULSE_HEALTH_H
+
+#include "daemon/common.h"
+
+void pulse_health_iteration_completed(usec_t duration_ut, usec_t lag_ut, size_t hosts);
+
+#if defined(PULSE_INTERNALS)
+void pulse_health_do(bool extended);
+#endif
+
+#endif //NETDATA_PULSE_HEALTH_H
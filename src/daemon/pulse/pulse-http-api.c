@@ -16,8 +16,20 @@ static struct web_statistics {
 
     PAD64(uint64_t) content_size_uncompressed;
     PAD64(uint64_t) content_size_compressed;
+
+    struct {
+        PAD64(uint64_t) content_size_uncompressed;
+        PAD64(uint64_t) content_size_compressed;
+        PAD64(uint64_t) compression_ut;
+    } encodings[PULSE_WEB_ENCODING_MAX];
 } live_stats = { 0 };
 
+static const char *pulse_web_encoding_names[PULSE_WEB_ENCODING_MAX] = {
+    [PULSE_WEB_ENCODING_GZIP] = "gzip",
+    [PULSE_WEB_ENCODING_ZSTD] = "zstd",
+    [PULSE_WEB_ENCODING_BROTLI] = "br",
+};
+
 void pulse_web_client_connected(void) {
     __atomic_fetch_add(&live_stats.connected_clients, 1, __ATOMIC_RELAXED);
 }
@@ -43,6 +55,18 @@ void pulse_web_request_completed(uint64_t dt,
     __atomic_fetch_add(&live_stats.content_size_compressed, compressed_content_size, __ATOMIC_RELAXED);
 }
 
+void pulse_web_response_compressed(PULSE_WEB_ENCODING encoding,
+                                   uint64_t content_size,
+                                   uint64_t compressed_content_size,
+                                   usec_t compression_ut) {
+    if(encoding >= PULSE_WEB_ENCODING_MAX)
+        return;
+
+    __atomic_fetch_add(&live_stats.encodings[encoding].content_size_uncompressed, content_size, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&live_stats.encodings[encoding].content_size_compressed, compressed_content_size, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&live_stats.encodings[encoding].compression_ut, compression_ut, __ATOMIC_RELAXED);
+}
+
 static inline void pulse_web_copy(struct web_statistics *gs, uint8_t options) {
     gs->connected_clients = __atomic_load_n(&live_stats.connected_clients, __ATOMIC_RELAXED);
     gs->web_requests = __atomic_load_n(&live_stats.web_requests, __ATOMIC_RELAXED);
@@ -53,6 +77,12 @@ static inline void pulse_web_copy(struct web_statistics *gs, uint8_t options) {
     gs->content_size_uncompressed = __atomic_load_n(&live_stats.content_size_uncompressed, __ATOMIC_RELAXED);
     gs->content_size_compressed = __atomic_load_n(&live_stats.content_size_compressed, __ATOMIC_RELAXED);
 
+    for(size_t i = 0; i < PULSE_WEB_ENCODING_MAX ;i++) {
+        gs->encodings[i].content_size_compressed = __atomic_load_n(&live_stats.encodings[i].content_size_compressed, __ATOMIC_RELAXED);
+        gs->encodings[i].content_size_uncompressed = __atomic_load_n(&live_stats.encodings[i].content_size_uncompressed, __ATOMIC_RELAXED);
+        gs->encodings[i].compression_ut = __atomic_load_n(&live_stats.encodings[i].compression_ut, __ATOMIC_RELAXED);
+    }
+
     if(options & GLOBAL_STATS_RESET_WEB_USEC_MAX) {
         uint64_t n = 0;
         __atomic_compare_exchange(&live_stats.web_usec_max, (uint64_t *) &gs->web_usec_max, &n, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED);
@@ -223,4 +253,88 @@ void pulse_web_do(bool extended) {
 
         rrdset_done(st_compression);
     }
-}
\ No newline at end of file
+
+    // ----------------------------------------------------------------
+
+    {
+        static unsigned long long old_content_size[PULSE_WEB_ENCODING_MAX] = { 0 },
+                                  old_compressed_content_size[PULSE_WEB_ENCODING_MAX] = { 0 };
+        static collected_number compression_ratio[PULSE_WEB_ENCODING_MAX] = { -1, -1, -1 };
+
+        static RRDSET *st_compression = NULL;
+        static RRDDIM *rd_savings[PULSE_WEB_ENCODING_MAX] = { NULL };
+
+        if (unlikely(!st_compression)) {
+            st_compression = rrdset_create_localhost(
+                "netdata"
+                , "compression_ratio_per_encoding"
+                , NULL
+                , "HTTP API"
+                , "netdata.http_api_compression_ratio_per_encoding"
+                , "Netdata Web API Responses Compression Savings Ratio per Encoding"
+                , "percentage"
+                , "netdata"
+                , "pulse"
+                , 130601
+                , localhost->rrd_update_every
+                , RRDSET_TYPE_LINE
+            );
+
+            for(size_t i = 0; i < PULSE_WEB_ENCODING_MAX ;i++)
+                rd_savings[i] = rrddim_add(st_compression, pulse_web_encoding_names[i], NULL, 1, 1000, RRD_ALGORITHM_ABSOLUTE);
+        }
+
+        for(size_t i = 0; i < PULSE_WEB_ENCODING_MAX ;i++) {
+            // since we don't lock here to read the data
+            // read the smaller value first
+            unsigned long long gcompressed_content_size = gs.encodings[i].content_size_compressed;
+            unsigned long long gcontent_size = gs.encodings[i].content_size_uncompressed;
+
+            unsigned long long compressed_content_size = gcompressed_content_size - old_compressed_content_size[i];
+            unsigned long long content_size = gcontent_size - old_content_size[i];
+
+            old_compressed_content_size[i] = gcompressed_content_size;
+            old_content_size[i] = gcontent_size;
+
+            if (content_size && content_size >= compressed_content_size)
+                compression_ratio[i] = ((content_size - compressed_content_size) * 100 * 1000) / content_size;
+
+            if (compression_ratio[i] != -1)
+                rrddim_set_by_pointer(st_compression, rd_savings[i], compression_ratio[i]);
+        }
+
+        rrdset_done(st_compression);
+    }
+
+    // ----------------------------------------------------------------
+
+    {
+        static RRDSET *st_compression_time = NULL;
+        static RRDDIM *rd_time[PULSE_WEB_ENCODING_MAX] = { NULL };
+
+        if (unlikely(!st_compression_time)) {
+            st_compression_time = rrdset_create_localhost(
+                "netdata"
+                , "compression_time"
+                , NULL
+                , "HTTP API"
+                , "netdata.http_api_compression_time"
+                , "Netdata Web API Responses Compression Time per Encoding"
+                , "milliseconds/s"
+                , "netdata"
+                , "pulse"
+                , 130602
+                , localhost->rrd_update_every
+                , RRDSET_TYPE_STACKED
+            );
+
+            for(size_t i = 0; i < PULSE_WEB_ENCODING_MAX ;i++)
+                rd_time[i] = rrddim_add(st_compression_time, pulse_web_encoding_names[i], NULL, 1, 1000, RRD_ALGORITHM_INCREMENTAL);
+        }
+
+        for(size_t i = 0; i < PULSE_WEB_ENCODING_MAX ;i++)
+            rrddim_set_by_pointer(st_compression_time, rd_time[i], (collected_number)gs.encodings[i].compression_ut);
+
+        rrdset_done(st_compression_time);
+    }
+}
@@ -14,6 +14,20 @@ void pulse_web_request_completed(uint64_t dt,
                                      uint64_t content_size,
                                      uint64_t compressed_content_size);
 
+typedef enum __attribute__((packed)) {
+    PULSE_WEB_ENCODING_GZIP = 0,
+    PULSE_WEB_ENCODING_ZSTD,
+    PULSE_WEB_ENCODING_BROTLI,
+
+    // terminator
+    PULSE_WEB_ENCODING_MAX,
+} PULSE_WEB_ENCODING;
+
+void pulse_web_response_compressed(PULSE_WEB_ENCODING encoding,
+                                   uint64_t content_size,
+                                   uint64_t compressed_content_size,
+                                   usec_t compression_ut);
+
 #if defined(PULSE_INTERNALS)
 void pulse_web_do(bool extended);
 #endif
@@ -17,6 +17,8 @@ static struct network_statistics {
     PAD64(uint64_t) statsd_bytes_sent;
     PAD64(uint64_t) stream_bytes_received;
     PAD64(uint64_t) stream_bytes_sent;
+    PAD64(uint64_t) stream_bytes_spilled;
+    PAD64(uint64_t) stream_bytes_replayed;
 } live_stats = { 0 };
 
 // --------------------------------------------------------------------------------------------------------------------
@@ -167,6 +169,14 @@ void pulse_stream_sent_bytes(size_t bytes) {
     __atomic_add_fetch(&live_stats.stream_bytes_sent, bytes, __ATOMIC_RELAXED);
 }
 
+void pulse_stream_spilled_bytes(size_t bytes) {
+    __atomic_add_fetch(&live_stats.stream_bytes_spilled, bytes, __ATOMIC_RELAXED);
+}
+
+void pulse_stream_replayed_bytes(size_t bytes) {
+    __atomic_add_fetch(&live_stats.stream_bytes_replayed, bytes, __ATOMIC_RELAXED);
+}
+
 static inline void pulse_network_copy(struct network_statistics *gs) {
     gs->api_bytes_received = __atomic_load_n(&live_stats.api_bytes_received, __ATOMIC_RELAXED);
     gs->api_bytes_sent = __atomic_load_n(&live_stats.api_bytes_sent, __ATOMIC_RELAXED);
@@ -176,6 +186,8 @@ static inline void pulse_network_copy(struct network_statistics *gs) {
 
     gs->stream_bytes_received = __atomic_load_n(&live_stats.stream_bytes_received, __ATOMIC_RELAXED);
     gs->stream_bytes_sent = __atomic_load_n(&live_stats.stream_bytes_sent, __ATOMIC_RELAXED);
+    gs->stream_bytes_spilled = __atomic_load_n(&live_stats.stream_bytes_spilled, __ATOMIC_RELAXED);
+    gs->stream_bytes_replayed = __atomic_load_n(&live_stats.stream_bytes_replayed, __ATOMIC_RELAXED);
 }
 
 void pulse_network_do(bool extended __maybe_unused) {
@@ -278,6 +290,38 @@ void pulse_network_do(bool extended __maybe_unused) {
         rrdset_done(st_bytes);
     }
 
+    if(gs.stream_bytes_spilled || gs.stream_bytes_replayed) {
+        static RRDSET *st_spill = NULL;
+        static RRDDIM *rd_spilled = NULL,
+                      *rd_replayed = NULL;
+
+        if (unlikely(!st_spill)) {
+            st_spill = rrdset_create_localhost(
+                "netdata"
+                , "network_streaming_spill"
+                , NULL
+                , PULSE_NETWORK_CHART_FAMILY
+                , "netdata.network_streaming_spill"
+                , "Netdata Streaming Data Spilled to Disk"
+                , PULSE_NETWORK_CHART_UNITS
+                , "netdata"
+                , "pulse"
+                , PULSE_NETWORK_CHART_PRIORITY + 4
+                , localhost->rrd_update_every
+                , RRDSET_TYPE_AREA
+            );
+
+            rrdlabels_add(st_spill->rrdlabels, "endpoint", "streaming", RRDLABEL_SRC_AUTO);
+
+            rd_spilled  = rrddim_add(st_spill, "spilled",  NULL,  8, BITS_IN_A_KILOBIT, RRD_ALGORITHM_INCREMENTAL);
+            rd_replayed = rrddim_add(st_spill, "replayed", NULL, -8, BITS_IN_A_KILOBIT, RRD_ALGORITHM_INCREMENTAL);
+        }
+
+        rrddim_set_by_pointer(st_spill, rd_spilled, (collected_number) gs.stream_bytes_spilled);
+        rrddim_set_by_pointer(st_spill, rd_replayed, (collected_number) gs.stream_bytes_replayed);
+        rrdset_done(st_spill);
+    }
+
     if(aclk_online()) {
         struct mqtt_wss_stats t = aclk_statistics();
         if (t.bytes_rx || t.bytes_tx) {
@@ -15,6 +15,8 @@ void pulse_statsd_sent_bytes(size_t bytes);
 
 void pulse_stream_received_bytes(size_t bytes);
 void pulse_stream_sent_bytes(size_t bytes);
+void pulse_stream_spilled_bytes(size_t bytes);
+void pulse_stream_replayed_bytes(size_t bytes);
 
 void pulse_aclk_sent_message_acked(usec_t usec, size_t len);
 
@@ -259,4 +259,70 @@ void pulse_queries_do(bool extended __maybe_unused) {
 
         rrdset_done(st_points_generated);
     }
+
+    struct query_cache_statistics qcs;
+    query_cache_statistics(&qcs);
+
+    if(qcs.hits || qcs.misses) {
+        static RRDSET *st_cache_events = NULL;
+        static RRDDIM *rd_hits = NULL;
+        static RRDDIM *rd_misses = NULL;
+        static RRDDIM *rd_evictions = NULL;
+        static RRDDIM *rd_expirations = NULL;
+
+        if (unlikely(!st_cache_events)) {
+            st_cache_events = rrdset_create_localhost(
+                "netdata"
+                , "api_data_cache_events"
+                , NULL
+                , "Time-Series Queries"
+                , NULL
+                , "Netdata /api/vX/data Responses Cache Events"
+                , "events/s"
+                , "netdata"
+                , "pulse"
+                , 131010
+                , localhost->rrd_update_every
+                , RRDSET_TYPE_LINE
+            );
+
+            rd_hits = rrddim_add(st_cache_events, "hits", NULL, 1, 1, RRD_ALGORITHM_INCREMENTAL);
+            rd_misses = rrddim_add(st_cache_events, "misses", NULL, 1, 1, RRD_ALGORITHM_INCREMENTAL);
+            rd_evictions = rrddim_add(st_cache_events, "evictions", NULL, 1, 1, RRD_ALGORITHM_INCREMENTAL);
+            rd_expirations = rrddim_add(st_cache_events, "expirations", NULL, 1, 1, RRD_ALGORITHM_INCREMENTAL);
+        }
+
+        rrddim_set_by_pointer(st_cache_events, rd_hits, (collected_number)qcs.hits);
+        rrddim_set_by_pointer(st_cache_events, rd_misses, (collected_number)qcs.misses);
+        rrddim_set_by_pointer(st_cache_events, rd_evictions, (collected_number)qcs.evictions);
+        rrddim_set_by_pointer(st_cache_events, rd_expirations, (collected_number)qcs.expirations);
+
+        rrdset_done(st_cache_events);
+
+        static RRDSET *st_cache_memory = NULL;
+        static RRDDIM *rd_memory = NULL;
+
+        if (unlikely(!st_cache_memory)) {
+            st_cache_memory = rrdset_create_localhost(
+                "netdata"
+                , "api_data_cache_memory"
+                , NULL
+                , "Time-Series Queries"
+                , NULL
+                , "Netdata /api/vX/data Responses Cache Memory"
+                , "bytes"
+                , "netdata"
+                , "pulse"
+                , 131011
+                , localhost->rrd_update_every
+                , RRDSET_TYPE_LINE
+            );
+
+            rd_memory = rrddim_add(st_cache_memory, "memory", NULL, 1, 1, RRD_ALGORITHM_ABSOLUTE);
+        }
+
+        rrddim_set_by_pointer(st_cache_memory, rd_memory, (collected_number)qcs.memory);
+
+        rrdset_done(st_cache_memory);
+    }
 }
@@ -18,7 +18,8 @@ int stacktrace_unittest(void);
 int test_dbengine(void);
 void generate_dbengine_dataset(unsigned history_seconds);
 void dbengine_stress_test(unsigned TEST_DURATION_SEC, unsigned DSET_CHARTS, unsigned QUERY_THREADS,
-                                 unsigned RAMP_UP_SECONDS, unsigned PAGE_CACHE_MB, unsigned DISK_SPACE_MB);
+                                 unsigned RAMP_UP_SECONDS, unsigned PAGE_CACHE_MB, unsigned DISK_SPACE_MB,
+                                 bool ASYNC_TIER_ROLLUP);
 
 #endif
 
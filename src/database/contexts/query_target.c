@@ -2,6 +2,7 @@
 
 #include "rrdcontext-internal.h"
 #include "database/pattern-array.h"
+#include "database/rrddim-collection.h"
 
 #define QUERY_TARGET_MAX_REALLOC_INCREASE 500
 #define query_target_realloc_size(size, start) \
@@ -145,6 +146,8 @@ void query_target_release(QUERY_TARGET *qt) {
     qt->db.first_time_s = 0;
     qt->db.last_time_s = 0;
 
+    qt->tail.offset = 0;
+
     for(size_t g = 0; g < MAX_QUERY_GROUP_BY_PASSES ;g++)
         qt->group_by[g].used = 0;
 
@@ -283,6 +286,14 @@ static bool query_metric_add(QUERY_TARGET_LOCALS *qtl, QUERY_NODE *qn, QUERY_CON
             tier_retention[tier].db_first_time_s = storage_engine_oldest_time_s(tier_retention[tier].eng->seb, tier_retention[tier].smh);
             tier_retention[tier].db_last_time_s = storage_engine_latest_time_s(tier_retention[tier].eng->seb, tier_retention[tier].smh);
 
+            // when the higher tiers are rolled up in the background, use them only up to their watermark,
+            // so that the query planner gets the rest from tier 0
+            if(tier && rm->rrddim && rrddim_option_check(rm->rrddim, RRDDIM_OPTION_ASYNC_TIER_ROLLUP)) {
+                time_t aggregated_until_s = rrddim_tier_aggregated_until_s(rm->rrddim, tier);
+                if(aggregated_until_s && tier_retention[tier].db_last_time_s > aggregated_until_s)
+                    tier_retention[tier].db_last_time_s = aggregated_until_s;
+            }
+
             if(!common_first_time_s)
                 common_first_time_s = tier_retention[tier].db_first_time_s;
             else if(tier_retention[tier].db_first_time_s)
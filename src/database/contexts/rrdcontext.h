@@ -424,6 +424,11 @@ typedef struct query_target {
     struct query_versions versions;
     struct query_timings timings;
 
+    struct {
+        size_t offset;                          // the length of the response before the agents and the timings (0 = not rendered)
+        struct buffer_json_state json;          // the json state of the response at this offset
+    } tail;
+
     struct {
         SPINLOCK spinlock;
         bool used;                              // when true, this query is currently being used
@@ -32,6 +32,7 @@ typedef enum __attribute__ ((__packed__)) {
     PGC_PAGE_IS_BEING_MIGRATED_TO_V2     = (1 << 4),
     PGC_PAGE_HAS_NO_DATA_IGNORE_ACCESSES = (1 << 5),
     PGC_PAGE_HAS_BEEN_ACCESSED           = (1 << 6),
+    PGC_PAGE_IS_PROBATION                = (1 << 7), // clean page in the probation list (PGC_OPTIONS_SCAN_RESISTANT)
 } PGC_PAGE_FLAGS;
 
 #define page_flag_check(page, flag) (__atomic_load_n(&((page)->flags), __ATOMIC_ACQUIRE) & (flag))
@@ -79,6 +80,7 @@ struct pgc_queue {
         PGC_PAGE *base;
         Pvoid_t sections_judy;
     };
+    PGC_PAGE *probation;            // clean pages seen once, evicted first (PGC_OPTIONS_SCAN_RESISTANT)
     PGC_PAGE_FLAGS flags;
     size_t version;
     size_t last_version_checked;
@@ -86,6 +88,30 @@ struct pgc_queue {
     struct pgc_queue_statistics *stats;
 };
 
+// Lockless exact lookups
+// Each partition has a direct mapped table of the pages recently found by exact
+// searches. Readers check it under a sequence counter, without locking the index,
+// and acquire the page they find. Pages are removed from the table while the index
+// is write locked, and they are freed only after all the readers that may have seen
+// them have finished (an SRCU style grace period over striped reader counters).
+// Misses fall back to the locked Judy lookup, which populates the table.
+
+#define PGC_LOOKUP_SLOTS_BITS 9
+#define PGC_LOOKUP_SLOTS (1 << PGC_LOOKUP_SLOTS_BITS)
+#define PGC_LOOKUP_READER_STRIPES 16
+
+struct pgc_lookup_slot {
+    uint32_t seq;                   // odd while the slot is being written
+    time_t start_time_s;
+    Word_t section;
+    Word_t metric_id;
+    PGC_PAGE *page;
+};
+
+struct pgc_lookup_readers {
+    PAD64(size_t) count;
+};
+
 struct pgc {
     struct {
         char name[PGC_NAME_MAX + 1];
@@ -126,6 +152,13 @@ struct pgc {
 #ifdef PGC_WITH_ARAL
         ARAL *aral;
 #endif
+
+        struct {
+            struct pgc_lookup_slot *slots;
+            SPINLOCK spinlock;      // serializes the grace periods
+            uint32_t epoch;         // the readers side currently used by new readers
+            struct pgc_lookup_readers readers[2][PGC_LOOKUP_READER_STRIPES];
+        } lookup;
     } *index;
 
     struct {
@@ -622,6 +655,75 @@ static ALWAYS_INLINE void pgc_stats_index_judy_change(PGC *cache, int64_t delta)
     __atomic_add_fetch(&cache->stats.size, delta, __ATOMIC_RELAXED);
 }
 
+// ----------------------------------------------------------------------------
+// scan resistance
+// With PGC_OPTIONS_SCAN_RESISTANT, the clean queue is split in two lists (2Q).
+// Clean pages seen once are appended to the probation list, and they move to the
+// protected list (the queue base) when they are accessed again. The evictor evicts
+// from the probation list while it holds more than its share of the clean pages,
+// so a wide query touching many pages once evicts its own pages, not the working set.
+
+#define PGC_PROBATION_PER1000 250
+
+static ALWAYS_INLINE bool pgc_clean_page_seen_again(PGC_PAGE *page) {
+    return page->accesses > 1 ||
+           page_flag_check(page, PGC_PAGE_HAS_BEEN_ACCESSED | PGC_PAGE_HAS_NO_DATA_IGNORE_ACCESSES) == PGC_PAGE_HAS_BEEN_ACCESSED;
+}
+
+static ALWAYS_INLINE void pgc_probation_add_unsafe(PGC *cache, struct pgc_queue *q, PGC_PAGE *page) {
+    if(page->accesses)
+        DOUBLE_LINKED_LIST_APPEND_ITEM_UNSAFE(q->probation, page, link.prev, link.next);
+    else
+        DOUBLE_LINKED_LIST_PREPEND_ITEM_UNSAFE(q->probation, page, link.prev, link.next);
+
+    page_flag_set(page, PGC_PAGE_IS_PROBATION);
+    __atomic_add_fetch(&cache->stats.probation_entries, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&cache->stats.probation_size, page->assumed_size, __ATOMIC_RELAXED);
+}
+
+static ALWAYS_INLINE void pgc_probation_del_unsafe(PGC *cache, struct pgc_queue *q, PGC_PAGE *page) {
+    DOUBLE_LINKED_LIST_REMOVE_ITEM_UNSAFE(q->probation, page, link.prev, link.next);
+
+    page_flag_clear(page, PGC_PAGE_IS_PROBATION);
+    __atomic_sub_fetch(&cache->stats.probation_entries, 1, __ATOMIC_RELAXED);
+    __atomic_sub_fetch(&cache->stats.probation_size, page->assumed_size, __ATOMIC_RELAXED);
+}
+
+// the page has been accessed again - the caller has the clean queue locked
+static ALWAYS_INLINE void pgc_clean_page_accessed_unsafe(PGC *cache, PGC_PAGE *page) {
+    if(page_flag_check(page, PGC_PAGE_IS_PROBATION)) {
+        pgc_probation_del_unsafe(cache, &cache->clean, page);
+        __atomic_add_fetch(&cache->stats.probation_promoted, 1, __ATOMIC_RELAXED);
+    }
+    else
+        DOUBLE_LINKED_LIST_REMOVE_ITEM_UNSAFE(cache->clean.base, page, link.prev, link.next);
+
+    DOUBLE_LINKED_LIST_APPEND_ITEM_UNSAFE(cache->clean.base, page, link.prev, link.next);
+    page_flag_clear(page, PGC_PAGE_HAS_BEEN_ACCESSED);
+}
+
+// the lists of the clean queue, in the order the evictor should try them
+static ALWAYS_INLINE size_t pgc_clean_lists_to_evict(PGC *cache, PGC_PAGE **lists[2]) {
+    if(!cache->clean.probation) {
+        lists[0] = &cache->clean.base;
+        return 1;
+    }
+
+    int64_t probation = __atomic_load_n(&cache->stats.probation_size, __ATOMIC_RELAXED);
+    int64_t clean = __atomic_load_n(&cache->clean.stats->size, __ATOMIC_RELAXED);
+
+    if(!cache->clean.base || probation * 1000 > clean * PGC_PROBATION_PER1000) {
+        lists[0] = &cache->clean.probation;
+        lists[1] = &cache->clean.base;
+    }
+    else {
+        lists[0] = &cache->clean.base;
+        lists[1] = &cache->clean.probation;
+    }
+
+    return 2;
+}
+
 static ALWAYS_INLINE void pgc_queue_add(PGC *cache __maybe_unused, struct pgc_queue *q, PGC_PAGE *page, bool having_lock, WAITQ_PRIORITY prio __maybe_unused) {
     if(!having_lock)
         pgc_queue_lock(cache, q, prio);
@@ -667,8 +769,12 @@ static ALWAYS_INLINE void pgc_queue_add(PGC *cache __maybe_unused, struct pgc_qu
         // CLEAN pages end up here.
         // - New pages created as CLEAN, always have 1 access.
         // - DIRTY pages made CLEAN, depending on their accesses may be appended (accesses > 0) or prepended (accesses = 0).
+        // - When the cache is scan resistant, the pages not seen again go to the probation list.
 
-        if(page->accesses || page_flag_check(page, PGC_PAGE_HAS_BEEN_ACCESSED | PGC_PAGE_HAS_NO_DATA_IGNORE_ACCESSES) == PGC_PAGE_HAS_BEEN_ACCESSED) {
+        if((cache->config.options & PGC_OPTIONS_SCAN_RESISTANT) && !pgc_clean_page_seen_again(page))
+            pgc_probation_add_unsafe(cache, q, page);
+
+        else if(page->accesses || page_flag_check(page, PGC_PAGE_HAS_BEEN_ACCESSED | PGC_PAGE_HAS_NO_DATA_IGNORE_ACCESSES) == PGC_PAGE_HAS_BEEN_ACCESSED) {
             DOUBLE_LINKED_LIST_APPEND_ITEM_UNSAFE(q->base, page, link.prev, link.next);
             page_flag_clear(page, PGC_PAGE_HAS_BEEN_ACCESSED);
         }
@@ -745,7 +851,11 @@ static ALWAYS_INLINE void pgc_queue_del(PGC *cache __maybe_unused, struct pgc_qu
         }
     }
     else {
-        DOUBLE_LINKED_LIST_REMOVE_ITEM_UNSAFE(q->base, page, link.prev, link.next);
+        if(page_flag_check(page, PGC_PAGE_IS_PROBATION))
+            pgc_probation_del_unsafe(cache, q, page);
+        else
+            DOUBLE_LINKED_LIST_REMOVE_ITEM_UNSAFE(q->base, page, link.prev, link.next);
+
         q->version++;
     }
 
@@ -761,10 +871,8 @@ static ALWAYS_INLINE void page_has_been_accessed(PGC *cache, PGC_PAGE *page) {
 
         if (flags & PGC_PAGE_CLEAN) {
             if(pgc_queue_trylock(cache, &cache->clean, PGC_QUEUE_LOCK_PRIO_EVICTORS)) {
-                DOUBLE_LINKED_LIST_REMOVE_ITEM_UNSAFE(cache->clean.base, page, link.prev, link.next);
-                DOUBLE_LINKED_LIST_APPEND_ITEM_UNSAFE(cache->clean.base, page, link.prev, link.next);
+                pgc_clean_page_accessed_unsafe(cache, page);
                 pgc_queue_unlock(cache, &cache->clean);
-                page_flag_clear(page, PGC_PAGE_HAS_BEEN_ACCESSED);
             }
             else
                 page_flag_set(page, PGC_PAGE_HAS_BEEN_ACCESSED);
@@ -953,6 +1061,115 @@ static ALWAYS_INLINE bool acquired_page_get_for_deletion_or_release_it(PGC *cach
 }
 
 
+// ----------------------------------------------------------------------------
+// lockless exact lookups
+
+static ALWAYS_INLINE struct pgc_lookup_slot *pgc_lookup_slot(PGC *cache, size_t partition, Word_t section, Word_t metric_id, time_t start_time_s) {
+    uint64_t hash = ((uint64_t)metric_id ^ ((uint64_t)section << 17) ^ (uint64_t)start_time_s) * 0x9E3779B97F4A7C15ULL;
+    return &cache->index[partition].lookup.slots[hash >> (64 - PGC_LOOKUP_SLOTS_BITS)];
+}
+
+static ALWAYS_INLINE size_t *pgc_lookup_reader_enter(PGC *cache, size_t partition) {
+    struct pgc_index *index = &cache->index[partition];
+    uint32_t side = __atomic_load_n(&index->lookup.epoch, __ATOMIC_ACQUIRE) & 1;
+    size_t *count = &index->lookup.readers[side][(size_t)gettid_cached() % PGC_LOOKUP_READER_STRIPES].count;
+
+    // the slot has to be read after the reader is counted
+    __atomic_add_fetch(count, 1, __ATOMIC_SEQ_CST);
+    return count;
+}
+
+static ALWAYS_INLINE void pgc_lookup_reader_exit(size_t *count) {
+    __atomic_sub_fetch(count, 1, __ATOMIC_RELEASE);
+}
+
+// find and acquire a page without locking the index
+static ALWAYS_INLINE PGC_PAGE *pgc_lookup_find_and_acquire(PGC *cache, size_t partition, Word_t section, Word_t metric_id, time_t start_time_s) {
+    struct pgc_lookup_slot *slot = pgc_lookup_slot(cache, partition, section, metric_id, start_time_s);
+    PGC_PAGE *page = NULL;
+
+    size_t *count = pgc_lookup_reader_enter(cache, partition);
+
+    uint32_t seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+    if(!(seq & 1) &&
+        __atomic_load_n(&slot->metric_id, __ATOMIC_RELAXED) == metric_id &&
+        __atomic_load_n(&slot->start_time_s, __ATOMIC_RELAXED) == start_time_s &&
+        __atomic_load_n(&slot->section, __ATOMIC_RELAXED) == section) {
+
+        page = __atomic_load_n(&slot->page, __ATOMIC_RELAXED);
+
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if(__atomic_load_n(&slot->seq, __ATOMIC_RELAXED) != seq || !page || !page_acquire(cache, page))
+            // the slot changed while we were reading it, or the page is being deleted
+            page = NULL;
+    }
+
+    pgc_lookup_reader_exit(count);
+
+    return page;
+}
+
+// remember a page found in the index
+// the caller has the index read locked, so the page cannot be removed meanwhile
+static ALWAYS_INLINE void pgc_lookup_set(PGC *cache, size_t partition, PGC_PAGE *page) {
+    struct pgc_lookup_slot *slot = pgc_lookup_slot(cache, partition, page->section, page->metric_id, page->start_time_s);
+
+    if(__atomic_load_n(&slot->page, __ATOMIC_RELAXED) == page)
+        return;
+
+    uint32_t seq = __atomic_load_n(&slot->seq, __ATOMIC_RELAXED);
+    if((seq & 1) || !__atomic_compare_exchange_n(&slot->seq, &seq, seq + 1, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+        // another reader is updating it
+        return;
+
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    __atomic_store_n(&slot->section, page->section, __ATOMIC_RELAXED);
+    __atomic_store_n(&slot->metric_id, page->metric_id, __ATOMIC_RELAXED);
+    __atomic_store_n(&slot->start_time_s, page->start_time_s, __ATOMIC_RELAXED);
+    __atomic_store_n(&slot->page, page, __ATOMIC_RELAXED);
+    __atomic_store_n(&slot->seq, seq + 2, __ATOMIC_RELEASE);
+}
+
+// forget a page that is removed from the index
+// the caller has the index write locked, so nobody else updates the slot
+static ALWAYS_INLINE void pgc_lookup_del_unsafe(PGC *cache, size_t partition, PGC_PAGE *page) {
+    struct pgc_lookup_slot *slot = pgc_lookup_slot(cache, partition, page->section, page->metric_id, page->start_time_s);
+
+    if(__atomic_load_n(&slot->page, __ATOMIC_RELAXED) != page)
+        return;
+
+    uint32_t seq = __atomic_load_n(&slot->seq, __ATOMIC_RELAXED);
+    __atomic_store_n(&slot->seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    __atomic_store_n(&slot->page, NULL, __ATOMIC_RELAXED);
+    __atomic_store_n(&slot->seq, seq + 2, __ATOMIC_RELEASE);
+}
+
+// wait for all the lockless readers that may still see the pages removed from the
+// lookup table of a partition - after this, these pages can be freed
+static void pgc_lookup_synchronize(PGC *cache, size_t partition) {
+    struct pgc_index *index = &cache->index[partition];
+
+    // the removal of the pages has to be visible before we check the readers
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+    spinlock_lock(&index->lookup.spinlock);
+
+    // new readers are counted on the other side, so the old side drains quickly;
+    // we flip twice, to also wait for the readers that loaded the epoch before
+    // the first flip, but were counted after it
+    for(size_t flip = 0; flip < 2 ; flip++) {
+        uint32_t side = __atomic_fetch_add(&index->lookup.epoch, 1, __ATOMIC_SEQ_CST) & 1;
+
+        for(size_t s = 0; s < PGC_LOOKUP_READER_STRIPES ; s++) {
+            while(__atomic_load_n(&index->lookup.readers[side][s].count, __ATOMIC_ACQUIRE))
+                yield_the_processor();
+        }
+    }
+
+    spinlock_unlock(&index->lookup.spinlock);
+}
+
 // ----------------------------------------------------------------------------
 // Indexing
 
@@ -1028,6 +1245,8 @@ static void remove_this_page_from_index_unsafe(PGC *cache, PGC_PAGE *page, size_
               page->start_time_s, (void *)page->metric_id, (void *)page->section,
               page, found_page);
 
+    pgc_lookup_del_unsafe(cache, partition, page);
+
     JudyAllocThreadPulseReset();
 
     if(unlikely(!JudyLDel(pages_judy_pptr, page->start_time_s, PJE0)))
@@ -1051,6 +1270,7 @@ static inline void remove_and_free_page_not_in_any_queue_and_acquired_for_deleti
     pgc_index_write_lock(cache, partition);
     remove_this_page_from_index_unsafe(cache, page, partition);
     pgc_index_write_unlock(cache, partition);
+    pgc_lookup_synchronize(cache, partition);
     free_this_page(cache, page, partition);
 }
 
@@ -1183,63 +1403,68 @@ static bool evict_pages_with_filter(PGC *cache, size_t max_skip, size_t max_evic
         PGC_PAGE *pages_to_evict = NULL;
         int64_t pages_to_evict_size = 0;
         size_t pages_to_evict_count = 0;
-        for(PGC_PAGE *page = cache->clean.base, *next = NULL, *first_page_we_relocated = NULL; page ; page = next) {
-            next = page->link.next;
-
-            if(unlikely(page == first_page_we_relocated))
-                // we did a complete loop on all pages
-                break;
-
-            if(unlikely(page_flag_check(page, PGC_PAGE_HAS_BEEN_ACCESSED | PGC_PAGE_HAS_NO_DATA_IGNORE_ACCESSES) == PGC_PAGE_HAS_BEEN_ACCESSED)) {
-                DOUBLE_LINKED_LIST_REMOVE_ITEM_UNSAFE(cache->clean.base, page, link.prev, link.next);
-                DOUBLE_LINKED_LIST_APPEND_ITEM_UNSAFE(cache->clean.base, page, link.prev, link.next);
-                page_flag_clear(page, PGC_PAGE_HAS_BEEN_ACCESSED);
-                continue;
-            }
 
-            if(unlikely(filter && !filter(page, data)))
-                continue;
+        PGC_PAGE **lists[2];
+        size_t lists_count = pgc_clean_lists_to_evict(cache, lists);
+        for(size_t l = 0; l < lists_count && !pages_to_evict && !stopped_before_finishing ; l++) {
+            PGC_PAGE **base = lists[l];
 
-            if(non_acquired_page_get_for_deletion___while_having_clean_locked(cache, page)) {
-                // we can delete this page
+            for(PGC_PAGE *page = *base, *next = NULL, *first_page_we_relocated = NULL; page ; page = next) {
+                next = page->link.next;
 
-                // remove it from the clean list
-                pgc_queue_del(cache, &cache->clean, page, true, PGC_QUEUE_LOCK_PRIO_EVICTORS);
+                if(unlikely(page == first_page_we_relocated))
+                    // we did a complete loop on all pages
+                    break;
 
-                __atomic_add_fetch(&cache->stats.evicting_entries, 1, __ATOMIC_RELAXED);
-                __atomic_add_fetch(&cache->stats.evicting_size, page->assumed_size, __ATOMIC_RELAXED);
+                if(unlikely(page_flag_check(page, PGC_PAGE_HAS_BEEN_ACCESSED | PGC_PAGE_HAS_NO_DATA_IGNORE_ACCESSES) == PGC_PAGE_HAS_BEEN_ACCESSED)) {
+                    pgc_clean_page_accessed_unsafe(cache, page);
+                    continue;
+                }
 
-                DOUBLE_LINKED_LIST_APPEND_ITEM_UNSAFE(pages_to_evict, page, link.prev, link.next);
+                if(unlikely(filter && !filter(page, data)))
+                    continue;
 
-                pages_to_evict_size += page->assumed_size;
-                pages_to_evict_count++;
+                if(non_acquired_page_get_for_deletion___while_having_clean_locked(cache, page)) {
+                    // we can delete this page
 
-                timing_dbengine_evict_step(TIMING_STEP_DBENGINE_EVICT_SELECT_PAGE);
+                    // remove it from the clean list
+                    pgc_queue_del(cache, &cache->clean, page, true, PGC_QUEUE_LOCK_PRIO_EVICTORS);
 
-                if((pages_to_evict_count < max_pages_to_evict && pages_to_evict_size < max_size_to_evict) || all_of_them)
-                    // get more pages
-                    ;
-                else
-                    // one page at a time
-                    break;
-            }
-            else {
-                // we can't delete this page
+                    __atomic_add_fetch(&cache->stats.evicting_entries, 1, __ATOMIC_RELAXED);
+                    __atomic_add_fetch(&cache->stats.evicting_size, page->assumed_size, __ATOMIC_RELAXED);
 
-                if(!first_page_we_relocated)
-                    first_page_we_relocated = page;
+                    DOUBLE_LINKED_LIST_APPEND_ITEM_UNSAFE(pages_to_evict, page, link.prev, link.next);
 
-                DOUBLE_LINKED_LIST_REMOVE_ITEM_UNSAFE(cache->clean.base, page, link.prev, link.next);
-                DOUBLE_LINKED_LIST_APPEND_ITEM_UNSAFE(cache->clean.base, page, link.prev, link.next);
+                    pages_to_evict_size += page->assumed_size;
+                    pages_to_evict_count++;
 
-                total_pages_relocated++;
+                    timing_dbengine_evict_step(TIMING_STEP_DBENGINE_EVICT_SELECT_PAGE);
 
-                timing_dbengine_evict_step(TIMING_STEP_DBENGINE_EVICT_RELOCATE_PAGE);
+                    if((pages_to_evict_count < max_pages_to_evict && pages_to_evict_size < max_size_to_evict) || all_of_them)
+                        // get more pages
+                        ;
+                    else
+                        // one page at a time
+                        break;
+                }
+                else {
+                    // we can't delete this page
 
-                // check if we have to stop
-                if(unlikely(total_pages_relocated >= max_skip && !all_of_them)) {
-                    stopped_before_finishing = true;
-                    break;
+                    if(!first_page_we_relocated)
+                        first_page_we_relocated = page;
+
+                    DOUBLE_LINKED_LIST_REMOVE_ITEM_UNSAFE(*base, page, link.prev, link.next);
+                    DOUBLE_LINKED_LIST_APPEND_ITEM_UNSAFE(*base, page, link.prev, link.next);
+
+                    total_pages_relocated++;
+
+                    timing_dbengine_evict_step(TIMING_STEP_DBENGINE_EVICT_RELOCATE_PAGE);
+
+                    // check if we have to stop
+                    if(unlikely(total_pages_relocated >= max_skip && !all_of_them)) {
+                        stopped_before_finishing = true;
+                        break;
+                    }
                 }
             }
         }
@@ -1303,6 +1528,8 @@ static bool evict_pages_with_filter(PGC *cache, size_t max_skip, size_t max_evic
                 for (size_t partition = 0; partition < cache->config.partitions; partition++) {
                     if (!pages_per_partition[partition]) continue;
 
+                    pgc_lookup_synchronize(cache, partition);
+
                     for (PGC_PAGE *page = pages_per_partition[partition], *next = NULL; page; page = next) {
                         next = page->link.next;
 
@@ -1335,6 +1562,7 @@ static bool evict_pages_with_filter(PGC *cache, size_t max_skip, size_t max_evic
                 pgc_index_write_lock(cache, partition);
                 remove_this_page_from_index_unsafe(cache, page, partition);
                 pgc_index_write_unlock(cache, partition);
+                pgc_lookup_synchronize(cache, partition);
                 free_this_page(cache, page, partition);
 
                 __atomic_sub_fetch(&cache->stats.evicting_entries, 1, __ATOMIC_RELAXED);
@@ -1598,6 +1826,14 @@ static ALWAYS_INLINE PGC_PAGE *page_find_and_acquire_once(PGC *cache, Word_t sec
     PGC_PAGE *page = NULL;
     size_t partition = pgc_indexing_partition(cache, metric_id);
 
+    if(method == PGC_SEARCH_EXACT) {
+        page = pgc_lookup_find_and_acquire(cache, partition, section, metric_id, start_time_s);
+        if(page) {
+            __atomic_add_fetch(&cache->stats.searches_exact_lockless, 1, __ATOMIC_RELAXED);
+            return page;
+        }
+    }
+
     pgc_index_read_lock(cache, partition);
 
     Pvoid_t *metrics_judy_pptr = JudyLGet(cache->index[partition].sections_judy, section, PJE0);
@@ -1639,6 +1875,8 @@ static ALWAYS_INLINE PGC_PAGE *page_find_and_acquire_once(PGC *cache, Word_t sec
 
         case PGC_SEARCH_EXACT:
             page = page_find_and_acquire_exact_unsafe(cache, pages_judy_pptr, start_time_s);
+            if(page)
+                pgc_lookup_set(cache, partition, page);
             break;
 
         case PGC_SEARCH_FIRST:
@@ -2037,6 +2275,8 @@ PGC *pgc_create(const char *name,
 
     for(size_t part = 0; part < cache->config.partitions ; part++) {
         rw_spinlock_init(&cache->index[part].rw_spinlock);
+        spinlock_init(&cache->index[part].lookup.spinlock);
+        cache->index[part].lookup.slots = callocz(PGC_LOOKUP_SLOTS, sizeof(struct pgc_lookup_slot));
 #ifdef PGC_WITH_ARAL
         {
             char buf[100];
@@ -2136,6 +2376,7 @@ void pgc_destroy(PGC *cache, bool flush) {
 
         for(size_t part = 0; part < cache->config.partitions ;part++) {
             //  netdata_rwlock_destroy(&cache->index[part].rw_spinlock);
+            freez(cache->index[part].lookup.slots);
 #ifdef PGC_WITH_ARAL
             aral_destroy(cache->index[part].aral);
 #endif
@@ -2645,6 +2886,8 @@ size_t pgc_count_clean_pages_having_data_ptr(PGC *cache, Word_t section, void *p
     pgc_queue_lock(cache, &cache->clean, PGC_QUEUE_LOCK_PRIO_LOW);
     for(PGC_PAGE *page = cache->clean.base; page ;page = page->link.next)
         found += (page->data == ptr && page->section == section) ? 1 : 0;
+    for(PGC_PAGE *page = cache->clean.probation; page ;page = page->link.next)
+        found += (page->data == ptr && page->section == section) ? 1 : 0;
     pgc_queue_unlock(cache, &cache->clean);
 
     return found;
@@ -2931,6 +3174,7 @@ void unittest_stress_test(void) {
 
         size_t searches_exact;
         size_t searches_exact_hits;
+        size_t searches_exact_lockless;
         size_t searches_closest;
         size_t searches_closest_hits;
 
@@ -2964,6 +3208,7 @@ void unittest_stress_test(void) {
 
         stats.searches_exact = __atomic_load_n(&pgc_uts.cache->stats.searches_exact, __ATOMIC_RELAXED);
         stats.searches_exact_hits = __atomic_load_n(&pgc_uts.cache->stats.searches_exact_hits, __ATOMIC_RELAXED);
+        stats.searches_exact_lockless = __atomic_load_n(&pgc_uts.cache->stats.searches_exact_lockless, __ATOMIC_RELAXED);
 
         stats.searches_closest = __atomic_load_n(&pgc_uts.cache->stats.searches_closest, __ATOMIC_RELAXED);
         stats.searches_closest_hits = __atomic_load_n(&pgc_uts.cache->stats.searches_closest_hits, __ATOMIC_RELAXED);
@@ -2981,6 +3226,12 @@ void unittest_stress_test(void) {
         double hit_exact_pc = (searches_exact > 0) ? (double)hit_exact * 100.0 / (double)searches_exact : 0.0;
         double hit_closest_pc = (searches_closest > 0) ? (double)hit_closest * 100.0 / (double)searches_closest : 0.0;
 
+        size_t lockless_exact = stats.searches_exact_lockless - old_stats.searches_exact_lockless;
+        double lockless_exact_pc = (hit_exact > 0) ? (double)lockless_exact * 100.0 / (double)hit_exact : 0.0;
+
+        // lookups per second, per query thread
+        double lookups_per_thread = (double)(searches_exact + searches_closest) / (double)pgc_uts.query_threads;
+
 #ifdef PGC_COUNT_POINTS_COLLECTED
         stats.collections = __atomic_load_n(&pgc_uts.cache->stats.points_collected, __ATOMIC_RELAXED);
 #endif
@@ -3001,6 +3252,7 @@ void unittest_stress_test(void) {
              "| DRT %s %5zuk +%4zuk -%4zuk "
              "| CLN %s %5zuk +%4zuk -%4zuk "
              "| SRCH %4zuk %4zuk, HIT %4.1f%% %4.1f%% "
+             "| LKP %zu threads %7.1fk/s/thread, LOCKLESS %4.1f%% "
 #ifdef PGC_COUNT_POINTS_COLLECTED
              "| CLCT %8.4f Mps"
 #endif
@@ -3016,6 +3268,7 @@ void unittest_stress_test(void) {
              , (stats.clean_added - old_stats.clean_added) / 1000, (stats.clean_deleted - old_stats.clean_deleted) / 1000
              , searches_exact / 1000, searches_closest / 1000
              , hit_exact_pc, hit_closest_pc
+             , pgc_uts.query_threads, lookups_per_thread / 1000.0, lockless_exact_pc
 #ifdef PGC_COUNT_POINTS_COLLECTED
              , (double)(stats.collections - old_stats.collections) / 1000.0 / 1000.0
 #endif
@@ -17,6 +17,7 @@ typedef enum __attribute__ ((__packed__)) {
     PGC_OPTIONS_EVICT_PAGES_NO_INLINE   = (1 << 0),
     PGC_OPTIONS_FLUSH_PAGES_NO_INLINE   = (1 << 1),
     PGC_OPTIONS_AUTOSCALE               = (1 << 2),
+    PGC_OPTIONS_SCAN_RESISTANT          = (1 << 3), // clean pages seen once are evicted before the ones seen again
 } PGC_OPTIONS;
 
 #define PGC_OPTIONS_DEFAULT (PGC_OPTIONS_EVICT_PAGES_NO_INLINE | PGC_OPTIONS_AUTOSCALE)
@@ -101,6 +102,10 @@ struct pgc_statistics {
     PAD64(size_t) hot_empty_pages_evicted_immediately;
     PAD64(size_t) hot_empty_pages_evicted_later;
 
+    PAD64(size_t) probation_entries;       // clean entries seen once (PGC_OPTIONS_SCAN_RESISTANT)
+    PAD64(int64_t) probation_size;         // clean entries seen once (PGC_OPTIONS_SCAN_RESISTANT)
+    PAD64(size_t) probation_promoted;      // clean entries seen again, moved to the protected list
+
     // ----------------------------------------------------------------------------------------------------------------
     // workload
 
@@ -112,6 +117,7 @@ struct pgc_statistics {
     PAD64(size_t) searches_exact;
     PAD64(size_t) searches_exact_hits;
     PAD64(size_t) searches_exact_misses;
+    PAD64(size_t) searches_exact_lockless;  // exact hits served without locking the index
 
     PAD64(size_t) searches_closest;
     PAD64(size_t) searches_closest_hits;
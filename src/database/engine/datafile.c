@@ -405,6 +405,9 @@ static int scan_data_files(struct rrdengine_instance *ctx)
                 (void) JudyLIns(&journafile_JudyL, (Word_t)fileno, PJE0);
         }
 
+        if (unknown_file && strncmp(dent.name, MRG_SNAPSHOT_FILENAME, strlen(MRG_SNAPSHOT_FILENAME)) == 0)
+            unknown_file = false;
+
         if (unknown_file)
             nd_log_daemon(NDLP_WARNING, "Unknown file detected : \"%s/%s\"", ctx->config.dbfiles_path, dent.name);
     }
@@ -63,6 +63,7 @@ struct rrdengine_datafile {
     struct {
         SPINLOCK spinlock;
         bool populated;
+        bool reconcile;                 // populated from the MRG snapshot, its journal has to be loaded later
     } populate_mrg;
 
     struct {
@@ -0,0 +1,150 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "rrdengine.h"
+
+struct rollup_job {
+    struct rrdeng_collect_handle *handle;
+    PGC_PAGE *page;
+
+    struct rollup_job *prev;
+    struct rollup_job *next;
+};
+
+struct rollup_shard {
+    SPINLOCK spinlock;
+    bool dispatched;                // there is a rollup opcode in the dbengine queue
+    bool running;                   // a thread is draining the shard
+    struct rollup_job *base;
+};
+
+static struct {
+    struct rollup_shard shards[DBENGINE_ROLLUP_SHARDS];
+
+    struct {
+        size_t pending;
+    } atomic;
+} rollup_globals = { 0 };
+
+void dbengine_rollup_init(void) {
+    for(size_t i = 0; i < DBENGINE_ROLLUP_SHARDS ; i++) {
+        spinlock_init(&rollup_globals.shards[i].spinlock);
+        rollup_globals.shards[i].base = NULL;
+    }
+}
+
+static inline struct rollup_shard *rollup_shard_of(struct rrdeng_collect_handle *handle) {
+    return &rollup_globals.shards[((uintptr_t)handle->metric >> 6) % DBENGINE_ROLLUP_SHARDS];
+}
+
+// ----------------------------------------------------------------------------
+
+static void rollup_job_execute(struct rollup_job *j) {
+    PGD *pgd = pgc_page_data(j->page);
+    uint32_t entries = pgd_slots_used(pgd);
+    time_t update_every_s = (time_t)pgc_page_update_every_s(j->page);
+
+    // the first point of a page ends at the start time of the page
+    time_t now_s = pgc_page_start_time_s(j->page);
+
+    STORAGE_POINT sp[DBENGINE_ROLLUP_BATCH];
+
+    PGDC cursor;
+    pgdc_reset(&cursor, pgd, 0);
+
+    for(uint32_t position = 0; position < entries && update_every_s ; ) {
+        size_t n = MIN(DBENGINE_ROLLUP_BATCH, entries - position);
+
+        for(size_t i = 0; i < n ; i++, now_s += update_every_s) {
+            sp[i].start_time_s = now_s - update_every_s;
+            sp[i].end_time_s = now_s;
+        }
+
+        size_t decoded = pgdc_get_next_points(&cursor, position, sp, n);
+        for(size_t i = decoded; i < n ; i++)
+            storage_point_empty(sp[i], sp[i].start_time_s, sp[i].end_time_s);
+
+        j->handle->rollup_cb(j->handle->rollup_data, sp, n);
+        position += n;
+    }
+
+    pgc_page_release(main_cache, j->page);
+
+    __atomic_sub_fetch(&rollup_globals.atomic.pending, 1, __ATOMIC_RELAXED);
+    __atomic_sub_fetch(&j->handle->rollup_pending, 1, __ATOMIC_RELEASE);
+    freez(j);
+}
+
+// returns false when another thread is draining the shard
+static bool rollup_shard_drain(struct rollup_shard *shard, bool dispatched) {
+    spinlock_lock(&shard->spinlock);
+
+    if(dispatched)
+        shard->dispatched = false;
+
+    if(shard->running) {
+        spinlock_unlock(&shard->spinlock);
+        return false;
+    }
+
+    shard->running = true;
+
+    struct rollup_job *j;
+    while((j = shard->base)) {
+        DOUBLE_LINKED_LIST_REMOVE_ITEM_UNSAFE(shard->base, j, prev, next);
+        spinlock_unlock(&shard->spinlock);
+
+        rollup_job_execute(j);
+
+        spinlock_lock(&shard->spinlock);
+    }
+
+    shard->running = false;
+    spinlock_unlock(&shard->spinlock);
+
+    return true;
+}
+
+void dbengine_rollup_drain(void *shard) {
+    rollup_shard_drain(shard, true);
+}
+
+// ----------------------------------------------------------------------------
+
+void dbengine_rollup_queue_page(struct rrdeng_collect_handle *handle, PGC_PAGE *page) {
+    struct rollup_job *j = mallocz(sizeof(*j));
+    j->handle = handle;
+    j->page = pgc_page_dup(main_cache, page);
+    j->prev = j->next = NULL;
+
+    __atomic_add_fetch(&handle->rollup_pending, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&rollup_globals.atomic.pending, 1, __ATOMIC_RELAXED);
+
+    struct rollup_shard *shard = rollup_shard_of(handle);
+
+    spinlock_lock(&shard->spinlock);
+    DOUBLE_LINKED_LIST_APPEND_ITEM_UNSAFE(shard->base, j, prev, next);
+    bool dispatch = !shard->dispatched && !shard->running;
+    if(dispatch)
+        shard->dispatched = true;
+    spinlock_unlock(&shard->spinlock);
+
+    // the thread draining the shard will also execute this job
+    if(dispatch)
+        rrdeng_enq_cmd(NULL, RRDENG_OPCODE_TIER_ROLLUP, shard, NULL, STORAGE_PRIORITY_INTERNAL_DBENGINE, NULL, NULL);
+}
+
+// wait until all the pages of a handle have been rolled up
+// the caller helps draining the shard, so that this works even when the
+// dbengine event loop is not dispatching work anymore
+void dbengine_rollup_wait(struct rrdeng_collect_handle *handle) {
+    struct rollup_shard *shard = rollup_shard_of(handle);
+
+    while(__atomic_load_n(&handle->rollup_pending, __ATOMIC_ACQUIRE)) {
+        if(!rollup_shard_drain(shard, false))
+            yield_the_processor();
+    }
+}
+
+size_t dbengine_rollup_pages_pending(void) {
+    return __atomic_load_n(&rollup_globals.atomic.pending, __ATOMIC_RELAXED);
+}
@@ -0,0 +1,31 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef NETDATA_DBENGINE_ROLLUP_H
+#define NETDATA_DBENGINE_ROLLUP_H
+
+// asynchronous tier rollup
+// When a collection handle has a rollup callback, every tier 0 page it completes
+// is queued here instead of the higher tiers being updated point by point by the
+// collector. The libuv workers decode the queued pages and give their points to
+// the callback, which aggregates them into the higher tiers.
+//
+// Pages are queued to a shard by metric, and each shard is drained by one worker
+// at a time, so the pages of a metric are always rolled up in order.
+
+#define DBENGINE_ROLLUP_SHARDS 8
+#define DBENGINE_ROLLUP_BATCH 256
+
+struct rrdeng_collect_handle;
+struct pgc_page;
+
+void dbengine_rollup_init(void);
+
+void dbengine_rollup_queue_page(struct rrdeng_collect_handle *handle, struct pgc_page *page);
+void dbengine_rollup_wait(struct rrdeng_collect_handle *handle);
+
+// run by the libuv workers
+void dbengine_rollup_drain(void *shard);
+
+size_t dbengine_rollup_pages_pending(void);
+
+#endif //NETDATA_DBENGINE_ROLLUP_H
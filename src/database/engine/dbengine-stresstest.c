@@ -60,6 +60,7 @@ struct dbengine_chart_thread {
     volatile long done; /* initialize to 0, set to 1 to stop thread */
     struct completion charts_initialized;
     unsigned long errors, stored_metrics_nr; /* statistics */
+    usec_t collection_cpu_ut; /* CPU time spent by the thread to collect the metrics */
 
     RRDSET *st;
     RRDDIM *rd[]; /* dset_dims elements */
@@ -124,6 +125,14 @@ static void generate_dbengine_chart(void *arg)
         rrdset_done(st);
         thread_info->time_max = time_current;
     }
+
+    // measured before the finalization, which waits for the pending rollups
+    struct rusage ru;
+    getrusage(RUSAGE_THREAD, &ru);
+    thread_info->collection_cpu_ut =
+        ru.ru_utime.tv_sec * USEC_PER_SEC + ru.ru_utime.tv_usec +
+        ru.ru_stime.tv_sec * USEC_PER_SEC + ru.ru_stime.tv_usec;
+
     for (j = 0; j < DSET_DIMS; ++j) {
         rrdeng_store_metric_finalize((rd[j])->tiers[0].sch);
     }
@@ -245,7 +254,7 @@ static void query_dbengine_chart(void *arg)
             time_before = MIN(time_after + duration, time_max); /* up to 1 hour queries */
         }
 
-        storage_engine_query_init(rd->tiers[0].seb, rd->tiers[0].smh, &seqh, time_after, time_before, STORAGE_PRIORITY_NORMAL);
+        storage_engine_query_init(rd->tiers[0].seb, rd->tiers[0].smh, &seqh, time_after, time_before, STORAGE_PRIORITY_NORMAL, QUERY_SOURCE_UNITTEST);
         ++thread_info->queries_nr;
         for (time_now = time_after ; time_now <= time_before ; time_now += update_every) {
             generatedv = generate_dbengine_chart_value(i, j, time_now);
@@ -310,7 +319,8 @@ static void query_dbengine_chart(void *arg)
 }
 
 void dbengine_stress_test(unsigned TEST_DURATION_SEC, unsigned DSET_CHARTS, unsigned QUERY_THREADS,
-                          unsigned RAMP_UP_SECONDS, unsigned PAGE_CACHE_MB, unsigned DISK_SPACE_MB)
+                          unsigned RAMP_UP_SECONDS, unsigned PAGE_CACHE_MB, unsigned DISK_SPACE_MB,
+                          bool ASYNC_TIER_ROLLUP)
 {
     fprintf(stderr, "%s() running...\n", __FUNCTION__ );
     const unsigned DSET_DIMS = 128;
@@ -335,6 +345,7 @@ void dbengine_stress_test(unsigned TEST_DURATION_SEC, unsigned DSET_CHARTS, unsi
 
     default_rrd_memory_mode = RRD_DB_MODE_DBENGINE;
     default_rrdeng_page_cache_mb = PAGE_CACHE_MB;
+    dbengine_async_tier_rollup = ASYNC_TIER_ROLLUP;
     if (DISK_SPACE_MB) {
         fprintf(stderr, "By setting disk space limit data are allowed to be deleted. "
                         "Data validation is turned off for this run.\n");
@@ -378,6 +389,7 @@ void dbengine_stress_test(unsigned TEST_DURATION_SEC, unsigned DSET_CHARTS, unsi
         chart_threads[i]->time_max = 0;
         chart_threads[i]->done = 0;
         chart_threads[i]->errors = chart_threads[i]->stored_metrics_nr = 0;
+        chart_threads[i]->collection_cpu_ut = 0;
         completion_init(&chart_threads[i]->charts_initialized);
         fatal_assert(0 == uv_thread_create(&chart_threads[i]->thread, generate_dbengine_chart, chart_threads[i]));
     }
@@ -422,8 +434,10 @@ void dbengine_stress_test(unsigned TEST_DURATION_SEC, unsigned DSET_CHARTS, unsi
         test_duration = 1;
     fprintf(stderr, "\nDB-engine stress test finished in %lld seconds.\n", (long long)test_duration);
     unsigned long stored_metrics_nr = 0;
+    usec_t collection_cpu_ut = 0;
     for (i = 0 ; i < DSET_CHARTS ; ++i) {
         stored_metrics_nr += chart_threads[i]->stored_metrics_nr;
+        collection_cpu_ut += chart_threads[i]->collection_cpu_ut;
     }
     unsigned long queried_metrics_nr = 0;
     for (i = 0 ; i < QUERY_THREADS ; ++i) {
@@ -437,6 +451,12 @@ void dbengine_stress_test(unsigned TEST_DURATION_SEC, unsigned DSET_CHARTS, unsi
                     "the latest data point, and ending time from 1 second up to 1 hour after the starting time.\n");
     fprintf(stderr, "Performance is %lld written data points/sec and %lld read data points/sec.\n",
             (long long)(stored_metrics_nr / test_duration), (long long)(queried_metrics_nr / test_duration));
+    fprintf(stderr, "Writer threads used %.2f CPU seconds, %.3f CPU usec per data point, storing %zu tiers,\n"
+                    "with the higher tiers rolled up %s.\n",
+            (double)collection_cpu_ut / USEC_PER_SEC,
+            stored_metrics_nr ? (double)collection_cpu_ut / (double)stored_metrics_nr : 0.0,
+            nd_profile.storage_tiers,
+            ASYNC_TIER_ROLLUP ? "asynchronously by the dbengine workers" : "inline by the writers");
 
     for (i = 0 ; i < DSET_CHARTS ; ++i) {
         freez(chart_threads[i]);
@@ -239,7 +239,8 @@ static size_t test_dbengine_check_metrics(
                                       &handles[c * DIMS + d],
                                       time_start,
                                       time_end,
-                                      STORAGE_PRIORITY_NORMAL);
+                                      STORAGE_PRIORITY_NORMAL,
+                                      QUERY_SOURCE_UNITTEST);
         }
     }
 
@@ -0,0 +1,509 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "rrdengine.h"
+#include "dbengine-uring.h"
+
+#if defined(OS_LINUX) && defined(HAVE_LINUX_IO_URING_H)
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <sys/mman.h>
+
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter) && defined(__NR_io_uring_register)
+#define DBENGINE_URING_SUPPORTED 1
+#endif
+#endif
+
+#ifdef DBENGINE_URING_SUPPORTED
+
+// each ring has its own registered buffers, one per entry
+// extents larger than this are read into a buffer allocated for them
+#define DBENGINE_URING_BUFFER_SIZE (64 * 1024)
+
+// rings are created on demand and reused, up to this number
+#define DBENGINE_URING_MAX_RINGS 16
+
+// io_uring_enter() calls that make no progress, before giving up on a ring
+#define DBENGINE_URING_MAX_RETRIES 10
+
+struct dbengine_uring_slot {
+    struct iovec iov;
+    bool allocated;                 // the buffer has been allocated for this read (not registered)
+    bool abandoned;                 // failed while the kernel may still be reading into the buffer
+    bool done;
+    int32_t res;
+};
+
+struct dbengine_uring {
+    int fd;
+    bool fixed_buffers;             // the buffers have been registered to the kernel
+    bool broken;                    // a submission failed, destroy the ring instead of reusing it
+
+    struct {
+        unsigned *head;
+        unsigned *tail;
+        unsigned *mask;
+        unsigned *array;
+        struct io_uring_sqe *sqes;
+        void *ptr;
+        size_t size;
+        size_t sqes_size;
+    } sq;
+
+    struct {
+        unsigned *head;
+        unsigned *tail;
+        unsigned *mask;
+        struct io_uring_cqe *cqes;
+        void *ptr;
+        size_t size;
+    } cq;
+
+    uint8_t *buffers;
+
+    // the state of the current batch
+    netdata_mutex_t mutex;          // serializes the waiters reaping completions
+    int32_t refcount;
+    uint8_t prepared;
+    uint8_t submitted;
+    usec_t submitted_ut;
+    struct dbengine_uring_slot slots[DBENGINE_URING_ENTRIES];
+
+    struct dbengine_uring *next;
+};
+
+static struct {
+    SPINLOCK spinlock;
+    DBENGINE_URING *available;
+    size_t rings;
+    bool disabled;
+} dbengine_uring_globals = {
+    .spinlock = SPINLOCK_INITIALIZER,
+    .available = NULL,
+    .rings = 0,
+    .disabled = false,
+};
+
+static inline int io_uring_setup(unsigned entries, struct io_uring_params *p) {
+    return (int)syscall(__NR_io_uring_setup, entries, p);
+}
+
+static inline int io_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+    return (int)syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, NULL, 0);
+}
+
+static inline int io_uring_register(int fd, unsigned opcode, void *arg, unsigned nr_args) {
+    return (int)syscall(__NR_io_uring_register, fd, opcode, arg, nr_args);
+}
+
+static void dbengine_uring_destroy(DBENGINE_URING *ur) {
+    if(ur->buffers)
+        munmap(ur->buffers, (size_t)DBENGINE_URING_ENTRIES * DBENGINE_URING_BUFFER_SIZE);
+
+    if(ur->sq.sqes)
+        munmap(ur->sq.sqes, ur->sq.sqes_size);
+
+    if(ur->cq.ptr && ur->cq.ptr != ur->sq.ptr)
+        munmap(ur->cq.ptr, ur->cq.size);
+
+    if(ur->sq.ptr)
+        munmap(ur->sq.ptr, ur->sq.size);
+
+    if(ur->fd != -1) {
+        close(ur->fd);
+        netdata_mutex_destroy(&ur->mutex);
+    }
+
+    freez(ur);
+}
+
+static DBENGINE_URING *dbengine_uring_create(void) {
+    DBENGINE_URING *ur = callocz(1, sizeof(DBENGINE_URING));
+
+    struct io_uring_params p = { 0 };
+    ur->fd = io_uring_setup(DBENGINE_URING_ENTRIES, &p);
+    if(ur->fd < 0) {
+        nd_log(NDLS_DAEMON, NDLP_NOTICE,
+               "DBENGINE: io_uring is not available (error %d), extents will be read synchronously", errno);
+        ur->fd = -1;
+        goto failed;
+    }
+    netdata_mutex_init(&ur->mutex);
+
+    ur->sq.size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    ur->cq.size = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+
+    if(p.features & IORING_FEAT_SINGLE_MMAP) {
+        if(ur->cq.size > ur->sq.size)
+            ur->sq.size = ur->cq.size;
+        ur->cq.size = ur->sq.size;
+    }
+
+    ur->sq.ptr = mmap(NULL, ur->sq.size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ur->fd, IORING_OFF_SQ_RING);
+    if(ur->sq.ptr == MAP_FAILED) {
+        ur->sq.ptr = NULL;
+        goto failed;
+    }
+
+    if(p.features & IORING_FEAT_SINGLE_MMAP)
+        ur->cq.ptr = ur->sq.ptr;
+    else {
+        ur->cq.ptr = mmap(NULL, ur->cq.size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ur->fd, IORING_OFF_CQ_RING);
+        if(ur->cq.ptr == MAP_FAILED) {
+            ur->cq.ptr = NULL;
+            goto failed;
+        }
+    }
+
+    ur->sq.sqes_size = p.sq_entries * sizeof(struct io_uring_sqe);
+    ur->sq.sqes = mmap(NULL, ur->sq.sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ur->fd, IORING_OFF_SQES);
+    if(ur->sq.sqes == MAP_FAILED) {
+        ur->sq.sqes = NULL;
+        goto failed;
+    }
+
+    ur->sq.head  = (unsigned *)((uint8_t *)ur->sq.ptr + p.sq_off.head);
+    ur->sq.tail  = (unsigned *)((uint8_t *)ur->sq.ptr + p.sq_off.tail);
+    ur->sq.mask  = (unsigned *)((uint8_t *)ur->sq.ptr + p.sq_off.ring_mask);
+    ur->sq.array = (unsigned *)((uint8_t *)ur->sq.ptr + p.sq_off.array);
+
+    ur->cq.head  = (unsigned *)((uint8_t *)ur->cq.ptr + p.cq_off.head);
+    ur->cq.tail  = (unsigned *)((uint8_t *)ur->cq.ptr + p.cq_off.tail);
+    ur->cq.mask  = (unsigned *)((uint8_t *)ur->cq.ptr + p.cq_off.ring_mask);
+    ur->cq.cqes  = (struct io_uring_cqe *)((uint8_t *)ur->cq.ptr + p.cq_off.cqes);
+
+    // page aligned buffers, suitable for direct I/O
+    ur->buffers = mmap(NULL, (size_t)DBENGINE_URING_ENTRIES * DBENGINE_URING_BUFFER_SIZE,
+                       PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(ur->buffers == MAP_FAILED) {
+        ur->buffers = NULL;
+        goto failed;
+    }
+
+    struct iovec iov[DBENGINE_URING_ENTRIES];
+    for(size_t i = 0; i < DBENGINE_URING_ENTRIES ; i++) {
+        iov[i].iov_base = ur->buffers + i * DBENGINE_URING_BUFFER_SIZE;
+        iov[i].iov_len = DBENGINE_URING_BUFFER_SIZE;
+    }
+
+    // registering the buffers may fail due to RLIMIT_MEMLOCK
+    // in this case we use them as normal buffers
+    ur->fixed_buffers = io_uring_register(ur->fd, IORING_REGISTER_BUFFERS, iov, DBENGINE_URING_ENTRIES) == 0;
+
+    return ur;
+
+failed:
+    dbengine_uring_destroy(ur);
+    return NULL;
+}
+
+bool dbengine_uring_available(void) {
+    return dbengine_use_io_uring && !__atomic_load_n(&dbengine_uring_globals.disabled, __ATOMIC_RELAXED);
+}
+
+DBENGINE_URING *dbengine_uring_batch_get(void) {
+    if(!dbengine_uring_available())
+        return NULL;
+
+    DBENGINE_URING *ur = NULL;
+    bool create = false;
+
+    spinlock_lock(&dbengine_uring_globals.spinlock);
+    if(dbengine_uring_globals.available) {
+        ur = dbengine_uring_globals.available;
+        dbengine_uring_globals.available = ur->next;
+    }
+    else if(dbengine_uring_globals.rings < DBENGINE_URING_MAX_RINGS) {
+        dbengine_uring_globals.rings++;
+        create = true;
+    }
+    spinlock_unlock(&dbengine_uring_globals.spinlock);
+
+    if(create) {
+        ur = dbengine_uring_create();
+        if(!ur) {
+            spinlock_lock(&dbengine_uring_globals.spinlock);
+            dbengine_uring_globals.rings--;
+            if(!dbengine_uring_globals.rings)
+                // the kernel does not give us any ring, stop trying
+                __atomic_store_n(&dbengine_uring_globals.disabled, true, __ATOMIC_RELAXED);
+            spinlock_unlock(&dbengine_uring_globals.spinlock);
+        }
+    }
+
+    if(!ur)
+        return NULL;
+
+    ur->next = NULL;
+    ur->refcount = 1;
+    ur->prepared = 0;
+    ur->submitted = 0;
+    memset(ur->slots, 0, sizeof(ur->slots));
+
+    return ur;
+}
+
+static void dbengine_uring_batch_put(DBENGINE_URING *ur) {
+    if(unlikely(ur->broken)) {
+        dbengine_uring_destroy(ur);
+
+        spinlock_lock(&dbengine_uring_globals.spinlock);
+        dbengine_uring_globals.rings--;
+        spinlock_unlock(&dbengine_uring_globals.spinlock);
+        return;
+    }
+
+    spinlock_lock(&dbengine_uring_globals.spinlock);
+    ur->next = dbengine_uring_globals.available;
+    dbengine_uring_globals.available = ur;
+    spinlock_unlock(&dbengine_uring_globals.spinlock);
+}
+
+static void dbengine_uring_release(DBENGINE_URING *ur) {
+    if(__atomic_sub_fetch(&ur->refcount, 1, __ATOMIC_ACQ_REL) == 0)
+        dbengine_uring_batch_put(ur);
+}
+
+uint8_t dbengine_uring_batch_add(DBENGINE_URING *ur, int fd, uint64_t pos, uint32_t size) {
+    if(ur->prepared >= DBENGINE_URING_ENTRIES || ur->submitted)
+        return DBENGINE_URING_NO_SLOT;
+
+    uint8_t slot = ur->prepared;
+    struct dbengine_uring_slot *s = &ur->slots[slot];
+
+    unsigned real_io_size = ALIGN_BYTES_CEILING(size);
+
+    struct io_uring_sqe *sqe = &ur->sq.sqes[slot];
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->fd = fd;
+    sqe->off = pos;
+    sqe->user_data = slot;
+
+    if(real_io_size <= DBENGINE_URING_BUFFER_SIZE) {
+        s->iov.iov_base = ur->buffers + (size_t)slot * DBENGINE_URING_BUFFER_SIZE;
+        s->iov.iov_len = real_io_size;
+        s->allocated = false;
+    }
+    else {
+        void *buffer = NULL;
+        (void)posix_memalignz(&buffer, RRDFILE_ALIGNMENT, real_io_size);
+        s->iov.iov_base = buffer;
+        s->iov.iov_len = real_io_size;
+        s->allocated = true;
+    }
+
+    if(ur->fixed_buffers && !s->allocated) {
+        sqe->opcode = IORING_OP_READ_FIXED;
+        sqe->addr = (uint64_t)(uintptr_t)s->iov.iov_base;
+        sqe->len = (uint32_t)s->iov.iov_len;
+        sqe->buf_index = slot;
+    }
+    else {
+        sqe->opcode = IORING_OP_READV;
+        sqe->addr = (uint64_t)(uintptr_t)&s->iov;
+        sqe->len = 1;
+    }
+
+    ur->prepared++;
+    __atomic_add_fetch(&ur->refcount, 1, __ATOMIC_RELAXED);
+
+    return slot;
+}
+
+static void dbengine_uring_fail_slots(DBENGINE_URING *ur, uint8_t from, int error) {
+    for(uint8_t i = from; i < ur->prepared ; i++) {
+        ur->slots[i].res = error;
+        __atomic_store_n(&ur->slots[i].done, true, __ATOMIC_RELEASE);
+    }
+}
+
+void dbengine_uring_batch_submit(DBENGINE_URING *ur) {
+    if(ur->prepared) {
+        unsigned tail = *ur->sq.tail;
+        unsigned mask = *ur->sq.mask;
+
+        for(uint8_t i = 0; i < ur->prepared ; i++)
+            ur->sq.array[(tail + i) & mask] = i;
+
+        __atomic_store_n(ur->sq.tail, tail + ur->prepared, __ATOMIC_RELEASE);
+
+        ur->submitted_ut = now_monotonic_usec();
+
+        uint8_t submitted = 0;
+        size_t retries = 0;
+        while(submitted < ur->prepared) {
+            int rc = io_uring_enter(ur->fd, ur->prepared - submitted, 0, 0);
+            if(rc > 0) {
+                submitted += (uint8_t)rc;
+                continue;
+            }
+
+            int error = (rc == 0) ? EAGAIN : errno;
+            if(error == EINTR)
+                continue;
+
+            // every call that does not submit anything counts as a retry
+            if((error == EAGAIN || error == EBUSY) && ++retries < DBENGINE_URING_MAX_RETRIES)
+                tinysleep();
+            else {
+                nd_log_limit_static_global_var(erl, 60, 0);
+                nd_log_limit(&erl, NDLS_DAEMON, NDLP_ERR,
+                             "DBENGINE: io_uring submission failed (error %d), reading %u extents synchronously",
+                             error, (unsigned)(ur->prepared - submitted));
+
+                // the sqes that were not consumed are still in the ring, so it cannot be reused
+                ur->broken = true;
+                dbengine_uring_fail_slots(ur, submitted, -EIO);
+                break;
+            }
+        }
+
+        ur->submitted = submitted;
+
+        __atomic_add_fetch(&rrdeng_cache_efficiency_stats.extent_reads_uring_batches, 1, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&rrdeng_cache_efficiency_stats.extent_reads_uring_submitted, submitted, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&rrdeng_cache_efficiency_stats.extent_reads_uring_in_flight, submitted, __ATOMIC_RELAXED);
+    }
+
+    dbengine_uring_release(ur);
+}
+
+// must be called with the mutex held
+static void dbengine_uring_reap(DBENGINE_URING *ur) {
+    unsigned head = *ur->cq.head;
+    unsigned tail = __atomic_load_n(ur->cq.tail, __ATOMIC_ACQUIRE);
+    unsigned mask = *ur->cq.mask;
+
+    if(head == tail)
+        return;
+
+    usec_t latency_ut = now_monotonic_usec() - ur->submitted_ut;
+
+    size_t completed = 0;
+    for(; head != tail ; head++) {
+        struct io_uring_cqe *cqe = &ur->cq.cqes[head & mask];
+        uint64_t slot = cqe->user_data;
+
+        if(likely(slot < DBENGINE_URING_ENTRIES)) {
+            ur->slots[slot].res = cqe->res;
+            __atomic_store_n(&ur->slots[slot].done, true, __ATOMIC_RELEASE);
+            time_and_count_add(&rrdeng_cache_efficiency_stats.extent_reads_uring_latency, latency_ut);
+            completed++;
+        }
+    }
+
+    __atomic_store_n(ur->cq.head, head, __ATOMIC_RELEASE);
+    __atomic_sub_fetch(&rrdeng_cache_efficiency_stats.extent_reads_uring_in_flight, completed, __ATOMIC_RELAXED);
+}
+
+// must be called with the mutex held
+// fails all the reads that have not completed, so that their waiters read synchronously
+static void dbengine_uring_abandon_slots(DBENGINE_URING *ur) {
+    for(uint8_t i = 0; i < ur->prepared ; i++) {
+        if(__atomic_load_n(&ur->slots[i].done, __ATOMIC_ACQUIRE))
+            continue;
+
+        ur->slots[i].res = -EIO;
+        ur->slots[i].abandoned = true;
+        __atomic_store_n(&ur->slots[i].done, true, __ATOMIC_RELEASE);
+    }
+}
+
+static void dbengine_uring_slot_wait_completion(DBENGINE_URING *ur, uint8_t slot) {
+    if(__atomic_load_n(&ur->slots[slot].done, __ATOMIC_ACQUIRE))
+        return;
+
+    size_t retries = 0;
+
+    netdata_mutex_lock(&ur->mutex);
+    while(!__atomic_load_n(&ur->slots[slot].done, __ATOMIC_ACQUIRE)) {
+        dbengine_uring_reap(ur);
+
+        if(__atomic_load_n(&ur->slots[slot].done, __ATOMIC_ACQUIRE))
+            break;
+
+        int rc = io_uring_enter(ur->fd, 0, 1, IORING_ENTER_GETEVENTS);
+        if(rc >= 0 || errno == EINTR)
+            continue;
+
+        if((errno == EAGAIN || errno == EBUSY) && ++retries < DBENGINE_URING_MAX_RETRIES) {
+            tinysleep();
+            continue;
+        }
+
+        // we cannot wait for completions anymore - fail all pending reads of the batch,
+        // instead of keeping the other queries waiting on the mutex
+        ur->broken = true;
+        nd_log_limit_static_global_var(erl, 60, 0);
+        nd_log_limit(&erl, NDLS_DAEMON, NDLP_ERR,
+                     "DBENGINE: io_uring failed to wait for completions (error %d), reading the extents synchronously",
+                     errno);
+
+        dbengine_uring_abandon_slots(ur);
+    }
+    netdata_mutex_unlock(&ur->mutex);
+}
+
+void *dbengine_uring_slot_wait(DBENGINE_URING *ur, uint8_t slot, uint32_t size) {
+    if(slot >= ur->prepared)
+        return NULL;
+
+    dbengine_uring_slot_wait_completion(ur, slot);
+
+    struct dbengine_uring_slot *s = &ur->slots[slot];
+    if(s->res < 0 || (uint32_t)s->res < size) {
+        __atomic_add_fetch(&rrdeng_cache_efficiency_stats.extent_reads_uring_failed, 1, __ATOMIC_RELAXED);
+        return NULL;
+    }
+
+    return s->iov.iov_base;
+}
+
+void dbengine_uring_slot_release(DBENGINE_URING *ur, uint8_t slot) {
+    if(slot >= ur->prepared)
+        return;
+
+    // the kernel must not be writing to the buffer when we free it or reuse the ring
+    dbengine_uring_slot_wait_completion(ur, slot);
+
+    struct dbengine_uring_slot *s = &ur->slots[slot];
+    if(s->allocated && s->abandoned) {
+        // the kernel may still write to it, so it is leaked
+        s->iov.iov_base = NULL;
+        s->allocated = false;
+    }
+    else if(s->allocated) {
+        posix_memalign_freez(s->iov.iov_base);
+        s->iov.iov_base = NULL;
+        s->allocated = false;
+    }
+
+    dbengine_uring_release(ur);
+}
+
+#else // !DBENGINE_URING_SUPPORTED
+
+bool dbengine_uring_available(void) {
+    return false;
+}
+
+DBENGINE_URING *dbengine_uring_batch_get(void) {
+    return NULL;
+}
+
+uint8_t dbengine_uring_batch_add(DBENGINE_URING *ur __maybe_unused, int fd __maybe_unused, uint64_t pos __maybe_unused, uint32_t size __maybe_unused) {
+    return DBENGINE_URING_NO_SLOT;
+}
+
+void dbengine_uring_batch_submit(DBENGINE_URING *ur __maybe_unused) {
+    ;
+}
+
+void *dbengine_uring_slot_wait(DBENGINE_URING *ur __maybe_unused, uint8_t slot __maybe_unused, uint32_t size __maybe_unused) {
+    return NULL;
+}
+
+void dbengine_uring_slot_release(DBENGINE_URING *ur __maybe_unused, uint8_t slot __maybe_unused) {
+    ;
+}
+
+#endif // DBENGINE_URING_SUPPORTED
@@ -0,0 +1,29 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef NETDATA_DBENGINE_URING_H
+#define NETDATA_DBENGINE_URING_H
+
+// io_uring extent reads
+// All the extents a query needs from disk are submitted to the kernel as a single
+// batch, before the extents are routed to the workers. Each worker then waits only
+// for the completion of its own extent, so the number of reads in flight is not
+// limited by the number of libuv workers.
+//
+// When io_uring is not available (old kernels, seccomp, disabled by configuration)
+// dbengine_uring_batch_get() returns NULL and extents are read synchronously.
+
+typedef struct dbengine_uring DBENGINE_URING;
+
+#define DBENGINE_URING_ENTRIES 32
+#define DBENGINE_URING_NO_SLOT UINT8_MAX
+
+bool dbengine_uring_available(void);
+
+DBENGINE_URING *dbengine_uring_batch_get(void);
+uint8_t dbengine_uring_batch_add(DBENGINE_URING *ur, int fd, uint64_t pos, uint32_t size);
+void dbengine_uring_batch_submit(DBENGINE_URING *ur);
+
+void *dbengine_uring_slot_wait(DBENGINE_URING *ur, uint8_t slot, uint32_t size);
+void dbengine_uring_slot_release(DBENGINE_URING *ur, uint8_t slot);
+
+#endif //NETDATA_DBENGINE_URING_H
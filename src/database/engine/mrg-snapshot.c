@@ -0,0 +1,438 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "mrg-internals.h"
+#include "rrdengine.h"
+
+// The MRG snapshot of a tier.
+//
+// At clean shutdown (and periodically) the retention of all the metrics of a tier
+// is written to <dbfiles path>/mrg-snapshot.ndm, together with the datafiles of
+// the tier and the size and last time of their journal v2 files.
+//
+// At startup, when all the datafiles recorded still exist, the snapshot is mmapped
+// and loaded to the MRG in parallel, and the datafiles that have the same journal v2
+// are marked as populated, so that the MRG is ready without reading their journals.
+// The journals of these datafiles are then reconciled lazily in the background.
+//
+// Anything not matching (rotation happened, journals were rebuilt, the tier was
+// reconfigured, the file is corrupted) makes the snapshot to be ignored.
+
+time_t dbengine_mrg_snapshot_every_s = 3600;    // 0 disables periodic snapshots
+
+#define MRG_SNAPSHOT_MAGIC      0x4d524753  // MRGS
+#define MRG_SNAPSHOT_VERSION    1
+
+struct mrg_snapshot_header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t tier;
+    uint32_t datafiles;
+    uint64_t metrics;
+    int64_t first_time_s;
+    uint64_t created_ut;
+    uint32_t body_crc;
+    uint32_t header_crc;                // the crc of the header up to this field
+};
+
+struct mrg_snapshot_datafile {
+    uint32_t fileno;
+    uint32_t journal_v2_size;           // 0 when the datafile was not indexed yet
+    int64_t journal_v2_last_time_s;
+};
+
+struct mrg_snapshot_metric {
+    nd_uuid_t uuid;
+    int64_t first_time_s;
+    int64_t last_time_s;
+    uint32_t update_every_s;
+    uint32_t reserved;
+};
+
+static void mrg_snapshot_filename(struct rrdengine_instance *ctx, char *dst, size_t size, bool tmp) {
+    snprintfz(dst, size, "%s/" MRG_SNAPSHOT_FILENAME "%s", ctx->config.dbfiles_path, tmp ? ".tmp" : "");
+}
+
+static bool mrg_snapshot_journal_v2(struct rrdengine_datafile *df, uint32_t *size, int64_t *last_time_s) {
+    struct rrdengine_journalfile *journalfile = df->journalfile;
+    *size = 0;
+    *last_time_s = 0;
+
+    if(!journalfile)
+        return false;
+
+    spinlock_lock(&journalfile->data_spinlock);
+    if(journalfile->v2.flags & JOURNALFILE_FLAG_IS_AVAILABLE) {
+        *size = journalfile->mmap.size;
+        *last_time_s = journalfile->v2.last_time_s;
+    }
+    spinlock_unlock(&journalfile->data_spinlock);
+
+    return *size != 0;
+}
+
+// ----------------------------------------------------------------------------
+// save
+
+static bool mrg_snapshot_write(int fd, const void *data, size_t size, uint32_t *crc) {
+    const uint8_t *p = data;
+    size_t remaining = size;
+
+    while(remaining) {
+        ssize_t rc = write(fd, p, remaining);
+        if(rc < 0) {
+            if(errno == EINTR)
+                continue;
+            return false;
+        }
+        p += rc;
+        remaining -= rc;
+    }
+
+    if(crc)
+        *crc = crc32(*crc, data, size);
+
+    return true;
+}
+
+bool mrg_snapshot_save(MRG *mrg, struct rrdengine_instance *ctx) {
+    if(!__atomic_load_n(&ctx->loading.mrg_populated, __ATOMIC_ACQUIRE))
+        // the MRG does not have the full retention of this tier yet
+        return false;
+
+    usec_t started_ut = now_monotonic_usec();
+
+    // the datafiles, before the metrics, so that the metrics cover them
+    BUFFER *datafiles = buffer_create(1024, NULL);
+    uv_rwlock_rdlock(&ctx->datafiles.rwlock);
+    for(struct rrdengine_datafile *df = get_next_datafile(NULL, ctx, true); df ; df = get_next_datafile(df, ctx, true)) {
+        struct mrg_snapshot_datafile sd = { .fileno = df->fileno };
+        mrg_snapshot_journal_v2(df, &sd.journal_v2_size, &sd.journal_v2_last_time_s);
+        buffer_memcat(datafiles, &sd, sizeof(sd));
+    }
+    uv_rwlock_rdunlock(&ctx->datafiles.rwlock);
+
+    struct mrg_snapshot_header hdr = {
+        .magic = MRG_SNAPSHOT_MAGIC,
+        .version = MRG_SNAPSHOT_VERSION,
+        .tier = ctx->config.tier,
+        .datafiles = buffer_strlen(datafiles) / sizeof(struct mrg_snapshot_datafile),
+        .first_time_s = __atomic_load_n(&ctx->atomic.first_time_s, __ATOMIC_RELAXED),
+        .created_ut = now_realtime_usec(),
+    };
+
+    if(!hdr.datafiles) {
+        buffer_free(datafiles);
+        return false;
+    }
+
+    char path_tmp[FILENAME_MAX + 1], path[FILENAME_MAX + 1];
+    mrg_snapshot_filename(ctx, path_tmp, sizeof(path_tmp), true);
+    mrg_snapshot_filename(ctx, path, sizeof(path), false);
+
+    int fd = open(path_tmp, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0664);
+    if(fd == -1) {
+        nd_log_daemon(NDLP_ERR, "DBENGINE: cannot create MRG snapshot file '%s'", path_tmp);
+        buffer_free(datafiles);
+        return false;
+    }
+
+    // the header is written last, when the counters and the crc are known
+    bool ok = lseek(fd, sizeof(hdr), SEEK_SET) == (off_t)sizeof(hdr);
+
+    uint32_t crc = crc32(0L, Z_NULL, 0);
+    ok = ok && mrg_snapshot_write(fd, buffer_tostring(datafiles), buffer_strlen(datafiles), &crc);
+    buffer_free(datafiles);
+
+    // collect the metrics of each partition under its read lock, and write them without it
+    BUFFER *wb = buffer_create(1024 * 1024, NULL);
+    for(size_t partition = 0; ok && partition < UUIDMAP_PARTITIONS ; partition++) {
+        buffer_flush(wb);
+
+        mrg_index_read_lock(mrg, partition);
+
+        Word_t uuid_index = 0;
+        for(Pvoid_t *uuid_pvalue = JudyLFirst(mrg->index[partition].uuid_judy, &uuid_index, PJE0);
+             uuid_pvalue != NULL && uuid_pvalue != PJERR;
+             uuid_pvalue = JudyLNext(mrg->index[partition].uuid_judy, &uuid_index, PJE0)) {
+
+            Pvoid_t *section_pvalue = JudyLGet(*uuid_pvalue, (Word_t)ctx, PJE0);
+            if(!section_pvalue || section_pvalue == PJERR || !*section_pvalue)
+                continue;
+
+            METRIC *metric = *section_pvalue;
+            struct mrg_snapshot_metric sm = {
+                .first_time_s = __atomic_load_n(&metric->first_time_s, __ATOMIC_RELAXED),
+                .last_time_s = __atomic_load_n(&metric->latest_time_s_clean, __ATOMIC_RELAXED),
+                .update_every_s = __atomic_load_n(&metric->latest_update_every_s, __ATOMIC_RELAXED),
+            };
+
+            // only the retention that is on disk
+            if(sm.last_time_s <= 0 || sm.first_time_s <= 0)
+                continue;
+
+            uuidmap_uuid(metric->uuid, sm.uuid);
+            buffer_memcat(wb, &sm, sizeof(sm));
+        }
+
+        mrg_index_read_unlock(mrg, partition);
+
+        hdr.metrics += buffer_strlen(wb) / sizeof(struct mrg_snapshot_metric);
+        ok = mrg_snapshot_write(fd, buffer_tostring(wb), buffer_strlen(wb), &crc);
+    }
+    buffer_free(wb);
+
+    hdr.body_crc = crc;
+    hdr.header_crc = crc32(crc32(0L, Z_NULL, 0), (const Bytef *)&hdr, offsetof(struct mrg_snapshot_header, header_crc));
+
+    ok = ok && lseek(fd, 0, SEEK_SET) == 0 && mrg_snapshot_write(fd, &hdr, sizeof(hdr), NULL);
+    ok = ok && fsync(fd) == 0;
+    close(fd);
+
+    if(!ok || rename(path_tmp, path) != 0) {
+        nd_log_daemon(NDLP_ERR, "DBENGINE: failed to write MRG snapshot file '%s'", path);
+        unlink(path_tmp);
+        return false;
+    }
+
+    nd_log_daemon(NDLP_INFO, "DBENGINE: tier %d MRG snapshot saved, %"PRIu64" metrics of %u datafiles, in %.2f ms",
+                  ctx->config.tier, hdr.metrics, hdr.datafiles,
+                  (double)(now_monotonic_usec() - started_ut) / USEC_PER_MS);
+
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+// load
+
+struct mrg_snapshot_load_thread {
+    MRG *mrg;
+    struct rrdengine_instance *ctx;
+    struct mrg_snapshot_metric *metrics;
+    size_t entries;
+    time_t now_s;
+    ND_THREAD *thread;
+};
+
+static void mrg_snapshot_load_worker(void *arg) {
+    struct mrg_snapshot_load_thread *t = arg;
+
+    for(size_t i = 0; i < t->entries ; i++) {
+        struct mrg_snapshot_metric *sm = &t->metrics[i];
+        mrg_update_metric_retention_and_granularity_by_uuid(
+            t->mrg, (Word_t)t->ctx, &sm->uuid, (time_t)sm->first_time_s, (time_t)sm->last_time_s, sm->update_every_s, t->now_s);
+    }
+}
+
+static bool mrg_snapshot_validate(struct rrdengine_instance *ctx, const char *path, uint8_t *data, size_t size) {
+    if(size < sizeof(struct mrg_snapshot_header))
+        return false;
+
+    struct mrg_snapshot_header *hdr = (struct mrg_snapshot_header *)data;
+    if(hdr->magic != MRG_SNAPSHOT_MAGIC || hdr->version != MRG_SNAPSHOT_VERSION || hdr->tier != (uint32_t)ctx->config.tier)
+        return false;
+
+    if(hdr->header_crc != crc32(crc32(0L, Z_NULL, 0), (const Bytef *)hdr, offsetof(struct mrg_snapshot_header, header_crc)))
+        return false;
+
+    size_t expected = sizeof(*hdr) + hdr->datafiles * sizeof(struct mrg_snapshot_datafile) +
+                      hdr->metrics * sizeof(struct mrg_snapshot_metric);
+    if(size != expected)
+        return false;
+
+    if(hdr->body_crc != crc32(crc32(0L, Z_NULL, 0), data + sizeof(*hdr), size - sizeof(*hdr))) {
+        nd_log_daemon(NDLP_WARNING, "DBENGINE: MRG snapshot file '%s' is corrupted", path);
+        return false;
+    }
+
+    return true;
+}
+
+// the datafiles that have the same journal v2 as when the snapshot was saved are returned in covered
+static bool mrg_snapshot_match_datafiles(struct rrdengine_instance *ctx, struct mrg_snapshot_datafile *sd, size_t entries, Pvoid_t *covered) {
+    bool ok = true;
+
+    uv_rwlock_rdlock(&ctx->datafiles.rwlock);
+    for(size_t i = 0; i < entries ; i++) {
+        Pvoid_t *Pvalue = JudyLGet(ctx->datafiles.JudyL, (Word_t)sd[i].fileno, PJE0);
+        if(!Pvalue || Pvalue == PJERR || !*Pvalue) {
+            // this datafile has been deleted, the snapshot has retention that does not exist
+            ok = false;
+            break;
+        }
+
+        struct rrdengine_datafile *df = *Pvalue;
+        uint32_t size;
+        int64_t last_time_s;
+        if(sd[i].journal_v2_size && mrg_snapshot_journal_v2(df, &size, &last_time_s) &&
+            size == sd[i].journal_v2_size && last_time_s == sd[i].journal_v2_last_time_s) {
+            Pvalue = JudyLIns(covered, (Word_t)df->fileno, PJE0);
+            if(Pvalue && Pvalue != PJERR)
+                *Pvalue = df;
+        }
+    }
+    uv_rwlock_rdunlock(&ctx->datafiles.rwlock);
+
+    if(!ok)
+        JudyLFreeArray(covered, PJE0);
+
+    return ok;
+}
+
+bool mrg_snapshot_load(MRG *mrg, struct rrdengine_instance *ctx, size_t threads) {
+    char path[FILENAME_MAX + 1];
+    mrg_snapshot_filename(ctx, path, sizeof(path), false);
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if(fd == -1)
+        return false;
+
+    usec_t started_ut = now_monotonic_usec();
+
+    struct stat st;
+    if(fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(struct mrg_snapshot_header)) {
+        close(fd);
+        return false;
+    }
+
+    size_t size = st.st_size;
+    uint8_t *data = nd_mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if(!data)
+        return false;
+
+    madvise_sequential(data, size);
+
+    bool loaded = false;
+    Pvoid_t covered = NULL;
+    struct mrg_snapshot_header *hdr = (struct mrg_snapshot_header *)data;
+
+    if(!mrg_snapshot_validate(ctx, path, data, size)) {
+        nd_log_daemon(NDLP_INFO, "DBENGINE: tier %d MRG snapshot '%s' is not usable, ignoring it", ctx->config.tier, path);
+        goto cleanup;
+    }
+
+    struct mrg_snapshot_datafile *sd = (struct mrg_snapshot_datafile *)(data + sizeof(*hdr));
+    struct mrg_snapshot_metric *sm = (struct mrg_snapshot_metric *)(sd + hdr->datafiles);
+
+    if(!mrg_snapshot_match_datafiles(ctx, sd, hdr->datafiles, &covered) || !covered) {
+        nd_log_daemon(NDLP_INFO, "DBENGINE: tier %d MRG snapshot '%s' does not match the datafiles, ignoring it", ctx->config.tier, path);
+        goto cleanup;
+    }
+
+    // load the metrics in parallel
+    if(threads < 1) threads = 1;
+    if(threads > hdr->metrics / 10000 + 1) threads = hdr->metrics / 10000 + 1;
+
+    struct mrg_snapshot_load_thread *t = callocz(threads, sizeof(*t));
+    size_t per_thread = hdr->metrics / threads + 1;
+    time_t now_s = max_acceptable_collected_time();
+    for(size_t i = 0, start = 0; i < threads && start < hdr->metrics ; i++, start += per_thread) {
+        t[i].mrg = mrg;
+        t[i].ctx = ctx;
+        t[i].metrics = &sm[start];
+        t[i].entries = MIN(per_thread, hdr->metrics - start);
+        t[i].now_s = now_s;
+
+        if(i + 1 < threads)
+            t[i].thread = nd_thread_create("MRGSNAP", NETDATA_THREAD_OPTION_DEFAULT, mrg_snapshot_load_worker, &t[i]);
+
+        if(!t[i].thread)
+            mrg_snapshot_load_worker(&t[i]);
+    }
+    for(size_t i = 0; i < threads ; i++) {
+        if(t[i].thread)
+            nd_thread_join(t[i].thread);
+    }
+    freez(t);
+
+    time_t old = __atomic_load_n(&ctx->atomic.first_time_s, __ATOMIC_RELAXED);
+    do {
+        if(old <= hdr->first_time_s)
+            break;
+    } while(!__atomic_compare_exchange_n(&ctx->atomic.first_time_s, &old, (time_t)hdr->first_time_s, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+
+    // the covered datafiles do not need to be populated now, they will be reconciled later
+    size_t covered_datafiles = 0;
+    Word_t idx = 0;
+    for(Pvoid_t *Pvalue = JudyLFirst(covered, &idx, PJE0); Pvalue && Pvalue != PJERR ; Pvalue = JudyLNext(covered, &idx, PJE0)) {
+        struct rrdengine_datafile *df = *Pvalue;
+        spinlock_lock(&df->populate_mrg.spinlock);
+        if(!df->populate_mrg.populated) {
+            df->populate_mrg.populated = true;
+            df->populate_mrg.reconcile = true;
+            covered_datafiles++;
+        }
+        spinlock_unlock(&df->populate_mrg.spinlock);
+    }
+
+    loaded = true;
+
+    nd_log_daemon(NDLP_INFO, "DBENGINE: tier %d MRG snapshot loaded, %"PRIu64" metrics covering %zu of %u datafiles, using %zu threads, in %.2f ms",
+                  ctx->config.tier, hdr->metrics, covered_datafiles, hdr->datafiles, threads,
+                  (double)(now_monotonic_usec() - started_ut) / USEC_PER_MS);
+
+cleanup:
+    JudyLFreeArray(&covered, PJE0);
+    nd_munmap(data, size);
+    return loaded;
+}
+
+// ----------------------------------------------------------------------------
+// background reconciliation of the datafiles loaded from the snapshot
+
+static void mrg_snapshot_reconcile_worker(void *arg) {
+    struct rrdengine_instance *ctx = arg;
+    usec_t started_ut = now_monotonic_usec();
+    size_t reconciled = 0;
+
+    Word_t fileno = 0;
+    while(ctx_is_available_for_queries(ctx) && !nd_thread_signaled_to_cancel()) {
+        struct rrdengine_datafile *df = NULL;
+
+        uv_rwlock_rdlock(&ctx->datafiles.rwlock);
+        for(Pvoid_t *Pvalue = JudyLNext(ctx->datafiles.JudyL, &fileno, PJE0); Pvalue && Pvalue != PJERR ;
+             Pvalue = JudyLNext(ctx->datafiles.JudyL, &fileno, PJE0)) {
+            struct rrdengine_datafile *candidate = *Pvalue;
+            if(__atomic_load_n(&candidate->populate_mrg.reconcile, __ATOMIC_RELAXED) &&
+                datafile_acquire(candidate, DATAFILE_ACQUIRE_RETENTION)) {
+                df = candidate;
+                break;
+            }
+        }
+        uv_rwlock_rdunlock(&ctx->datafiles.rwlock);
+
+        if(!df)
+            break;
+
+        journalfile_v2_populate_retention_to_mrg(ctx, df->journalfile);
+        __atomic_store_n(&df->populate_mrg.reconcile, false, __ATOMIC_RELAXED);
+        datafile_release(df, DATAFILE_ACQUIRE_RETENTION);
+        reconciled++;
+    }
+
+    nd_log_daemon(NDLP_INFO, "DBENGINE: tier %d MRG reconciled %zu datafiles loaded from the snapshot, in %.2f ms",
+                  ctx->config.tier, reconciled, (double)(now_monotonic_usec() - started_ut) / USEC_PER_MS);
+}
+
+void mrg_snapshot_reconcile_start(struct rrdengine_instance *ctx) {
+    bool needed = false;
+
+    uv_rwlock_rdlock(&ctx->datafiles.rwlock);
+    for(struct rrdengine_datafile *df = get_next_datafile(NULL, ctx, true); df && !needed ; df = get_next_datafile(df, ctx, true))
+        needed = __atomic_load_n(&df->populate_mrg.reconcile, __ATOMIC_RELAXED);
+    uv_rwlock_rdunlock(&ctx->datafiles.rwlock);
+
+    if(needed && !ctx->loading.mrg_reconcile_thread)
+        ctx->loading.mrg_reconcile_thread =
+            nd_thread_create("MRGRECON", NETDATA_THREAD_OPTION_DEFAULT, mrg_snapshot_reconcile_worker, ctx);
+}
+
+void mrg_snapshot_reconcile_stop(struct rrdengine_instance *ctx) {
+    if(!ctx->loading.mrg_reconcile_thread)
+        return;
+
+    nd_thread_signal_cancel(ctx->loading.mrg_reconcile_thread);
+    nd_thread_join(ctx->loading.mrg_reconcile_thread);
+    ctx->loading.mrg_reconcile_thread = NULL;
+}
@@ -93,4 +93,13 @@ bool mrg_save(MRG *mrg);
 bool mrg_load(MRG *mrg);
 void mrg_metric_prepopulate_cleanup(MRG *mrg);
 
+// the on-disk snapshot of the retention of a tier (mrg-snapshot.c)
+#define MRG_SNAPSHOT_FILENAME "mrg-snapshot.ndm"
+extern time_t dbengine_mrg_snapshot_every_s;
+struct rrdengine_instance;
+bool mrg_snapshot_save(MRG *mrg, struct rrdengine_instance *ctx);
+bool mrg_snapshot_load(MRG *mrg, struct rrdengine_instance *ctx, size_t threads);
+void mrg_snapshot_reconcile_start(struct rrdengine_instance *ctx);
+void mrg_snapshot_reconcile_stop(struct rrdengine_instance *ctx);
+
 #endif // DBENGINE_METRIC_H
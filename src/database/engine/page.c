@@ -8,6 +8,7 @@ typedef enum __attribute__((packed)) {
     PAGE_OPTION_ALL_VALUES_EMPTY    = (1 << 0),
     PAGE_OPTION_ARAL_MARKED         = (1 << 1),
     PAGE_OPTION_ARAL_UNMARKED       = (1 << 2),
+    PAGE_OPTION_STORE_AS_ARRAY      = (1 << 3), // a gorilla tier1 page that does not compress
 } PAGE_OPTIONS;
 
 typedef enum __attribute__((packed)) {
@@ -20,6 +21,11 @@ typedef enum __attribute__((packed)) {
 typedef struct {
     uint8_t *data;
     uint16_t size;
+
+    // gorilla tier1 pages being flushed are encoded once, by pgd_disk_footprint(),
+    // and the encoded page is kept until pgd_copy_to_extent() writes it
+    uint16_t encoded_size;
+    uint32_t *encoded;
 } page_raw_t;
 
 typedef struct {
@@ -80,6 +86,11 @@ static PRINTFLIKE(2, 3) void pgd_fatal(const PGD *pg, const char *fmt, ...) {
             added = true;
         }
 
+        if (pg->type == RRDENG_PAGE_TYPE_GORILLA_TIER1) {
+            buffer_sprintf(wb, added ? "|%s" : "%s", "GORILLA_TIER1");
+            added = true;
+        }
+
         if (!added) {
             int type = pg->type;
             buffer_sprintf(wb, "%d", type);
@@ -439,6 +450,167 @@ ALWAYS_INLINE void dbengine_extent_free(void *extent, size_t size) {
     pgd_data_free(extent, size, 0);
 }
 
+// ----------------------------------------------------------------------------
+// gorilla tier1 pages
+
+// Collected GORILLA_TIER1 pages keep a raw array of storage_number_tier1_t in
+// memory, exactly like ARRAY_TIER1 pages, so collection and queries on hot pages
+// cost the same. The column-wise encoding happens once, when the page is flushed.
+// Pages loaded from disk keep the encoded data and are decoded by the cursor.
+
+#define GORILLA_TIER1_HEADER_WORDS (sizeof(struct rrdeng_gorilla_tier1_header) / sizeof(uint32_t))
+#define GORILLA_TIER1_MAX_WORDS (RRDENG_BLOCK_SIZE / sizeof(uint32_t))
+
+_Static_assert(sizeof(struct rrdeng_gorilla_tier1_header) % sizeof(uint32_t) == 0,
+               "gorilla tier1 header must be a multiple of 32-bit words");
+
+enum {
+    GORILLA_TIER1_COLUMN_SUM = 0,
+    GORILLA_TIER1_COLUMN_MIN,
+    GORILLA_TIER1_COLUMN_MAX,
+    GORILLA_TIER1_COLUMN_COUNT,
+    GORILLA_TIER1_COLUMN_ANOMALY_COUNT,
+};
+
+static ALWAYS_INLINE uint32_t gorilla_tier1_float_to_bits(float f) {
+    uint32_t u;
+    memcpy(&u, &f, sizeof(u));
+    return u;
+}
+
+static ALWAYS_INLINE float gorilla_tier1_bits_to_float(uint32_t u) {
+    float f;
+    memcpy(&f, &u, sizeof(f));
+    return f;
+}
+
+static ALWAYS_INLINE uint32_t gorilla_tier1_column_value(const storage_number_tier1_t *t, size_t column) {
+    switch(column) {
+        case GORILLA_TIER1_COLUMN_SUM:
+            return gorilla_tier1_float_to_bits(t->sum_value);
+
+        case GORILLA_TIER1_COLUMN_MIN:
+            return gorilla_tier1_float_to_bits(t->min_value);
+
+        case GORILLA_TIER1_COLUMN_MAX:
+            return gorilla_tier1_float_to_bits(t->max_value);
+
+        case GORILLA_TIER1_COLUMN_COUNT:
+            return t->count;
+
+        default:
+        case GORILLA_TIER1_COLUMN_ANOMALY_COUNT:
+            return t->anomaly_count;
+    }
+}
+
+// encodes the raw array of the page into words (which must be able to hold GORILLA_TIER1_MAX_WORDS)
+// returns the bytes of the encoded page, or 0 when the encoded page is not smaller than the raw one
+static uint32_t pgd_gorilla_tier1_encode(PGD *pg, uint32_t *words) {
+    const storage_number_tier1_t *array = (const storage_number_tier1_t *)pg->raw.data;
+    uint32_t raw_bytes = pg->used * sizeof(storage_number_tier1_t);
+
+    size_t max_words = MIN(GORILLA_TIER1_MAX_WORDS, raw_bytes / sizeof(uint32_t));
+    if(max_words <= GORILLA_TIER1_HEADER_WORDS)
+        return 0;
+
+    memset(words, 0, max_words * sizeof(uint32_t));
+
+    struct rrdeng_gorilla_tier1_header *hdr = (struct rrdeng_gorilla_tier1_header *)words;
+    uint32_t *data = &words[GORILLA_TIER1_HEADER_WORDS];
+    uint32_t capacity = (max_words - GORILLA_TIER1_HEADER_WORDS) * RRDENG_GORILLA_32BIT_SLOT_BITS;
+    uint32_t nbits = 0;
+
+    for(size_t c = 0; c < RRDENG_GORILLA_TIER1_COLUMNS ;c++) {
+        hdr->column_start_bit[c] = nbits;
+
+        gorilla_stream_writer_t gsw = gorilla_stream_writer_init(data, capacity, nbits);
+        for(uint32_t i = 0; i < pg->used ;i++) {
+            uint32_t v = gorilla_tier1_column_value(&array[i], c);
+            bool ok = (c < GORILLA_TIER1_COLUMN_COUNT) ? gorilla_stream_write_xor(&gsw, v) : gorilla_stream_write_dod(&gsw, v);
+            if(!ok)
+                return 0;
+        }
+
+        nbits = gsw.nbits;
+    }
+
+    hdr->entries = pg->used;
+    hdr->nbits = nbits;
+
+    uint32_t bytes = sizeof(*hdr) + ((nbits + RRDENG_GORILLA_32BIT_SLOT_BITS - 1) / RRDENG_GORILLA_32BIT_SLOT_BITS) * sizeof(uint32_t);
+    return (bytes < raw_bytes) ? bytes : 0;
+}
+
+// encodes a collected page for flushing, once
+static void pgd_gorilla_tier1_encode_for_flushing(PGD *pg) {
+    if(pg->raw.encoded_size)
+        return;
+
+    uint32_t used_size = pg->used * page_type_size[pg->type];
+    internal_fatal(used_size > pg->raw.size, "Wrong disk footprint page size");
+
+    uint32_t words[GORILLA_TIER1_MAX_WORDS];
+    uint32_t size = pgd_gorilla_tier1_encode(pg, words);
+
+    pulse_gorilla_tier1_page_flush(size ? size : used_size, used_size);
+
+    if(size) {
+        pg->raw.encoded = mallocz(size);
+        memcpy(pg->raw.encoded, words, size);
+        pg->raw.encoded_size = size;
+    }
+    else {
+        // the points do not compress - the page is stored as a plain array
+        pg->options |= PAGE_OPTION_STORE_AS_ARRAY;
+        pg->raw.encoded_size = used_size;
+    }
+}
+
+static bool pgd_gorilla_tier1_header_is_valid(const struct rrdeng_gorilla_tier1_header *hdr, uint32_t size) {
+    if(size < sizeof(*hdr) || size % sizeof(uint32_t) || !hdr->entries)
+        return false;
+
+    uint32_t capacity = (size - sizeof(*hdr)) * CHAR_BIT;
+    if(hdr->nbits > capacity)
+        return false;
+
+    for(size_t c = 0; c < RRDENG_GORILLA_TIER1_COLUMNS ;c++) {
+        if(hdr->column_start_bit[c] > hdr->nbits || (c && hdr->column_start_bit[c] < hdr->column_start_bit[c - 1]))
+            return false;
+    }
+
+    return true;
+}
+
+static void pgdc_gorilla_tier1_readers_init(PGDC *pgdc) {
+    const struct rrdeng_gorilla_tier1_header *hdr = (const struct rrdeng_gorilla_tier1_header *)pgdc->pgd->raw.data;
+    const uint32_t *data = (const uint32_t *)&pgdc->pgd->raw.data[sizeof(*hdr)];
+
+    for(size_t c = 0; c < RRDENG_GORILLA_TIER1_COLUMNS ;c++) {
+        // each column can only be read up to the start of the next one
+        uint32_t end_bit = (c + 1 < RRDENG_GORILLA_TIER1_COLUMNS) ? hdr->column_start_bit[c + 1] : hdr->nbits;
+        pgdc->gsr[c] = gorilla_stream_reader_init(data, end_bit, hdr->column_start_bit[c]);
+    }
+}
+
+static ALWAYS_INLINE bool pgdc_gorilla_tier1_read(PGDC *pgdc, storage_number_tier1_t *t) {
+    uint32_t v[RRDENG_GORILLA_TIER1_COLUMNS];
+
+    for(size_t c = 0; c < RRDENG_GORILLA_TIER1_COLUMNS ;c++) {
+        bool ok = (c < GORILLA_TIER1_COLUMN_COUNT) ? gorilla_stream_read_xor(&pgdc->gsr[c], &v[c]) : gorilla_stream_read_dod(&pgdc->gsr[c], &v[c]);
+        if(unlikely(!ok))
+            return false;
+    }
+
+    t->sum_value = gorilla_tier1_bits_to_float(v[GORILLA_TIER1_COLUMN_SUM]);
+    t->min_value = gorilla_tier1_bits_to_float(v[GORILLA_TIER1_COLUMN_MIN]);
+    t->max_value = gorilla_tier1_bits_to_float(v[GORILLA_TIER1_COLUMN_MAX]);
+    t->count = (uint16_t)v[GORILLA_TIER1_COLUMN_COUNT];
+    t->anomaly_count = (uint16_t)v[GORILLA_TIER1_COLUMN_ANOMALY_COUNT];
+    return true;
+}
+
 // ----------------------------------------------------------------------------
 // management api
 
@@ -472,7 +644,8 @@ ALWAYS_INLINE PGD *pgd_create(uint8_t type, uint32_t slots) {
         }
 
         case RRDENG_PAGE_TYPE_ARRAY_32BIT:
-        case RRDENG_PAGE_TYPE_ARRAY_TIER1: {
+        case RRDENG_PAGE_TYPE_ARRAY_TIER1:
+        case RRDENG_PAGE_TYPE_GORILLA_TIER1: {
             uint32_t size = slots * page_type_size[type];
 
             internal_fatal(!size || slots == 1,
@@ -480,6 +653,8 @@ ALWAYS_INLINE PGD *pgd_create(uint8_t type, uint32_t slots) {
 
             pg->raw.size = size;
             pg->raw.data = pgd_data_alloc(size, pg->partition, true);
+            pg->raw.encoded_size = 0;
+            pg->raw.encoded = NULL;
             break;
         }
 
@@ -528,9 +703,34 @@ ALWAYS_INLINE PGD *pgd_create_from_disk_data(uint8_t type, void *base, uint32_t
 
             pg->raw.size = size;
             pg->raw.data = pgd_data_alloc(size, pg->partition, false);
+            pg->raw.encoded_size = 0;
+            pg->raw.encoded = NULL;
             memcpy(pg->raw.data, base, size);
             break;
 
+        case RRDENG_PAGE_TYPE_GORILLA_TIER1: {
+            struct rrdeng_gorilla_tier1_header hdr = { 0 };
+            if(size >= sizeof(hdr))
+                memcpy(&hdr, base, sizeof(hdr));
+
+            if(!pgd_gorilla_tier1_header_is_valid(&hdr, size)) {
+                netdata_log_error("DBENGINE: invalid gorilla tier1 page of %u bytes found. Ignoring it.", size);
+                aral_freez(pgd_alloc_globals.aral_pgd[pg->partition], pg);
+                pg = PGD_EMPTY;
+                break;
+            }
+
+            pg->used = hdr.entries;
+            pg->slots = pg->used;
+
+            pg->raw.size = size;
+            pg->raw.data = pgd_data_alloc(size, pg->partition, false);
+            pg->raw.encoded_size = 0;
+            pg->raw.encoded = NULL;
+            memcpy(pg->raw.data, base, size);
+            break;
+        }
+
         default:
             netdata_log_error("%s() - Unknown page type: %uc", __FUNCTION__, type);
             aral_freez(pgd_alloc_globals.aral_pgd[pg->partition], pg);
@@ -600,6 +800,9 @@ void pgd_free(PGD *pg) {
 
         case RRDENG_PAGE_TYPE_ARRAY_32BIT:
         case RRDENG_PAGE_TYPE_ARRAY_TIER1:
+        case RRDENG_PAGE_TYPE_GORILLA_TIER1:
+            // encoded, but never copied to an extent
+            freez(pg->raw.encoded);
             pgd_data_free(pg->raw.data, pg->raw.size, pg->partition);
             break;
 
@@ -653,6 +856,7 @@ static void pgd_aral_unmark(PGD *pg) {
 
         case RRDENG_PAGE_TYPE_ARRAY_32BIT:
         case RRDENG_PAGE_TYPE_ARRAY_TIER1:
+        case RRDENG_PAGE_TYPE_GORILLA_TIER1:
             pgd_data_unmark(pg->raw.data, pg->raw.size, pg->partition);
             break;
 
@@ -675,6 +879,15 @@ ALWAYS_INLINE uint32_t pgd_type(PGD *pg)
     return pg->type;
 }
 
+// the type the page is stored on disk with - valid after pgd_disk_footprint()
+uint32_t pgd_disk_type(PGD *pg)
+{
+    if (pg->type == RRDENG_PAGE_TYPE_GORILLA_TIER1 && (pg->options & PAGE_OPTION_STORE_AS_ARRAY))
+        return RRDENG_PAGE_TYPE_ARRAY_TIER1;
+
+    return pg->type;
+}
+
 ALWAYS_INLINE bool pgd_is_empty(PGD *pg)
 {
     if (!pg)
@@ -738,6 +951,7 @@ ALWAYS_INLINE uint32_t pgd_memory_footprint(PGD *pg)
 
         case RRDENG_PAGE_TYPE_ARRAY_32BIT:
         case RRDENG_PAGE_TYPE_ARRAY_TIER1:
+        case RRDENG_PAGE_TYPE_GORILLA_TIER1:
             footprint += pgd_data_footprint(pg->raw.size, pg->partition);
             break;
 
@@ -772,6 +986,7 @@ uint32_t pgd_buffer_memory_footprint(PGD *pg)
 
         case RRDENG_PAGE_TYPE_ARRAY_32BIT:
         case RRDENG_PAGE_TYPE_ARRAY_TIER1:
+        case RRDENG_PAGE_TYPE_GORILLA_TIER1:
             footprint = pg->raw.size;
             break;
 
@@ -831,6 +1046,16 @@ uint32_t pgd_disk_footprint(PGD *pg)
             break;
         }
 
+        case RRDENG_PAGE_TYPE_GORILLA_TIER1:
+            if (pg->states & PGD_STATE_CREATED_FROM_DISK) {
+                size = pg->raw.size;
+                break;
+            }
+
+            pgd_gorilla_tier1_encode_for_flushing(pg);
+            size = pg->raw.encoded_size;
+            break;
+
         default:
             netdata_log_error("%s() - Unknown page type: %uc", __FUNCTION__, pg->type);
             break;
@@ -872,6 +1097,20 @@ void pgd_copy_to_extent(PGD *pg, uint8_t *dst, uint32_t dst_size)
             memcpy(dst, pg->raw.data, dst_size);
             break;
 
+        case RRDENG_PAGE_TYPE_GORILLA_TIER1:
+            internal_fatal(pg->raw.encoded_size != dst_size,
+                           "pgd_copy_to_extent() gorilla tier1 page encoded to %u bytes, but %u bytes were reserved",
+                           pg->raw.encoded_size, dst_size);
+
+            if(pg->options & PAGE_OPTION_STORE_AS_ARRAY)
+                memcpy(dst, pg->raw.data, dst_size);
+            else {
+                memcpy(dst, pg->raw.encoded, MIN(pg->raw.encoded_size, dst_size));
+                freez(pg->raw.encoded);
+                pg->raw.encoded = NULL;
+            }
+            break;
+
         default:
             netdata_log_error("%s() - Unknown page type: %uc", __FUNCTION__, pg->type);
             break;
@@ -880,6 +1119,54 @@ void pgd_copy_to_extent(PGD *pg, uint8_t *dst, uint32_t dst_size)
     pg->states = PGD_STATE_FLUSHED_TO_DISK;
 }
 
+// copy the page data in their on-disk format, without preparing the page for flushing
+// - unlike pgd_disk_footprint() and pgd_copy_to_extent(), it does not alter the page,
+//   so it can be used on pages at any state, shared with other readers
+// - only the tier 0 page types are supported
+// returns the bytes copied, or 0 when the page is empty, not supported, or does not fit in dst
+uint32_t pgd_serialize(PGD *pg, uint8_t *dst, uint32_t dst_size)
+{
+    if (!pgd_slots_used(pg))
+        return 0;
+
+    uint32_t size = 0;
+
+    switch (pg->type) {
+        case RRDENG_PAGE_TYPE_GORILLA_32BIT:
+            if (pg->states & PGD_STATE_CREATED_FROM_DISK) {
+                // the buffers have been patched to point to each other in memory,
+                // which is also how gorilla_buffer_patch() expects to find them on disk
+                size = pg->raw.size;
+                if (size > dst_size)
+                    return 0;
+
+                memcpy(dst, pg->raw.data, size);
+            }
+            else {
+                if (!pg->gorilla.writer || !pg->gorilla.num_buffers)
+                    return 0;
+
+                size = pg->gorilla.num_buffers * RRDENG_GORILLA_32BIT_BUFFER_SIZE;
+                if (size > dst_size || !gorilla_writer_serialize(pg->gorilla.writer, dst, size))
+                    return 0;
+            }
+            break;
+
+        case RRDENG_PAGE_TYPE_ARRAY_32BIT:
+            size = pg->used * page_type_size[pg->type];
+            if (size > dst_size)
+                return 0;
+
+            memcpy(dst, pg->raw.data, size);
+            break;
+
+        default:
+            break;
+    }
+
+    return size;
+}
+
 // ----------------------------------------------------------------------------
 // data collection
 
@@ -943,7 +1230,8 @@ size_t pgd_append_point(
 
             break;
         }
-        case RRDENG_PAGE_TYPE_ARRAY_TIER1: {
+        case RRDENG_PAGE_TYPE_ARRAY_TIER1:
+        case RRDENG_PAGE_TYPE_GORILLA_TIER1: {
             storage_number_tier1_t *tier12_metric_data = (storage_number_tier1_t *)pg->raw.data;
             storage_number_tier1_t t;
             t.sum_value = (float) n;
@@ -1022,6 +1310,23 @@ static void pgdc_seek(PGDC *pgdc, uint32_t position)
             pgdc->slots = pgdc->pgd->used;
             break;
 
+        case RRDENG_PAGE_TYPE_GORILLA_TIER1:
+            pgdc->slots = pgdc->pgd->used;
+
+            if (pg->states & PGD_STATE_CREATED_FROM_DISK) {
+                pgdc_gorilla_tier1_readers_init(pgdc);
+
+                if (position > pgdc->slots)
+                    position = pgdc->slots;
+
+                storage_number_tier1_t t;
+                for (uint32_t i = 0; i != position; i++) {
+                    if (!pgdc_gorilla_tier1_read(pgdc, &t))
+                        break;
+                }
+            }
+            break;
+
         default:
             netdata_log_error("%s() - Unknown page type: %uc", __FUNCTION__, pg->type);
             break;
@@ -1047,6 +1352,15 @@ void pgdc_reset(PGDC *pgdc, PGD *pgd, uint32_t position)
     pgdc_seek(pgdc, position);
 }
 
+static ALWAYS_INLINE void storage_point_from_tier1(STORAGE_POINT *sp, storage_number_tier1_t n) {
+    sp->flags = n.anomaly_count ? SN_FLAG_NONE : SN_FLAG_NOT_ANOMALOUS;
+    sp->count = n.count;
+    sp->anomaly_count = n.anomaly_count;
+    sp->min = n.min_value;
+    sp->max = n.max_value;
+    sp->sum = n.sum_value;
+}
+
 ALWAYS_INLINE_HOT_FLATTEN
 bool pgdc_get_next_point(PGDC *pgdc, uint32_t expected_position __maybe_unused, STORAGE_POINT *sp)
 {
@@ -1077,17 +1391,28 @@ bool pgdc_get_next_point(PGDC *pgdc, uint32_t expected_position __maybe_unused,
 
             return ok;
         }
-        case RRDENG_PAGE_TYPE_ARRAY_TIER1: {
-            storage_number_tier1_t *array = (storage_number_tier1_t *) pgdc->pgd->raw.data;
-            storage_number_tier1_t n = array[pgdc->position++];
+        case RRDENG_PAGE_TYPE_GORILLA_TIER1:
+            if (pgdc->pgd->states & PGD_STATE_CREATED_FROM_DISK) {
+                pgdc->position++;
+
+                storage_number_tier1_t n;
+                bool ok = pgdc_gorilla_tier1_read(pgdc, &n);
+
+                if (ok)
+                    storage_point_from_tier1(sp, n);
+                else
+                    storage_point_empty(*sp, sp->start_time_s, sp->end_time_s);
+
+                return ok;
+            }
 
-            sp->flags = n.anomaly_count ? SN_FLAG_NONE : SN_FLAG_NOT_ANOMALOUS;
-            sp->count = n.count;
-            sp->anomaly_count = n.anomaly_count;
-            sp->min = n.min_value;
-            sp->max = n.max_value;
-            sp->sum = n.sum_value;
+            // collected pages are raw arrays
+            storage_point_from_tier1(sp, ((storage_number_tier1_t *) pgdc->pgd->raw.data)[pgdc->position++]);
+            return true;
 
+        case RRDENG_PAGE_TYPE_ARRAY_TIER1: {
+            storage_number_tier1_t *array = (storage_number_tier1_t *) pgdc->pgd->raw.data;
+            storage_point_from_tier1(sp, array[pgdc->position++]);
             return true;
         }
         case RRDENG_PAGE_TYPE_ARRAY_32BIT: {
@@ -1115,3 +1440,65 @@ bool pgdc_get_next_point(PGDC *pgdc, uint32_t expected_position __maybe_unused,
         }
     }
 }
+
+// Decode up to `n` consecutive points of the page into `sp`, starting at the
+// current cursor position. The timestamps of the points have to be set by
+// the caller before calling this.
+// Returns the number of points decoded, which is less than `n` only when
+// the page has fewer remaining slots.
+ALWAYS_INLINE_HOT_FLATTEN
+size_t pgdc_get_next_points(PGDC *pgdc, uint32_t expected_position __maybe_unused, STORAGE_POINT *sp, size_t n)
+{
+    if (!pgdc->pgd || pgdc->pgd == PGD_EMPTY || pgdc->position >= pgdc->slots)
+        return 0;
+
+    internal_fatal(pgdc->position != expected_position, "Wrong expected cursor position");
+
+    size_t remaining = pgdc->slots - pgdc->position;
+    if (n > remaining)
+        n = remaining;
+
+    switch (pgdc->pgd->type)
+    {
+        case RRDENG_PAGE_TYPE_ARRAY_32BIT: {
+            storage_number *array = &((storage_number *) pgdc->pgd->raw.data)[pgdc->position];
+
+            for (size_t i = 0; i < n; i++) {
+                storage_number v = array[i];
+                sp[i].min = sp[i].max = sp[i].sum = unpack_storage_number(v);
+                sp[i].flags = (SN_FLAGS)(v & SN_USER_FLAGS);
+                sp[i].count = 1;
+                sp[i].anomaly_count = is_storage_number_anomalous(v) ? 1 : 0;
+            }
+
+            pgdc->position += n;
+            return n;
+        }
+
+        case RRDENG_PAGE_TYPE_GORILLA_TIER1:
+            if (pgdc->pgd->states & PGD_STATE_CREATED_FROM_DISK)
+                break;
+
+            // collected pages are raw arrays
+            // fall through
+
+        case RRDENG_PAGE_TYPE_ARRAY_TIER1: {
+            storage_number_tier1_t *array = &((storage_number_tier1_t *) pgdc->pgd->raw.data)[pgdc->position];
+
+            for (size_t i = 0; i < n; i++)
+                storage_point_from_tier1(&sp[i], array[i]);
+
+            pgdc->position += n;
+            return n;
+        }
+
+        default:
+            break;
+    }
+
+    // streams that have to be decoded point by point
+    for (size_t i = 0; i < n; i++)
+        pgdc_get_next_point(pgdc, pgdc->position, &sp[i]);
+
+    return n;
+}
@@ -8,13 +8,17 @@ extern "C" {
 #endif
 
 #include "libnetdata/libnetdata.h"
+#include "rrddiskprotocol.h"
 
 typedef struct pgd_cursor {
     struct pgd *pgd;
     uint32_t position;
     uint32_t slots;
 
-    gorilla_reader_t gr;
+    union {
+        gorilla_reader_t gr;
+        gorilla_stream_reader_t gsr[RRDENG_GORILLA_TIER1_COLUMNS];
+    };
 } PGDC;
 
 #include "rrdengine.h"
@@ -30,6 +34,7 @@ PGD *pgd_create_from_disk_data(uint8_t type, void *base, uint32_t size);
 void pgd_free(PGD *pg);
 
 uint32_t pgd_type(PGD *pg);
+uint32_t pgd_disk_type(PGD *pg);
 bool pgd_is_empty(PGD *pg);
 uint32_t pgd_slots_used(PGD *pg);
 
@@ -42,6 +47,7 @@ struct aral_statistics *pgd_aral_stats(void);
 size_t pgd_padding_bytes(void);
 
 void pgd_copy_to_extent(PGD *pg, uint8_t *dst, uint32_t dst_size);
+uint32_t pgd_serialize(PGD *pg, uint8_t *dst, uint32_t dst_size);
 
 size_t pgd_append_point(PGD *pg,
                       usec_t point_in_time_ut,
@@ -55,6 +61,7 @@ size_t pgd_append_point(PGD *pg,
 
 void pgdc_reset(PGDC *pgdc, PGD *pgd, uint32_t position);
 bool pgdc_get_next_point(PGDC *pgdc, uint32_t expected_position, STORAGE_POINT *sp);
+size_t pgdc_get_next_points(PGDC *pgdc, uint32_t expected_position, STORAGE_POINT *sp, size_t n);
 
 void *dbengine_extent_alloc(size_t size);
 void dbengine_extent_free(void *extent, size_t size);
@@ -6,6 +6,7 @@
 #include <gtest/gtest.h>
 #include <limits>
 #include <random>
+#include <vector>
 
 bool operator==(const STORAGE_POINT lhs, const STORAGE_POINT rhs) {
     if (lhs.min != rhs.min)
@@ -34,13 +35,13 @@ bool operator==(const STORAGE_POINT lhs, const STORAGE_POINT rhs) {
 
 // TODO: use value-parameterized tests
 // http://google.github.io/googletest/advanced.html#value-parameterized-tests
-static uint8_t page_type = PAGE_GORILLA_METRICS;
+static uint8_t page_type = RRDENG_PAGE_TYPE_GORILLA_32BIT;
 
 static size_t slots_for_page(size_t n) {
     switch (page_type) {
-        case PAGE_METRICS:
+        case RRDENG_PAGE_TYPE_ARRAY_32BIT:
             return 1024;
-        case PAGE_GORILLA_METRICS:
+        case RRDENG_PAGE_TYPE_GORILLA_32BIT:
             return n;
         default:
             fatal("Slots requested for unsupported page: %uc", page_type);
@@ -200,10 +201,10 @@ TEST(PGD, MemoryFootprint) {
 
     uint32_t footprint = 0;
     switch (pgd_type(pg)) {
-        case PAGE_METRICS:
+        case RRDENG_PAGE_TYPE_ARRAY_32BIT:
             footprint = slots * sizeof(uint32_t);
             break;
-        case PAGE_GORILLA_METRICS:
+        case RRDENG_PAGE_TYPE_GORILLA_32BIT:
             footprint = 128 * sizeof(uint32_t);
             break;
         default:
@@ -225,10 +226,10 @@ TEST(PGD, MemoryFootprint) {
 
     uint32_t abs_error = 0;
     switch (pgd_type(pg)) {
-        case PAGE_METRICS:
+        case RRDENG_PAGE_TYPE_ARRAY_32BIT:
             abs_error = 128;
             break;
-        case PAGE_GORILLA_METRICS:
+        case RRDENG_PAGE_TYPE_GORILLA_32BIT:
             abs_error = footprint / 10;
             break;
         default:
@@ -256,10 +257,10 @@ TEST(PGD, DiskFootprint) {
 
     uint32_t footprint = 0;
     switch (pgd_type(pg)) {
-        case PAGE_METRICS:
+        case RRDENG_PAGE_TYPE_ARRAY_32BIT:
             footprint = used_slots * sizeof(uint32_t);
             break;
-        case PAGE_GORILLA_METRICS:
+        case RRDENG_PAGE_TYPE_GORILLA_32BIT:
             footprint = 128 * sizeof(uint32_t);
             break;
         default:
@@ -279,10 +280,10 @@ TEST(PGD, DiskFootprint) {
     }
 
     switch (pgd_type(pg)) {
-        case PAGE_METRICS:
+        case RRDENG_PAGE_TYPE_ARRAY_32BIT:
             footprint = used_slots * sizeof(uint32_t);
             break;
-        case PAGE_GORILLA_METRICS:
+        case RRDENG_PAGE_TYPE_GORILLA_32BIT:
             footprint = 2 * (128 * sizeof(uint32_t));
             break;
         default:
@@ -377,6 +378,184 @@ TEST(PGD, Roundtrip) {
     pgd_free(pg_collector);
 }
 
+static void gorilla_tier1_roundtrip(uint32_t slots, bool compressible) {
+    std::mt19937 gen(slots);
+    std::uniform_int_distribution<uint32_t> distr;
+
+    PGD *pg = pgd_create(RRDENG_PAGE_TYPE_GORILLA_TIER1, slots);
+    std::vector<storage_number_tier1_t> expected(slots);
+
+    for (uint32_t i = 0; i != slots; i++) {
+        storage_number_tier1_t &t = expected[i];
+
+        if (compressible) {
+            t.sum_value = (float) (1000 + (i % 7));
+            t.min_value = (float) (i % 3);
+            t.max_value = (float) (100 + (i % 5));
+            t.count = 60;
+            t.anomaly_count = (i % 10 == 0) ? 1 : 0;
+        } else {
+            t.sum_value = (float) distr(gen);
+            t.min_value = (float) distr(gen);
+            t.max_value = (float) distr(gen);
+            t.count = (uint16_t) distr(gen);
+            t.anomaly_count = (uint16_t) distr(gen);
+        }
+
+        pgd_append_point(pg, 0, t.sum_value, t.min_value, t.max_value, t.count, t.anomaly_count, SN_FLAG_NONE, i);
+    }
+
+    uint32_t raw_size = slots * sizeof(storage_number_tier1_t);
+    uint32_t size = pgd_disk_footprint(pg);
+
+    // asking again does not encode the page again, or change it
+    EXPECT_EQ(pgd_disk_footprint(pg), size);
+    EXPECT_EQ(pgd_type(pg), RRDENG_PAGE_TYPE_GORILLA_TIER1);
+
+    uint8_t type = pgd_disk_type(pg);
+    if (compressible) {
+        EXPECT_EQ(type, RRDENG_PAGE_TYPE_GORILLA_TIER1);
+        EXPECT_LT(size, raw_size);
+    } else {
+        EXPECT_EQ(type, RRDENG_PAGE_TYPE_ARRAY_TIER1);
+        EXPECT_EQ(size, raw_size);
+    }
+
+    // write it unaligned, like in extents
+    std::vector<uint8_t> extent(size + 1);
+    pgd_copy_to_extent(pg, &extent[1], size);
+
+    PGD *pg_disk = pgd_create_from_disk_data(type, &extent[1], size);
+    ASSERT_EQ(pgd_slots_used(pg_disk), slots);
+
+    // read everything, then seek to the middle and read the rest again
+    for (uint32_t start = 0; start < slots; start += slots / 2 + 1) {
+        PGDC cursor;
+        pgdc_reset(&cursor, pg_disk, start);
+
+        for (uint32_t i = start; i != slots; i++) {
+            STORAGE_POINT sp = {};
+            ASSERT_TRUE(pgdc_get_next_point(&cursor, i, &sp));
+            EXPECT_EQ(sp.sum, (NETDATA_DOUBLE) expected[i].sum_value);
+            EXPECT_EQ(sp.min, (NETDATA_DOUBLE) expected[i].min_value);
+            EXPECT_EQ(sp.max, (NETDATA_DOUBLE) expected[i].max_value);
+            EXPECT_EQ(sp.count, expected[i].count);
+            EXPECT_EQ(sp.anomaly_count, expected[i].anomaly_count);
+        }
+    }
+
+    // read everything again, in batches
+    PGDC cursor;
+    pgdc_reset(&cursor, pg_disk, 0);
+
+    STORAGE_POINT batch[10];
+    for (uint32_t i = 0; i < slots; ) {
+        size_t n = pgdc_get_next_points(&cursor, i, batch, sizeof(batch) / sizeof(batch[0]));
+        ASSERT_NE(n, 0u);
+
+        for (size_t b = 0; b != n; b++, i++) {
+            EXPECT_EQ(batch[b].sum, (NETDATA_DOUBLE) expected[i].sum_value);
+            EXPECT_EQ(batch[b].count, expected[i].count);
+        }
+    }
+
+    // the collected page is still queried as an array
+    pgdc_reset(&cursor, pg, 0);
+    for (uint32_t i = 0; i != slots; i++) {
+        STORAGE_POINT sp = {};
+        ASSERT_TRUE(pgdc_get_next_point(&cursor, i, &sp));
+        EXPECT_EQ(sp.sum, (NETDATA_DOUBLE) expected[i].sum_value);
+    }
+
+    pgd_free(pg_disk);
+    pgd_free(pg);
+}
+
+TEST(PGD, GorillaTier1Compressible) {
+    gorilla_tier1_roundtrip(24, true);
+    gorilla_tier1_roundtrip(128, true);
+}
+
+TEST(PGD, GorillaTier1Incompressible) {
+    gorilla_tier1_roundtrip(24, false);
+    gorilla_tier1_roundtrip(128, false);
+}
+
+static void expect_page_points(PGD *pg, uint32_t points) {
+    ASSERT_EQ(pgd_slots_used(pg), points);
+
+    PGDC cursor;
+    pgdc_reset(&cursor, pg, 0);
+
+    for (uint32_t i = 0; i != points; i++) {
+        STORAGE_POINT sp = {};
+        ASSERT_TRUE(pgdc_get_next_point(&cursor, i, &sp));
+        EXPECT_EQ(static_cast<uint32_t>(sp.min), i);
+    }
+}
+
+// pages are replicated with pgd_serialize(), which must work on pages at any
+// state, any number of times, without preparing them for flushing
+static void serialize_roundtrip(uint8_t type, uint32_t slots, uint32_t points) {
+    PGD *pg = pgd_create(type, slots);
+    for (uint32_t i = 0; i != points; i++)
+        pgd_append_point(pg, i, i, 0, 0, 1, 0, SN_DEFAULT_FLAGS, i);
+
+    std::vector<uint8_t> buffer(1024 * 1024);
+
+    // a collected page
+    uint32_t size = pgd_serialize(pg, &buffer[0], buffer.size());
+    ASSERT_NE(size, 0u);
+    EXPECT_EQ(pgd_serialize(pg, &buffer[0], buffer.size()), size);
+    EXPECT_EQ(pgd_serialize(pg, &buffer[0], size - 1), 0u);
+
+    PGD *pg_disk = pgd_create_from_disk_data(type, &buffer[0], size);
+    expect_page_points(pg_disk, points);
+
+    // a page loaded from disk, serialized twice, unaligned like in extents
+    uint32_t memory = pgd_memory_footprint(pg_disk);
+    for (int i = 0; i != 2; i++) {
+        std::vector<uint8_t> copy(size + 1);
+        ASSERT_EQ(pgd_serialize(pg_disk, &copy[1], size), size);
+
+        PGD *pg_copy = pgd_create_from_disk_data(type, &copy[1], size);
+        expect_page_points(pg_copy, points);
+        pgd_free(pg_copy);
+    }
+    EXPECT_EQ(pgd_memory_footprint(pg_disk), memory);
+    expect_page_points(pg_disk, points);
+
+    // the collected page can still be flushed, and serialized after that
+    EXPECT_EQ(pgd_disk_footprint(pg), size);
+    std::vector<uint8_t> extent(size);
+    pgd_copy_to_extent(pg, &extent[0], size);
+    EXPECT_EQ(pgd_serialize(pg, &buffer[0], buffer.size()), size);
+
+    pgd_free(pg_disk);
+    pgd_free(pg);
+}
+
+TEST(PGD, SerializeArray) {
+    serialize_roundtrip(RRDENG_PAGE_TYPE_ARRAY_32BIT, 1024, 1024);
+    serialize_roundtrip(RRDENG_PAGE_TYPE_ARRAY_32BIT, 1024, 100);
+}
+
+TEST(PGD, SerializeGorilla) {
+    serialize_roundtrip(RRDENG_PAGE_TYPE_GORILLA_32BIT, 1024, 1024);
+    serialize_roundtrip(RRDENG_PAGE_TYPE_GORILLA_32BIT, 64 * 1024, 64 * 1024);
+}
+
+TEST(PGD, SerializeUnsupported) {
+    std::vector<uint8_t> buffer(1024);
+    EXPECT_EQ(pgd_serialize(NULL, &buffer[0], buffer.size()), 0u);
+    EXPECT_EQ(pgd_serialize(PGD_EMPTY, &buffer[0], buffer.size()), 0u);
+
+    PGD *pg = pgd_create(RRDENG_PAGE_TYPE_ARRAY_TIER1, 10);
+    pgd_append_point(pg, 0, 1, 1, 1, 1, 0, SN_DEFAULT_FLAGS, 0);
+    EXPECT_EQ(pgd_serialize(pg, &buffer[0], buffer.size()), 0u);
+    pgd_free(pg);
+}
+
 int pgd_test(int argc, char *argv[])
 {
     // Dummy/necessary initialization stuff
@@ -387,7 +566,7 @@ int pgd_test(int argc, char *argv[])
     ::testing::InitGoogleTest(&argc, argv);
     int rc = RUN_ALL_TESTS();
 
-    pgc_destroy(dummy_cache);
+    pgc_destroy(dummy_cache, false);
 
     return rc;
 }
@@ -42,8 +42,11 @@ static void main_cache_flush_dirty_page_callback(PGC *cache __maybe_unused, PGC_
         descr->update_every_s = entries_array[Index].update_every_s;
 
         descr->pgd = pgc_page_data(pages_array[Index]);
-        descr->type = pgd_type(descr->pgd);
+
+        // gorilla tier1 pages that do not compress are stored as arrays,
+        // so the disk type is known after the disk footprint
         descr->page_length = pgd_disk_footprint(descr->pgd);
+        descr->type = pgd_disk_type(descr->pgd);
 
         DOUBLE_LINKED_LIST_APPEND_ITEM_UNSAFE(base, descr, link.prev, link.next);
     }
@@ -680,7 +683,8 @@ static ALWAYS_INLINE_HOT Pvoid_t get_page_list(
         usec_t end_time_ut,
         time_t *optimal_end_time_s,
         size_t *pages_to_load_from_disk,
-        PDC_PAGE_STATUS *common_status
+        PDC_PAGE_STATUS *common_status,
+        QUERY_SOURCE source
 ) {
     *optimal_end_time_s = 0;
     *pages_to_load_from_disk = 0;
@@ -797,6 +801,12 @@ we_are_done:
     __atomic_add_fetch(&rrdeng_cache_efficiency_stats.pages_to_load_from_disk, *pages_to_load_from_disk, __ATOMIC_RELAXED);
     __atomic_add_fetch(&rrdeng_cache_efficiency_stats.pages_overlapping_skipped, pages_overlapping, __ATOMIC_RELAXED);
 
+    if(source < QUERY_SOURCE_MAX) {
+        __atomic_add_fetch(&rrdeng_cache_efficiency_stats.query_sources[source].pages_total, pages_total, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&rrdeng_cache_efficiency_stats.query_sources[source].pages_from_main_cache,
+                           pages_found_in_main_cache + pages_found_pass4, __ATOMIC_RELAXED);
+    }
+
     return JudyL_page_array;
 }
 
@@ -818,7 +828,8 @@ ALWAYS_INLINE_HOT void rrdeng_prep_query(struct page_details_control *pdc, bool
                                                  pdc->end_time_s * USEC_PER_SEC,
                                                  &pdc->optimal_end_time_s,
                                                  &pdc->pages_to_load_from_disk,
-                                                 &pdc->common_status);
+                                                 &pdc->common_status,
+                                                 pdc->source);
 
     internal_fatal(pdc->pages_to_load_from_disk && !(pdc->common_status & PDC_PAGE_DISK_PENDING),
                    "DBENGINE: PDC reports there are %zu pages to load from disk, "
@@ -875,6 +886,7 @@ ALWAYS_INLINE_HOT void pg_cache_preload(struct rrdeng_query_handle *handle) {
     handle->pdc->start_time_s = handle->start_time_s;
     handle->pdc->end_time_s = handle->end_time_s;
     handle->pdc->priority = handle->priority;
+    handle->pdc->source = handle->source;
     handle->pdc->optimal_end_time_s = handle->end_time_s;
     handle->pdc->ctx = handle->ctx;
     handle->pdc->refcount = 1;
@@ -1150,7 +1162,7 @@ void pgc_and_mrg_initialize(void)
             pgc_max_evictors(),
             1000,
             1,
-            PGC_OPTIONS_AUTOSCALE | PGC_OPTIONS_EVICT_PAGES_NO_INLINE,
+            PGC_OPTIONS_AUTOSCALE | PGC_OPTIONS_EVICT_PAGES_NO_INLINE | PGC_OPTIONS_SCAN_RESISTANT,
             0,
             0
     );
@@ -15,6 +15,13 @@ struct extent_page_details_list {
     struct rrdeng_cmd *cmd;
     bool head_to_datafile_extent_queries_pending_for_extent;
 
+    struct {
+        DBENGINE_URING *ur;                         // the io_uring batch reading this extent
+        uint8_t slot;
+    } uring;
+
+    struct extent_page_details_list *route_next;    // used by the router to collect the extents of a pdc
+
     struct {
         struct extent_page_details_list *prev;
         struct extent_page_details_list *next;
@@ -560,6 +567,46 @@ static ALWAYS_INLINE void epdl_pending_del(EPDL *epdl) {
     spinlock_unlock(&e->spinlock);
 }
 
+// read with io_uring all the extents of a pdc that are not already in the extent cache
+static void epdl_submit_uring_reads(struct rrdengine_instance *ctx, EPDL *route_first) {
+    if(!route_first || !dbengine_uring_available())
+        return;
+
+    DBENGINE_URING *ur = NULL;
+    for(EPDL *epdl = route_first; epdl ; epdl = epdl->route_next) {
+        epdl->uring.ur = NULL;
+        epdl->uring.slot = DBENGINE_URING_NO_SLOT;
+
+        PGC_PAGE *extent_cache_page = pgc_page_get_and_acquire(
+            extent_cache, (Word_t)ctx,
+            (Word_t)epdl->datafile->fileno, (time_t)epdl->extent_offset,
+            PGC_SEARCH_EXACT);
+
+        if(extent_cache_page) {
+            pgc_page_release(extent_cache, extent_cache_page);
+            continue;
+        }
+
+        if(!ur) {
+            ur = dbengine_uring_batch_get();
+            if(!ur)
+                // no ring available, the workers will read the extents
+                return;
+        }
+
+        uint8_t slot = dbengine_uring_batch_add(ur, epdl->file, epdl->extent_offset, epdl->extent_size);
+        if(slot == DBENGINE_URING_NO_SLOT)
+            // the batch is full, the workers will read the rest
+            break;
+
+        epdl->uring.ur = ur;
+        epdl->uring.slot = slot;
+    }
+
+    if(ur)
+        dbengine_uring_batch_submit(ur);
+}
+
 ALWAYS_INLINE_HOT void pdc_to_epdl_router(struct rrdengine_instance *ctx, PDC *pdc, execute_extent_page_details_list_t exec_first_extent_list, execute_extent_page_details_list_t exec_rest_extent_list)
 {
     Pvoid_t *PValue;
@@ -628,7 +675,7 @@ ALWAYS_INLINE_HOT void pdc_to_epdl_router(struct rrdengine_instance *ctx, PDC *p
             *pd_pptr = pd;
         }
 
-        size_t extent_list_no = 0;
+        EPDL *route_first = NULL, *route_last = NULL;
         Word_t datafile_no = 0;
         first_then_next = true;
         while((PValue = PDCJudyLFirstThenNext(JudyL_datafile_list, &datafile_no, &first_then_next))) {
@@ -648,16 +695,32 @@ ALWAYS_INLINE_HOT void pdc_to_epdl_router(struct rrdengine_instance *ctx, PDC *p
                 epdl->pdc = pdc;
 
                 if(epdl_pending_add(epdl)) {
-                    if (extent_list_no++ == 0)
-                        exec_first_extent_list(ctx, epdl, pdc->priority);
+                    epdl->route_next = NULL;
+                    if(route_last)
+                        route_last->route_next = epdl;
                     else
-                        exec_rest_extent_list(ctx, epdl, pdc->priority);
+                        route_first = epdl;
+                    route_last = epdl;
                 }
             }
             PDCJudyLFreeArray(&deol->extent_pd_list_by_extent_offset_JudyL, PJE0);
             deol_release(deol);
         }
         PDCJudyLFreeArray(&JudyL_datafile_list, PJE0);
+
+        // submit all the reads at once, before any extent is processed
+        epdl_submit_uring_reads(ctx, route_first);
+
+        size_t extent_list_no = 0;
+        for(EPDL *ep = route_first, *next = NULL; ep ; ep = next) {
+            // the extent may be processed and freed by the time exec returns
+            next = ep->route_next;
+
+            if (extent_list_no++ == 0)
+                exec_first_extent_list(ctx, ep, pdc->priority);
+            else
+                exec_rest_extent_list(ctx, ep, pdc->priority);
+        }
     }
 
     pdc_release_and_destroy_if_unreferenced(pdc, true, true);
@@ -707,6 +770,7 @@ ALWAYS_INLINE VALIDATED_PAGE_DESCRIPTOR validate_extent_page_descr(const struct
             entries = 0;
             break;
         case RRDENG_PAGE_TYPE_GORILLA_32BIT:
+        case RRDENG_PAGE_TYPE_GORILLA_TIER1:
             end_time_s = start_time_s + descr->gorilla.delta_time_s;
             entries = descr->gorilla.entries;
             break;
@@ -853,6 +917,13 @@ VALIDATED_PAGE_DESCRIPTOR validate_page(
             internal_fatal(entries == 0, "0 number of entries found on gorilla page");
             vd.entries = entries;
             break;
+        case RRDENG_PAGE_TYPE_GORILLA_TIER1:
+            // collected pages are raw arrays until they are flushed,
+            // so the number of entries can also be calculated by size
+            vd.entries = entries ? entries : page_entries_by_size(vd.page_length, vd.point_size);
+            if(!entries)
+                entries = vd.entries;
+            break;
         default:
             known_page_type = false;
             break;
@@ -977,6 +1048,7 @@ static void epdl_extent_loading_error_log(struct rrdengine_instance *ctx, EPDL *
                 end_time_s = (time_t)(descr->end_time_ut / USEC_PER_SEC);
                 break;
             case RRDENG_PAGE_TYPE_GORILLA_32BIT:
+            case RRDENG_PAGE_TYPE_GORILLA_TIER1:
                 end_time_s = (time_t) start_time_s + (descr->gorilla.delta_time_s);
                 break;
         }
@@ -1296,6 +1368,7 @@ static inline void *datafile_extent_read(struct rrdengine_instance *ctx, uv_file
         ctx_io_read_op_bytes(ctx, real_io_size);
 
     uv_fs_req_cleanup(&request);
+    __atomic_add_fetch(&rrdeng_cache_efficiency_stats.extent_reads_sync, 1, __ATOMIC_RELAXED);
 
     return buffer;
 }
@@ -1304,6 +1377,41 @@ static inline void datafile_extent_read_free(void *buffer) {
     posix_memalign_freez(buffer);
 }
 
+static inline void epdl_uring_release(EPDL *epdl) {
+    if(epdl->uring.ur) {
+        dbengine_uring_slot_release(epdl->uring.ur, epdl->uring.slot);
+        epdl->uring.ur = NULL;
+        epdl->uring.slot = DBENGINE_URING_NO_SLOT;
+    }
+}
+
+// get the extent from the io_uring read submitted by the router, or read it now
+static inline void *epdl_extent_read(struct rrdengine_instance *ctx, EPDL *epdl) {
+    void *extent_data = NULL;
+
+    if(epdl->uring.ur) {
+        void *buffer = dbengine_uring_slot_wait(epdl->uring.ur, epdl->uring.slot, epdl->extent_size);
+        if(buffer) {
+            extent_data = dbengine_extent_alloc(epdl->extent_size);
+            memcpy(extent_data, buffer, epdl->extent_size);
+            ctx_io_read_op_bytes(ctx, ALIGN_BYTES_CEILING(epdl->extent_size));
+        }
+        epdl_uring_release(epdl);
+
+        if(extent_data)
+            return extent_data;
+    }
+
+    void *buffer = datafile_extent_read(ctx, epdl->file, epdl->extent_offset, epdl->extent_size);
+    if(buffer) {
+        extent_data = dbengine_extent_alloc(epdl->extent_size);
+        memcpy(extent_data, buffer, epdl->extent_size);
+        datafile_extent_read_free(buffer);
+    }
+
+    return extent_data;
+}
+
 NOT_INLINE_HOT void epdl_find_extent_and_populate_pages(struct rrdengine_instance *ctx, EPDL *epdl, bool worker) {
     if(worker)
         worker_is_busy(UV_EVENT_DBENGINE_EXTENT_CACHE_LOOKUP);
@@ -1351,14 +1459,8 @@ NOT_INLINE_HOT void epdl_find_extent_and_populate_pages(struct rrdengine_instanc
         if(worker)
             worker_is_busy(UV_EVENT_DBENGINE_EXTENT_MMAP);
 
-        void *extent_data = datafile_extent_read(ctx, epdl->file, epdl->extent_offset, epdl->extent_size);
+        void *extent_data = epdl_extent_read(ctx, epdl);
         if(extent_data != NULL) {
-
-            void *tmp = dbengine_extent_alloc(epdl->extent_size);
-            memcpy(tmp, extent_data, epdl->extent_size);
-            datafile_extent_read_free(extent_data);
-            extent_data = tmp;
-
             if(worker)
                 worker_is_busy(UV_EVENT_DBENGINE_EXTENT_CACHE_LOOKUP);
 
@@ -1413,6 +1515,10 @@ NOT_INLINE_HOT void epdl_find_extent_and_populate_pages(struct rrdengine_instanc
         pgc_page_release(extent_cache, extent_cache_page);
 
 cleanup:
+    // the extent was found in cache or the query was cancelled,
+    // but an io_uring read may still be in flight for it
+    epdl_uring_release(epdl);
+
     // remove it from the datafile extent_queries
     // this can be called multiple times safely
     epdl_pending_del(epdl);
@@ -43,7 +43,26 @@ struct rrdeng_df_sb {
 #define RRDENG_PAGE_TYPE_ARRAY_32BIT    (0)
 #define RRDENG_PAGE_TYPE_ARRAY_TIER1    (1)
 #define RRDENG_PAGE_TYPE_GORILLA_32BIT  (2)
-#define RRDENG_PAGE_TYPE_MAX            (2) // Maximum page type (inclusive)
+#define RRDENG_PAGE_TYPE_GORILLA_TIER1  (3)
+#define RRDENG_PAGE_TYPE_MAX            (3) // Maximum page type (inclusive)
+
+/*
+ * Gorilla tier1 page header
+ *
+ * The points of a GORILLA_TIER1 page are stored column-wise, each column
+ * being a gorilla stream: sum, min and max are XOR encoded, count and
+ * anomaly_count are delta-of-delta encoded. The columns follow the header
+ * back to back, as an array of 32-bit words.
+ */
+
+#define RRDENG_GORILLA_TIER1_COLUMNS (5)
+
+struct rrdeng_gorilla_tier1_header {
+    uint16_t entries;
+    uint16_t nbits;
+    uint16_t column_start_bit[RRDENG_GORILLA_TIER1_COLUMNS];
+    uint16_t reserved;
+} __attribute__ ((packed));
 
 /*
  * Data file page descriptor
@@ -55,6 +74,7 @@ struct rrdeng_extent_page_descr {
     uint32_t page_length;
     uint64_t start_time_ut;
     union {
+        // used by GORILLA_32BIT and GORILLA_TIER1 pages
         struct {
             uint32_t entries;
             uint32_t delta_time_s;
@@ -890,6 +890,7 @@ datafile_extent_build(struct rrdengine_instance *ctx, struct page_descr_with_dat
                 header->descr[i].end_time_ut = descr->end_time_ut;
                 break;
             case RRDENG_PAGE_TYPE_GORILLA_32BIT:
+            case RRDENG_PAGE_TYPE_GORILLA_TIER1:
                 header->descr[i].gorilla.delta_time_s = (uint32_t) ((descr->end_time_ut - descr->start_time_ut) / USEC_PER_SEC);
                 header->descr[i].gorilla.entries = pgd_slots_used(descr->pgd);
                 break;
@@ -1570,6 +1571,9 @@ static void *populate_mrg_tp_worker(
     size_t thread_index = 0;
     int rc;
 
+    // the datafiles found in the snapshot do not need their journals now
+    mrg_snapshot_load(main_mrg, ctx, max_threads);
+
     uv_rwlock_rdlock(&ctx->datafiles.rwlock);
 
     size_t total_datafiles = 0;
@@ -1706,10 +1710,30 @@ static void *populate_mrg_tp_worker(
 
     } while (threads_still_running);
 
+    __atomic_store_n(&ctx->loading.mrg_populated, true, __ATOMIC_RELEASE);
+    ctx->loading.mrg_snapshot_last_s = now_monotonic_sec();
+    mrg_snapshot_reconcile_start(ctx);
+
     worker_is_idle();
     return data;
 }
 
+static void after_mrg_snapshot(struct rrdengine_instance *ctx __maybe_unused, void *data __maybe_unused, struct completion *completion __maybe_unused, uv_work_t* req __maybe_unused, int status __maybe_unused) {
+    ;
+}
+
+static void *mrg_snapshot_tp_worker(struct rrdengine_instance *ctx, void *data __maybe_unused, struct completion *completion __maybe_unused, uv_work_t *uv_work_req __maybe_unused) {
+    if(!spinlock_trylock(&ctx->loading.mrg_snapshot_spinlock))
+        return data;
+
+    worker_is_busy(UV_EVENT_DBENGINE_MRG_SNAPSHOT);
+    if(ctx_is_available_for_queries(ctx))
+        mrg_snapshot_save(main_mrg, ctx);
+
+    spinlock_unlock(&ctx->loading.mrg_snapshot_spinlock);
+    return data;
+}
+
 static void after_ctx_shutdown(struct rrdengine_instance *ctx __maybe_unused, void *data __maybe_unused, struct completion *completion __maybe_unused, uv_work_t* req __maybe_unused, int status __maybe_unused) {
     ;
 }
@@ -1728,6 +1752,11 @@ static void *ctx_shutdown_tp_worker(struct rrdengine_instance *ctx __maybe_unuse
         sleep_usec(1 * USEC_PER_MS);
     }
 
+    // nothing is flushed any more, the retention in the MRG is final
+    spinlock_lock(&ctx->loading.mrg_snapshot_spinlock);
+    mrg_snapshot_save(main_mrg, ctx);
+    spinlock_unlock(&ctx->loading.mrg_snapshot_spinlock);
+
     completion_mark_complete(completion);
 
     return data;
@@ -2026,6 +2055,12 @@ static void *cleanup_tp_worker(struct rrdengine_instance *ctx __maybe_unused, vo
     return data;
 }
 
+static void *tier_rollup_tp_worker(struct rrdengine_instance *ctx __maybe_unused, void *data, struct completion *completion __maybe_unused, uv_work_t *uv_work_req __maybe_unused) {
+    worker_is_busy(UV_EVENT_DBENGINE_TIER_ROLLUP);
+    dbengine_rollup_drain(data);
+    return data;
+}
+
 uint64_t rrdeng_get_used_disk_space(struct rrdengine_instance *ctx, bool having_lock)
 {
     uint64_t active_space = 0;
@@ -2112,6 +2147,13 @@ static void retention_timer_cb(uv_timer_t *handle) {
         if (!eng || eng->seb != STORAGE_ENGINE_BACKEND_DBENGINE)
             continue;
         check_and_schedule_db_rotation(multidb_ctx[tier]);
+
+        struct rrdengine_instance *ctx = multidb_ctx[tier];
+        if(dbengine_mrg_snapshot_every_s && __atomic_load_n(&ctx->loading.mrg_populated, __ATOMIC_ACQUIRE) &&
+            now_monotonic_sec() - ctx->loading.mrg_snapshot_last_s >= dbengine_mrg_snapshot_every_s) {
+            ctx->loading.mrg_snapshot_last_s = now_monotonic_sec();
+            rrdeng_enq_cmd(ctx, RRDENG_OPCODE_CTX_MRG_SNAPSHOT, NULL, NULL, STORAGE_PRIORITY_INTERNAL_DBENGINE, NULL, NULL);
+        }
     }
 
     worker_is_idle();
@@ -2150,6 +2192,7 @@ static void dbengine_initialize_structures(void) {
     page_descriptors_init();
     extent_buffer_init();
     extent_io_descriptor_init();
+    dbengine_rollup_init();
 }
 
 bool rrdeng_dbengine_spawn(struct rrdengine_instance *ctx __maybe_unused) {
@@ -2297,7 +2340,9 @@ void dbengine_event_loop(void* arg) {
     worker_register_job_name(RRDENG_OPCODE_CTX_FLUSH_DIRTY,                          "ctx flush dirty");
     worker_register_job_name(RRDENG_OPCODE_CTX_FLUSH_HOT_DIRTY,                      "ctx flush all");
     worker_register_job_name(RRDENG_OPCODE_CTX_QUIESCE,                              "ctx quiesce");
+    worker_register_job_name(RRDENG_OPCODE_CTX_MRG_SNAPSHOT,                         "ctx mrg snapshot");
     worker_register_job_name(RRDENG_OPCODE_SHUTDOWN_EVLOOP,                          "dbengine shutdown");
+    worker_register_job_name(RRDENG_OPCODE_TIER_ROLLUP,                              "tier rollup");
 
     worker_register_job_name(RRDENG_OPCODE_MAX,                                      "get opcode");
 
@@ -2311,6 +2356,7 @@ void dbengine_event_loop(void* arg) {
     worker_register_job_name(RRDENG_OPCODE_MAX + RRDENG_OPCODE_CTX_SHUTDOWN,         "ctx shutdown cb");
     worker_register_job_name(RRDENG_OPCODE_MAX + RRDENG_OPCODE_CTX_FLUSH_DIRTY,      "ctx flush dirty cb");
     worker_register_job_name(RRDENG_OPCODE_MAX + RRDENG_OPCODE_CTX_QUIESCE,          "ctx quiesce cb");
+    worker_register_job_name(RRDENG_OPCODE_MAX + RRDENG_OPCODE_CTX_MRG_SNAPSHOT,     "ctx mrg snapshot cb");
 
     // special jobs
     worker_register_job_name(RRDENG_RETENTION_TIMER_CB,                              "retention timer");
@@ -2417,6 +2463,11 @@ void dbengine_event_loop(void* arg) {
                     break;
                 }
 
+                case RRDENG_OPCODE_TIER_ROLLUP: {
+                    work_dispatch(NULL, cmd.data, NULL, opcode, tier_rollup_tp_worker, NULL);
+                    break;
+                }
+
                 case RRDENG_OPCODE_JOURNAL_INDEX: {
                     struct rrdengine_instance *ctx = cmd.ctx;
                     struct rrdengine_datafile *datafile = cmd.data;
@@ -2448,6 +2499,12 @@ void dbengine_event_loop(void* arg) {
                     break;
                 }
 
+                case RRDENG_OPCODE_CTX_MRG_SNAPSHOT: {
+                    struct rrdengine_instance *ctx = cmd.ctx;
+                    work_dispatch(ctx, NULL, NULL, opcode, mrg_snapshot_tp_worker, after_mrg_snapshot);
+                    break;
+                }
+
                 case RRDENG_OPCODE_CTX_FLUSH_DIRTY: {
                     struct rrdengine_instance *ctx = cmd.ctx;
                     work_dispatch(ctx, NULL, NULL, opcode,
@@ -19,6 +19,8 @@
 #include "cache.h"
 #include "pdc.h"
 #include "page.h"
+#include "dbengine-uring.h"
+#include "dbengine-rollup.h"
 
 #include "daemon/protected-access.h"
 
@@ -127,6 +129,7 @@ typedef struct page_details_control {
     time_t start_time_s;
     time_t end_time_s;
     STORAGE_PRIORITY priority;
+    QUERY_SOURCE source;
 
     time_t optimal_end_time_s;
 } PDC;
@@ -234,6 +237,10 @@ struct rrdeng_collect_handle {
     usec_t page_start_time_ut;
     usec_t page_end_time_ut;
     usec_t update_every_ut;
+
+    STORAGE_ROLLUP_CB rollup_cb;              // when set, the completed pages are rolled up asynchronously
+    void *rollup_data;
+    uint32_t rollup_pending;                  // atomic, the pages queued for rollup
 };
 
 struct rrdeng_query_handle {
@@ -247,6 +254,7 @@ struct rrdeng_query_handle {
     time_t start_time_s;
     time_t end_time_s;
     STORAGE_PRIORITY priority;
+    QUERY_SOURCE source;
 
     // internal data
     time_t now_s;
@@ -283,8 +291,10 @@ enum rrdeng_opcode {
     RRDENG_OPCODE_CTX_FLUSH_HOT_DIRTY,
     RRDENG_OPCODE_CTX_QUIESCE,
     RRDENG_OPCODE_CTX_POPULATE_MRG,
+    RRDENG_OPCODE_CTX_MRG_SNAPSHOT,
     RRDENG_OPCODE_SHUTDOWN_EVLOOP,
     RRDENG_OPCODE_CLEANUP,
+    RRDENG_OPCODE_TIER_ROLLUP,
 
     RRDENG_OPCODE_MAX
 };
@@ -438,6 +448,11 @@ struct rrdengine_instance {
     struct {
         struct completion load_mrg;
         bool create_new_datafile_pair;
+
+        bool mrg_populated;                         // the MRG has the retention of all the datafiles
+        SPINLOCK mrg_snapshot_spinlock;             // one snapshot at a time
+        time_t mrg_snapshot_last_s;
+        ND_THREAD *mrg_reconcile_thread;
     } loading;
 
     struct rrdengine_statistics stats;
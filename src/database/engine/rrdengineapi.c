@@ -19,10 +19,10 @@ struct rrdengine_instance multidb_ctx_storage_tier4 = { 0 };
 struct rrdengine_instance *multidb_ctx[RRD_STORAGE_TIERS] = { 0 };
 uint8_t tier_page_type[RRD_STORAGE_TIERS] = {
     RRDENG_PAGE_TYPE_GORILLA_32BIT,
-    RRDENG_PAGE_TYPE_ARRAY_TIER1,
-    RRDENG_PAGE_TYPE_ARRAY_TIER1,
-    RRDENG_PAGE_TYPE_ARRAY_TIER1,
-    RRDENG_PAGE_TYPE_ARRAY_TIER1};
+    RRDENG_PAGE_TYPE_GORILLA_TIER1,
+    RRDENG_PAGE_TYPE_GORILLA_TIER1,
+    RRDENG_PAGE_TYPE_GORILLA_TIER1,
+    RRDENG_PAGE_TYPE_GORILLA_TIER1};
 
 #if defined(ENV32BIT)
 size_t tier_page_size[RRD_STORAGE_TIERS] = {2048, 1024, 192, 192, 192};
@@ -32,14 +32,15 @@ size_t tier_page_size[RRD_STORAGE_TIERS] = {4096, 2048, 384, 384, 384};
 size_t tier_quota_mb[RRD_STORAGE_TIERS] = {1024, 1024, 1024, 128, 64};
 #endif
 
-#if RRDENG_PAGE_TYPE_MAX != 2
-#error PAGE_TYPE_MAX is not 2 - you need to add allocations here
+#if RRDENG_PAGE_TYPE_MAX != 3
+#error PAGE_TYPE_MAX is not 3 - you need to add allocations here
 #endif
 
 size_t page_type_size[256] = {
         [RRDENG_PAGE_TYPE_ARRAY_32BIT] = sizeof(storage_number),
         [RRDENG_PAGE_TYPE_ARRAY_TIER1] = sizeof(storage_number_tier1_t),
-        [RRDENG_PAGE_TYPE_GORILLA_32BIT] = sizeof(storage_number)
+        [RRDENG_PAGE_TYPE_GORILLA_32BIT] = sizeof(storage_number),
+        [RRDENG_PAGE_TYPE_GORILLA_TIER1] = sizeof(storage_number_tier1_t),
 };
 
 static inline void initialize_single_ctx(struct rrdengine_instance *ctx) {
@@ -339,6 +340,9 @@ void rrdeng_store_metric_flush_current_page(STORAGE_COLLECT_HANDLE *sch) {
             __atomic_add_fetch(&ctx->atomic.samples, add_samples, __ATOMIC_RELAXED);
         }
 
+        if(handle->rollup_cb)
+            dbengine_rollup_queue_page(handle, handle->pgc_page);
+
         pgc_page_hot_to_dirty_and_release(main_cache, handle->pgc_page, false);
     }
 
@@ -475,6 +479,7 @@ static PGD *rrdeng_alloc_new_page_data(struct rrdeng_collect_handle *handle, use
         case RRDENG_PAGE_TYPE_ARRAY_32BIT:
         case RRDENG_PAGE_TYPE_ARRAY_TIER1:
         case RRDENG_PAGE_TYPE_GORILLA_32BIT:
+        case RRDENG_PAGE_TYPE_GORILLA_TIER1:
             d = pgd_create(ctx->config.page_type, slots);
             break;
         default:
@@ -663,6 +668,9 @@ int rrdeng_store_metric_finalize(STORAGE_COLLECT_HANDLE *sch) {
     rrdeng_store_metric_flush_current_page(sch);
     rrdeng_page_alignment_release(handle->alignment);
 
+    // the rollup jobs reference the handle
+    dbengine_rollup_wait(handle);
+
     __atomic_sub_fetch(&ctx->atomic.collectors_running, 1, __ATOMIC_RELAXED);
 
 #ifdef NETDATA_INTERNAL_CHECKS
@@ -699,6 +707,21 @@ void rrdeng_store_metric_change_collection_frequency(STORAGE_COLLECT_HANDLE *sch
     rrdeng_store_metric_flush_current_page(sch);
     mrg_metric_set_update_every(main_mrg, metric, update_every);
     handle->update_every_ut = update_every_ut;
+
+    // the higher tiers have to switch frequency after the old pages are rolled up
+    dbengine_rollup_wait(handle);
+}
+
+// Derive the higher tiers from the completed pages of this handle, in the background.
+// The callback gets the points of every page, in order, while the handle is alive.
+void rrdeng_store_metric_set_rollup(STORAGE_COLLECT_HANDLE *sch, STORAGE_ROLLUP_CB cb, void *data) {
+    struct rrdeng_collect_handle *handle = (struct rrdeng_collect_handle *)sch;
+
+    // pages completed before this call are not rolled up
+    dbengine_rollup_wait(handle);
+
+    handle->rollup_data = data;
+    handle->rollup_cb = cb;
 }
 
 // ----------------------------------------------------------------------------
@@ -738,7 +761,8 @@ ALWAYS_INLINE_HOT void rrdeng_load_metric_init(
     struct storage_engine_query_handle *seqh,
     time_t start_time_s,
     time_t end_time_s,
-    STORAGE_PRIORITY priority)
+    STORAGE_PRIORITY priority,
+    QUERY_SOURCE source)
 {
     usec_t started_ut = now_monotonic_usec();
 
@@ -757,6 +781,7 @@ ALWAYS_INLINE_HOT void rrdeng_load_metric_init(
     handle->ctx = ctx;
     handle->metric = metric;
     handle->priority = priority;
+    handle->source = source;
 
     // IMPORTANT!
     // It is crucial not to exceed the db boundaries, because dbengine
@@ -908,6 +933,149 @@ prepare_for_next_iteration:
     return sp;
 }
 
+// Fills up to `max` points into `points`, with the same semantics as calling
+// rrdeng_load_metric_next() that many times, but decoding the points of the
+// current page in one go. A batch never crosses a page boundary and never goes
+// past the end of the query, so it may return fewer points than requested.
+ALWAYS_INLINE_HOT size_t rrdeng_load_metric_next_batch(struct storage_engine_query_handle *seqh, STORAGE_POINT *points, size_t max) {
+    struct rrdeng_query_handle *handle = (struct rrdeng_query_handle *)seqh->handle;
+    size_t filled = 0;
+
+    while(filled < max && handle->now_s <= seqh->end_time_s) {
+        if (unlikely(!handle->page || handle->position >= handle->entries)) {
+            if(filled)
+                break;
+
+            // let the single point path load the next page
+            points[filled++] = rrdeng_load_metric_next(seqh);
+            continue;
+        }
+
+        size_t n = MIN(max - filled, handle->entries - handle->position);
+        if(likely(handle->dt_s > 0)) {
+            size_t till_end = (size_t)((seqh->end_time_s - handle->now_s) / handle->dt_s) + 1;
+            if(n > till_end)
+                n = till_end;
+        }
+
+        STORAGE_POINT *sp = &points[filled];
+        time_t now_s = handle->now_s;
+        for(size_t i = 0; i < n ; i++, now_s += handle->dt_s) {
+            sp[i].start_time_s = now_s - handle->dt_s;
+            sp[i].end_time_s = now_s;
+        }
+
+        size_t decoded = pgdc_get_next_points(&handle->pgdc, handle->position, sp, n);
+        for(size_t i = decoded; i < n ; i++)
+            storage_point_empty(sp[i], sp[i].start_time_s, sp[i].end_time_s);
+
+        handle->now_s = now_s;
+        handle->position += n;
+        filled += n;
+    }
+
+    return filled;
+}
+
+// Copies the next page of the query in its on-disk format, when the next point
+// of the query is the first point of the page, the page is not collected anymore
+// and it ends at or before before_s. The query continues after the page.
+// Otherwise it returns 0 and the query continues with the next point, as usual.
+size_t rrdeng_load_metric_next_page(struct storage_engine_query_handle *seqh, time_t before_s, STORAGE_PAGE *page, void *dst, size_t dst_size) {
+    struct rrdeng_query_handle *handle = (struct rrdeng_query_handle *)seqh->handle;
+
+    if (unlikely(handle->now_s > seqh->end_time_s))
+        return 0;
+
+    if (!handle->page || handle->position >= handle->entries) {
+        if (!rrdeng_load_page_next(seqh, false))
+            return 0;
+    }
+
+    if (handle->position != 0 || pgc_is_page_hot(handle->page))
+        return 0;
+
+    time_t page_start_time_s = pgc_page_start_time_s(handle->page);
+    time_t page_end_time_s = pgc_page_end_time_s(handle->page);
+    if (page_end_time_s > seqh->end_time_s || page_end_time_s > before_s || !handle->dt_s)
+        return 0;
+
+    // the page is shared with queries and the flushing of the cache, so it must not be altered
+    PGD *pgd = pgc_page_data(handle->page);
+    uint32_t size = pgd_serialize(pgd, dst, (uint32_t)MIN(dst_size, (size_t)UINT32_MAX));
+    if (!size)
+        return 0;
+
+    page->type = (uint8_t)pgd_type(pgd);
+    page->update_every_s = handle->dt_s;
+    page->entries = handle->entries;
+    page->first_time_s = page_start_time_s;
+    page->last_time_s = page_end_time_s;
+
+    // the next point is the first point after the page
+    handle->now_s = page_end_time_s + handle->dt_s;
+    handle->position = handle->entries;
+
+    return size;
+}
+
+// Decodes a page copied by rrdeng_load_metric_next_page(), giving its points to
+// the callback in batches. Only the tier 0 page types are accepted.
+bool rrdeng_page_points(const STORAGE_PAGE *page, void *data, size_t size, STORAGE_PAGE_POINTS_CB cb, void *cb_data) {
+    if (!page->entries || !page->update_every_s || !size || size > UINT32_MAX ||
+        page->last_time_s != page->first_time_s + (time_t)(page->entries - 1) * (time_t)page->update_every_s)
+        return false;
+
+    switch (page->type) {
+        case RRDENG_PAGE_TYPE_ARRAY_32BIT:
+            if (size != page->entries * sizeof(storage_number))
+                return false;
+            break;
+
+        case RRDENG_PAGE_TYPE_GORILLA_32BIT:
+            if (size % RRDENG_GORILLA_32BIT_BUFFER_SIZE)
+                return false;
+            break;
+
+        default:
+            return false;
+    }
+
+    PGD *pgd = pgd_create_from_disk_data(page->type, data, (uint32_t)size);
+    if (pgd == PGD_EMPTY)
+        return false;
+
+    if (pgd_slots_used(pgd) < page->entries) {
+        pgd_free(pgd);
+        return false;
+    }
+
+    STORAGE_POINT sp[256];
+    time_t now_s = page->first_time_s;
+
+    PGDC cursor;
+    pgdc_reset(&cursor, pgd, 0);
+
+    for (uint32_t position = 0; position < page->entries; ) {
+        size_t n = MIN(sizeof(sp) / sizeof(sp[0]), (size_t)(page->entries - position));
+
+        for (size_t i = 0; i < n; i++, now_s += page->update_every_s) {
+            sp[i].start_time_s = now_s - page->update_every_s;
+            sp[i].end_time_s = now_s;
+        }
+
+        size_t decoded = pgdc_get_next_points(&cursor, position, sp, n);
+        for (size_t i = decoded; i < n; i++)
+            storage_point_empty(sp[i], sp[i].start_time_s, sp[i].end_time_s);
+
+        cb(cb_data, sp, n);
+        position += n;
+    }
+
+    pgd_free(pgd);
+    return true;
+}
+
 ALWAYS_INLINE int rrdeng_load_metric_is_finished(struct storage_engine_query_handle *seqh) {
     struct rrdeng_query_handle *handle = (struct rrdeng_query_handle *)seqh->handle;
     return (handle->now_s > seqh->end_time_s);
@@ -1237,6 +1405,8 @@ int rrdeng_exit(struct rrdengine_instance *ctx) {
         count--;
     }
 
+    mrg_snapshot_reconcile_stop(ctx);
+
     pgc_flush_all_hot_and_dirty_pages(main_cache, (Word_t)ctx);
 
     struct completion completion = {};
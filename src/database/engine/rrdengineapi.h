@@ -51,8 +51,11 @@ void rrdeng_store_metric_next(STORAGE_COLLECT_HANDLE *sch, usec_t point_in_time_
 int rrdeng_store_metric_finalize(STORAGE_COLLECT_HANDLE *sch);
 
 void rrdeng_load_metric_init(STORAGE_METRIC_HANDLE *smh, struct storage_engine_query_handle *seqh,
-                                    time_t start_time_s, time_t end_time_s, STORAGE_PRIORITY priority);
+                                    time_t start_time_s, time_t end_time_s, STORAGE_PRIORITY priority, QUERY_SOURCE source);
 STORAGE_POINT rrdeng_load_metric_next(struct storage_engine_query_handle *seqh);
+size_t rrdeng_load_metric_next_batch(struct storage_engine_query_handle *seqh, STORAGE_POINT *points, size_t max);
+size_t rrdeng_load_metric_next_page(struct storage_engine_query_handle *seqh, time_t before_s, STORAGE_PAGE *page, void *dst, size_t dst_size);
+bool rrdeng_page_points(const STORAGE_PAGE *page, void *data, size_t size, STORAGE_PAGE_POINTS_CB cb, void *cb_data);
 
 
 int rrdeng_load_metric_is_finished(struct storage_engine_query_handle *seqh);
@@ -188,6 +191,14 @@ struct rrdeng_cache_efficiency_stats {
     PAD64(size_t) pages_load_fail_invalid_extent;
     PAD64(size_t) pages_load_fail_cancelled;
 
+    // extent reads
+    PAD64(size_t) extent_reads_sync;
+    PAD64(size_t) extent_reads_uring_batches;
+    PAD64(size_t) extent_reads_uring_submitted;
+    PAD64(size_t) extent_reads_uring_in_flight;
+    PAD64(size_t) extent_reads_uring_failed;
+    PAD64(struct time_and_count) extent_reads_uring_latency;
+
     // count of queries and times spent in them
     PAD64(struct time_and_count) prep_time_to_route_sync;
     PAD64(struct time_and_count) prep_time_to_route_syncfirst;
@@ -197,6 +208,12 @@ struct rrdeng_cache_efficiency_stats {
     PAD64(struct time_and_count) prep_time_in_journal_v2_lookup;
     PAD64(struct time_and_count) prep_time_in_pass4_lookup;
 
+    // main cache efficiency per query source
+    struct {
+        PAD64(size_t) pages_total;
+        PAD64(size_t) pages_from_main_cache;
+    } query_sources[QUERY_SOURCE_MAX];
+
     // timings the query thread experiences
     PAD64(struct time_and_count) query_time_init;
     PAD64(struct time_and_count) query_time_wait_for_prep;
@@ -378,7 +378,7 @@ static inline time_t rrddim_slot2time(STORAGE_METRIC_HANDLE *smh, size_t slot) {
 // ----------------------------------------------------------------------------
 // RRDDIM legacy database query functions
 
-void rrddim_query_init(STORAGE_METRIC_HANDLE *smh, struct storage_engine_query_handle *seqh, time_t start_time_s, time_t end_time_s, STORAGE_PRIORITY priority __maybe_unused) {
+void rrddim_query_init(STORAGE_METRIC_HANDLE *smh, struct storage_engine_query_handle *seqh, time_t start_time_s, time_t end_time_s, STORAGE_PRIORITY priority __maybe_unused, QUERY_SOURCE source __maybe_unused) {
     struct mem_metric_handle *mh = (struct mem_metric_handle *)smh;
 
     check_metric_handle_from_rrddim(mh);
@@ -448,6 +448,16 @@ ALWAYS_INLINE STORAGE_POINT rrddim_query_next_metric(struct storage_engine_query
     return sp;
 }
 
+size_t rrddim_query_next_metric_batch(struct storage_engine_query_handle *seqh, STORAGE_POINT *points, size_t max) {
+    struct mem_query_handle *h = (struct mem_query_handle*)seqh->handle;
+    size_t filled = 0;
+
+    while(filled < max && h->next_timestamp <= seqh->end_time_s)
+        points[filled++] = rrddim_query_next_metric(seqh);
+
+    return filled;
+}
+
 int rrddim_query_is_finished(struct storage_engine_query_handle *seqh) {
     struct mem_query_handle *h = (struct mem_query_handle*)seqh->handle;
     return (h->next_timestamp > seqh->end_time_s);
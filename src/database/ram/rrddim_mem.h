@@ -46,8 +46,9 @@ void rrddim_collect_store_metric(STORAGE_COLLECT_HANDLE *sch, usec_t point_in_ti
 void rrddim_store_metric_flush(STORAGE_COLLECT_HANDLE *sch);
 int rrddim_collect_finalize(STORAGE_COLLECT_HANDLE *sch);
 
-void rrddim_query_init(STORAGE_METRIC_HANDLE *smh, struct storage_engine_query_handle *seqh, time_t start_time_s, time_t end_time_s, STORAGE_PRIORITY priority);
+void rrddim_query_init(STORAGE_METRIC_HANDLE *smh, struct storage_engine_query_handle *seqh, time_t start_time_s, time_t end_time_s, STORAGE_PRIORITY priority, QUERY_SOURCE source);
 STORAGE_POINT rrddim_query_next_metric(struct storage_engine_query_handle *seqh);
+size_t rrddim_query_next_metric_batch(struct storage_engine_query_handle *seqh, STORAGE_POINT *points, size_t max);
 int rrddim_query_is_finished(struct storage_engine_query_handle *seqh);
 void rrddim_query_finalize(struct storage_engine_query_handle *seqh);
 time_t rrddim_query_latest_time_s(STORAGE_METRIC_HANDLE *smh);
@@ -22,18 +22,6 @@ struct ml_metrics_statistics {
 
 // --------------------------------------------------------------------------------------------------------------------
 
-typedef enum __attribute__ ((__packed__)) {
-    QUERY_SOURCE_UNKNOWN = 0,
-    QUERY_SOURCE_API_DATA,
-    QUERY_SOURCE_API_BADGE,
-    QUERY_SOURCE_API_WEIGHTS,
-    QUERY_SOURCE_HEALTH,
-    QUERY_SOURCE_ML,
-    QUERY_SOURCE_UNITTEST,
-} QUERY_SOURCE;
-
-// --------------------------------------------------------------------------------------------------------------------
-
 typedef struct rrdcalc RRDCALC;
 typedef struct alarm_entry ALARM_ENTRY;
 typedef struct rrdvar_acquired RRDVAR_ACQUIRED;
@@ -80,6 +80,9 @@ void store_metric_at_tier(RRDDIM *rd, size_t tier, struct rrddim_tier *t, STORAG
         t->next_point_end_time_s = tier_next_point_time_s(rd, t, sp.end_time_s);
     }
 
+    if (likely(sp.end_time_s > t->aggregated_until_s))
+        __atomic_store_n(&t->aggregated_until_s, sp.end_time_s, __ATOMIC_RELAXED);
+
     // merge the dates into our virtual point
     if (unlikely(sp.start_time_s < t->virtual_point.start_time_s))
         t->virtual_point.start_time_s = sp.start_time_s;
@@ -107,6 +110,56 @@ void store_metric_at_tier(RRDDIM *rd, size_t tier, struct rrddim_tier *t, STORAG
     }
 }
 
+// ----------------------------------------------------------------------------
+// asynchronous rollup of the higher tiers
+// when enabled, the collector stores only tier 0 and the dbengine gives us back
+// the points of every completed tier 0 page, from its workers, to aggregate them
+// into the higher tiers - so the higher tiers lag by up to one tier 0 page
+
+static void rrddim_async_tier_rollup_cb(void *data, STORAGE_POINT *points, size_t entries) {
+    RRDDIM *rd = data;
+
+    for(size_t tier = 1; tier < nd_profile.storage_tiers; tier++) {
+        struct rrddim_tier *t = &rd->tiers[tier];
+
+        spinlock_lock(&t->spinlock);
+
+        if(likely(t->sch)) {
+            for(size_t i = 0; i < entries; i++) {
+                // skip the points backfilled already
+                if(likely(points[i].end_time_s > t->aggregated_until_s))
+                    store_metric_at_tier(rd, tier, t, points[i], points[i].end_time_s * USEC_PER_SEC);
+            }
+        }
+
+        spinlock_unlock(&t->spinlock);
+    }
+
+    store_metric_collection_completed();
+}
+
+void rrddim_async_tier_rollup_enable(RRDDIM *rd) {
+    if(!dbengine_async_tier_rollup || nd_profile.storage_tiers < 2)
+        return;
+
+    if(storage_engine_store_set_rollup(rd->tiers[0].sch, rrddim_async_tier_rollup_cb, rd))
+        rrddim_option_set(rd, RRDDIM_OPTION_ASYNC_TIER_ROLLUP);
+    else
+        rrddim_option_clear(rd, RRDDIM_OPTION_ASYNC_TIER_ROLLUP);
+}
+
+// the data of a tier are complete up to this time
+// later points are still being aggregated, or have not been rolled up yet
+time_t rrddim_tier_aggregated_until_s(RRDDIM *rd, size_t tier) {
+    time_t until_s = __atomic_load_n(&rd->tiers[tier].aggregated_until_s, __ATOMIC_RELAXED);
+    time_t granularity = (time_t)rd->tiers[tier].tier_grouping * (time_t)rd->rrdset->update_every;
+
+    if(granularity > 0)
+        until_s -= until_s % granularity;
+
+    return until_s;
+}
+
 NOT_INLINE_HOT
 #ifdef NETDATA_LOG_COLLECTION_ERRORS
 void rrddim_store_metric_with_trace(RRDDIM *rd, usec_t point_end_time_ut, NETDATA_DOUBLE n, SN_FLAGS flags, const char *function) {
@@ -155,31 +208,46 @@ void rrddim_store_metric(RRDDIM *rd, usec_t point_end_time_ut, NETDATA_DOUBLE n,
 
     time_t now_s = (time_t)(point_end_time_ut / USEC_PER_SEC);
 
-    STORAGE_POINT sp = {
-        .start_time_s = now_s - rd->rrdset->update_every,
-        .end_time_s = now_s,
-        .min = n,
-        .max = n,
-        .sum = n,
-        .count = 1,
-        .anomaly_count = (flags & SN_FLAG_NOT_ANOMALOUS) ? 0 : 1,
-        .flags = flags
-    };
-
-    for(size_t tier = 1; tier < nd_profile.storage_tiers;tier++) {
-        if(unlikely(!rd->tiers[tier].smh)) continue;
-
-        struct rrddim_tier *t = &rd->tiers[tier];
-
-        if(!rrddim_option_check(rd, RRDDIM_OPTION_BACKFILLED_HIGH_TIERS)) {
-            // we have not collected this tier before
-            // let's fill any gap that may exist
-            backfill_tier_from_smaller_tiers(rd, tier, now_s);
+    if(rrddim_option_check(rd, RRDDIM_OPTION_ASYNC_TIER_ROLLUP)) {
+        // the dbengine will roll up this point, when its page is completed
+        if(unlikely(!rrddim_option_check(rd, RRDDIM_OPTION_BACKFILLED_HIGH_TIERS))) {
+            for(size_t tier = 1; tier < nd_profile.storage_tiers; tier++) {
+                if(unlikely(!rd->tiers[tier].smh)) continue;
+
+                spinlock_lock(&rd->tiers[tier].spinlock);
+                backfill_tier_from_smaller_tiers(rd, tier, now_s);
+                spinlock_unlock(&rd->tiers[tier].spinlock);
+            }
+            rrddim_option_set(rd, RRDDIM_OPTION_BACKFILLED_HIGH_TIERS);
         }
-
-        store_metric_at_tier(rd, tier, t, sp, point_end_time_ut);
     }
-    rrddim_option_set(rd, RRDDIM_OPTION_BACKFILLED_HIGH_TIERS);
+    else {
+        STORAGE_POINT sp = {
+            .start_time_s = now_s - rd->rrdset->update_every,
+            .end_time_s = now_s,
+            .min = n,
+            .max = n,
+            .sum = n,
+            .count = 1,
+            .anomaly_count = (flags & SN_FLAG_NOT_ANOMALOUS) ? 0 : 1,
+            .flags = flags
+        };
+
+        for(size_t tier = 1; tier < nd_profile.storage_tiers;tier++) {
+            if(unlikely(!rd->tiers[tier].smh)) continue;
+
+            struct rrddim_tier *t = &rd->tiers[tier];
+
+            if(!rrddim_option_check(rd, RRDDIM_OPTION_BACKFILLED_HIGH_TIERS)) {
+                // we have not collected this tier before
+                // let's fill any gap that may exist
+                backfill_tier_from_smaller_tiers(rd, tier, now_s);
+            }
+
+            store_metric_at_tier(rd, tier, t, sp, point_end_time_ut);
+        }
+        rrddim_option_set(rd, RRDDIM_OPTION_BACKFILLED_HIGH_TIERS);
+    }
 
     rrdcontext_collected_rrddim(rd);
     log_stack_pop(&lgs);
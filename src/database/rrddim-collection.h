@@ -17,4 +17,7 @@ void rrddim_store_metric(RRDDIM *rd, usec_t point_end_time_ut, NETDATA_DOUBLE n,
 
 void store_metric_at_tier_flush_last_completed(RRDDIM *rd, size_t tier, struct rrddim_tier *t);
 
+void rrddim_async_tier_rollup_enable(RRDDIM *rd);
+time_t rrddim_tier_aggregated_until_s(RRDDIM *rd, size_t tier);
+
 #endif //NETDATA_RRDDIM_COLLECTION_H
@@ -43,6 +43,8 @@ static void rrddim_reinitialize_collection(RRDDIM *rd) {
             rd->tiers[tier].sch =
                 storage_metric_store_init(rd->tiers[tier].seb, rd->tiers[tier].smh, st->rrdhost->db[tier].tier_grouping * st->update_every, rd->rrdset->smg[tier]);
     }
+
+    rrddim_async_tier_rollup_enable(rd);
 }
 
 static void rrddim_insert_callback(const DICTIONARY_ITEM *item __maybe_unused, void *rrddim, void *constructor_data) {
@@ -52,6 +54,7 @@ static void rrddim_insert_callback(const DICTIONARY_ITEM *item __maybe_unused, v
     RRDHOST *host = st->rrdhost;
 
     spinlock_init(&rd->destroy_lock);
+    spinlock_init(&rd->prometheus.spinlock);
 
     rd->flags = RRDDIM_FLAG_NONE;
 
@@ -141,6 +144,8 @@ static void rrddim_insert_callback(const DICTIONARY_ITEM *item __maybe_unused, v
 
         if(!initialized)
             netdata_log_error("Failed to initialize data collection for all db tiers for chart '%s', dimension '%s", rrdset_name(st), rrddim_name(rd));
+
+        rrddim_async_tier_rollup_enable(rd);
     }
 
     if(rrdset_number_of_dimensions(st) != 0) {
@@ -227,6 +232,8 @@ static void rrddim_delete_callback(const DICTIONARY_ITEM *item __maybe_unused, v
 
     ml_dimension_delete(rd);
 
+    prometheus_series_cache_free(&rd->prometheus.cache);
+
     netdata_log_debug(D_RRD_CALLS, "rrddim_free() %s.%s", rrdset_name(st), rrddim_name(rd));
 
     if (!rrddim_finalize_collection_and_check_retention(rd) && rd->rrd_memory_mode == RRD_DB_MODE_DBENGINE) {
@@ -27,6 +27,7 @@ typedef enum __attribute__ ((__packed__)) rrddim_options {
     RRDDIM_OPTION_DONT_DETECT_RESETS_OR_OVERFLOWS   = (1 << 1), // do not offer RESET or OVERFLOW info to callers
     RRDDIM_OPTION_BACKFILLED_HIGH_TIERS             = (1 << 2), // when set, we have backfilled higher tiers
     RRDDIM_OPTION_UPDATED                           = (1 << 3), // single-threaded collector updated flag
+    RRDDIM_OPTION_ASYNC_TIER_ROLLUP                 = (1 << 4), // the higher tiers are derived from the completed tier 0 pages
 
     // this is 8-bit
 } RRDDIM_OPTIONS;
@@ -111,6 +112,14 @@ struct rrddim {
         } snd;
     } stream;
 
+    // ------------------------------------------------------------------------
+    // exporting
+
+    struct {
+        SPINLOCK spinlock;
+        struct prometheus_series_cache *cache;      // the pre-rendered series of the dimension, for /api/v1/allmetrics
+    } prometheus;
+
     // ------------------------------------------------------------------------
     // data collection members
 
@@ -19,6 +19,7 @@ typedef struct rrdhost_acquired RRDHOST_ACQUIRED;
 #include "rrd-database-mode.h"
 //#include "streaming/stream-replication-tracking.h"
 #include "streaming/stream-parents.h"
+#include "streaming/stream-sender-spill.h"
 #include "streaming/stream-path.h"
 #include "storage-engine.h"
 //#include "streaming/stream-traffic-types.h"
@@ -220,6 +221,8 @@ struct rrdhost {
                 struct rrdset **array;
             } pluginsd_chart_slots;
 
+            STREAM_SPILL_APPLIED spill;             // the records of the spill of the child we have applied
+
             struct {
                 pid_t tid;
 
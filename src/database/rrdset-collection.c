@@ -11,20 +11,23 @@ time_t rrdset_set_update_every_s(RRDSET *st, time_t update_every_s) {
                    rrdset_id(st), (int)st->update_every, (int)update_every_s);
 
     time_t prev_update_every_s = (time_t) st->update_every;
-    st->update_every = (int) update_every_s;
 
     // switch update every to the storage engine
+    // this waits for the pending rollups of the old pages to the higher tiers,
+    // which need the old update every, so st->update_every is changed afterwards
     RRDDIM *rd;
     rrddim_foreach_read(rd, st) {
         for (size_t tier = 0; tier < nd_profile.storage_tiers; tier++) {
             if (rd->tiers[tier].sch)
                 storage_engine_store_change_collection_frequency(
                     rd->tiers[tier].sch,
-                    (int)(st->rrdhost->db[tier].tier_grouping * st->update_every));
+                    (int)(st->rrdhost->db[tier].tier_grouping * update_every_s));
         }
     }
     rrddim_foreach_done(rd);
 
+    st->update_every = (int) update_every_s;
+
     return prev_update_every_s;
 }
 
@@ -81,8 +84,12 @@ static void rrdset_collection_reset(RRDSET *st) {
         rd->collector.last_collected_time.tv_usec = 0;
         rd->collector.counter = 0;
 
-        for(size_t tier = 0; tier < nd_profile.storage_tiers;tier++)
+        for(size_t tier = 0; tier < nd_profile.storage_tiers;tier++) {
+            // the higher tiers may be rolled up in the background
+            spinlock_lock(&rd->tiers[tier].spinlock);
             storage_engine_store_flush(rd->tiers[tier].sch);
+            spinlock_unlock(&rd->tiers[tier].spinlock);
+        }
     }
     rrddim_foreach_done(rd);
 }
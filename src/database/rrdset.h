@@ -193,6 +193,11 @@ struct rrdset {
 
     RRDSET_FLAGS *exporting_flags;                  // array of flags for exporting connector instances
 
+    struct {
+        SPINLOCK spinlock;
+        struct prometheus_series_cache *cache;      // the pre-rendered labels of the chart, for /api/v1/allmetrics
+    } prometheus;
+
     // ------------------------------------------------------------------------
     // health monitoring members
     // TODO - they should be managed by health
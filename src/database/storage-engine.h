@@ -32,6 +32,20 @@ typedef enum __attribute__ ((__packed__)) {
     STORAGE_ENGINE_BACKEND_DBENGINE = 2,
 } STORAGE_ENGINE_BACKEND;
 
+typedef enum __attribute__ ((__packed__)) {
+    QUERY_SOURCE_UNKNOWN = 0,
+    QUERY_SOURCE_API_DATA,
+    QUERY_SOURCE_API_BADGE,
+    QUERY_SOURCE_API_WEIGHTS,
+    QUERY_SOURCE_HEALTH,
+    QUERY_SOURCE_ML,
+    QUERY_SOURCE_UNITTEST,
+    QUERY_SOURCE_REPLICATION,
+
+    // terminator
+    QUERY_SOURCE_MAX,
+} QUERY_SOURCE;
+
 #define is_valid_backend(backend) ((backend) >= STORAGE_ENGINE_BACKEND_RRDDIM && (backend) <= STORAGE_ENGINE_BACKEND_DBENGINE)
 
 // iterator state for RRD dimension data queries
@@ -56,6 +70,21 @@ typedef struct storage_collect_handle {
     STORAGE_ENGINE_BACKEND seb;
 } STORAGE_COLLECT_HANDLE;
 
+// receives the points of the completed pages of a collection handle, to derive the higher tiers from them
+typedef void (*STORAGE_ROLLUP_CB)(void *data, STORAGE_POINT *points, size_t entries);
+
+// receives the points of a page, in batches
+typedef void (*STORAGE_PAGE_POINTS_CB)(void *data, STORAGE_POINT *points, size_t entries);
+
+// a whole page of a metric, as stored by the storage engine
+typedef struct storage_page {
+    uint8_t type;                   // the page type of the storage engine
+    uint32_t update_every_s;
+    uint32_t entries;
+    time_t first_time_s;            // the end time of the first point
+    time_t last_time_s;             // the end time of the last point
+} STORAGE_PAGE;
+
 // --------------------------------------------------------------------------------------------------------------------
 // function pointers for all APIs provided by a storage engine
 
@@ -96,6 +125,7 @@ struct rrddim_tier {
     uint16_t last_completed_point_flush_modulo; // tier1/2 spread over time
     uint32_t tier_grouping;
     time_t next_point_end_time_s;
+    time_t aggregated_until_s;                  // atomic, the watermark: the end time of the last point aggregated into this tier
     STORAGE_METRIC_HANDLE *smh;    // the metric handle inside the database
     STORAGE_COLLECT_HANDLE *sch;   // the data collection handle
 };
@@ -282,6 +312,27 @@ static inline void storage_engine_store_flush(STORAGE_COLLECT_HANDLE *sch) {
 
 // --------------------------------------------------------------------------------------------------------------------
 
+void rrdeng_store_metric_set_rollup(STORAGE_COLLECT_HANDLE *sch, STORAGE_ROLLUP_CB cb, void *data);
+
+// returns false when the backend cannot roll up its completed pages in the background
+static inline bool storage_engine_store_set_rollup(STORAGE_COLLECT_HANDLE *sch, STORAGE_ROLLUP_CB cb __maybe_unused, void *data __maybe_unused) {
+    if(unlikely(!sch))
+        return false;
+
+    internal_fatal(!is_valid_backend(sch->seb), "STORAGE: invalid backend");
+
+#ifdef ENABLE_DBENGINE
+    if(likely(sch->seb == STORAGE_ENGINE_BACKEND_DBENGINE)) {
+        rrdeng_store_metric_set_rollup(sch, cb, data);
+        return true;
+    }
+#endif
+
+    return false;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+
 int rrdeng_store_metric_finalize(STORAGE_COLLECT_HANDLE *sch);
 int rrddim_collect_finalize(STORAGE_COLLECT_HANDLE *sch);
 // a finalization function to run after collection is over
@@ -351,25 +402,25 @@ static time_t storage_engine_latest_time_s(STORAGE_ENGINE_BACKEND seb __maybe_un
 
 void rrdeng_load_metric_init(
     STORAGE_METRIC_HANDLE *smh, struct storage_engine_query_handle *seqh,
-    time_t start_time_s, time_t end_time_s, STORAGE_PRIORITY priority);
+    time_t start_time_s, time_t end_time_s, STORAGE_PRIORITY priority, QUERY_SOURCE source);
 
 void rrddim_query_init(
     STORAGE_METRIC_HANDLE *smh, struct storage_engine_query_handle *seqh,
-    time_t start_time_s, time_t end_time_s, STORAGE_PRIORITY priority);
+    time_t start_time_s, time_t end_time_s, STORAGE_PRIORITY priority, QUERY_SOURCE source);
 
 ALWAYS_INLINE_HOT_FLATTEN
 static void storage_engine_query_init(
     STORAGE_ENGINE_BACKEND seb __maybe_unused,
     STORAGE_METRIC_HANDLE *smh, struct storage_engine_query_handle *seqh,
-    time_t start_time_s, time_t end_time_s, STORAGE_PRIORITY priority) {
+    time_t start_time_s, time_t end_time_s, STORAGE_PRIORITY priority, QUERY_SOURCE source) {
     internal_fatal(!is_valid_backend(seb), "STORAGE: invalid backend");
 
 #ifdef ENABLE_DBENGINE
     if(likely(seb == STORAGE_ENGINE_BACKEND_DBENGINE))
-        rrdeng_load_metric_init(smh, seqh, start_time_s, end_time_s, priority);
+        rrdeng_load_metric_init(smh, seqh, start_time_s, end_time_s, priority, source);
     else
 #endif
-        rrddim_query_init(smh, seqh, start_time_s, end_time_s, priority);
+        rrddim_query_init(smh, seqh, start_time_s, end_time_s, priority, source);
 }
 
 // --------------------------------------------------------------------------------------------------------------------
@@ -390,6 +441,54 @@ static STORAGE_POINT storage_engine_query_next_metric(struct storage_engine_quer
 
 // --------------------------------------------------------------------------------------------------------------------
 
+size_t rrdeng_load_metric_next_batch(struct storage_engine_query_handle *seqh, STORAGE_POINT *points, size_t max);
+size_t rrddim_query_next_metric_batch(struct storage_engine_query_handle *seqh, STORAGE_POINT *points, size_t max);
+
+// fill up to max points, as if storage_engine_query_next_metric() was called that many times
+// it may return fewer points (e.g. at page boundaries), and 0 only when the query is finished
+ALWAYS_INLINE_HOT_FLATTEN
+static size_t storage_engine_query_next_metric_batch(struct storage_engine_query_handle *seqh, STORAGE_POINT *points, size_t max) {
+    internal_fatal(!is_valid_backend(seqh->seb), "STORAGE: invalid backend");
+
+#ifdef ENABLE_DBENGINE
+    if(likely(seqh->seb == STORAGE_ENGINE_BACKEND_DBENGINE))
+        return rrdeng_load_metric_next_batch(seqh, points, max);
+#endif
+    return rrddim_query_next_metric_batch(seqh, points, max);
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+
+size_t rrdeng_load_metric_next_page(struct storage_engine_query_handle *seqh, time_t before_s, STORAGE_PAGE *page, void *dst, size_t dst_size);
+
+// when the next point of the query is the first point of a page that is not collected anymore
+// and the whole page ends at or before before_s, copy the page to dst and advance the query past it
+// returns the bytes copied, or 0 when the next points have to be read one by one
+ALWAYS_INLINE_HOT_FLATTEN
+static size_t storage_engine_query_next_page(struct storage_engine_query_handle *seqh, time_t before_s __maybe_unused, STORAGE_PAGE *page __maybe_unused, void *dst __maybe_unused, size_t dst_size __maybe_unused) {
+    internal_fatal(!is_valid_backend(seqh->seb), "STORAGE: invalid backend");
+
+#ifdef ENABLE_DBENGINE
+    if(likely(seqh->seb == STORAGE_ENGINE_BACKEND_DBENGINE))
+        return rrdeng_load_metric_next_page(seqh, before_s, page, dst, dst_size);
+#endif
+    return 0;
+}
+
+bool rrdeng_page_points(const STORAGE_PAGE *page, void *data, size_t size, STORAGE_PAGE_POINTS_CB cb, void *cb_data);
+
+// decode a page copied by storage_engine_query_next_page() (maybe on another agent)
+// returns false when the page is not valid
+static inline bool storage_engine_page_points(const STORAGE_PAGE *page __maybe_unused, void *data __maybe_unused, size_t size __maybe_unused, STORAGE_PAGE_POINTS_CB cb __maybe_unused, void *cb_data __maybe_unused) {
+#ifdef ENABLE_DBENGINE
+    return rrdeng_page_points(page, data, size, cb, cb_data);
+#else
+    return false;
+#endif
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+
 int rrdeng_load_metric_is_finished(struct storage_engine_query_handle *seqh);
 int rrddim_query_is_finished(struct storage_engine_query_handle *seqh);
 
@@ -273,6 +273,7 @@ inline char *prometheus_units_copy(char *d, const char *s, size_t usable, int sh
 
 struct format_prometheus_label_callback {
     struct instance *instance;
+    BUFFER *wb;
     size_t count;
 };
 
@@ -288,28 +289,37 @@ static int format_prometheus_label_callback(const char *name, const char *value,
     prometheus_label_copy(v, value, sizeof(v));
 
     if (*k && *v) {
-        if (d->count > 0) buffer_strcat(d->instance->labels_buffer, ",");
-        buffer_sprintf(d->instance->labels_buffer, "%s=\"%s\"", k, v);
+        if (d->count > 0) buffer_strcat(d->wb, ",");
+        buffer_sprintf(d->wb, "%s=\"%s\"", k, v);
         d->count++;
     }
     return 1;
 }
 
-void format_host_labels_prometheus(struct instance *instance, RRDHOST *host)
+static void format_host_labels_prometheus_to_buffer(struct instance *instance, RRDHOST *host, BUFFER *wb)
 {
     if (unlikely(!sending_labels_configured(instance)))
         return;
 
-    if (!instance->labels_buffer)
-        instance->labels_buffer = buffer_create(1024, &netdata_buffers_statistics.buffers_exporters);
-
     struct format_prometheus_label_callback tmp = {
         .instance = instance,
+        .wb = wb,
         .count = 0
     };
     rrdlabels_walkthrough_read(host->rrdlabels, format_prometheus_label_callback, &tmp);
 }
 
+void format_host_labels_prometheus(struct instance *instance, RRDHOST *host)
+{
+    if (unlikely(!sending_labels_configured(instance)))
+        return;
+
+    if (!instance->labels_buffer)
+        instance->labels_buffer = buffer_create(1024, &netdata_buffers_statistics.buffers_exporters);
+
+    format_host_labels_prometheus_to_buffer(instance, host, instance->labels_buffer);
+}
+
 /**
  * Format host labels for the Prometheus exporter
  * We are using a structure instead a direct buffer to expand options quickly.
@@ -350,8 +360,49 @@ struct host_variables_callback_options {
     struct instance *instance;
     STRING *prometheus;
     PROM_CONTEXT_OPTIONS_JudyLSet *context_options;
+    uint64_t series_key;        // identifies the options the series are rendered with
+
+    // when hosts are rendered in parallel, where HELP and TYPE have been printed
+    STRING *help_context;
+    struct prometheus_help_blocks *help_blocks;
+};
+
+// ----------------------------------------------------------------------------
+// HELP and TYPE of hosts rendered in parallel
+// When all hosts are rendered sequentially, HELP and TYPE are printed only by the
+// first host that has a context. When they are rendered in parallel, each host
+// prints them for all its contexts and keeps where it printed them, so that they
+// can be removed while merging the hosts in order.
+
+struct prometheus_help_block {
+    STRING *context;            // the host keeps it referenced in its context options
+    size_t start;
+    size_t end;
+};
+
+struct prometheus_help_blocks {
+    struct prometheus_help_block *array;
+    size_t used;
+    size_t size;
 };
 
+static void prometheus_help_block_add(struct host_variables_callback_options *opts, size_t start) {
+    struct prometheus_help_blocks *hb = opts->help_blocks;
+    if(!hb)
+        return;
+
+    if(hb->used == hb->size) {
+        hb->size = hb->size ? hb->size * 2 : 64;
+        hb->array = reallocz(hb->array, hb->size * sizeof(*hb->array));
+    }
+
+    hb->array[hb->used++] = (struct prometheus_help_block){
+        .context = opts->help_context,
+        .start = start,
+        .end = buffer_strlen(opts->wb),
+    };
+}
+
 /**
  * Print host variables.
  *
@@ -411,6 +462,7 @@ struct gen_parameters {
     const char *prefix;
     const char *labels_prefix;
     char *context;
+    char *units;
     char *suffix;
 
     char *chart;
@@ -422,6 +474,10 @@ struct gen_parameters {
     RRDSET *st;
     RRDDIM *rd;
 
+    int homogeneous;
+    uint64_t series_key;
+    STRING *chart_string;
+
     const char *relation;
     const char *type;
 };
@@ -458,41 +514,203 @@ static inline void generate_as_collected_prom_type(BUFFER *wb,
     buffer_sprintf(wb, "# TYPE %s_%s%s%s %s\n", prefix, context, units, suffix, type);
 }
 
+// ----------------------------------------------------------------------------
+// pre-rendered series
+// Sanitizing the names and rendering the labels of every series on every scrape
+// is expensive on parents with millions of series. So, each dimension keeps the
+// head of its series (name{chart="...",dimension="..."), and each chart keeps the
+// tail of the labels of its series (,family="...",<chart labels>,<instance>}),
+// rendered for the few combinations of prometheus options it is scraped with.
+// They are rendered again when the version of the chart labels, or any of the
+// strings they were rendered from (e.g. after a rename), change.
+
+#define PROMETHEUS_SERIES_CACHE_STRINGS 4
+#define PROMETHEUS_SERIES_CACHE_MAX 2           // combinations of options kept per chart and per dimension
+
+struct prometheus_series_cache {
+    uint64_t key;                               // the options it was rendered with
+    uint32_t version;                           // the version of the chart labels
+    STRING *strings[PROMETHEUS_SERIES_CACHE_STRINGS]; // the strings it was rendered from, referenced so that they are not reused
+    struct prometheus_series_cache *next;
+    size_t len;
+    char rendered[];
+};
+
+static void prometheus_series_cache_entry_free(struct prometheus_series_cache *c) {
+    for(size_t i = 0; i < PROMETHEUS_SERIES_CACHE_STRINGS ; i++)
+        string_freez(c->strings[i]);
+
+    freez(c);
+}
+
+void prometheus_series_cache_free(struct prometheus_series_cache **base) {
+    while(*base) {
+        struct prometheus_series_cache *c = *base;
+        *base = c->next;
+        prometheus_series_cache_entry_free(c);
+    }
+}
+
+// the caller has the list locked
+static struct prometheus_series_cache *prometheus_series_cache_get(
+    struct prometheus_series_cache **base, uint64_t key, uint32_t version, STRING **strings)
+{
+    for(struct prometheus_series_cache **pc = base; *pc ; pc = &(*pc)->next) {
+        struct prometheus_series_cache *c = *pc;
+        if(c->key != key)
+            continue;
+
+        if(c->version == version && !memcmp(c->strings, strings, sizeof(c->strings)))
+            return c;
+
+        // it is stale
+        *pc = c->next;
+        prometheus_series_cache_entry_free(c);
+        break;
+    }
+
+    return NULL;
+}
+
+// the caller has the list locked
+static void prometheus_series_cache_add(
+    struct prometheus_series_cache **base, uint64_t key, uint32_t version, STRING **strings, const char *rendered, size_t len)
+{
+    struct prometheus_series_cache *c = mallocz(sizeof(*c) + len + 1);
+    c->key = key;
+    c->version = version;
+    for(size_t i = 0; i < PROMETHEUS_SERIES_CACHE_STRINGS ; i++)
+        c->strings[i] = string_dup(strings[i]);
+    c->len = len;
+    memcpy(c->rendered, rendered, len);
+    c->rendered[len] = '\0';
+
+    c->next = *base;
+    *base = c;
+
+    // keep only the most recent combinations of options
+    size_t count = 1;
+    for(struct prometheus_series_cache **pc = &c->next; *pc ; ) {
+        if(++count > PROMETHEUS_SERIES_CACHE_MAX) {
+            struct prometheus_series_cache *old = *pc;
+            *pc = old->next;
+            prometheus_series_cache_entry_free(old);
+        }
+        else
+            pc = &(*pc)->next;
+    }
+}
+
 /**
- * Write an as-collected metric to a buffer.
+ * Write the name and the first labels of the series of a dimension to a buffer.
  *
- * @param wb the buffer to write the metric to.
+ * The dimension name is sanitized and the series is rendered only when the
+ * dimension has not been scraped with these options before, or it has been
+ * renamed since then.
+ *
+ * @param wb the buffer to write the series to.
  * @param p parameters for generating the metric string.
- * @param homogeneous a flag for homogeneous charts.
- * @param prometheus_collector a flag for metrics from prometheus collector.
- * @param chart_labels the dictionary with chart labels
  */
-static void generate_as_collected_from_metric(BUFFER *wb,
-                                              struct gen_parameters *p,
-                                              int homogeneous,
-                                              int prometheus_collector,
-                                              RRDLABELS *chart_labels)
+static void generate_series_head(BUFFER *wb, struct gen_parameters *p)
 {
-    buffer_strcat(wb, p->prefix);
-    buffer_putc(wb, '_');
-    buffer_strcat(wb, p->context);
+    RRDDIM *rd = p->rd;
+    RRDSET *st = p->st;
+
+    STRING *dimension = (p->output_options & PROMETHEUS_OUTPUT_NAMES && rd->name) ? rd->name : rd->id;
+    STRING *strings[PROMETHEUS_SERIES_CACHE_STRINGS] = { p->chart_string, dimension, st->context, st->units };
+
+    // the suffix is "", "_total", "_average" or "_sum"
+    uint64_t key = p->series_key ^
+                   (((uint64_t)p->homogeneous | ((uint64_t)(uint8_t)(*p->suffix ? p->suffix[1] : 0) << 1)) *
+                    0x9E3779B97F4A7C15ULL);
+
+    spinlock_lock(&rd->prometheus.spinlock);
+
+    struct prometheus_series_cache *c = prometheus_series_cache_get(&rd->prometheus.cache, key, 0, strings);
+    if(c)
+        buffer_fast_strcat(wb, c->rendered, c->len);
 
-    if (!homogeneous) {
+    else {
+        if (p->homogeneous)
+            prometheus_label_copy(p->dimension, string2str(dimension), PROMETHEUS_ELEMENT_MAX + 1);
+        else
+            prometheus_name_copy(p->dimension, string2str(dimension), PROMETHEUS_ELEMENT_MAX + 1);
+
+        size_t start = buffer_strlen(wb);
+
+        buffer_strcat(wb, p->prefix);
         buffer_putc(wb, '_');
-        buffer_strcat(wb, p->dimension);
+        buffer_strcat(wb, p->context);
+
+        if (!p->homogeneous) {
+            buffer_putc(wb, '_');
+            buffer_strcat(wb, p->dimension);
+        }
+
+        buffer_sprintf(wb, "%s%s{%schart=\"%s\"", p->units, p->suffix, p->labels_prefix, p->chart);
+
+        if (p->homogeneous)
+            buffer_sprintf(wb, ",%sdimension=\"%s\"", p->labels_prefix, p->dimension);
+
+        prometheus_series_cache_add(&rd->prometheus.cache, key, 0, strings,
+                                    &wb->buffer[start], buffer_strlen(wb) - start);
     }
 
-    buffer_sprintf(wb, "%s{%schart=\"%s\"", p->suffix, p->labels_prefix, p->chart);
+    spinlock_unlock(&rd->prometheus.spinlock);
+}
+
+/**
+ * Write the rest of the labels of the series of a chart to a buffer.
+ *
+ * The labels are rendered only when the chart has not been scraped with these
+ * options before, or its labels or family have changed since then.
+ *
+ * @param wb the buffer to write the labels to.
+ * @param p parameters for generating the metric string.
+ */
+static void generate_series_tail(BUFFER *wb, struct gen_parameters *p)
+{
+    RRDSET *st = p->st;
+
+    uint32_t version = rrdlabels_version(st->rrdlabels);
+    STRING *strings[PROMETHEUS_SERIES_CACHE_STRINGS] = { p->chart_string, st->family, NULL, NULL };
+
+    spinlock_lock(&st->prometheus.spinlock);
+
+    struct prometheus_series_cache *c = prometheus_series_cache_get(&st->prometheus.cache, p->series_key, version, strings);
+    if(c)
+        buffer_fast_strcat(wb, c->rendered, c->len);
 
-    if (homogeneous)
-        buffer_sprintf(wb, ",%sdimension=\"%s\"", p->labels_prefix, p->dimension);
+    else {
+        size_t start = buffer_strlen(wb);
 
-    buffer_sprintf(wb, ",%sfamily=\"%s\"", p->labels_prefix, p->family);
+        buffer_sprintf(wb, ",%sfamily=\"%s\"", p->labels_prefix, p->family);
+        rrdlabels_walkthrough_read(st->rrdlabels, format_prometheus_chart_label_callback, wb);
+        buffer_strcat(wb, p->labels);
+        buffer_putc(wb, '}');
 
-    rrdlabels_walkthrough_read(chart_labels, format_prometheus_chart_label_callback, wb);
+        prometheus_series_cache_add(&st->prometheus.cache, p->series_key, version, strings,
+                                    &wb->buffer[start], buffer_strlen(wb) - start);
+    }
+
+    spinlock_unlock(&st->prometheus.spinlock);
+}
 
-    buffer_strcat(wb, p->labels);
-    buffer_putc(wb, '}');
+/**
+ * Write an as-collected metric to a buffer.
+ *
+ * @param wb the buffer to write the metric to.
+ * @param p parameters for generating the metric string.
+ * @param prometheus_collector a flag for metrics from prometheus collector.
+ * @param tail the rendered tail of the series of the chart
+ */
+static void generate_as_collected_from_metric(BUFFER *wb,
+                                              struct gen_parameters *p,
+                                              int prometheus_collector,
+                                              BUFFER *tail)
+{
+    generate_series_head(wb, p);
+    buffer_fast_strcat(wb, buffer_tostring(tail), buffer_strlen(tail));
     buffer_putc(wb, ' ');
 
     if (prometheus_collector)
@@ -634,6 +852,7 @@ static int prometheus_rrdset_to_json(RRDSET *st, void *data)
                 // it is not printed for this context yet
                 ctx_opts = opts->output_options;
                 PROM_CONTEXT_OPTIONS_SET(opts->context_options, (Word_t)context_id, ctx_opts);
+                opts->help_context = context_id;
             }
             else {
                 // we have printed HELP and TYPE for this context already
@@ -666,25 +885,35 @@ static int prometheus_rrdset_to_json(RRDSET *st, void *data)
                                       output_options & PROMETHEUS_OUTPUT_OLDUNITS);
         }
 
+        char dimension[PROMETHEUS_ELEMENT_MAX + 1];
+
+        struct gen_parameters p;
+        p.prefix = prefix;
+        p.labels_prefix = plabels_prefix;
+        p.context = context;
+        p.units = units;
+        p.chart = chart;
+        p.dimension = dimension;
+        p.family = family;
+        p.labels = (char *)opts->labels;
+        p.output_options = output_options;
+        p.st = st;
+        p.homogeneous = as_collected ? homogeneous : 1;
+        p.series_key = opts->series_key;
+        p.chart_string = (output_options & PROMETHEUS_OUTPUT_NAMES && st->name) ? st->name : st->id;
+
+        // the labels following the dimension are the same for all the dimensions of the chart
+        buffer_flush(plabels_buffer);
+        generate_series_tail(plabels_buffer, &p);
+
         // for each dimension
         RRDDIM *rd;
         rrddim_foreach_read(rd, st) {
 
             if (rd->collector.counter && !rrddim_flag_check(rd, RRDDIM_FLAG_OBSOLETE)) {
-                char dimension[PROMETHEUS_ELEMENT_MAX + 1];
                 char *suffix = "";
 
-                struct gen_parameters p;
-                p.prefix = prefix;
-                p.labels_prefix = plabels_prefix;
-                p.context = context;
                 p.suffix = suffix;
-                p.chart = chart;
-                p.dimension = dimension;
-                p.family = family;
-                p.labels = (char *)opts->labels;
-                p.output_options = output_options;
-                p.st = st;
                 p.rd = rd;
 
                 if (as_collected) {
@@ -704,30 +933,16 @@ static int prometheus_rrdset_to_json(RRDSET *st, void *data)
                     }
 
                     if (opts->output_options & PROMETHEUS_OUTPUT_HELP_TYPE) {
+                        size_t help_start = buffer_strlen(wb);
                         generate_as_collected_prom_help(wb, prefix, context, units, p.suffix, st);
                         generate_as_collected_prom_type(wb, prefix, context, units, p.suffix, p.type);
+                        prometheus_help_block_add(opts, help_start);
                         opts->output_options &= ~PROMETHEUS_OUTPUT_HELP_TYPE;
                     }
 
-                    if (homogeneous) {
-                        // all the dimensions of the chart, has the same algorithm, multiplier and divisor
-                        // we add all dimensions as labels
-
-                        prometheus_label_copy(
-                            dimension,
-                            (output_options & PROMETHEUS_OUTPUT_NAMES && rd->name) ? rrddim_name(rd) : rrddim_id(rd),
-                            sizeof(dimension));
-                    }
-                    else {
-                        // the dimensions of the chart, do not have the same algorithm, multiplier or divisor
-                        // we create a metric per dimension
-
-                        prometheus_name_copy(
-                            dimension,
-                            (output_options & PROMETHEUS_OUTPUT_NAMES && rd->name) ? rrddim_name(rd) : rrddim_id(rd),
-                            sizeof(dimension));
-                    }
-                    generate_as_collected_from_metric(wb, &p, homogeneous, prometheus_collector, st->rrdlabels);
+                    // when all the dimensions of the chart have the same algorithm, multiplier and divisor,
+                    // the dimensions are added as labels, otherwise we create a metric per dimension
+                    generate_as_collected_from_metric(wb, &p, prometheus_collector, plabels_buffer);
                 }
                 else {
                     // we need average or sum of the data
@@ -742,48 +957,23 @@ static int prometheus_rrdset_to_json(RRDSET *st, void *data)
                                  == EXPORTING_SOURCE_DATA_SUM)
                             suffix = "_sum";
 
-                        prometheus_label_copy(
-                            dimension,
-                            (output_options & PROMETHEUS_OUTPUT_NAMES && rd->name) ? rrddim_name(rd) : rrddim_id(rd),
-                            sizeof(dimension));
+                        p.suffix = suffix;
 
                         if (opts->output_options & PROMETHEUS_OUTPUT_HELP_TYPE) {
+                            size_t help_start = buffer_strlen(wb);
                             generate_as_collected_prom_help(wb, prefix, context, units, suffix, st);
                             generate_as_collected_prom_type(wb, prefix, context, units, suffix, "gauge");
+                            prometheus_help_block_add(opts, help_start);
                             opts->output_options &= ~PROMETHEUS_OUTPUT_HELP_TYPE;
                         }
 
-                        buffer_flush(plabels_buffer);
-                        buffer_sprintf(plabels_buffer,
-                                       "%1$schart=\"%2$s\",%1$sdimension=\"%3$s\",%1$sfamily=\"%4$s\"",
-                                       plabels_prefix,
-                                       chart,
-                                       dimension,
-                                       family);
-                        rrdlabels_walkthrough_read(st->rrdlabels,
-                                                   format_prometheus_chart_label_callback,
-                                                   plabels_buffer);
+                        generate_series_head(wb, &p);
+                        buffer_fast_strcat(wb, buffer_tostring(plabels_buffer), buffer_strlen(plabels_buffer));
 
                         if (output_options & PROMETHEUS_OUTPUT_TIMESTAMPS)
-                            buffer_sprintf(wb,
-                                           "%s_%s%s%s{%s%s} " NETDATA_DOUBLE_FORMAT " %llu\n",
-                                           prefix,
-                                           context,
-                                           units,
-                                           suffix,
-                                           buffer_tostring(plabels_buffer),
-                                           opts->labels,
-                                           value,
-                                           last_time * MSEC_PER_SEC);
+                            buffer_sprintf(wb, " " NETDATA_DOUBLE_FORMAT " %llu\n", value, last_time * MSEC_PER_SEC);
                         else
-                            buffer_sprintf(wb, "%s_%s%s%s{%s%s} " NETDATA_DOUBLE_FORMAT "\n",
-                                           prefix,
-                                           context,
-                                           units,
-                                           suffix,
-                                           buffer_tostring(plabels_buffer),
-                                           opts->labels,
-                                           value);
+                            buffer_sprintf(wb, " " NETDATA_DOUBLE_FORMAT "\n", value);
                     }
                 }
             }
@@ -832,6 +1022,8 @@ static inline int prometheus_rrdcontext_callback(const DICTIONARY_ITEM *item, vo
  * @param exporting_options options to configure what data is exported.
  * @param allhosts set to 1 if host instance should be in the output for tags.
  * @param output_options options to configure the format of the output.
+ * @param context_options the contexts HELP and TYPE have been printed for.
+ * @param help_blocks when not NULL, where HELP and TYPE are printed in the buffer.
  */
 static void rrd_stats_api_v1_charts_allmetrics_prometheus(
     struct instance *instance,
@@ -842,14 +1034,17 @@ static void rrd_stats_api_v1_charts_allmetrics_prometheus(
     EXPORTING_OPTIONS exporting_options,
     int allhosts,
     PROMETHEUS_OUTPUT_OPTIONS output_options,
-    PROM_CONTEXT_OPTIONS_JudyLSet *context_options)
+    PROM_CONTEXT_OPTIONS_JudyLSet *context_options,
+    struct prometheus_help_blocks *help_blocks)
 {
     SIMPLE_PATTERN *filter = simple_pattern_create(filter_string, NULL, SIMPLE_PATTERN_EXACT, true);
 
     char hostname[PROMETHEUS_ELEMENT_MAX + 1];
     prometheus_label_copy(hostname, rrdhost_hostname(host), sizeof(hostname));
 
-    format_host_labels_prometheus(instance, host);
+    // the host labels are rendered to a local buffer, hosts may be rendered in parallel
+    BUFFER *plabels_buffer = buffer_create(0, NULL);
+    format_host_labels_prometheus_to_buffer(instance, host, plabels_buffer);
 
     buffer_sprintf(
         wb,
@@ -858,8 +1053,8 @@ static void rrd_stats_api_v1_charts_allmetrics_prometheus(
         rrdhost_program_name(host),
         rrdhost_program_version(host));
 
-    if (instance->labels_buffer && *buffer_tostring(instance->labels_buffer)) {
-        buffer_sprintf(wb, ",%s", buffer_tostring(instance->labels_buffer));
+    if (buffer_strlen(plabels_buffer)) {
+        buffer_sprintf(wb, ",%s", buffer_tostring(plabels_buffer));
     }
 
     if (output_options & PROMETHEUS_OUTPUT_TIMESTAMPS)
@@ -872,14 +1067,20 @@ static void rrd_stats_api_v1_charts_allmetrics_prometheus(
         snprintfz(labels, PROMETHEUS_LABELS_MAX, ",%sinstance=\"%s\"", instance->config.label_prefix, hostname);
      }
 
-    if (instance->labels_buffer)
-        buffer_flush(instance->labels_buffer);
+    buffer_flush(plabels_buffer);
 
     if (instance->config.options & EXPORTING_OPTION_SEND_AUTOMATIC_LABELS)
         prometheus_print_os_info(wb, host, output_options);
 
-
-    BUFFER *plabels_buffer = buffer_create(0, NULL);
+    // the key of the pre-rendered series of these options
+    buffer_sprintf(plabels_buffer, "%s\x1f%s\x1f%s\x1f%u\x1f%u",
+                   prefix,
+                   instance->config.label_prefix,
+                   labels,
+                   (unsigned)(output_options & (PROMETHEUS_OUTPUT_NAMES | PROMETHEUS_OUTPUT_OLDUNITS | PROMETHEUS_OUTPUT_HIDEUNITS)),
+                   (unsigned)EXPORTING_OPTIONS_DATA_SOURCE(exporting_options));
+    uint64_t series_key = XXH3_64bits(buffer_tostring(plabels_buffer), buffer_strlen(plabels_buffer));
+    buffer_flush(plabels_buffer);
 
     struct host_variables_callback_options opts = {
         .host = host,
@@ -895,6 +1096,9 @@ static void rrd_stats_api_v1_charts_allmetrics_prometheus(
         .instance = instance,
         .prometheus = string_strdupz("prometheus"),
         .context_options = context_options,
+        .series_key = series_key,
+        .help_context = NULL,
+        .help_blocks = help_blocks,
     };
 
     // send custom variables set for the host
@@ -990,11 +1194,189 @@ void rrd_stats_api_v1_charts_allmetrics_prometheus_single_host(
     PROM_CONTEXT_OPTIONS_INIT(&context_options);
 
     rrd_stats_api_v1_charts_allmetrics_prometheus(
-        prometheus_exporter_instance, host, filter_string, wb, prefix, exporting_options, 0, output_options, &context_options);
+        prometheus_exporter_instance, host, filter_string, wb, prefix, exporting_options, 0, output_options, &context_options, NULL);
 
     PROM_CONTEXT_OPTIONS_FREE(&context_options, PROM_CONTEXT_OPTIONS_free_cb, NULL);
 }
 
+// ----------------------------------------------------------------------------
+// all hosts in parallel
+// The hosts are rendered by worker threads into buffers of their own, and the
+// calling thread appends them to the response in the order of the hosts index,
+// as soon as each one completes. The workers do not render more than a window
+// of hosts ahead of the one being appended, so that the memory of a scrape is
+// bounded by the window, not by the number of hosts.
+
+int prometheus_allmetrics_threads = 1;
+
+#define PROMETHEUS_ALLMETRICS_WINDOW_PER_THREAD 2
+
+struct prometheus_host_job {
+    const DICTIONARY_ITEM *item;
+    BUFFER *wb;
+    PROM_CONTEXT_OPTIONS_JudyLSet context_options;
+    struct prometheus_help_blocks help_blocks;
+    bool done;
+};
+
+struct prometheus_allmetrics_parallel {
+    uv_mutex_t mutex;
+    uv_cond_t cond;
+
+    struct prometheus_host_job *jobs;
+    size_t count;
+    size_t next;                // the next job to be rendered
+    size_t merged;              // the jobs appended to the response
+    size_t window;
+
+    const char *filter_string;
+    const char *prefix;
+    EXPORTING_OPTIONS exporting_options;
+    PROMETHEUS_OUTPUT_OPTIONS output_options;
+};
+
+// the caller has the mutex locked, and it is unlocked while the host is rendered
+static void prometheus_host_job_render(struct prometheus_allmetrics_parallel *pp) {
+    struct prometheus_host_job *j = &pp->jobs[pp->next++];
+    uv_mutex_unlock(&pp->mutex);
+
+    rrd_stats_api_v1_charts_allmetrics_prometheus(
+        prometheus_exporter_instance, dictionary_acquired_item_value(j->item), pp->filter_string, j->wb,
+        pp->prefix, pp->exporting_options, 1, pp->output_options, &j->context_options, &j->help_blocks);
+
+    uv_mutex_lock(&pp->mutex);
+    j->done = true;
+    uv_cond_broadcast(&pp->cond);
+}
+
+static void prometheus_allmetrics_worker(void *ptr) {
+    struct prometheus_allmetrics_parallel *pp = ptr;
+
+    uv_mutex_lock(&pp->mutex);
+    while(true) {
+        while(pp->next < pp->count && pp->next >= pp->merged + pp->window)
+            uv_cond_wait(&pp->cond, &pp->mutex);
+
+        if(pp->next >= pp->count)
+            break;
+
+        prometheus_host_job_render(pp);
+    }
+    uv_mutex_unlock(&pp->mutex);
+}
+
+// the contexts of a host are added to the contexts of the hosts before it
+static void prometheus_context_options_merge_cb(Word_t index, PROMETHEUS_OUTPUT_OPTIONS options, void *data) {
+    PROM_CONTEXT_OPTIONS_JudyLSet *context_options = data;
+
+    if(PROM_CONTEXT_OPTIONS_GET(context_options, index) & PROMETHEUS_OUTPUT_HELP_TYPE)
+        string_freez((STRING *)index);
+    else
+        PROM_CONTEXT_OPTIONS_SET(context_options, index, options);
+}
+
+static void prometheus_host_job_merge(BUFFER *wb, struct prometheus_host_job *j, PROM_CONTEXT_OPTIONS_JudyLSet *context_options) {
+    const char *s = buffer_tostring(j->wb);
+    size_t pos = 0;
+
+    // skip the HELP and TYPE of the contexts the hosts before it have
+    for(size_t i = 0; i < j->help_blocks.used ; i++) {
+        struct prometheus_help_block *hb = &j->help_blocks.array[i];
+        if(PROM_CONTEXT_OPTIONS_GET(context_options, (Word_t)hb->context) & PROMETHEUS_OUTPUT_HELP_TYPE) {
+            buffer_fast_strcat(wb, &s[pos], hb->start - pos);
+            pos = hb->end;
+        }
+    }
+    buffer_fast_strcat(wb, &s[pos], buffer_strlen(j->wb) - pos);
+
+    PROM_CONTEXT_OPTIONS_FREE(&j->context_options, prometheus_context_options_merge_cb, context_options);
+
+    freez(j->help_blocks.array);
+    buffer_free(j->wb);
+    dictionary_acquired_item_release(rrdhost_root_index, j->item);
+}
+
+static void rrd_stats_api_v1_charts_allmetrics_prometheus_parallel(
+    const char *filter_string,
+    BUFFER *wb,
+    const char *prefix,
+    EXPORTING_OPTIONS exporting_options,
+    PROMETHEUS_OUTPUT_OPTIONS output_options,
+    PROM_CONTEXT_OPTIONS_JudyLSet *context_options,
+    size_t threads)
+{
+    struct prometheus_allmetrics_parallel pp = {
+        .filter_string = filter_string,
+        .prefix = prefix,
+        .exporting_options = exporting_options,
+        .output_options = output_options,
+        .window = threads * PROMETHEUS_ALLMETRICS_WINDOW_PER_THREAD,
+    };
+
+    size_t size = dictionary_entries(rrdhost_root_index) + 1;
+    pp.jobs = callocz(size, sizeof(*pp.jobs));
+
+    RRDHOST *host;
+    dfe_start_reentrant(rrdhost_root_index, host) {
+        if(pp.count == size) {
+            size *= 2;
+            pp.jobs = reallocz(pp.jobs, size * sizeof(*pp.jobs));
+        }
+
+        struct prometheus_host_job *j = &pp.jobs[pp.count++];
+        memset(j, 0, sizeof(*j));
+        j->item = dictionary_acquired_item_dup(rrdhost_root_index, host_dfe.item);
+        j->wb = buffer_create(0, NULL);
+        PROM_CONTEXT_OPTIONS_INIT(&j->context_options);
+    }
+    dfe_done(host);
+
+    if(!pp.count) {
+        freez(pp.jobs);
+        return;
+    }
+
+    if(threads > pp.count)
+        threads = pp.count;
+
+    fatal_assert(uv_mutex_init(&pp.mutex) == 0);
+    fatal_assert(uv_cond_init(&pp.cond) == 0);
+
+    ND_THREAD *workers[threads];
+    for(size_t t = 0; t < threads ; t++)
+        workers[t] = nd_thread_create("PROMALL", NETDATA_THREAD_OPTION_DONT_LOG, prometheus_allmetrics_worker, &pp);
+
+    for(size_t i = 0; i < pp.count ; i++) {
+        struct prometheus_host_job *j = &pp.jobs[i];
+
+        uv_mutex_lock(&pp.mutex);
+        while(!j->done) {
+            // render it ourselves when no worker has picked it up yet
+            if(pp.next == i)
+                prometheus_host_job_render(&pp);
+            else
+                uv_cond_wait(&pp.cond, &pp.mutex);
+        }
+        uv_mutex_unlock(&pp.mutex);
+
+        prometheus_host_job_merge(wb, j, context_options);
+
+        uv_mutex_lock(&pp.mutex);
+        pp.merged++;
+        uv_cond_broadcast(&pp.cond);
+        uv_mutex_unlock(&pp.mutex);
+    }
+
+    for(size_t t = 0; t < threads ; t++) {
+        if(workers[t])
+            nd_thread_join(workers[t]);
+    }
+
+    uv_cond_destroy(&pp.cond);
+    uv_mutex_destroy(&pp.mutex);
+    freez(pp.jobs);
+}
+
 /**
  * Write metrics and auxiliary information for all hosts to a buffer.
  *
@@ -1030,12 +1412,19 @@ void rrd_stats_api_v1_charts_allmetrics_prometheus_all_hosts(
     PROM_CONTEXT_OPTIONS_JudyLSet context_options;
     PROM_CONTEXT_OPTIONS_INIT(&context_options);
 
-    dfe_start_reentrant(rrdhost_root_index, host)
-    {
-        rrd_stats_api_v1_charts_allmetrics_prometheus(
-            prometheus_exporter_instance, host, filter_string, wb, prefix, exporting_options, 1, output_options, &context_options);
+    size_t threads = (prometheus_allmetrics_threads > 1) ? (size_t)prometheus_allmetrics_threads : 1;
+    if (threads > 1 && dictionary_entries(rrdhost_root_index) > 1)
+        rrd_stats_api_v1_charts_allmetrics_prometheus_parallel(
+            filter_string, wb, prefix, exporting_options, output_options, &context_options, threads);
+    else {
+        dfe_start_reentrant(rrdhost_root_index, host)
+        {
+            rrd_stats_api_v1_charts_allmetrics_prometheus(
+                prometheus_exporter_instance, host, filter_string, wb, prefix, exporting_options, 1, output_options,
+                &context_options, NULL);
+        }
+        dfe_done(host);
     }
-    dfe_done(host);
 
     PROM_CONTEXT_OPTIONS_FREE(&context_options, PROM_CONTEXT_OPTIONS_free_cb, NULL);
 }
@@ -9,6 +9,8 @@
 #define PROMETHEUS_LABELS_MAX   1024
 #define PROMETHEUS_VARIABLE_MAX 256
 
+extern int prometheus_allmetrics_threads;
+
 typedef enum prometheus_output_flags {
     PROMETHEUS_OUTPUT_NONE       = 0,
     PROMETHEUS_OUTPUT_HELP_TYPE  = (1 << 1),
@@ -35,4 +37,7 @@ void format_host_labels_prometheus(struct instance *instance, RRDHOST *host);
 
 void prometheus_clean_server_root();
 
+struct prometheus_series_cache;
+void prometheus_series_cache_free(struct prometheus_series_cache **base);
+
 #endif //NETDATA_EXPORTING_PROMETHEUS_H
@@ -280,6 +280,13 @@ struct engine *read_exporting_config()
 
         prometheus_exporter_instance->config.label_prefix = prometheus_config_get("netdata label prefix", "");
 
+        // the threads rendering the hosts of /api/v1/allmetrics?format=prometheus_all_hosts
+        prometheus_allmetrics_threads = (int)prometheus_config_get_number("allmetrics threads", 1);
+        if (prometheus_allmetrics_threads < 1)
+            prometheus_allmetrics_threads = 1;
+        else if ((size_t)prometheus_allmetrics_threads > netdata_conf_cpus())
+            prometheus_allmetrics_threads = (int)netdata_conf_cpus();
+
         prometheus_exporter_instance->config.initialized = 1;
     }
 
@@ -88,6 +88,11 @@ void health_load_config_defaults(void) {
                                     "postpone alarms during hibernation for",
                                     health_globals.config.postpone_alarms_during_hibernation_for_seconds);
 
+    health_globals.config.worker_threads =
+        (size_t)inicfg_get_number_range(&netdata_config, CONFIG_SECTION_HEALTH, "worker threads",
+                                        (long long)MIN(MAX(netdata_conf_cpus() / 2, 1), HEALTH_WORKER_THREADS_MAX),
+                                        1, HEALTH_WORKER_THREADS_MAX);
+
     health_globals.config.default_recipient =
         string_strdupz("root");
 
@@ -648,9 +648,187 @@ static void health_event_loop_for_host(RRDHOST *host, bool apply_hibernation_del
 }
 
 __thread bool is_health_thread = false;
+
+// ----------------------------------------------------------------------------
+// parallel evaluation of hosts
+// Every iteration, the hosts are evaluated by the main health thread and the
+// worker threads together, each host by exactly one thread. The main health thread
+// waits for all workers before starting the next iteration, so the transitions of
+// each host remain ordered. The workers are started when more than one host
+// needs to be evaluated.
+
+static struct {
+    size_t workers;                     // worker threads, excluding the main health thread
+    ND_THREAD **threads;
+
+    struct completion start;            // a job is marked for every iteration
+    struct completion done;             // a job is marked by every worker finishing an iteration
+    unsigned done_jobs;
+
+    // the current iteration
+    struct {
+        RRDHOST_ACQUIRED **array;
+        size_t used;
+        size_t size;
+        size_t next;                    // atomic, the next host to be evaluated
+    } hosts;
+
+    time_t now;
+    bool apply_hibernation_delay;
+    time_t next_run;                    // atomic, the minimum of all threads
+} health_pool = { 0 };
+
+static void health_register_workers(void) {
+    worker_register("HEALTH");
+    worker_register_job_name(WORKER_HEALTH_JOB_RRD_LOCK, "rrd lock");
+    worker_register_job_name(WORKER_HEALTH_JOB_HOST_LOCK, "host lock");
+    worker_register_job_name(WORKER_HEALTH_JOB_DB_QUERY, "db lookup");
+    worker_register_job_name(WORKER_HEALTH_JOB_CALC_EVAL, "calc eval");
+    worker_register_job_name(WORKER_HEALTH_JOB_WARNING_EVAL, "warning eval");
+    worker_register_job_name(WORKER_HEALTH_JOB_CRITICAL_EVAL, "critical eval");
+    worker_register_job_name(WORKER_HEALTH_JOB_ALARM_LOG_ENTRY, "alert log entry");
+    worker_register_job_name(WORKER_HEALTH_JOB_ALARM_LOG_PROCESS, "alert log process");
+    worker_register_job_name(WORKER_HEALTH_JOB_ALARM_LOG_QUEUE, "alert log queue");
+    worker_register_job_name(WORKER_HEALTH_JOB_WAIT_EXEC, "alert wait exec");
+    worker_register_job_name(WORKER_HEALTH_JOB_DELAYED_INIT_RRDSET, "rrdset init");
+    worker_register_job_name(WORKER_HEALTH_JOB_DELAYED_INIT_RRDDIM, "rrddim init");
+}
+
+static void health_pool_evaluate_hosts(void) {
+    time_t next_run = __atomic_load_n(&health_pool.next_run, __ATOMIC_RELAXED);
+
+    size_t i;
+    while((i = __atomic_fetch_add(&health_pool.hosts.next, 1, __ATOMIC_RELAXED)) < health_pool.hosts.used) {
+        if(unlikely(!service_running(SERVICE_HEALTH)))
+            break;
+
+        RRDHOST *host = rrdhost_acquired_to_rrdhost(health_pool.hosts.array[i]);
+        health_event_loop_for_host(host, health_pool.apply_hibernation_delay, health_pool.now, &next_run);
+    }
+
+    time_t expected = __atomic_load_n(&health_pool.next_run, __ATOMIC_RELAXED);
+    while(next_run < expected &&
+           !__atomic_compare_exchange_n(&health_pool.next_run, &expected, next_run, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        ;
+}
+
+static void health_pool_worker(void *ptr __maybe_unused) {
+    health_register_workers();
+    is_health_thread = true;
+
+    unsigned jobs = 0;
+    while(true) {
+        jobs = completion_wait_for_a_job(&health_pool.start, jobs);
+        if(completion_is_done(&health_pool.start))
+            break;
+
+        health_pool_evaluate_hosts();
+        worker_is_idle();
+
+        completion_mark_complete_a_job(&health_pool.done);
+    }
+
+    finalize_self_prepared_sql_statements();
+    worker_unregister();
+}
+
+static void health_pool_start(void) {
+    if(health_pool.threads || health_globals.config.worker_threads <= 1)
+        return;
+
+    completion_init(&health_pool.start);
+    completion_init(&health_pool.done);
+    health_pool.done_jobs = 0;
+
+    health_pool.workers = health_globals.config.worker_threads - 1;
+    health_pool.threads = callocz(health_pool.workers, sizeof(ND_THREAD *));
+
+    size_t started = 0;
+    for(size_t i = 0; i < health_pool.workers; i++) {
+        char tag[NETDATA_THREAD_TAG_MAX + 1];
+        snprintfz(tag, sizeof(tag), "HEALTH[%zu]", i);
+        health_pool.threads[started] = nd_thread_create(tag, NETDATA_THREAD_OPTION_DEFAULT, health_pool_worker, NULL);
+        if(health_pool.threads[started])
+            started++;
+    }
+
+    if(started != health_pool.workers)
+        nd_log(NDLS_DAEMON, NDLP_WARNING,
+               "HEALTH: started %zu out of %zu health worker threads", started, health_pool.workers);
+
+    health_pool.workers = started;
+
+    nd_log(NDLS_DAEMON, NDLP_DEBUG,
+           "HEALTH: evaluating hosts with %zu worker threads", health_pool.workers + 1);
+}
+
+static void health_pool_stop(void) {
+    if(!health_pool.threads)
+        return;
+
+    completion_mark_complete(&health_pool.start);
+
+    for(size_t i = 0; i < health_pool.workers; i++)
+        nd_thread_join(health_pool.threads[i]);
+
+    freez(health_pool.threads);
+    health_pool.threads = NULL;
+    health_pool.workers = 0;
+
+    completion_destroy(&health_pool.start);
+    completion_destroy(&health_pool.done);
+}
+
+// returns the number of hosts evaluated
+static size_t health_evaluate_all_hosts(bool apply_hibernation_delay, time_t now, time_t *next_run) {
+    health_pool.hosts.used = 0;
+
+    RRDHOST *host;
+    dfe_start_reentrant(rrdhost_root_index, host) {
+        if(unlikely(!rrdhost_should_run_health(host)))
+            continue;
+
+        if(health_pool.hosts.used == health_pool.hosts.size) {
+            health_pool.hosts.size = health_pool.hosts.size ? health_pool.hosts.size * 2 : 64;
+            health_pool.hosts.array = reallocz(health_pool.hosts.array, health_pool.hosts.size * sizeof(*health_pool.hosts.array));
+        }
+
+        health_pool.hosts.array[health_pool.hosts.used++] =
+            (RRDHOST_ACQUIRED *)dictionary_acquired_item_dup(rrdhost_root_index, host_dfe.item);
+    }
+    dfe_done(host);
+
+    health_pool.now = now;
+    health_pool.apply_hibernation_delay = apply_hibernation_delay;
+    health_pool.next_run = *next_run;
+    health_pool.hosts.next = 0;
+
+    if(health_pool.hosts.used > 1)
+        health_pool_start();
+
+    if(health_pool.workers && health_pool.hosts.used > 1) {
+        completion_mark_complete_a_job(&health_pool.start);
+        health_pool_evaluate_hosts();
+
+        unsigned target = health_pool.done_jobs + health_pool.workers;
+        while(health_pool.done_jobs < target)
+            health_pool.done_jobs = completion_wait_for_a_job(&health_pool.done, health_pool.done_jobs);
+    }
+    else
+        health_pool_evaluate_hosts();
+
+    *next_run = health_pool.next_run;
+
+    for(size_t i = 0; i < health_pool.hosts.used; i++)
+        rrdhost_acquired_release(health_pool.hosts.array[i]);
+
+    return health_pool.hosts.used;
+}
+
 static void health_event_loop(void) {
 
     is_health_thread = true;
+    time_t scheduled_s = 0;
     while(service_running(SERVICE_HEALTH)) {
         if(!stream_control_health_should_be_running()) {
             worker_is_idle();
@@ -684,14 +862,12 @@ static void health_event_loop(void) {
         worker_is_busy(WORKER_HEALTH_JOB_RRD_LOCK);
         uint64_t loop = __atomic_add_fetch(&health_evloop_iteration, 1, __ATOMIC_RELAXED);
 
-        RRDHOST *host;
-        dfe_start_reentrant(rrdhost_root_index, host) {
-            if(unlikely(!service_running(SERVICE_HEALTH)))
-                break;
+        // how late this iteration started, compared to when it was scheduled
+        usec_t started_ut = now_realtime_usec();
+        usec_t lag_ut = (scheduled_s && started_ut > (usec_t)scheduled_s * USEC_PER_SEC) ?
+                            started_ut - (usec_t)scheduled_s * USEC_PER_SEC : 0;
 
-            health_event_loop_for_host(host, apply_hibernation_delay, now, &next_run);
-        }
-        dfe_done(host);
+        size_t hosts = health_evaluate_all_hosts(apply_hibernation_delay, now, &next_run);
 
         if(unlikely(!service_running(SERVICE_HEALTH)))
             break;
@@ -700,9 +876,14 @@ static void health_event_loop(void) {
         worker_is_busy(WORKER_HEALTH_JOB_WAIT_EXEC);
         wait_for_all_notifications_to_finish_before_allowing_health_to_be_cleaned_up();
         worker_is_idle();
-        
+
+        pulse_health_iteration_completed(now_realtime_usec() - started_ut, lag_ut, hosts);
+
+        scheduled_s = next_run;
         health_sleep(next_run, loop);
     } // forever
+
+    health_pool_stop();
 }
 
 
@@ -718,19 +899,7 @@ static void health_main_cleanup(void *pptr) {
 }
 
 void *health_main(void *ptr) {
-    worker_register("HEALTH");
-    worker_register_job_name(WORKER_HEALTH_JOB_RRD_LOCK, "rrd lock");
-    worker_register_job_name(WORKER_HEALTH_JOB_HOST_LOCK, "host lock");
-    worker_register_job_name(WORKER_HEALTH_JOB_DB_QUERY, "db lookup");
-    worker_register_job_name(WORKER_HEALTH_JOB_CALC_EVAL, "calc eval");
-    worker_register_job_name(WORKER_HEALTH_JOB_WARNING_EVAL, "warning eval");
-    worker_register_job_name(WORKER_HEALTH_JOB_CRITICAL_EVAL, "critical eval");
-    worker_register_job_name(WORKER_HEALTH_JOB_ALARM_LOG_ENTRY, "alert log entry");
-    worker_register_job_name(WORKER_HEALTH_JOB_ALARM_LOG_PROCESS, "alert log process");
-    worker_register_job_name(WORKER_HEALTH_JOB_ALARM_LOG_QUEUE, "alert log queue");
-    worker_register_job_name(WORKER_HEALTH_JOB_WAIT_EXEC, "alert wait exec");
-    worker_register_job_name(WORKER_HEALTH_JOB_DELAYED_INIT_RRDSET, "rrdset init");
-    worker_register_job_name(WORKER_HEALTH_JOB_DELAYED_INIT_RRDDIM, "rrddim init");
+    health_register_workers();
 
     CLEANUP_FUNCTION_REGISTER(health_main_cleanup) cleanup_ptr = ptr;
     health_event_loop();
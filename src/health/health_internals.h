@@ -11,6 +11,8 @@
 
 #define HEALTH_LOG_RETENTION_DEFAULT (5 * 86400)
 
+#define HEALTH_WORKER_THREADS_MAX 16
+
 #define HEALTH_CONF_MAX_LINE 4096
 
 #define HEALTH_ALARM_KEY "alarm"
@@ -88,6 +90,8 @@ struct health_plugin_globals {
 
         int32_t run_at_least_every_seconds;
         int32_t postpone_alarms_during_hibernation_for_seconds;
+
+        size_t worker_threads;                  // the number of threads evaluating hosts in parallel
     } config;
 
     struct {
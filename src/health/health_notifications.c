@@ -4,7 +4,9 @@
 #include "health-alert-entry.h"
 
 // the queue of executed alarm notifications that haven't been waited for yet
+// hosts are evaluated in parallel, so the queue is protected by a spinlock
 static ALARM_ENTRY *alarm_notifications_in_progress = NULL;
+static SPINLOCK alarm_notifications_in_progress_spinlock = SPINLOCK_INITIALIZER;
 
 struct health_raised_summary {
     RRDHOST *host;
@@ -52,8 +54,12 @@ cleanup:
 
 void wait_for_all_notifications_to_finish_before_allowing_health_to_be_cleaned_up(void) {
     ALARM_ENTRY *ae;
-    while (NULL != (ae = alarm_notifications_in_progress)) {
-        if(unlikely(!service_running(SERVICE_HEALTH)))
+    while (true) {
+        spinlock_lock(&alarm_notifications_in_progress_spinlock);
+        ae = alarm_notifications_in_progress;
+        spinlock_unlock(&alarm_notifications_in_progress_spinlock);
+
+        if(!ae || unlikely(!service_running(SERVICE_HEALTH)))
             break;
 
         health_alarm_wait_for_execution(ae);
@@ -62,14 +68,18 @@ void wait_for_all_notifications_to_finish_before_allowing_health_to_be_cleaned_u
 
 void unlink_alarm_notify_in_progress(ALARM_ENTRY *ae)
 {
+    spinlock_lock(&alarm_notifications_in_progress_spinlock);
     fatal_assert(ae->prev_in_progress || ae->next_in_progress);
     DOUBLE_LINKED_LIST_REMOVE_ITEM_UNSAFE(alarm_notifications_in_progress, ae, prev_in_progress, next_in_progress);
+    spinlock_unlock(&alarm_notifications_in_progress_spinlock);
 }
 
 static inline void enqueue_alarm_notify_in_progress(ALARM_ENTRY *ae)
 {
+    spinlock_lock(&alarm_notifications_in_progress_spinlock);
     fatal_assert(!ae->prev_in_progress && !ae->next_in_progress);
     DOUBLE_LINKED_LIST_APPEND_ITEM_UNSAFE(alarm_notifications_in_progress, ae, prev_in_progress, next_in_progress);
+    spinlock_unlock(&alarm_notifications_in_progress_spinlock);
 }
 
 static bool prepare_command(BUFFER *wb,
@@ -63,7 +63,7 @@ typedef struct web_buffer {
     size_t *statistics;
     char *buffer;           // the buffer itself
 
-    struct {
+    struct buffer_json_state {
         char key_quote[BUFFER_QUOTE_MAX_SIZE + 1];
         char value_quote[BUFFER_QUOTE_MAX_SIZE + 1];
         int8_t depth;
@@ -149,4 +149,62 @@ static inline bool buffered_reader_next_line(struct buffered_reader *reader, BUF
     return false;
 }
 
+/* Binary frames can be mixed with text lines: a frame starts with a marker byte
+ * that never starts a text line, followed by the payload length as a 32-bit
+ * little endian number and the payload. Frames may contain newlines.
+ */
+#define BUFFERED_READER_FRAME_MARKER '\x01'
+#define BUFFERED_READER_FRAME_HEADER_SIZE (1 + sizeof(uint32_t))
+#define BUFFERED_READER_FRAME_MAX_PAYLOAD (PLUGINSD_LINE_MAX - BUFFERED_READER_FRAME_HEADER_SIZE)
+
+static inline size_t buffered_reader_frame_payload_size(const char *frame) {
+    uint32_t len;
+    memcpy(&len, &frame[1], sizeof(len));
+    return le32toh(len);
+}
+
+/* Like buffered_reader_next_line(), but also produces whole binary frames into dst.
+ * A frame is complete when dst->len == BUFFERED_READER_FRAME_HEADER_SIZE + payload size.
+ * A frame announcing more than BUFFERED_READER_FRAME_MAX_PAYLOAD bytes is returned
+ * immediately with its header only, so that the caller will reject it.
+ */
+static inline bool buffered_reader_next_frame_or_line(struct buffered_reader *reader, BUFFER *dst) {
+    bool in_frame = dst->len ? dst->buffer[0] == BUFFERED_READER_FRAME_MARKER
+                             : (reader->pos < reader->read_len && reader->read_buffer[reader->pos] == BUFFERED_READER_FRAME_MARKER);
+
+    if(likely(!in_frame))
+        return buffered_reader_next_line(reader, dst);
+
+    while(true) {
+        size_t wanted = BUFFERED_READER_FRAME_HEADER_SIZE;
+        if(dst->len >= BUFFERED_READER_FRAME_HEADER_SIZE) {
+            size_t payload = buffered_reader_frame_payload_size(dst->buffer);
+            if(unlikely(payload > BUFFERED_READER_FRAME_MAX_PAYLOAD))
+                return true;
+
+            wanted += payload;
+            if(dst->len == wanted)
+                return true;
+        }
+
+        size_t available = reader->read_len - reader->pos;
+        if(!available) {
+            reader->pos = 0;
+            reader->read_len = 0;
+            reader->read_buffer[reader->read_len] = '\0';
+            return false;
+        }
+
+        size_t bytes_to_copy = wanted - dst->len;
+        if(bytes_to_copy > available)
+            bytes_to_copy = available;
+
+        buffer_need_bytes(dst, bytes_to_copy + 1);
+        memcpy(&dst->buffer[dst->len], &reader->read_buffer[reader->pos], bytes_to_copy);
+        dst->len += bytes_to_copy;
+        dst->buffer[dst->len] = '\0';
+        reader->pos += bytes_to_copy;
+    }
+}
+
 #endif //NETDATA_BUFFERED_READER_H
@@ -170,6 +170,7 @@ struct facet_key {
     FACET_KEY_OPTIONS options;
 
     bool default_selected_for_values; // the default "selected" for all values in the dictionary
+    bool summarized;                  // it got summarized rows, since the last facets_summarized_rows()
 
     // members about the current row
     uint32_t key_found_in_row;
@@ -223,6 +224,7 @@ struct facets {
     SIMPLE_PATTERN *excluded_keys;
     SIMPLE_PATTERN *included_keys;
     bool all_keys_included_by_default;
+    bool worker;                    // created by facets_create_worker(), the patterns belong to the parent
 
     FACETS_OPTIONS options;
 
@@ -1725,9 +1727,12 @@ void facets_destroy(FACETS *facets) {
 
     dictionary_destroy(facets->accepted_params);
     FACETS_KEYS_INDEX_DESTROY(facets);
-    simple_pattern_free(facets->visible_keys);
-    simple_pattern_free(facets->included_keys);
-    simple_pattern_free(facets->excluded_keys);
+
+    if(!facets->worker) {
+        simple_pattern_free(facets->visible_keys);
+        simple_pattern_free(facets->included_keys);
+        simple_pattern_free(facets->excluded_keys);
+    }
 
     while(facets->base) {
         FACET_ROW *r = facets->base;
@@ -2120,8 +2125,8 @@ static inline FACET_ROW *facets_row_keep_seek_to_position(FACETS *facets, usec_t
     return last;
 }
 
-static void facets_row_keep_first_entry(FACETS *facets, usec_t usec) {
-    facets->operations.last_added = facets_row_create(facets, usec, NULL);
+static void facets_row_keep_first_entry(FACETS *facets, usec_t usec, FACET_ROW *row) {
+    facets->operations.last_added = row ? row : facets_row_create(facets, usec, NULL);
     DOUBLE_LINKED_LIST_APPEND_ITEM_UNSAFE(facets->base, facets->operations.last_added, prev, next);
     facets->items_to_return++;
     facets->operations.first++;
@@ -2169,12 +2174,12 @@ bool facets_row_candidate_to_keep(FACETS *facets, usec_t usec) {
             facets->items_to_return < facets->max_items_to_return;
 }
 
-static void facets_row_keep(FACETS *facets, usec_t usec) {
-    facets->operations.rows.matched++;
-
+// keep a new row for the current values of the keys, or, when row is given,
+// an existing row moved from another facets instance
+static void facets_row_keep_or_move(FACETS *facets, usec_t usec, FACET_ROW *row) {
     if(unlikely(!facets->base)) {
         // the first row to keep
-        facets_row_keep_first_entry(facets, usec);
+        facets_row_keep_first_entry(facets, usec, row);
         return;
     }
 
@@ -2190,6 +2195,7 @@ static void facets_row_keep(FACETS *facets, usec_t usec) {
                 if(closest == facets->base->prev && usec < closest->usec) {
                     // this is to the end of the list, belonging to the next page
                     facets->operations.skips_after++;
+                    if(row) facets_row_free(facets, row);
                     return;
                 }
 
@@ -2204,6 +2210,7 @@ static void facets_row_keep(FACETS *facets, usec_t usec) {
                 if(closest == facets->base && usec > closest->usec) {
                     // this is to the beginning of the list, belonging to the next page
                     facets->operations.skips_before++;
+                    if(row) facets_row_free(facets, row);
                     return;
                 }
 
@@ -2223,7 +2230,14 @@ static void facets_row_keep(FACETS *facets, usec_t usec) {
     internal_fatal(!closest, "FACETS: closest cannot be NULL");
     internal_fatal(closest == to_replace, "FACETS: closest cannot be the same as to_replace");
 
-    facets->operations.last_added = facets_row_create(facets, usec, to_replace);
+    if(row) {
+        if(to_replace)
+            facets_row_free(facets, to_replace);
+
+        facets->operations.last_added = row;
+    }
+    else
+        facets->operations.last_added = facets_row_create(facets, usec, to_replace);
 
     if(usec < closest->usec) {
         DOUBLE_LINKED_LIST_INSERT_ITEM_AFTER_UNSAFE(facets->base, closest, facets->operations.last_added, prev, next);
@@ -2340,8 +2354,10 @@ bool facets_row_finished(FACETS *facets, usec_t usec) {
         // we need to keep this row
         facets_histogram_update_value(facets, usec);
 
-        if(within_anchor)
-            facets_row_keep(facets, usec);
+        if(within_anchor) {
+            facets->operations.rows.matched++;
+            facets_row_keep_or_move(facets, usec, NULL);
+        }
     }
 
     facets_reset_keys_with_value_and_row(facets);
@@ -2349,6 +2365,293 @@ bool facets_row_finished(FACETS *facets, usec_t usec) {
     return selected_keys == total_keys;
 }
 
+// ----------------------------------------------------------------------------
+// workers and merging
+
+FACETS *facets_create_worker(FACETS *parent) {
+    FACETS *facets = callocz(1, sizeof(FACETS));
+    facets->worker = true;
+    facets->all_keys_included_by_default = parent->all_keys_included_by_default;
+    facets->options = parent->options;
+    facets->visible_keys = parent->visible_keys;
+    facets->included_keys = parent->included_keys;
+    facets->excluded_keys = parent->excluded_keys;
+    facets->query = parent->query;
+    facets->anchor = parent->anchor;
+    facets->timeframe = parent->timeframe;
+    facets->severity = parent->severity;
+    facets->max_items_to_return = parent->max_items_to_return;
+
+    facets->histogram = parent->histogram;
+    facets->histogram.key = NULL;
+    facets->histogram.chart = parent->histogram.chart ? strdupz(parent->histogram.chart) : NULL;
+
+    FACETS_KEYS_INDEX_CREATE(facets);
+
+    FACET_KEY *pk;
+    foreach_key_in_facets(parent, pk) {
+        FACET_KEY *k = FACETS_KEY_ADD_TO_INDEX(facets, pk->hash, pk->name, pk->name ? strlen(pk->name) : 0, pk->options);
+        k->options = pk->options;
+        k->order = pk->order;
+        k->default_selected_for_values = pk->default_selected_for_values;
+        k->transform = pk->transform;
+        k->dynamic = pk->dynamic;
+
+        if(pk->values.enabled) {
+            facet_key_late_init(facets, k);
+
+            // the filters
+            FACET_VALUE *pv;
+            foreach_value_in_key(pk, pv) {
+                if(!pv->selected || k->default_selected_for_values)
+                    continue;
+
+                FACET_VALUE_ADD_OR_UPDATE_SELECTED(k, pv->name, pv->hash);
+                FACET_VALUE_GET_FROM_INDEX(k, pv->hash)->rows_matching_facet_value = 0;
+            }
+            foreach_value_in_key_done(pv);
+        }
+    }
+    foreach_key_in_facets_done(pk);
+
+    facets->order = parent->order;
+    facets_rows_begin(facets);
+
+    return facets;
+}
+
+static inline FACET_VALUE *FACET_VALUE_MERGE_TO_INDEX(FACETS *facets, FACET_KEY *k, FACET_VALUE *sv) {
+    SIMPLE_HASHTABLE_SLOT_VALUE *slot = simple_hashtable_get_slot_VALUE(&k->values.ht, sv->hash, NULL, true);
+    FACET_VALUE *v = SIMPLE_HASHTABLE_SLOT_DATA(slot);
+
+    if(v) {
+        if(!v->name && sv->name) {
+            v->name = facets_value_dup(sv->name, sv->name_len);
+            v->name_len = sv->name_len;
+        }
+    }
+    else {
+        v = callocz(1, sizeof(*v));
+        simple_hashtable_set_slot_VALUE(&k->values.ht, slot, sv->hash, v);
+
+        v->hash = sv->hash;
+        v->color = sv->color;
+        v->empty = sv->empty;
+        v->unsampled = sv->unsampled;
+        v->estimated = sv->estimated;
+        v->selected = k->default_selected_for_values;
+
+        if(sv->name) {
+            v->name = facets_value_dup(sv->name, sv->name_len);
+            v->name_len = sv->name_len;
+        }
+
+        if(v->estimated || v->unsampled) {
+            if(k->values.ll && k->values.ll->estimated) {
+                FACET_VALUE *estimated = k->values.ll;
+                DOUBLE_LINKED_LIST_INSERT_ITEM_AFTER_UNSAFE(k->values.ll, estimated, v, prev, next);
+            }
+            else
+                DOUBLE_LINKED_LIST_PREPEND_ITEM_UNSAFE(k->values.ll, v, prev, next);
+        }
+        else
+            DOUBLE_LINKED_LIST_APPEND_ITEM_UNSAFE(k->values.ll, v, prev, next);
+
+        k->values.used++;
+
+        if(v->empty) k->empty_value.v = v;
+        if(v->unsampled) k->unsampled_value.v = v;
+        if(v->estimated) k->estimated_value.v = v;
+
+        facets->operations.values.inserts++;
+    }
+
+    v->rows_matching_facet_value += sv->rows_matching_facet_value;
+    v->final_facet_value_counter += sv->final_facet_value_counter;
+
+    if(sv->histogram) {
+        if(!v->histogram)
+            v->histogram = callocz(facets->histogram.slots, sizeof(*v->histogram));
+
+        for(uint32_t slot = 0; slot < facets->histogram.slots ;slot++)
+            v->histogram[slot] += sv->histogram[slot];
+    }
+
+    return v;
+}
+
+void facets_merge(FACETS *dst, FACETS *src) {
+    FACET_KEY *sk;
+    foreach_key_in_facets(src, sk) {
+        FACET_KEY *k = FACETS_KEY_GET_FROM_INDEX(dst, sk->hash);
+        if(!k)
+            k = FACETS_KEY_ADD_TO_INDEX(dst, sk->hash, sk->name, sk->name ? strlen(sk->name) : 0,
+                                        sk->options & ~(FACET_KEY_OPTION_REORDER | FACET_KEY_OPTION_REORDER_DONE));
+        else if(sk->name)
+            facet_key_set_name(k, sk->name, strlen(sk->name));
+
+        if(!sk->values.enabled)
+            continue;
+
+        facet_key_late_init(dst, k);
+        if(!k->values.enabled)
+            continue;
+
+        FACET_VALUE *sv;
+        foreach_value_in_key(sk, sv) {
+            FACET_VALUE_MERGE_TO_INDEX(dst, k, sv);
+        }
+        foreach_value_in_key_done(sv);
+
+        if(!dst->histogram.key && src->histogram.key == sk)
+            dst->histogram.key = k;
+    }
+    foreach_key_in_facets_done(sk);
+
+    // move the rows, keeping the ones of the page
+    while(src->base) {
+        FACET_ROW *row = src->base;
+        DOUBLE_LINKED_LIST_REMOVE_ITEM_UNSAFE(src->base, row, prev, next);
+        src->items_to_return--;
+
+        if(row->bin_data.data) {
+            src->operations.bin_data_inflight--;
+            dst->operations.bin_data_inflight++;
+        }
+
+        facets_row_keep_or_move(dst, row->usec, row);
+    }
+    src->operations.last_added = NULL;
+
+    dst->operations.first += src->operations.first;
+    dst->operations.forwards += src->operations.forwards;
+    dst->operations.backwards += src->operations.backwards;
+    dst->operations.skips_before += src->operations.skips_before;
+    dst->operations.skips_after += src->operations.skips_after;
+    dst->operations.prepends += src->operations.prepends;
+    dst->operations.appends += src->operations.appends;
+    dst->operations.shifts += src->operations.shifts;
+
+    dst->operations.rows.evaluated += src->operations.rows.evaluated;
+    dst->operations.rows.matched += src->operations.rows.matched;
+    dst->operations.rows.unsampled += src->operations.rows.unsampled;
+    dst->operations.rows.estimated += src->operations.rows.estimated;
+    dst->operations.rows.created += src->operations.rows.created;
+    dst->operations.rows.reused += src->operations.rows.reused;
+
+    dst->operations.values.registered += src->operations.values.registered;
+    dst->operations.values.transformed += src->operations.values.transformed;
+    dst->operations.values.dynamic += src->operations.values.dynamic;
+    dst->operations.values.empty += src->operations.values.empty;
+    dst->operations.values.unsampled += src->operations.values.unsampled;
+    dst->operations.values.estimated += src->operations.values.estimated;
+    dst->operations.values.indexed += src->operations.values.indexed;
+    dst->operations.values.conflicts += src->operations.values.conflicts;
+
+    dst->operations.fts.searches += src->operations.fts.searches;
+}
+
+// ----------------------------------------------------------------------------
+// summarized rows
+
+bool facets_histogram_slots_are_multiple_of(FACETS *facets, usec_t ut) {
+    if(!facets->histogram.enabled)
+        return true;
+
+    return ut && facets->histogram.slot_width_ut % ut == 0 && facets->histogram.after_ut % ut == 0;
+}
+
+void facets_reset_counters(FACETS *facets) {
+    FACET_KEY *k;
+    foreach_key_in_facets(facets, k) {
+        FACET_VALUE *v;
+        foreach_value_in_key(k, v) {
+            v->rows_matching_facet_value = 0;
+            v->final_facet_value_counter = 0;
+            if(v->histogram)
+                memset(v->histogram, 0, facets->histogram.slots * sizeof(*v->histogram));
+        }
+        foreach_value_in_key_done(v);
+    }
+    foreach_key_in_facets_done(k);
+
+    facets->operations.rows.evaluated = 0;
+    facets->operations.rows.matched = 0;
+    facets->operations.rows.unsampled = 0;
+    facets->operations.rows.estimated = 0;
+}
+
+static void facets_summarized_value(FACETS *facets, FACET_KEY *k, FACET_VALUE *tv, const FACETS_TIME_COUNT *histogram, size_t entries) {
+    FACET_VALUE *v = FACET_VALUE_MERGE_TO_INDEX(facets, k, tv);
+
+    if(!facets->histogram.enabled || facets->histogram.hash != k->hash)
+        return;
+
+    if(!facets->histogram.key)
+        facets->histogram.key = k;
+
+    for(size_t i = 0; i < entries ;i++) {
+        if(histogram[i].ut < facets->histogram.after_ut || histogram[i].ut > facets->histogram.before_ut)
+            continue;
+
+        uint32_t slot = facets_histogram_slot_at_time_ut(facets, histogram[i].ut, v);
+        v->histogram[slot] += histogram[i].count;
+    }
+}
+
+bool facets_summarized_key_value(FACETS *facets, const char *key, size_t key_len, const char *value, size_t value_len, size_t rows, const FACETS_TIME_COUNT *histogram, size_t entries) {
+    FACET_KEY *k = FACETS_KEY_ADD_TO_INDEX(facets, FACETS_HASH_FUNCTION(key, key_len), key, key_len, 0);
+    facet_key_late_init(facets, k);
+    if(!k->values.enabled)
+        return false;
+
+    FACET_VALUE tv = {
+        .rows_matching_facet_value = rows,
+        .final_facet_value_counter = rows,
+    };
+
+    if(value) {
+        tv.hash = FACETS_HASH_FUNCTION(value, value_len);
+        tv.name = value;
+        tv.name_len = value_len;
+    }
+    else {
+        tv.hash = FACETS_HASH_ZERO;
+        tv.name = FACET_VALUE_UNSET;
+        tv.name_len = sizeof(FACET_VALUE_UNSET) - 1;
+        tv.empty = true;
+    }
+
+    facets_summarized_value(facets, k, &tv, histogram, entries);
+    k->summarized = true;
+
+    return true;
+}
+
+void facets_summarized_rows(FACETS *facets, size_t rows, const FACETS_TIME_COUNT *histogram, size_t entries) {
+    facets->operations.rows.evaluated += rows;
+    facets->operations.rows.matched += rows;
+
+    // the facets not found in these rows, get all of them as empty
+    FACET_KEY *k;
+    foreach_key_in_facets(facets, k) {
+        if(k->values.enabled && !k->summarized && rows) {
+            FACET_VALUE tv = {
+                .hash = FACETS_HASH_ZERO,
+                .name = FACET_VALUE_UNSET,
+                .name_len = sizeof(FACET_VALUE_UNSET) - 1,
+                .empty = true,
+                .rows_matching_facet_value = rows,
+                .final_facet_value_counter = rows,
+            };
+            facets_summarized_value(facets, k, &tv, histogram, entries);
+        }
+
+        k->summarized = false;
+    }
+    foreach_key_in_facets_done(k);
+}
+
 // ----------------------------------------------------------------------------
 // output
 
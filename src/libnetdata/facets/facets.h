@@ -96,6 +96,16 @@ typedef enum __attribute__((packed)) {
 FACETS *facets_create(uint32_t items_to_return, FACETS_OPTIONS options, const char *visible_keys, const char *facet_keys, const char *non_facet_keys);
 void facets_destroy(FACETS *facets);
 
+// A facets instance with the configuration of the parent (keys, filters, anchor,
+// full text search, histogram), to be filled in parallel to it and merged back with
+// facets_merge(). The parent must outlive it and must not be modified while creating it.
+FACETS *facets_create_worker(FACETS *parent);
+
+// Add the facet values counters, the histograms and the statistics of src to dst,
+// and move to dst the rows of src that belong to the page of dst.
+// src is left without rows and it can only be destroyed.
+void facets_merge(FACETS *dst, FACETS *src);
+
 void facets_accepted_param(FACETS *facets, const char *param);
 
 void facets_rows_begin(FACETS *facets);
@@ -105,6 +115,21 @@ void facets_row_finished_unsampled(FACETS *facets, usec_t usec);
 void facets_update_estimations(FACETS *facets, usec_t from_ut, usec_t to_ut, size_t entries);
 size_t facets_histogram_slots(FACETS *facets);
 
+// Rows aggregated elsewhere can be added to the facets without processing them one by one.
+// They are counted as matching, so this is only correct when there are no filters and no
+// full text search, and the timeframe covers all of them.
+// Call facets_summarized_key_value() for each key/value (value NULL for the rows without the key)
+// and then facets_summarized_rows() with the total, to count as empty the facets not given.
+typedef struct facets_time_count {
+    usec_t ut;
+    uint32_t count;
+} FACETS_TIME_COUNT;
+
+bool facets_histogram_slots_are_multiple_of(FACETS *facets, usec_t ut);
+void facets_reset_counters(FACETS *facets);
+bool facets_summarized_key_value(FACETS *facets, const char *key, size_t key_len, const char *value, size_t value_len, size_t rows, const FACETS_TIME_COUNT *histogram, size_t entries);
+void facets_summarized_rows(FACETS *facets, size_t rows, const FACETS_TIME_COUNT *histogram, size_t entries);
+
 FACET_KEY *facets_register_key_name(FACETS *facets, const char *key, FACET_KEY_OPTIONS options);
 void facets_set_query(FACETS *facets, const char *query);
 void facets_set_items(FACETS *facets, uint32_t items);
@@ -82,6 +82,11 @@
 #define PLUGINSD_KEYWORD_JSON_CMD_STREAM_PATH   "STREAM_PATH"
 #define PLUGINSD_KEYWORD_JSON_CMD_ML_MODEL      "ML_MODEL"
 
+// the records of the spill of a sender
+#define PLUGINSD_KEYWORD_SPILL_BEGIN            "SPILL_BEGIN"
+#define PLUGINSD_KEYWORD_SPILL_END              "SPILL_END"
+#define PLUGINSD_KEYWORD_SPILL_ACK              "SPILL_ACK"
+
 typedef void (*functions_evloop_worker_execute_t)(const char *transaction, char *function, usec_t *stop_monotonic_ut,
                                                   bool *cancelled, BUFFER *payload, HTTP_ACCESS access,
                                                   const char *source, void *data);
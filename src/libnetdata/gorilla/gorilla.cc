@@ -428,6 +428,272 @@ extern "C" {
     }
 }
 
+/*
+ * Gorilla streams
+*/
+
+static inline void stream_write_bits(uint32_t *buf, uint32_t pos, uint32_t v, uint32_t nbits)
+{
+    assert(nbits > 0 && nbits <= bit_size<uint32_t>());
+
+    if (nbits < bit_size<uint32_t>())
+        v &= ((uint32_t) 1 << nbits) - 1;
+
+    const uint32_t index = pos / bit_size<uint32_t>();
+    const uint32_t offset = pos % bit_size<uint32_t>();
+
+    buf[index] |= (v << offset);
+
+    if (offset && offset + nbits > bit_size<uint32_t>())
+        buf[index + 1] |= (v >> (bit_size<uint32_t>() - offset));
+}
+
+static inline uint32_t stream_read_bits(const uint32_t *buf, uint32_t pos, uint32_t nbits)
+{
+    assert(nbits > 0 && nbits <= bit_size<uint32_t>());
+
+    const uint32_t index = pos / bit_size<uint32_t>();
+    const uint32_t offset = pos % bit_size<uint32_t>();
+
+    uint64_t v = buf[index] >> offset;
+    if (offset && offset + nbits > bit_size<uint32_t>())
+        v |= static_cast<uint64_t>(buf[index + 1]) << (bit_size<uint32_t>() - offset);
+
+    if (nbits < bit_size<uint32_t>())
+        v &= ((uint64_t) 1 << nbits) - 1;
+
+    return static_cast<uint32_t>(v);
+}
+
+gorilla_stream_writer_t gorilla_stream_writer_init(uint32_t *data, uint32_t capacity_bits, uint32_t start_bit)
+{
+    return gorilla_stream_writer_t {
+        .data = data,
+        .capacity = capacity_bits,
+        .nbits = start_bit,
+        .entries = 0,
+        .prev_number = 0,
+        .prev_xor_lzc = 0,
+        .prev_delta = 0,
+    };
+}
+
+gorilla_stream_reader_t gorilla_stream_reader_init(const uint32_t *data, uint32_t capacity_bits, uint32_t start_bit)
+{
+    return gorilla_stream_reader_t {
+        .data = data,
+        .capacity = capacity_bits,
+        .position = start_bit,
+        .index = 0,
+        .prev_number = 0,
+        .prev_xor_lzc = 0,
+        .prev_delta = 0,
+    };
+}
+
+bool gorilla_stream_write_xor(gorilla_stream_writer_t *gsw, uint32_t number)
+{
+    if (gsw->entries == 0) {
+        if (gsw->nbits + bit_size<uint32_t>() > gsw->capacity)
+            return false;
+
+        stream_write_bits(gsw->data, gsw->nbits, number, bit_size<uint32_t>());
+        gsw->nbits += bit_size<uint32_t>();
+        gsw->entries++;
+        gsw->prev_number = number;
+        return true;
+    }
+
+    if (number == gsw->prev_number) {
+        if (gsw->nbits + 1 > gsw->capacity)
+            return false;
+
+        stream_write_bits(gsw->data, gsw->nbits, 1, 1);
+        gsw->nbits++;
+        gsw->entries++;
+        return true;
+    }
+
+    uint32_t xor_value = gsw->prev_number ^ number;
+    uint32_t xor_lzc = __builtin_clz(xor_value);
+    uint32_t is_xor_lzc_same = (xor_lzc == gsw->prev_xor_lzc) ? 1 : 0;
+
+    // same-number bit, same-lzc bit, the lzc (if changed) and the suffix
+    uint32_t bits_needed = 2 + (is_xor_lzc_same ? 0 : 5) + (bit_size<uint32_t>() - xor_lzc);
+    if (gsw->nbits + bits_needed > gsw->capacity)
+        return false;
+
+    stream_write_bits(gsw->data, gsw->nbits, 0, 1);
+    gsw->nbits++;
+
+    stream_write_bits(gsw->data, gsw->nbits, is_xor_lzc_same, 1);
+    gsw->nbits++;
+
+    if (!is_xor_lzc_same) {
+        stream_write_bits(gsw->data, gsw->nbits, xor_lzc, 5);
+        gsw->nbits += 5;
+    }
+
+    stream_write_bits(gsw->data, gsw->nbits, xor_value, bit_size<uint32_t>() - xor_lzc);
+    gsw->nbits += bit_size<uint32_t>() - xor_lzc;
+
+    gsw->entries++;
+    gsw->prev_number = number;
+    gsw->prev_xor_lzc = xor_lzc;
+    return true;
+}
+
+bool gorilla_stream_read_xor(gorilla_stream_reader_t *gsr, uint32_t *number)
+{
+    if (gsr->index == 0) {
+        if (gsr->position + bit_size<uint32_t>() > gsr->capacity)
+            return false;
+
+        *number = stream_read_bits(gsr->data, gsr->position, bit_size<uint32_t>());
+        gsr->position += bit_size<uint32_t>();
+        gsr->index++;
+        gsr->prev_number = *number;
+        return true;
+    }
+
+    if (gsr->position + 1 > gsr->capacity)
+        return false;
+
+    uint32_t is_same_number = stream_read_bits(gsr->data, gsr->position, 1);
+    gsr->position++;
+
+    if (is_same_number) {
+        *number = gsr->prev_number;
+        gsr->index++;
+        return true;
+    }
+
+    if (gsr->position + 1 > gsr->capacity)
+        return false;
+
+    uint32_t xor_lzc = gsr->prev_xor_lzc;
+    uint32_t same_xor_lzc = stream_read_bits(gsr->data, gsr->position, 1);
+    gsr->position++;
+
+    if (!same_xor_lzc) {
+        if (gsr->position + 5 > gsr->capacity)
+            return false;
+
+        xor_lzc = stream_read_bits(gsr->data, gsr->position, 5);
+        gsr->position += 5;
+    }
+
+    if (gsr->position + (bit_size<uint32_t>() - xor_lzc) > gsr->capacity)
+        return false;
+
+    uint32_t xor_value = stream_read_bits(gsr->data, gsr->position, bit_size<uint32_t>() - xor_lzc);
+    gsr->position += bit_size<uint32_t>() - xor_lzc;
+
+    *number = gsr->prev_number ^ xor_value;
+
+    gsr->index++;
+    gsr->prev_number = *number;
+    gsr->prev_xor_lzc = xor_lzc;
+    return true;
+}
+
+// delta-of-delta buckets: the number of '1' bits in the prefix selects
+// the width of the zig-zag encoded value that follows.
+static constexpr uint32_t dod_bucket_bits[] = { 0, 7, 9, 12, 32 };
+static constexpr uint32_t dod_buckets = sizeof(dod_bucket_bits) / sizeof(dod_bucket_bits[0]);
+
+bool gorilla_stream_write_dod(gorilla_stream_writer_t *gsw, uint32_t number)
+{
+    if (gsw->entries == 0) {
+        if (gsw->nbits + bit_size<uint32_t>() > gsw->capacity)
+            return false;
+
+        stream_write_bits(gsw->data, gsw->nbits, number, bit_size<uint32_t>());
+        gsw->nbits += bit_size<uint32_t>();
+        gsw->entries++;
+        gsw->prev_number = number;
+        gsw->prev_delta = 0;
+        return true;
+    }
+
+    // all arithmetic is modulo 2^32, so that decoding is always exact
+    uint32_t delta = number - gsw->prev_number;
+    uint32_t dod = delta - gsw->prev_delta;
+    uint32_t zz = (dod << 1) ^ static_cast<uint32_t>(static_cast<int32_t>(dod) >> 31);
+
+    uint32_t bucket = 0;
+    while (bucket < dod_buckets - 1 && (zz >> dod_bucket_bits[bucket]) != 0)
+        bucket++;
+
+    // '1' bits for the bucket, terminated with a '0', unless it is the last bucket
+    uint32_t prefix_bits = (bucket < dod_buckets - 1) ? bucket + 1 : bucket;
+    uint32_t prefix = ((uint32_t) 1 << bucket) - 1;
+
+    if (gsw->nbits + prefix_bits + dod_bucket_bits[bucket] > gsw->capacity)
+        return false;
+
+    stream_write_bits(gsw->data, gsw->nbits, prefix, prefix_bits);
+    gsw->nbits += prefix_bits;
+
+    if (dod_bucket_bits[bucket]) {
+        stream_write_bits(gsw->data, gsw->nbits, zz, dod_bucket_bits[bucket]);
+        gsw->nbits += dod_bucket_bits[bucket];
+    }
+
+    gsw->entries++;
+    gsw->prev_number = number;
+    gsw->prev_delta = delta;
+    return true;
+}
+
+bool gorilla_stream_read_dod(gorilla_stream_reader_t *gsr, uint32_t *number)
+{
+    if (gsr->index == 0) {
+        if (gsr->position + bit_size<uint32_t>() > gsr->capacity)
+            return false;
+
+        *number = stream_read_bits(gsr->data, gsr->position, bit_size<uint32_t>());
+        gsr->position += bit_size<uint32_t>();
+        gsr->index++;
+        gsr->prev_number = *number;
+        gsr->prev_delta = 0;
+        return true;
+    }
+
+    uint32_t bucket = 0;
+    while (bucket < dod_buckets - 1) {
+        if (gsr->position + 1 > gsr->capacity)
+            return false;
+
+        uint32_t bit = stream_read_bits(gsr->data, gsr->position, 1);
+        gsr->position++;
+
+        if (!bit)
+            break;
+
+        bucket++;
+    }
+
+    uint32_t zz = 0;
+    if (dod_bucket_bits[bucket]) {
+        if (gsr->position + dod_bucket_bits[bucket] > gsr->capacity)
+            return false;
+
+        zz = stream_read_bits(gsr->data, gsr->position, dod_bucket_bits[bucket]);
+        gsr->position += dod_bucket_bits[bucket];
+    }
+
+    uint32_t dod = (zz >> 1) ^ (0 - (zz & 1));
+    uint32_t delta = gsr->prev_delta + dod;
+
+    *number = gsr->prev_number + delta;
+
+    gsr->index++;
+    gsr->prev_number = *number;
+    gsr->prev_delta = delta;
+    return true;
+}
+
 extern "C" {
 struct aral;
 void aral_unmark_allocation(struct aral *ar, void *ptr);
@@ -73,6 +73,54 @@ size_t gorilla_buffer_unpatched_nbytes(const gorilla_buffer_t *gbuf);
 gorilla_reader_t gorilla_reader_init(gorilla_buffer_t *buf);
 bool gorilla_reader_read(gorilla_reader_t *gr, uint32_t *number);
 
+/*
+ * Gorilla streams
+ *
+ * A gorilla stream encodes values into a single, caller provided, zeroed
+ * array of 32-bit words, starting at an arbitrary bit offset and without
+ * any per-buffer header. This allows packing multiple streams (columns)
+ * back to back, which is what small pages need.
+ *
+ * Two encodings are supported:
+ * - XOR, exactly the same algorithm the gorilla buffers above use,
+ *   appropriate for floating point numbers.
+ * - delta-of-delta, appropriate for integer counters that rarely change.
+ */
+
+typedef struct {
+    uint32_t *data;
+
+    // in bits
+    uint32_t capacity;
+    uint32_t nbits;
+
+    uint32_t entries;
+    uint32_t prev_number;
+    uint32_t prev_xor_lzc;
+    uint32_t prev_delta;
+} gorilla_stream_writer_t;
+
+typedef struct {
+    const uint32_t *data;
+
+    // in bits
+    uint32_t capacity;
+    uint32_t position;
+
+    uint32_t index;
+    uint32_t prev_number;
+    uint32_t prev_xor_lzc;
+    uint32_t prev_delta;
+} gorilla_stream_reader_t;
+
+gorilla_stream_writer_t gorilla_stream_writer_init(uint32_t *data, uint32_t capacity_bits, uint32_t start_bit);
+bool gorilla_stream_write_xor(gorilla_stream_writer_t *gsw, uint32_t number);
+bool gorilla_stream_write_dod(gorilla_stream_writer_t *gsw, uint32_t number);
+
+gorilla_stream_reader_t gorilla_stream_reader_init(const uint32_t *data, uint32_t capacity_bits, uint32_t start_bit);
+bool gorilla_stream_read_xor(gorilla_stream_reader_t *gsr, uint32_t *number);
+bool gorilla_stream_read_dod(gorilla_stream_reader_t *gsr, uint32_t *number);
+
 #define RRDENG_GORILLA_32BIT_SLOT_BYTES sizeof(uint32_t)
 #define RRDENG_GORILLA_32BIT_SLOT_BITS (RRDENG_GORILLA_32BIT_SLOT_BYTES * CHAR_BIT)
 #define RRDENG_GORILLA_32BIT_BUFFER_SLOTS 128
@@ -121,6 +121,7 @@ extern const char *netdata_configured_host_prefix;
 
 #include "eval/eval.h"
 #include "statistical/statistical.h"
+#include "statistical/tdigest.h"
 #include "adaptive_resortable_list/adaptive_resortable_list.h"
 #include "url/url.h"
 #include "json/json.h"
@@ -438,10 +438,10 @@ void procfile_set_open_close(procfile *ff, const char *open, const char *close)
         ffs[(int)*s++] = PF_CHAR_IS_CLOSE;
 }
 
-procfile *procfile_open(const char *filename, const char *separators, uint32_t flags) {
+procfile *procfile_openat(int dirfd, const char *filename, const char *separators, uint32_t flags) {
     netdata_log_debug(D_PROCFILE, PF_PREFIX ": Opening file '%s'", filename);
 
-    int fd = open(filename, procfile_open_flags, 0666);
+    int fd = openat(dirfd, filename, procfile_open_flags, 0666);
     if(unlikely(fd == -1)) {
         if (unlikely(flags & PROCFILE_FLAG_ERROR_ON_ERROR_LOG))
             netdata_log_error(PF_PREFIX ": Cannot open file '%s'", filename);
@@ -483,15 +483,19 @@ procfile *procfile_open(const char *filename, const char *separators, uint32_t f
     return ff;
 }
 
-procfile *procfile_reopen(procfile *ff, const char *filename, const char *separators, uint32_t flags) {
-    if(unlikely(!ff)) return procfile_open(filename, separators, flags);
+procfile *procfile_open(const char *filename, const char *separators, uint32_t flags) {
+    return procfile_openat(AT_FDCWD, filename, separators, flags);
+}
+
+procfile *procfile_reopenat(procfile *ff, int dirfd, const char *filename, const char *separators, uint32_t flags) {
+    if(unlikely(!ff)) return procfile_openat(dirfd, filename, separators, flags);
 
     if(likely(ff->fd != -1)) {
         // netdata_log_info("PROCFILE: closing fd %d", ff->fd);
         close(ff->fd);
     }
 
-    ff->fd = open(filename, procfile_open_flags, 0666);
+    ff->fd = openat(dirfd, filename, procfile_open_flags, 0666);
     if(unlikely(ff->fd == -1)) {
         procfile_close(ff);
         return NULL;
@@ -511,6 +515,10 @@ procfile *procfile_reopen(procfile *ff, const char *filename, const char *separa
     return ff;
 }
 
+procfile *procfile_reopen(procfile *ff, const char *filename, const char *separators, uint32_t flags) {
+    return procfile_reopenat(ff, AT_FDCWD, filename, separators, flags);
+}
+
 // ----------------------------------------------------------------------------
 // example parsing of procfile data
 
@@ -87,6 +87,10 @@ procfile *procfile_open(const char *filename, const char *separators, uint32_t f
 // if separators == NULL, the last separators are used
 procfile *procfile_reopen(procfile *ff, const char *filename, const char *separators, uint32_t flags);
 
+// the same, with filename relative to the directory dirfd (see openat(2))
+procfile *procfile_openat(int dirfd, const char *filename, const char *separators, uint32_t flags);
+procfile *procfile_reopenat(procfile *ff, int dirfd, const char *filename, const char *separators, uint32_t flags);
+
 // example walk-through a procfile parsed file
 void procfile_print(procfile *ff);
 
@@ -0,0 +1,454 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "tdigest.h"
+
+// the k1 scale function and its inverse
+// k(q) = delta / (2 * pi) * asin(2q - 1)
+
+static inline NETDATA_DOUBLE tdigest_q_to_k(NETDATA_DOUBLE q) {
+    if(q <= 0.0) q = 0.0;
+    if(q >= 1.0) q = 1.0;
+    return (NETDATA_DOUBLE)TDIGEST_COMPRESSION / (2.0 * M_PI) * asin(2.0 * q - 1.0);
+}
+
+static inline NETDATA_DOUBLE tdigest_k_to_q(NETDATA_DOUBLE k) {
+    NETDATA_DOUBLE x = k * 2.0 * M_PI / (NETDATA_DOUBLE)TDIGEST_COMPRESSION;
+    if(x >= M_PI / 2.0) return 1.0;
+    if(x <= -M_PI / 2.0) return 0.0;
+    return (sin(x) + 1.0) / 2.0;
+}
+
+static int tdigest_centroid_compar(const void *a, const void *b) {
+    NETDATA_DOUBLE m1 = ((const struct tdigest_centroid *)a)->mean;
+    NETDATA_DOUBLE m2 = ((const struct tdigest_centroid *)b)->mean;
+
+    if(m1 < m2) return -1;
+    if(m1 > m2) return 1;
+    return 0;
+}
+
+void tdigest_reset(TDIGEST *td) {
+    td->min = NAN;
+    td->max = NAN;
+    td->sum = 0.0;
+    td->weight = 0.0;
+    td->centroids = 0;
+    td->buffered = 0;
+}
+
+void tdigest_compress(TDIGEST *td) {
+    if(!td->buffered)
+        return;
+
+    // the centroids are already sorted, so only the buffer needs sorting
+    struct tdigest_centroid *buffer = &td->centroid[td->centroids];
+    qsort(buffer, td->buffered, sizeof(struct tdigest_centroid), tdigest_centroid_compar);
+
+    struct tdigest_centroid centroids[TDIGEST_MAX_CENTROIDS];
+    size_t centroids_count = MIN(td->centroids, _countof(centroids));
+    memcpy(centroids, td->centroid, centroids_count * sizeof(struct tdigest_centroid));
+
+    NETDATA_DOUBLE total = 0.0;
+    for(size_t i = 0; i < centroids_count ;i++)
+        total += centroids[i].weight;
+    for(size_t i = 0; i < td->buffered ;i++)
+        total += buffer[i].weight;
+
+    // walk both sorted runs, merging adjacent centroids as long as the merged one spans at most 1 in k
+    // the merged centroids are written at the beginning of centroid[], always before the buffer entries still to be read
+    size_t c = 0, b = 0, merged = 0;
+    struct tdigest_centroid current = { 0 };
+    NETDATA_DOUBLE weight_so_far = 0.0;
+    NETDATA_DOUBLE weight_limit = total * tdigest_k_to_q(tdigest_q_to_k(0.0) + 1.0);
+
+    while(c < centroids_count || b < td->buffered) {
+        struct tdigest_centroid next;
+        if(b >= td->buffered || (c < centroids_count && centroids[c].mean <= buffer[b].mean))
+            next = centroids[c++];
+        else
+            next = buffer[b++];
+
+        if(c + b == 1) {
+            current = next;
+            continue;
+        }
+
+        NETDATA_DOUBLE proposed = current.weight + next.weight;
+        if(weight_so_far + proposed <= weight_limit) {
+            current.mean += (next.mean - current.mean) * next.weight / proposed;
+            current.weight = proposed;
+        }
+        else {
+            weight_so_far += current.weight;
+            td->centroid[merged++] = current;
+            weight_limit = total * tdigest_k_to_q(tdigest_q_to_k(weight_so_far / total) + 1.0);
+            current = next;
+        }
+    }
+
+    td->centroid[merged++] = current;
+    td->centroids = merged;
+    td->buffered = 0;
+}
+
+static inline void tdigest_append(TDIGEST *td, NETDATA_DOUBLE mean, NETDATA_DOUBLE weight) {
+    if(unlikely(td->centroids + td->buffered >= _countof(td->centroid)))
+        tdigest_compress(td);
+
+    struct tdigest_centroid *c = &td->centroid[td->centroids + td->buffered++];
+    c->mean = mean;
+    c->weight = weight;
+}
+
+void tdigest_add_weighted(TDIGEST *td, NETDATA_DOUBLE value, NETDATA_DOUBLE weight) {
+    if(unlikely(!netdata_double_isnumber(value) || !(weight > 0.0)))
+        return;
+
+    if(unlikely(td->weight == 0.0))
+        td->min = td->max = value;
+    else if(value < td->min)
+        td->min = value;
+    else if(value > td->max)
+        td->max = value;
+
+    td->sum += value * weight;
+    td->weight += weight;
+
+    tdigest_append(td, value, weight);
+}
+
+void tdigest_merge(TDIGEST *dst, TDIGEST *src) {
+    if(src->weight == 0.0)
+        return;
+
+    if(dst->weight == 0.0) {
+        dst->min = src->min;
+        dst->max = src->max;
+    }
+    else {
+        if(src->min < dst->min) dst->min = src->min;
+        if(src->max > dst->max) dst->max = src->max;
+    }
+
+    dst->sum += src->sum;
+    dst->weight += src->weight;
+
+    size_t entries = src->centroids + src->buffered;
+    for(size_t i = 0; i < entries ;i++)
+        tdigest_append(dst, src->centroid[i].mean, src->centroid[i].weight);
+}
+
+// ----------------------------------------------------------------------------
+// queries
+//
+// Each centroid is assumed to have half of its weight on each side of its mean,
+// and the values are interpolated linearly between the means of adjacent centroids,
+// and between the first and the last centroids and the exact min and max.
+
+NETDATA_DOUBLE tdigest_quantile(TDIGEST *td, NETDATA_DOUBLE q) {
+    if(unlikely(td->weight == 0.0))
+        return NAN;
+
+    tdigest_compress(td);
+
+    if(q <= 0.0 || td->min == td->max) return td->min;
+    if(q >= 1.0) return td->max;
+
+    struct tdigest_centroid *c = td->centroid;
+    size_t n = td->centroids;
+    NETDATA_DOUBLE index = q * td->weight;
+
+    // between the min and the mean of the first centroid
+    NETDATA_DOUBLE weight_so_far = c[0].weight / 2.0;
+    if(index < weight_so_far)
+        return td->min + (c[0].mean - td->min) * index / weight_so_far;
+
+    for(size_t i = 0; i + 1 < n ;i++) {
+        NETDATA_DOUBLE dw = (c[i].weight + c[i + 1].weight) / 2.0;
+        if(index < weight_so_far + dw)
+            return c[i].mean + (c[i + 1].mean - c[i].mean) * (index - weight_so_far) / dw;
+
+        weight_so_far += dw;
+    }
+
+    // between the mean of the last centroid and the max
+    NETDATA_DOUBLE last_half = c[n - 1].weight / 2.0;
+    NETDATA_DOUBLE value = c[n - 1].mean + (td->max - c[n - 1].mean) * (index - weight_so_far) / last_half;
+    return MIN(value, td->max);
+}
+
+NETDATA_DOUBLE tdigest_cdf(TDIGEST *td, NETDATA_DOUBLE value) {
+    if(unlikely(td->weight == 0.0))
+        return NAN;
+
+    tdigest_compress(td);
+
+    if(value < td->min) return 0.0;
+    if(value >= td->max) return 1.0;
+
+    struct tdigest_centroid *c = td->centroid;
+    size_t n = td->centroids;
+
+    // between the min and the mean of the first centroid
+    if(value < c[0].mean)
+        return (value - td->min) / (c[0].mean - td->min) * c[0].weight / 2.0 / td->weight;
+
+    NETDATA_DOUBLE weight_so_far = c[0].weight / 2.0;
+    for(size_t i = 0; i + 1 < n ;i++) {
+        NETDATA_DOUBLE dw = (c[i].weight + c[i + 1].weight) / 2.0;
+        if(value < c[i + 1].mean)
+            return (weight_so_far + dw * (value - c[i].mean) / (c[i + 1].mean - c[i].mean)) / td->weight;
+
+        weight_so_far += dw;
+    }
+
+    // between the mean of the last centroid and the max
+    NETDATA_DOUBLE last_half = c[n - 1].weight / 2.0;
+    return (weight_so_far + last_half * (value - c[n - 1].mean) / (td->max - c[n - 1].mean)) / td->weight;
+}
+
+NETDATA_DOUBLE tdigest_mean_below(TDIGEST *td, NETDATA_DOUBLE q) {
+    if(unlikely(td->weight == 0.0))
+        return NAN;
+
+    tdigest_compress(td);
+
+    if(q <= 0.0 || td->min == td->max) return td->min;
+    if(q > 1.0) q = 1.0;
+
+    NETDATA_DOUBLE wanted = q * td->weight;
+    NETDATA_DOUBLE sum = 0.0, weight = 0.0;
+    for(size_t i = 0; i < td->centroids && weight < wanted ;i++) {
+        NETDATA_DOUBLE w = MIN(td->centroid[i].weight, wanted - weight);
+        sum += td->centroid[i].mean * w;
+        weight += w;
+    }
+
+    return sum / weight;
+}
+
+NETDATA_DOUBLE tdigest_mean_above(TDIGEST *td, NETDATA_DOUBLE q) {
+    if(unlikely(td->weight == 0.0))
+        return NAN;
+
+    tdigest_compress(td);
+
+    if(q <= 0.0 || td->min == td->max) return td->max;
+    if(q > 1.0) q = 1.0;
+
+    NETDATA_DOUBLE wanted = q * td->weight;
+    NETDATA_DOUBLE sum = 0.0, weight = 0.0;
+    for(size_t i = td->centroids; i > 0 && weight < wanted ;i--) {
+        NETDATA_DOUBLE w = MIN(td->centroid[i - 1].weight, wanted - weight);
+        sum += td->centroid[i - 1].mean * w;
+        weight += w;
+    }
+
+    return sum / weight;
+}
+
+// ----------------------------------------------------------------------------
+// unittest
+
+static inline uint64_t tdigest_unittest_random(uint64_t *state) {
+    // xorshift64*
+    uint64_t x = *state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+    return x * 0x2545F4914F6CDD1DULL;
+}
+
+static inline NETDATA_DOUBLE tdigest_unittest_uniform(uint64_t *state) {
+    return (NETDATA_DOUBLE)(tdigest_unittest_random(state) >> 11) / (NETDATA_DOUBLE)(1ULL << 53);
+}
+
+// the fraction of the sorted series that is below value
+static NETDATA_DOUBLE tdigest_unittest_rank(const NETDATA_DOUBLE *sorted, size_t entries, NETDATA_DOUBLE value) {
+    size_t lo = 0, hi = entries;
+    while(lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if(sorted[mid] < value) lo = mid + 1;
+        else hi = mid;
+    }
+    return (NETDATA_DOUBLE)lo / (NETDATA_DOUBLE)entries;
+}
+
+static int tdigest_unittest_check(const char *name, TDIGEST *td, const NETDATA_DOUBLE *sorted, size_t entries) {
+    static const NETDATA_DOUBLE quantiles[] = { 0.001, 0.01, 0.1, 0.25, 0.5, 0.75, 0.9, 0.95, 0.99, 0.999 };
+    int errors = 0;
+
+    if(td->min != sorted[0] || td->max != sorted[entries - 1]) {
+        fprintf(stderr, "TDIGEST: %s: min/max %f/%f, expected %f/%f\n",
+                name, td->min, td->max, sorted[0], sorted[entries - 1]);
+        errors++;
+    }
+
+    for(size_t i = 0; i < _countof(quantiles) ;i++) {
+        NETDATA_DOUBLE q = quantiles[i];
+        NETDATA_DOUBLE v = tdigest_quantile(td, q);
+        NETDATA_DOUBLE rank = tdigest_unittest_rank(sorted, entries, v);
+
+        // the rank error allowed is smaller at the tails
+        NETDATA_DOUBLE allowed = 0.001 + 0.04 * q * (1.0 - q);
+        if(fabsndd(rank - q) > allowed) {
+            fprintf(stderr, "TDIGEST: %s: quantile %f gave %f, which is at rank %f (allowed error %f)\n",
+                    name, q, v, rank, allowed);
+            errors++;
+        }
+
+        NETDATA_DOUBLE cdf = tdigest_cdf(td, percentile_on_sorted_series(sorted, entries, q));
+        if(fabsndd(cdf - q) > allowed) {
+            fprintf(stderr, "TDIGEST: %s: cdf at quantile %f gave %f (allowed error %f)\n",
+                    name, q, cdf, allowed);
+            errors++;
+        }
+    }
+
+    // the average of the smallest 95%, and the average of the largest 5%
+    size_t below = (size_t)((NETDATA_DOUBLE)entries * 0.95);
+    NETDATA_DOUBLE range = sorted[entries - 1] - sorted[0];
+    NETDATA_DOUBLE exact_below = sum(sorted, below) / (NETDATA_DOUBLE)below;
+    NETDATA_DOUBLE exact_above = sum(&sorted[below], entries - below) / (NETDATA_DOUBLE)(entries - below);
+    NETDATA_DOUBLE mean_below = tdigest_mean_below(td, 0.95);
+    NETDATA_DOUBLE mean_above = tdigest_mean_above(td, 0.05);
+
+    if(fabsndd(mean_below - exact_below) > range * 0.001 || fabsndd(mean_above - exact_above) > range * 0.005) {
+        fprintf(stderr, "TDIGEST: %s: mean below 95%% %f (exact %f), mean above 95%% %f (exact %f)\n",
+                name, mean_below, exact_below, mean_above, exact_above);
+        errors++;
+    }
+
+    if(td->centroids > TDIGEST_MAX_CENTROIDS) {
+        fprintf(stderr, "TDIGEST: %s: %zu centroids, the max is %d\n", name, td->centroids, TDIGEST_MAX_CENTROIDS);
+        errors++;
+    }
+
+    return errors;
+}
+
+int tdigest_unittest(void) {
+    const size_t entries = 1000000;
+    int errors = 0;
+
+    NETDATA_DOUBLE *series = mallocz(entries * sizeof(NETDATA_DOUBLE));
+    NETDATA_DOUBLE *sorted = mallocz(entries * sizeof(NETDATA_DOUBLE));
+    TDIGEST *td = mallocz(sizeof(TDIGEST));
+    TDIGEST *parts = mallocz(4 * sizeof(TDIGEST));
+
+    const char *distributions[] = { "uniform", "exponential", "negative normal" };
+    for(size_t d = 0; d < _countof(distributions) ;d++) {
+        uint64_t state = 0x9E3779B97F4A7C15ULL + d;
+
+        for(size_t i = 0; i < entries ;i++) {
+            NETDATA_DOUBLE u = tdigest_unittest_uniform(&state);
+            switch(d) {
+                default:
+                case 0:
+                    series[i] = u * 1000.0;
+                    break;
+
+                case 1:
+                    series[i] = -log(1.0 - u) * 100.0;
+                    break;
+
+                case 2: {
+                    NETDATA_DOUBLE u2 = tdigest_unittest_uniform(&state);
+                    series[i] = -1000.0 + 100.0 * sqrt(-2.0 * log(1.0 - u)) * cos(2.0 * M_PI * u2);
+                    break;
+                }
+            }
+        }
+
+        // the current implementation: copy and sort everything
+        usec_t started_ut = now_monotonic_high_precision_usec();
+        memcpy(sorted, series, entries * sizeof(NETDATA_DOUBLE));
+        sort_series(sorted, entries);
+        NETDATA_DOUBLE exact = percentile_on_sorted_series(sorted, entries, 0.95);
+        usec_t sort_ut = now_monotonic_high_precision_usec() - started_ut;
+
+        // the sketch
+        started_ut = now_monotonic_high_precision_usec();
+        tdigest_reset(td);
+        for(size_t i = 0; i < entries ;i++)
+            tdigest_add(td, series[i]);
+        NETDATA_DOUBLE approximate = tdigest_quantile(td, 0.95);
+        usec_t sketch_ut = now_monotonic_high_precision_usec() - started_ut;
+
+        fprintf(stderr, "TDIGEST: %s, %zu values, p95: sort %f in %"PRIu64" usec using %zu bytes, "
+                        "t-digest %f in %"PRIu64" usec using %zu bytes (%zu centroids)\n",
+                distributions[d], entries,
+                exact, sort_ut, entries * sizeof(NETDATA_DOUBLE),
+                approximate, sketch_ut, sizeof(TDIGEST), td->centroids);
+
+        errors += tdigest_unittest_check(distributions[d], td, sorted, entries);
+
+        // merging per thread digests
+        for(size_t p = 0; p < 4 ;p++)
+            tdigest_reset(&parts[p]);
+        for(size_t i = 0; i < entries ;i++)
+            tdigest_add(&parts[i % 4], series[i]);
+
+        tdigest_reset(td);
+        for(size_t p = 0; p < 4 ;p++)
+            tdigest_merge(td, &parts[p]);
+
+        errors += tdigest_unittest_check("merged", td, sorted, entries);
+    }
+
+    // weighted values are the same as repeated values
+    {
+        uint64_t state = 1;
+        TDIGEST *repeated = &parts[0];
+        tdigest_reset(td);
+        tdigest_reset(repeated);
+
+        for(size_t i = 0; i < entries / 100 ;i++) {
+            NETDATA_DOUBLE v = tdigest_unittest_uniform(&state) * 100.0;
+            tdigest_add_weighted(td, v, 100.0);
+            for(size_t r = 0; r < 100 ;r++)
+                tdigest_add(repeated, v);
+        }
+
+        for(NETDATA_DOUBLE q = 0.05; q < 1.0 ; q += 0.05) {
+            NETDATA_DOUBLE v1 = tdigest_quantile(td, q);
+            NETDATA_DOUBLE v2 = tdigest_quantile(repeated, q);
+            if(fabsndd(v1 - v2) > 0.5) {
+                fprintf(stderr, "TDIGEST: weighted: quantile %f is %f, but %f when repeated\n", q, v1, v2);
+                errors++;
+            }
+        }
+
+        if(td->weight != repeated->weight || fabsndd(td->sum - repeated->sum) > fabsndd(td->sum) * 1e-9) {
+            fprintf(stderr, "TDIGEST: weighted: weight %f, sum %f, but %f and %f when repeated\n",
+                    td->weight, td->sum, repeated->weight, repeated->sum);
+            errors++;
+        }
+    }
+
+    // constant and empty series
+    {
+        tdigest_reset(td);
+        if(!isnan(tdigest_quantile(td, 0.5))) {
+            fprintf(stderr, "TDIGEST: empty: the quantile is not NAN\n");
+            errors++;
+        }
+
+        for(size_t i = 0; i < 1000 ;i++)
+            tdigest_add(td, 42.0);
+
+        if(tdigest_quantile(td, 0.01) != 42.0 || tdigest_quantile(td, 0.99) != 42.0 || tdigest_mean_below(td, 0.5) != 42.0) {
+            fprintf(stderr, "TDIGEST: constant: the quantiles are not the constant\n");
+            errors++;
+        }
+    }
+
+    freez(parts);
+    freez(td);
+    freez(sorted);
+    freez(series);
+
+    fprintf(stderr, "TDIGEST: %d errors\n", errors);
+    return errors;
+}
@@ -0,0 +1,67 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef NETDATA_TDIGEST_H
+#define NETDATA_TDIGEST_H 1
+
+#include "../libnetdata.h"
+
+// A merging t-digest (Dunning, "Computing Extremely Accurate Quantiles Using t-Digests").
+//
+// It summarizes any number of weighted values in a fixed amount of memory.
+// Values are appended to a buffer and, when the buffer is full, they are sorted
+// together with the existing centroids and merged, using the k1 (arcsine) scale
+// function, so that the centroids at the tails are small and the quantiles near
+// 0 and 1 are more accurate than the ones near the median.
+//
+// The minimum, the maximum, the sum and the total weight are exact.
+// Digests can be merged, so each thread may keep its own.
+
+#define TDIGEST_COMPRESSION 100
+#define TDIGEST_MAX_CENTROIDS (2 * TDIGEST_COMPRESSION)
+#define TDIGEST_BUFFER_SIZE (4 * TDIGEST_COMPRESSION)
+
+struct tdigest_centroid {
+    NETDATA_DOUBLE mean;
+    NETDATA_DOUBLE weight;
+};
+
+typedef struct tdigest {
+    NETDATA_DOUBLE min;
+    NETDATA_DOUBLE max;
+    NETDATA_DOUBLE sum;
+    NETDATA_DOUBLE weight;
+
+    size_t centroids;                   // the merged centroids at the beginning of centroid[]
+    size_t buffered;                    // the values appended after them, not merged yet
+
+    struct tdigest_centroid centroid[TDIGEST_MAX_CENTROIDS + TDIGEST_BUFFER_SIZE];
+} TDIGEST;
+
+void tdigest_reset(TDIGEST *td);
+void tdigest_add_weighted(TDIGEST *td, NETDATA_DOUBLE value, NETDATA_DOUBLE weight);
+void tdigest_merge(TDIGEST *dst, TDIGEST *src);
+
+// merge the buffered values into the centroids
+void tdigest_compress(TDIGEST *td);
+
+static inline void tdigest_add(TDIGEST *td, NETDATA_DOUBLE value) {
+    tdigest_add_weighted(td, value, 1.0);
+}
+
+static inline NETDATA_DOUBLE tdigest_weight(TDIGEST *td) {
+    return td->weight;
+}
+
+// the value at quantile q (0.0 to 1.0), NAN when empty
+NETDATA_DOUBLE tdigest_quantile(TDIGEST *td, NETDATA_DOUBLE q);
+
+// the fraction of the weight that is below value (0.0 to 1.0), NAN when empty
+NETDATA_DOUBLE tdigest_cdf(TDIGEST *td, NETDATA_DOUBLE value);
+
+// the average of the smallest (or the largest) q fraction of the values, NAN when empty
+NETDATA_DOUBLE tdigest_mean_below(TDIGEST *td, NETDATA_DOUBLE q);
+NETDATA_DOUBLE tdigest_mean_above(TDIGEST *td, NETDATA_DOUBLE q);
+
+int tdigest_unittest(void);
+
+#endif //NETDATA_TDIGEST_H
@@ -6,10 +6,17 @@
 // ----------------------------------------------------------------------------
 // STRING implementation - dedup all STRING
 
-#define STRING_PARTITION_SHIFTS (0)
-#define STRING_PARTITIONS (256 >> STRING_PARTITION_SHIFTS)
-#define string_partition_str(str) ((uint8_t)((str)[0]) >> STRING_PARTITION_SHIFTS)
-#define string_partition(string) (string_partition_str((string)->str))
+// Strings are partitioned by a hash of their contents. Most of them share a few
+// prefixes ("system.", "cgroup_", "k8s_", "net.", etc), so partitioning them by
+// their first byte made a handful of partitions take almost all the contention.
+
+#define STRING_PARTITIONS 256
+#define STRING_CACHE_SLOTS 64       // per partition, for lock-free lookups of existing strings
+
+#define string_hash(str, length) XXH3_64bits(str, (length) - 1)
+#define string_partition_hash(hash) ((uint8_t)(hash))
+#define string_cache_slot_hash(hash) (((hash) >> 8) & (STRING_CACHE_SLOTS - 1))
+#define string_partition(string) (string_partition_hash(string_hash((string)->str, (string)->length)))
 
 struct netdata_string {
     uint32_t length;    // the string length including the terminating '\0'
@@ -41,6 +48,12 @@ static struct string_partition {
     Pvoid_t JudyLPointers;      // JudyL array to keep track of all string pointers for traversal
 #endif
 
+    struct {
+        uint32_t epoch;         // selects the readers counter new lookups use
+        int32_t readers[2];     // the lookups in progress, per epoch
+        STRING *slots[STRING_CACHE_SLOTS];
+    } cache;
+
 #ifdef NETDATA_INTERNAL_CHECKS
     // internal statistics
     struct {
@@ -52,6 +65,7 @@ static struct string_partition {
 
     size_t found_deleted_on_search;
     size_t found_available_on_search;
+    size_t found_available_on_cache;
     size_t found_deleted_on_insert;
     size_t found_available_on_insert;
     size_t spins;
@@ -96,11 +110,7 @@ void string_statistics(size_t *inserts, size_t *deletes, size_t *searches, size_
     }
 }
 
-static inline bool string_entry_check_and_acquire(STRING *se) {
-#ifdef NETDATA_INTERNAL_CHECKS
-    uint8_t partition = string_partition(se);
-#endif
-
+static inline bool string_entry_check_and_acquire(STRING *se, uint8_t partition __maybe_unused) {
     if(!refcount_acquire(&se->refcount))
         return false;
 
@@ -133,11 +143,76 @@ STRING *string_dup(STRING *string) {
     return string;
 }
 
+// ----------------------------------------------------------------------------
+// lock-free lookups of existing strings
+//
+// Each partition caches its recently used strings in a small array indexed by
+// their hash. Lookups do not lock: they register themselves to the readers
+// counter of the current epoch and acquire the string they find there.
+// string_index_delete() removes the string from the cache, advances the epoch
+// and waits for the readers of the previous epoch before freeing it, so a string
+// found in the cache is never freed while it is being checked. Lookups that
+// race with an epoch change just fall back to the locked index.
+
+static bool string_cache_enabled = true; // the unittest disables it to measure the difference
+
+static inline STRING *string_cache_search(const char *str, size_t length, uint64_t hash) {
+    if(unlikely(!__atomic_load_n(&string_cache_enabled, __ATOMIC_RELAXED)))
+        return NULL;
+
+    uint8_t partition = string_partition_hash(hash);
+    struct string_partition *sp = &string_base[partition];
+
+    uint32_t epoch = __atomic_load_n(&sp->cache.epoch, __ATOMIC_SEQ_CST);
+    __atomic_add_fetch(&sp->cache.readers[epoch & 1], 1, __ATOMIC_SEQ_CST);
+
+    STRING *string = NULL;
+    if(likely(__atomic_load_n(&sp->cache.epoch, __ATOMIC_SEQ_CST) == epoch)) {
+        string = __atomic_load_n(&sp->cache.slots[string_cache_slot_hash(hash)], __ATOMIC_SEQ_CST);
+
+        if(string && (string->length != length || memcmp(string->str, str, length) != 0 ||
+                      !string_entry_check_and_acquire(string, partition)))
+            string = NULL;
+    }
+
+    __atomic_sub_fetch(&sp->cache.readers[epoch & 1], 1, __ATOMIC_RELEASE);
+
+    if(string) {
+        string_stats_atomic_increment(partition, searches);
+        string_internal_stats_add(partition, found_available_on_cache, 1);
+    }
+
+    return string;
+}
+
+// the caller must hold a lock on the partition and a reference to the string
+static inline void string_cache_set(uint8_t partition, uint64_t hash, STRING *string) {
+    __atomic_store_n(&string_base[partition].cache.slots[string_cache_slot_hash(hash)], string, __ATOMIC_RELEASE);
+}
+
+// the caller must hold the write lock of the partition
+static inline void string_cache_del_and_wait(uint8_t partition, uint64_t hash, STRING *string) {
+    struct string_partition *sp = &string_base[partition];
+
+    STRING *expected = string;
+    __atomic_compare_exchange_n(&sp->cache.slots[string_cache_slot_hash(hash)], &expected, NULL,
+                                false, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED);
+
+    // even when it was not in the cache any more, a lookup may still be checking it
+    uint32_t epoch = __atomic_fetch_add(&sp->cache.epoch, 1, __ATOMIC_SEQ_CST);
+    while(__atomic_load_n(&sp->cache.readers[epoch & 1], __ATOMIC_SEQ_CST)) {
+        string_internal_stats_add(partition, spins, 1);
+        tinysleep();
+    }
+}
+
+// ----------------------------------------------------------------------------
+
 // Search the index and return an ACQUIRED string entry, or NULL
-static STRING *string_index_search(const char *str, size_t length) {
+static STRING *string_index_search(const char *str, size_t length, uint64_t hash) {
     STRING *string;
 
-    uint8_t partition = string_partition_str(str);
+    uint8_t partition = string_partition_hash(hash);
 
     // Find the string in the index
     // With a read-lock so that multiple readers can use the index concurrently.
@@ -150,8 +225,9 @@ static STRING *string_index_search(const char *str, size_t length) {
         // found in the hash table
         string = *Rc;
 
-        if(string_entry_check_and_acquire(string)) {
+        if(string_entry_check_and_acquire(string, partition)) {
             // we can use this entry
+            string_cache_set(partition, hash, string);
             string_internal_stats_add(partition, found_available_on_search, 1);
         }
         else {
@@ -177,10 +253,10 @@ static STRING *string_index_search(const char *str, size_t length) {
 // The returned entry is ACQUIRED, and it can either be:
 //   1. a new item inserted, or
 //   2. an item found in the index that is not currently deleted
-static STRING *string_index_insert(const char *str, size_t length) {
+static STRING *string_index_insert(const char *str, size_t length, uint64_t hash) {
     STRING *string;
 
-    uint8_t partition = string_partition_str(str);
+    uint8_t partition = string_partition_hash(hash);
 
     rw_spinlock_write_lock(&string_base[partition].spinlock);
 
@@ -226,6 +302,7 @@ static STRING *string_index_insert(const char *str, size_t length) {
 #endif
         
         *ptr = string;
+        string_cache_set(partition, hash, string);
         string_base[partition].inserts++;
         string_base[partition].entries++;
         string_base[partition].memory += mem_size;
@@ -235,8 +312,9 @@ static STRING *string_index_insert(const char *str, size_t length) {
         // the item is already in the index
         string = *ptr;
 
-        if(string_entry_check_and_acquire(string)) {
+        if(string_entry_check_and_acquire(string, partition)) {
             // we can use this entry
+            string_cache_set(partition, hash, string);
             string_internal_stats_add(partition, found_available_on_insert, 1);
         }
         else {
@@ -255,7 +333,8 @@ static STRING *string_index_insert(const char *str, size_t length) {
 
 // delete an entry from the index
 static void string_index_delete(STRING *string) {
-    uint8_t partition = string_partition(string);
+    uint64_t hash = string_hash(string->str, string->length);
+    uint8_t partition = string_partition_hash(hash);
 
     rw_spinlock_write_lock(&string_base[partition].spinlock);
 
@@ -295,7 +374,8 @@ static void string_index_delete(STRING *string) {
         if (string_base[partition].JudyLPointers)
             JudyLDel(&string_base[partition].JudyLPointers, (Word_t)string, PJE0);
 #endif
-        
+
+        string_cache_del_and_wait(partition, hash, string);
         freez(string);
     }
 
@@ -306,19 +386,23 @@ ALWAYS_INLINE
 STRING *string_strdupz(const char *str) {
     if(unlikely(!str || !*str)) return NULL;
 
+    size_t length = strlen(str) + 1;
+    uint64_t hash = string_hash(str, length);
+
 #ifdef NETDATA_INTERNAL_CHECKS
-    uint8_t partition = string_partition_str(str);
+    uint8_t partition = string_partition_hash(hash);
 #endif
 
-    size_t length = strlen(str) + 1;
-    STRING *string = string_index_search(str, length);
+    STRING *string = string_cache_search(str, length, hash);
+    if(!string)
+        string = string_index_search(str, length, hash);
 
     while(!string) {
         // The search above did not find anything,
         // We loop here, because during insert we may find an entry that is being deleted by another thread.
         // So, we have to let it go and retry to insert it again.
 
-        string = string_index_insert(str, length);
+        string = string_index_insert(str, length, hash);
     }
 
     // statistics
@@ -336,17 +420,22 @@ ALWAYS_INLINE
 STRING *string_strndupz(const char *str, size_t len) {
     if(unlikely(!str || !*str || !len)) return NULL;
 
-#ifdef NETDATA_INTERNAL_CHECKS
-    uint8_t partition = string_partition_str(str);
-#endif
-
     char buf[len + 1];
     memcpy(buf, str, len);
     buf[len] = '\0';
 
-    STRING *string = string_index_search(buf, len + 1);
+    uint64_t hash = string_hash(buf, len + 1);
+
+#ifdef NETDATA_INTERNAL_CHECKS
+    uint8_t partition = string_partition_hash(hash);
+#endif
+
+    STRING *string = string_cache_search(buf, len + 1, hash);
+    if(!string)
+        string = string_index_search(buf, len + 1, hash);
+
     while(!string)
-        string = string_index_insert(buf, len + 1);
+        string = string_index_insert(buf, len + 1, hash);
 
     string_stats_atomic_increment(partition, active_references);
 
@@ -506,6 +595,55 @@ static void string_thread(void *arg) {
     }
 }
 
+struct thread_contention_unittest {
+    int join;
+    size_t names;
+    char **names_array;
+    size_t ops;
+};
+
+static void string_contention_thread(void *arg) {
+    struct thread_contention_unittest *tu = arg;
+    size_t ops = 0;
+
+    for(size_t i = gettid_cached(); 1 ; i++) {
+        if(unlikely((ops & 1023) == 0 && __atomic_load_n(&tu->join, __ATOMIC_RELAXED)))
+            break;
+
+        string_freez(string_strdupz(tu->names_array[i % tu->names]));
+        ops++;
+    }
+
+    __atomic_add_fetch(&tu->ops, ops, __ATOMIC_RELAXED);
+}
+
+// lookups of existing strings from many threads, all sharing a few common prefixes
+static double string_unittest_contention(char **names, size_t entries, size_t threads, time_t seconds_to_run) {
+    struct thread_contention_unittest tu = {
+        .join = 0,
+        .names = entries,
+        .names_array = names,
+        .ops = 0,
+    };
+
+    ND_THREAD *th[threads];
+    for(size_t i = 0; i < threads; i++) {
+        char buf[100 + 1];
+        snprintf(buf, 100, "strbench%zu", i);
+        th[i] = nd_thread_create(buf, NETDATA_THREAD_OPTION_DONT_LOG, string_contention_thread, &tu);
+    }
+
+    usec_t start_ut = now_monotonic_usec();
+    sleep_usec(seconds_to_run * USEC_PER_SEC);
+
+    __atomic_store_n(&tu.join, 1, __ATOMIC_RELAXED);
+    for(size_t i = 0; i < threads; i++)
+        nd_thread_join(th[i]);
+
+    usec_t dt_ut = now_monotonic_usec() - start_ut;
+    return (double)__atomic_load_n(&tu.ops, __ATOMIC_RELAXED) * (double)USEC_PER_SEC / (double)dt_ut;
+}
+
 static char **string_unittest_generate_names(size_t entries) {
     char **names = mallocz(sizeof(char *) * entries);
     for(size_t i = 0; i < entries ;i++) {
@@ -623,6 +761,7 @@ size_t string_destroy(void) {
         string_base[partition].found_available_on_search = 0;
         string_base[partition].found_deleted_on_insert = 0;
         string_base[partition].found_available_on_insert = 0;
+        string_base[partition].found_available_on_cache = 0;
         string_base[partition].spins = 0;
 #endif
 
@@ -734,6 +873,13 @@ static size_t unittest_string_found_available_on_insert(void) {
 
     return entries;
 }
+static size_t unittest_string_found_available_on_cache(void) {
+    size_t entries = 0;
+    for(size_t p = 0; p < STRING_PARTITIONS ;p++)
+        entries += string_base[p].found_available_on_cache;
+
+    return entries;
+}
 static size_t unittest_string_spins(void) {
     size_t entries = 0;
     for(size_t p = 0; p < STRING_PARTITIONS ;p++)
@@ -895,6 +1041,7 @@ int string_unittest(size_t entries) {
                ofound_available_on_search = unittest_string_found_available_on_search(),
                ofound_deleted_on_insert = unittest_string_found_deleted_on_insert(),
                ofound_available_on_insert = unittest_string_found_available_on_insert(),
+               ofound_available_on_cache = unittest_string_found_available_on_cache(),
                ospins = unittest_string_spins();
 #endif
 
@@ -933,18 +1080,79 @@ int string_unittest(size_t entries) {
                found_available_on_search = unittest_string_found_available_on_search(),
                found_deleted_on_insert = unittest_string_found_deleted_on_insert(),
                found_available_on_insert = unittest_string_found_available_on_insert(),
+               found_available_on_cache = unittest_string_found_available_on_cache(),
                spins = unittest_string_spins();
 
-        fprintf(stderr, "on insert: %zu ok + %zu deleted\non search: %zu ok + %zu deleted\nspins: %zu\n",
+        fprintf(stderr, "on insert: %zu ok + %zu deleted\non search: %zu ok + %zu deleted\non cache: %zu ok\nspins: %zu\n",
                 found_available_on_insert - ofound_available_on_insert,
                 found_deleted_on_insert - ofound_deleted_on_insert,
                 found_available_on_search - ofound_available_on_search,
                 found_deleted_on_search - ofound_deleted_on_search,
+                found_available_on_cache - ofound_available_on_cache,
                 spins - ospins
         );
 #endif
     }
 
+    // contention benchmark
+    {
+        const char *prefixes[] = { "system.", "cgroup_", "k8s_", "net.", };
+        size_t names_count = 4096;
+        char **prefixed = mallocz(sizeof(char *) * names_count);
+        STRING **held = mallocz(sizeof(STRING *) * names_count);
+
+        bool first_byte_used[256] = { 0 }, hash_used[256] = { 0 };
+        size_t first_byte_partitions = 0, hash_partitions = 0;
+
+        for(size_t i = 0; i < names_count ;i++) {
+            char buf[100 + 1];
+            snprintfz(buf, sizeof(buf) - 1, "%sunittest_%zu.dimension_%zu", prefixes[i % _countof(prefixes)], i, i * 7);
+            prefixed[i] = strdupz(buf);
+
+            // keep them referenced, so that the benchmark measures lookups of existing strings
+            held[i] = string_strdupz(prefixed[i]);
+
+            uint8_t fb = (uint8_t)buf[0];
+            if(!first_byte_used[fb]) { first_byte_used[fb] = true; first_byte_partitions++; }
+
+            uint8_t hp = string_partition_hash(string_hash(buf, strlen(buf) + 1));
+            if(!hash_used[hp]) { hash_used[hp] = true; hash_partitions++; }
+        }
+
+        fprintf(stderr, "\nChecking string contention with %zu names sharing %zu prefixes...\n",
+                names_count, _countof(prefixes));
+        fprintf(stderr, "partitions used: %zu by the first byte, %zu by the hash (of %d)\n",
+                first_byte_partitions, hash_partitions, STRING_PARTITIONS);
+
+        if(hash_partitions < STRING_PARTITIONS / 2) {
+            errors++;
+            fprintf(stderr, "ERROR: strings are not spread across the partitions\n");
+        }
+
+        size_t threads = MIN(MAX(os_get_system_cpus(), 2), 16);
+        time_t seconds_to_run = 2;
+
+        __atomic_store_n(&string_cache_enabled, false, __ATOMIC_RELAXED);
+        double locked_ops = string_unittest_contention(prefixed, names_count, threads, seconds_to_run);
+
+        __atomic_store_n(&string_cache_enabled, true, __ATOMIC_RELAXED);
+        double lockfree_ops = string_unittest_contention(prefixed, names_count, threads, seconds_to_run);
+
+        fprintf(stderr, "%zu threads, strdupz/freez of existing strings: %.0f ops/s locked, %.0f ops/s lock-free (%.2fx)\n",
+                threads, locked_ops, lockfree_ops, locked_ops > 0 ? lockfree_ops / locked_ops : 0.0);
+
+        for(size_t i = 0; i < names_count ;i++) {
+            if(held[i]->refcount != 1) {
+                errors++;
+                fprintf(stderr, "ERROR: string '%s' has refcount %d after the benchmark, expected 1\n",
+                        string2str(held[i]), held[i]->refcount);
+            }
+            string_freez(held[i]);
+        }
+        freez(held);
+        string_unittest_free_char_pp(prefixed, names_count);
+    }
+
     string_unittest_free_char_pp(names, entries);
 
     fprintf(stderr, "\n%zu errors found\n", errors);
@@ -706,30 +706,8 @@ static inline PARSER_RC pluginsd_clabel_commit(char **words __maybe_unused, size
     return PARSER_RC_OK;
 }
 
-static ALWAYS_INLINE PARSER_RC pluginsd_begin_v2(char **words, size_t num_words, PARSER *parser) {
-    timing_init();
-
-    int idx = 1;
-    ssize_t slot = pluginsd_parse_rrd_slot(words, num_words);
-    if(slot >= 0) idx++;
-
-    char *id = get_word(words, num_words, idx++);
-    char *update_every_str = get_word(words, num_words, idx++);
-    char *end_time_str = get_word(words, num_words, idx++);
-    char *wall_clock_time_str = get_word(words, num_words, idx++);
-
-    if(unlikely(!id || !update_every_str || !end_time_str || !wall_clock_time_str))
-        return PLUGINSD_DISABLE_PLUGIN(parser, PLUGINSD_KEYWORD_BEGIN_V2, "missing parameters");
-
-    RRDHOST *host = pluginsd_require_scope_host(parser, PLUGINSD_KEYWORD_BEGIN_V2);
-    if(unlikely(!host)) return PLUGINSD_DISABLE_PLUGIN(parser, NULL, NULL);
-
-    timing_step(TIMING_STEP_BEGIN2_PREPARE);
-
-    RRDSET *st = pluginsd_rrdset_cache_get_from_slot(parser, host, id, slot, PLUGINSD_KEYWORD_BEGIN_V2);
-
-    if(unlikely(!st)) return PLUGINSD_DISABLE_PLUGIN(parser, NULL, NULL);
-
+// the text parameters are given only when they can be copied as-is to our parent
+static ALWAYS_INLINE PARSER_RC pluginsd_begin_v2_chart(PARSER *parser, RRDSET *st, time_t update_every, time_t end_time, time_t wall_clock_time, const char *update_every_str, const char *end_time_str, const char *wall_clock_time_str) {
     if(!pluginsd_set_scope_chart(parser, st, PLUGINSD_KEYWORD_BEGIN_V2))
         return PLUGINSD_DISABLE_PLUGIN(parser, NULL, NULL);
 
@@ -743,18 +721,6 @@ static ALWAYS_INLINE PARSER_RC pluginsd_begin_v2(char **words, size_t num_words,
 
     timing_step(TIMING_STEP_BEGIN2_FIND_CHART);
 
-    // ------------------------------------------------------------------------
-    // parse the parameters
-
-    time_t update_every = (time_t) str2ull_encoded(update_every_str);
-    time_t end_time = (time_t) str2ull_encoded(end_time_str);
-
-    time_t wall_clock_time;
-    if(likely(*wall_clock_time_str == '#'))
-        wall_clock_time = end_time;
-    else
-        wall_clock_time = (time_t) str2ull_encoded(wall_clock_time_str);
-
     if (unlikely(update_every != st->update_every))
         rrdset_set_update_every_s(st, update_every);
 
@@ -778,9 +744,19 @@ static ALWAYS_INLINE PARSER_RC pluginsd_begin_v2(char **words, size_t num_words,
     if(!parser->user.v2.stream_buffer.wb && rrdhost_has_stream_sender_enabled(st->rrdhost))
         parser->user.v2.stream_buffer = stream_send_metrics_init(parser->user.st, wall_clock_time);
 
-    if(parser->user.v2.stream_buffer.v2 && parser->user.v2.stream_buffer.wb) {
+    if(parser->user.v2.stream_buffer.v2 && parser->user.v2.stream_buffer.wb && parser->user.v2.stream_buffer.binary) {
+        if(unlikely(parser->user.v2.stream_buffer.begin_v2_added))
+            stream_send_rrdset_end_v2_binary(&parser->user.v2.stream_buffer);
+
+        stream_send_rrdset_begin_v2_binary(&parser->user.v2.stream_buffer, st, update_every, end_time, wall_clock_time);
+
+        parser->user.v2.stream_buffer.last_point_end_time_s = end_time;
+        parser->user.v2.stream_buffer.begin_v2_added = true;
+    }
+    else if(parser->user.v2.stream_buffer.v2 && parser->user.v2.stream_buffer.wb) {
         // check receiver capabilities
-        bool can_copy = stream_has_capability(&parser->user, STREAM_CAP_IEEE754) == stream_has_capability(&parser->user.v2.stream_buffer, STREAM_CAP_IEEE754);
+        bool can_copy = update_every_str &&
+            stream_has_capability(&parser->user, STREAM_CAP_IEEE754) == stream_has_capability(&parser->user.v2.stream_buffer, STREAM_CAP_IEEE754);
 
         // check sender capabilities
         bool with_slots = stream_has_capability(&parser->user.v2.stream_buffer, STREAM_CAP_SLOTS) ? true : false;
@@ -851,32 +827,48 @@ static ALWAYS_INLINE PARSER_RC pluginsd_begin_v2(char **words, size_t num_words,
     return PARSER_RC_OK;
 }
 
-static ALWAYS_INLINE PARSER_RC pluginsd_set_v2(char **words, size_t num_words, PARSER *parser) {
+static ALWAYS_INLINE PARSER_RC pluginsd_begin_v2(char **words, size_t num_words, PARSER *parser) {
     timing_init();
 
     int idx = 1;
     ssize_t slot = pluginsd_parse_rrd_slot(words, num_words);
     if(slot >= 0) idx++;
 
-    char *dimension = get_word(words, num_words, idx++);
-    char *collected_str = get_word(words, num_words, idx++);
-    char *value_str = get_word(words, num_words, idx++);
-    char *flags_str = get_word(words, num_words, idx++);
+    char *id = get_word(words, num_words, idx++);
+    char *update_every_str = get_word(words, num_words, idx++);
+    char *end_time_str = get_word(words, num_words, idx++);
+    char *wall_clock_time_str = get_word(words, num_words, idx++);
 
-    if(unlikely(!dimension || !collected_str || !value_str || !flags_str))
-        return PLUGINSD_DISABLE_PLUGIN(parser, PLUGINSD_KEYWORD_SET_V2, "missing parameters");
+    if(unlikely(!id || !update_every_str || !end_time_str || !wall_clock_time_str))
+        return PLUGINSD_DISABLE_PLUGIN(parser, PLUGINSD_KEYWORD_BEGIN_V2, "missing parameters");
 
-    RRDHOST *host = pluginsd_require_scope_host(parser, PLUGINSD_KEYWORD_SET_V2);
+    RRDHOST *host = pluginsd_require_scope_host(parser, PLUGINSD_KEYWORD_BEGIN_V2);
     if(unlikely(!host)) return PLUGINSD_DISABLE_PLUGIN(parser, NULL, NULL);
 
-    RRDSET *st = pluginsd_require_scope_chart(parser, PLUGINSD_KEYWORD_SET_V2, PLUGINSD_KEYWORD_BEGIN_V2);
+    timing_step(TIMING_STEP_BEGIN2_PREPARE);
+
+    RRDSET *st = pluginsd_rrdset_cache_get_from_slot(parser, host, id, slot, PLUGINSD_KEYWORD_BEGIN_V2);
+
     if(unlikely(!st)) return PLUGINSD_DISABLE_PLUGIN(parser, NULL, NULL);
 
-    timing_step(TIMING_STEP_SET2_PREPARE);
+    // ------------------------------------------------------------------------
+    // parse the parameters
 
-    RRDDIM *rd = pluginsd_acquire_dimension(host, st, dimension, slot, PLUGINSD_KEYWORD_SET_V2);
-    if(unlikely(!rd)) return PLUGINSD_DISABLE_PLUGIN(parser, NULL, NULL);
+    time_t update_every = (time_t) str2ull_encoded(update_every_str);
+    time_t end_time = (time_t) str2ull_encoded(end_time_str);
 
+    time_t wall_clock_time;
+    if(likely(*wall_clock_time_str == '#'))
+        wall_clock_time = end_time;
+    else
+        wall_clock_time = (time_t) str2ull_encoded(wall_clock_time_str);
+
+    return pluginsd_begin_v2_chart(parser, st, update_every, end_time, wall_clock_time,
+                                   update_every_str, end_time_str, wall_clock_time_str);
+}
+
+// the text parameters are given only when they can be copied as-is to our parent
+static ALWAYS_INLINE PARSER_RC pluginsd_set_v2_dimension(PARSER *parser, RRDSET *st, RRDDIM *rd, collected_number collected_value, NETDATA_DOUBLE value, SN_FLAGS flags, const char *collected_str, const char *value_str) {
     st->pluginsd.set = true;
 
     if(unlikely(rrddim_flag_check(rd, RRDDIM_FLAG_OBSOLETE))) {
@@ -888,20 +880,6 @@ static ALWAYS_INLINE PARSER_RC pluginsd_set_v2(char **words, size_t num_words, P
     }
 
     timing_step(TIMING_STEP_SET2_LOOKUP_DIMENSION);
-
-    // ------------------------------------------------------------------------
-    // parse the parameters
-
-    collected_number collected_value = (collected_number) str2ll_encoded(collected_str);
-
-    NETDATA_DOUBLE value;
-    if(*value_str == '#')
-        value = (NETDATA_DOUBLE)collected_value;
-    else
-        value = str2ndd_encoded(value_str, NULL);
-
-    SN_FLAGS flags = pluginsd_parse_storage_number_flags(flags_str);
-
     timing_step(TIMING_STEP_SET2_PARSE);
 
     // ------------------------------------------------------------------------
@@ -941,9 +919,14 @@ static ALWAYS_INLINE PARSER_RC pluginsd_set_v2(char **words, size_t num_words, P
     // ------------------------------------------------------------------------
     // propagate it forward in v2
 
-    if(parser->user.v2.stream_buffer.v2 && parser->user.v2.stream_buffer.begin_v2_added && parser->user.v2.stream_buffer.wb) {
+    if(parser->user.v2.stream_buffer.v2 && parser->user.v2.stream_buffer.begin_v2_added && parser->user.v2.stream_buffer.wb &&
+        parser->user.v2.stream_buffer.binary) {
+        stream_send_rrddim_set_v2_binary(&parser->user.v2.stream_buffer, rd, collected_value, value, flags);
+    }
+    else if(parser->user.v2.stream_buffer.v2 && parser->user.v2.stream_buffer.begin_v2_added && parser->user.v2.stream_buffer.wb) {
         // check if receiver and sender have the same number parsing capabilities
-        bool can_copy = stream_has_capability(&parser->user, STREAM_CAP_IEEE754) == stream_has_capability(&parser->user.v2.stream_buffer, STREAM_CAP_IEEE754);
+        bool can_copy = collected_str && value_str &&
+            stream_has_capability(&parser->user, STREAM_CAP_IEEE754) == stream_has_capability(&parser->user.v2.stream_buffer, STREAM_CAP_IEEE754);
 
         // check the sender capabilities
         bool with_slots = stream_has_capability(&parser->user.v2.stream_buffer, STREAM_CAP_SLOTS) ? true : false;
@@ -995,6 +978,48 @@ static ALWAYS_INLINE PARSER_RC pluginsd_set_v2(char **words, size_t num_words, P
     return PARSER_RC_OK;
 }
 
+static ALWAYS_INLINE PARSER_RC pluginsd_set_v2(char **words, size_t num_words, PARSER *parser) {
+    timing_init();
+
+    int idx = 1;
+    ssize_t slot = pluginsd_parse_rrd_slot(words, num_words);
+    if(slot >= 0) idx++;
+
+    char *dimension = get_word(words, num_words, idx++);
+    char *collected_str = get_word(words, num_words, idx++);
+    char *value_str = get_word(words, num_words, idx++);
+    char *flags_str = get_word(words, num_words, idx++);
+
+    if(unlikely(!dimension || !collected_str || !value_str || !flags_str))
+        return PLUGINSD_DISABLE_PLUGIN(parser, PLUGINSD_KEYWORD_SET_V2, "missing parameters");
+
+    RRDHOST *host = pluginsd_require_scope_host(parser, PLUGINSD_KEYWORD_SET_V2);
+    if(unlikely(!host)) return PLUGINSD_DISABLE_PLUGIN(parser, NULL, NULL);
+
+    RRDSET *st = pluginsd_require_scope_chart(parser, PLUGINSD_KEYWORD_SET_V2, PLUGINSD_KEYWORD_BEGIN_V2);
+    if(unlikely(!st)) return PLUGINSD_DISABLE_PLUGIN(parser, NULL, NULL);
+
+    timing_step(TIMING_STEP_SET2_PREPARE);
+
+    RRDDIM *rd = pluginsd_acquire_dimension(host, st, dimension, slot, PLUGINSD_KEYWORD_SET_V2);
+    if(unlikely(!rd)) return PLUGINSD_DISABLE_PLUGIN(parser, NULL, NULL);
+
+    // ------------------------------------------------------------------------
+    // parse the parameters
+
+    collected_number collected_value = (collected_number) str2ll_encoded(collected_str);
+
+    NETDATA_DOUBLE value;
+    if(*value_str == '#')
+        value = (NETDATA_DOUBLE)collected_value;
+    else
+        value = str2ndd_encoded(value_str, NULL);
+
+    SN_FLAGS flags = pluginsd_parse_storage_number_flags(flags_str);
+
+    return pluginsd_set_v2_dimension(parser, st, rd, collected_value, value, flags, collected_str, value_str);
+}
+
 static ALWAYS_INLINE PARSER_RC pluginsd_end_v2(char **words __maybe_unused, size_t num_words __maybe_unused, PARSER *parser) {
     timing_init();
 
@@ -1068,6 +1093,142 @@ static ALWAYS_INLINE PARSER_RC pluginsd_end_v2(char **words __maybe_unused, size
     return PARSER_RC_OK;
 }
 
+// ----------------------------------------------------------------------------
+// binary BEGIN2 / SET2 / END2 (STREAM_CAP_BINARY_FRAMES)
+// the records are decoded in place, without tokenizing anything
+
+static ALWAYS_INLINE PARSER_RC pluginsd_begin_v2_binary(PARSER *parser, const char **s, const char *e) {
+    timing_init();
+
+    uint64_t slot, update_every, end_time;
+    int64_t wall_clock_delta;
+    if(unlikely(!stream_binary_get_varint(s, e, &slot) ||
+                !stream_binary_get_varint(s, e, &update_every) ||
+                !stream_binary_get_varint(s, e, &end_time) ||
+                !stream_binary_get_zigzag(s, e, &wall_clock_delta)))
+        return PLUGINSD_DISABLE_PLUGIN(parser, PLUGINSD_KEYWORD_BEGIN_V2, "truncated binary record");
+
+    RRDHOST *host = pluginsd_require_scope_host(parser, PLUGINSD_KEYWORD_BEGIN_V2);
+    if(unlikely(!host)) return PLUGINSD_DISABLE_PLUGIN(parser, NULL, NULL);
+
+    timing_step(TIMING_STEP_BEGIN2_PREPARE);
+
+    RRDSET *st = NULL;
+    if(likely(slot >= 1 && slot <= host->stream.rcv.pluginsd_chart_slots.size))
+        st = host->stream.rcv.pluginsd_chart_slots.array[slot - 1];
+
+    if(unlikely(!st)) {
+        // the records carry no ids to look the chart up with, so we skip
+        // this chart until its END, instead of disconnecting the child
+        nd_log_limit_static_global_var(erl, 60, 0);
+        nd_log_limit(&erl, NDLS_DAEMON, NDLP_WARNING,
+                     "PLUGINSD: 'host:%s' binary BEGIN2 for unknown chart slot %"PRIu64", skipping the chart",
+                     rrdhost_hostname(host), slot);
+
+        parser->user.v2.binary_chart_skipped = true;
+        return PARSER_RC_OK;
+    }
+
+    parser->user.v2.binary_chart_skipped = false;
+    return pluginsd_begin_v2_chart(parser, st, (time_t)update_every, (time_t)end_time,
+                                   (time_t)end_time + (time_t)wall_clock_delta, NULL, NULL, NULL);
+}
+
+static ALWAYS_INLINE PARSER_RC pluginsd_set_v2_binary(PARSER *parser, const char **s, const char *e) {
+    timing_init();
+
+    uint64_t slot;
+    int64_t collected_value;
+    if(unlikely(!stream_binary_get_varint(s, e, &slot) ||
+                !stream_binary_get_zigzag(s, e, &collected_value) ||
+                *s >= e))
+        return PLUGINSD_DISABLE_PLUGIN(parser, PLUGINSD_KEYWORD_SET_V2, "truncated binary record");
+
+    uint8_t set_flags = (uint8_t)*(*s)++;
+
+    NETDATA_DOUBLE value;
+    if(set_flags & STREAM_BINARY_SET_HAS_VALUE) {
+        if(unlikely(!stream_binary_get_double(s, e, &value)))
+            return PLUGINSD_DISABLE_PLUGIN(parser, PLUGINSD_KEYWORD_SET_V2, "truncated binary record");
+    }
+    else
+        value = (NETDATA_DOUBLE)collected_value;
+
+    if(unlikely(parser->user.v2.binary_chart_skipped))
+        return PARSER_RC_OK;
+
+    RRDHOST *host = pluginsd_require_scope_host(parser, PLUGINSD_KEYWORD_SET_V2);
+    if(unlikely(!host)) return PLUGINSD_DISABLE_PLUGIN(parser, NULL, NULL);
+
+    RRDSET *st = pluginsd_require_scope_chart(parser, PLUGINSD_KEYWORD_SET_V2, PLUGINSD_KEYWORD_BEGIN_V2);
+    if(unlikely(!st)) return PLUGINSD_DISABLE_PLUGIN(parser, NULL, NULL);
+
+    timing_step(TIMING_STEP_SET2_PREPARE);
+
+    RRDDIM *rd = NULL;
+    if(likely(st->pluginsd.dims_with_slots && slot >= 1 && slot <= st->pluginsd.size))
+        rd = st->pluginsd.prd_array[slot - 1].rd;
+
+    if(unlikely(!rd)) {
+        nd_log_limit_static_global_var(erl, 60, 0);
+        nd_log_limit(&erl, NDLS_DAEMON, NDLP_WARNING,
+                     "PLUGINSD: 'host:%s/chart:%s' binary SET2 for unknown dimension slot %"PRIu64", skipping it",
+                     rrdhost_hostname(host), rrdset_id(st), slot);
+        return PARSER_RC_OK;
+    }
+
+    return pluginsd_set_v2_dimension(parser, st, rd, (collected_number)collected_value, value,
+                                     stream_binary_set_flags_to_sn_flags(set_flags), NULL, NULL);
+}
+
+int parser_binary_frame(PARSER *parser, const char *frame, size_t len) {
+    parser->line.count++;
+
+    if(unlikely(!stream_has_capability(&parser->user, STREAM_CAP_BINARY_FRAMES) ||
+                len < BUFFERED_READER_FRAME_HEADER_SIZE ||
+                len != BUFFERED_READER_FRAME_HEADER_SIZE + buffered_reader_frame_payload_size(frame))) {
+        nd_log(NDLS_DAEMON, NDLP_ERR,
+               "PLUGINSD: invalid binary frame of %zu bytes on line %zu", len, parser->line.count);
+        return 1;
+    }
+
+    const char *s = &frame[BUFFERED_READER_FRAME_HEADER_SIZE];
+    const char *e = &frame[len];
+
+    PARSER_RC rc = PARSER_RC_OK;
+    while(s < e && rc == PARSER_RC_OK) {
+        switch((STREAM_BINARY_RECORD)*s++) {
+            case STREAM_BINARY_RECORD_SET:
+                rc = pluginsd_set_v2_binary(parser, &s, e);
+                break;
+
+            case STREAM_BINARY_RECORD_BEGIN:
+                rc = pluginsd_begin_v2_binary(parser, &s, e);
+                break;
+
+            case STREAM_BINARY_RECORD_END:
+                if(unlikely(parser->user.v2.binary_chart_skipped))
+                    parser->user.v2.binary_chart_skipped = false;
+                else
+                    rc = pluginsd_end_v2(NULL, 0, parser);
+                break;
+
+            case STREAM_BINARY_RECORD_REPLAY_PAGE:
+                rc = pluginsd_replay_page_binary(parser, &s, e);
+                break;
+
+            default:
+                rc = PLUGINSD_DISABLE_PLUGIN(parser, "BINARY", "unknown binary record");
+                break;
+        }
+    }
+
+    if(rc == PARSER_RC_ERROR)
+        netdata_log_error("PLUGINSD: binary frame of %zu bytes failed on line %zu", len, parser->line.count);
+
+    return (rc == PARSER_RC_ERROR || rc == PARSER_RC_STOP);
+}
+
 static inline PARSER_RC pluginsd_exit(char **words __maybe_unused, size_t num_words __maybe_unused, PARSER *parser __maybe_unused) {
     netdata_log_info("PLUGINSD: plugin called EXIT.");
     return PARSER_RC_STOP;
@@ -1385,3 +1546,229 @@ int pluginsd_parser_unittest(void) {
     parser_destroy(p);
     return 0;
 }
+
+// ----------------------------------------------------------------------------
+// binary frames unittest
+
+static int pluginsd_binary_codecs_unittest(void) {
+    int errors = 0;
+    char buf[16];
+
+    uint64_t varints[] = { 0, 1, 127, 128, 16383, 16384, UINT32_MAX, (uint64_t)UINT32_MAX + 1, UINT64_MAX };
+    for(size_t i = 0; i < sizeof(varints) / sizeof(varints[0]); i++) {
+        size_t len = stream_binary_put_varint(buf, varints[i]);
+        const char *s = buf;
+        uint64_t v = 0;
+        if(!stream_binary_get_varint(&s, &buf[len], &v) || v != varints[i] || s != &buf[len]) {
+            fprintf(stderr, "BINARY FRAMES: varint %"PRIu64" does not roundtrip\n", varints[i]);
+            errors++;
+        }
+
+        s = buf;
+        if(stream_binary_get_varint(&s, &buf[len - 1], &v) || s != buf) {
+            fprintf(stderr, "BINARY FRAMES: truncated varint %"PRIu64" is accepted\n", varints[i]);
+            errors++;
+        }
+    }
+
+    int64_t zigzags[] = { 0, 1, -1, 63, -64, 64, -65, INT32_MAX, INT32_MIN, INT64_MAX, INT64_MIN };
+    for(size_t i = 0; i < sizeof(zigzags) / sizeof(zigzags[0]); i++) {
+        size_t len = stream_binary_put_zigzag(buf, zigzags[i]);
+        const char *s = buf;
+        int64_t v = 0;
+        if(!stream_binary_get_zigzag(&s, &buf[len], &v) || v != zigzags[i] || s != &buf[len]) {
+            fprintf(stderr, "BINARY FRAMES: zigzag %"PRId64" does not roundtrip\n", zigzags[i]);
+            errors++;
+        }
+    }
+
+    // small magnitudes must stay small on the wire
+    if(stream_binary_put_zigzag(buf, -64) != 1 || stream_binary_put_zigzag(buf, 63) != 1) {
+        fprintf(stderr, "BINARY FRAMES: zigzag does not encode small values in 1 byte\n");
+        errors++;
+    }
+
+    NETDATA_DOUBLE doubles[] = { 0.0, -0.5, 1.0 / 3.0, 1e300, -1e-300 };
+    for(size_t i = 0; i < sizeof(doubles) / sizeof(doubles[0]); i++) {
+        size_t len = stream_binary_put_double(buf, doubles[i]);
+        const char *s = buf;
+        NETDATA_DOUBLE v = 0;
+        if(len != 8 || !stream_binary_get_double(&s, &buf[len], &v) || v != doubles[i] || s != &buf[len]) {
+            fprintf(stderr, "BINARY FRAMES: double " NETDATA_DOUBLE_FORMAT " does not roundtrip\n", doubles[i]);
+            errors++;
+        }
+
+        s = buf;
+        if(stream_binary_get_double(&s, &buf[len - 1], &v) || s != buf) {
+            fprintf(stderr, "BINARY FRAMES: truncated double is accepted\n");
+            errors++;
+        }
+    }
+
+    return errors;
+}
+
+static size_t pluginsd_binary_frame_build(char *dst, const char *payload, uint32_t len) {
+    dst[0] = BUFFERED_READER_FRAME_MARKER;
+    uint32_t le = htole32(len);
+    memcpy(&dst[1], &le, sizeof(le));
+    memcpy(&dst[BUFFERED_READER_FRAME_HEADER_SIZE], payload, len);
+    return BUFFERED_READER_FRAME_HEADER_SIZE + len;
+}
+
+// feed the input to the reader in chunks of the given size, and check that
+// the lines and the frames come out whole and in order
+static int pluginsd_binary_reader_unittest(const char *input, size_t input_len, size_t chunk, const char **expected, const size_t *expected_len) {
+    int errors = 0;
+    struct buffered_reader reader;
+    buffered_reader_init(&reader);
+    BUFFER *dst = buffer_create(sizeof(reader.read_buffer), NULL);
+
+    size_t outputs = 0;
+    for(size_t pos = 0; pos < input_len; pos += chunk) {
+        size_t n = MIN(chunk, input_len - pos);
+        memcpy(&reader.read_buffer[reader.read_len], &input[pos], n);
+        reader.read_len += (ssize_t)n;
+        reader.read_buffer[reader.read_len] = '\0';
+
+        while(buffered_reader_next_frame_or_line(&reader, dst)) {
+            if(!expected[outputs] || dst->len != expected_len[outputs] || memcmp(dst->buffer, expected[outputs], dst->len) != 0) {
+                fprintf(stderr, "BINARY FRAMES: output %zu of %zu bytes is wrong, with chunks of %zu bytes\n",
+                        outputs, (size_t)dst->len, chunk);
+                errors++;
+            }
+            outputs++;
+            buffer_flush(dst);
+        }
+    }
+
+    if(expected[outputs]) {
+        fprintf(stderr, "BINARY FRAMES: got %zu outputs, with chunks of %zu bytes\n", outputs, chunk);
+        errors++;
+    }
+
+    buffer_free(dst);
+    return errors;
+}
+
+int pluginsd_binary_frames_unittest(void) {
+    int errors = pluginsd_binary_codecs_unittest();
+
+    // ------------------------------------------------------------------------
+    // framing: lines and frames mixed, frames containing newlines and markers,
+    // a marker in the middle of a text line
+
+    char payload[] = { STREAM_BINARY_RECORD_END, '\n', BUFFERED_READER_FRAME_MARKER, '\n', STREAM_BINARY_RECORD_END };
+    char frame[BUFFERED_READER_FRAME_HEADER_SIZE + sizeof(payload)];
+    size_t frame_len = pluginsd_binary_frame_build(frame, payload, sizeof(payload));
+
+    const char *line1 = "BEGIN2 chart 1 2\n";
+    const char *line2 = "SET2 dim \x01 1 \n";
+    const char *line3 = "END2\n";
+
+    char input[256];
+    size_t input_len = 0;
+    memcpy(&input[input_len], line1, strlen(line1)); input_len += strlen(line1);
+    memcpy(&input[input_len], frame, frame_len); input_len += frame_len;
+    memcpy(&input[input_len], frame, frame_len); input_len += frame_len;
+    memcpy(&input[input_len], line2, strlen(line2)); input_len += strlen(line2);
+    memcpy(&input[input_len], frame, frame_len); input_len += frame_len;
+    memcpy(&input[input_len], line3, strlen(line3)); input_len += strlen(line3);
+
+    const char *expected[] = { line1, frame, frame, line2, frame, line3, NULL };
+    size_t expected_len[] = { strlen(line1), frame_len, frame_len, strlen(line2), frame_len, strlen(line3), 0 };
+
+    for(size_t chunk = 1; chunk <= input_len; chunk++)
+        errors += pluginsd_binary_reader_unittest(input, input_len, chunk, expected, expected_len);
+
+    // ------------------------------------------------------------------------
+    // a frame announcing an oversized payload is returned with its header only
+
+    {
+        char oversize[BUFFERED_READER_FRAME_HEADER_SIZE + 1];
+        oversize[0] = BUFFERED_READER_FRAME_MARKER;
+        uint32_t le = htole32((uint32_t)BUFFERED_READER_FRAME_MAX_PAYLOAD + 1);
+        memcpy(&oversize[1], &le, sizeof(le));
+        oversize[BUFFERED_READER_FRAME_HEADER_SIZE] = 'x';
+
+        const char *expected_oversize[] = { oversize, NULL };
+        size_t expected_oversize_len[] = { BUFFERED_READER_FRAME_HEADER_SIZE, 0 };
+        errors += pluginsd_binary_reader_unittest(oversize, sizeof(oversize), 1, expected_oversize, expected_oversize_len);
+        errors += pluginsd_binary_reader_unittest(oversize, sizeof(oversize), sizeof(oversize), expected_oversize, expected_oversize_len);
+    }
+
+    // ------------------------------------------------------------------------
+    // the parser rejects malformed frames
+
+    PARSER *p = parser_init(NULL, -1, -1, PARSER_INPUT_SPLIT, NULL);
+    pluginsd_keywords_init(p, PARSER_INIT_STREAMING);
+
+    char f[64];
+    size_t f_len;
+
+    // without the capability
+    f_len = pluginsd_binary_frame_build(f, payload, 1);
+    if(!parser_binary_frame(p, f, f_len)) {
+        fprintf(stderr, "BINARY FRAMES: frame accepted without STREAM_CAP_BINARY_FRAMES\n");
+        errors++;
+    }
+
+    p->user.capabilities = STREAM_CAP_BINARY_FRAMES;
+
+    // header only
+    if(!parser_binary_frame(p, f, BUFFERED_READER_FRAME_HEADER_SIZE - 1)) {
+        fprintf(stderr, "BINARY FRAMES: truncated frame header accepted\n");
+        errors++;
+    }
+
+    // length mismatch, as returned for oversized frames
+    if(!parser_binary_frame(p, f, BUFFERED_READER_FRAME_HEADER_SIZE)) {
+        fprintf(stderr, "BINARY FRAMES: frame shorter than its length accepted\n");
+        errors++;
+    }
+
+    // a BEGIN with its varints cut short
+    {
+        char rec[1 + 10];
+        size_t rec_len = 0;
+        rec[rec_len++] = STREAM_BINARY_RECORD_BEGIN;
+        rec_len += stream_binary_put_varint(&rec[rec_len], 1);
+        rec_len += stream_binary_put_varint(&rec[rec_len], 1000);
+        f_len = pluginsd_binary_frame_build(f, rec, rec_len);
+        if(!parser_binary_frame(p, f, f_len)) {
+            fprintf(stderr, "BINARY FRAMES: truncated BEGIN record accepted\n");
+            errors++;
+        }
+    }
+
+    // a SET with its double cut short
+    {
+        char rec[1 + 10 + 10 + 1 + 4];
+        size_t rec_len = 0;
+        rec[rec_len++] = STREAM_BINARY_RECORD_SET;
+        rec_len += stream_binary_put_varint(&rec[rec_len], 1);
+        rec_len += stream_binary_put_zigzag(&rec[rec_len], -5);
+        rec[rec_len++] = STREAM_BINARY_SET_HAS_VALUE;
+        memset(&rec[rec_len], 0, 4); rec_len += 4;
+        f_len = pluginsd_binary_frame_build(f, rec, rec_len);
+        if(!parser_binary_frame(p, f, f_len)) {
+            fprintf(stderr, "BINARY FRAMES: truncated SET record accepted\n");
+            errors++;
+        }
+    }
+
+    // an unknown record type
+    {
+        char rec[] = { 0x7f };
+        f_len = pluginsd_binary_frame_build(f, rec, sizeof(rec));
+        if(!parser_binary_frame(p, f, f_len)) {
+            fprintf(stderr, "BINARY FRAMES: unknown record accepted\n");
+            errors++;
+        }
+    }
+
+    parser_destroy(p);
+
+    fprintf(stderr, "BINARY FRAMES: %d errors\n", errors);
+    return errors;
+}
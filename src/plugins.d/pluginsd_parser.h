@@ -94,7 +94,12 @@ typedef struct parser_user_object {
         time_t end_time;
         time_t wall_clock_time;
         bool ml_locked;
+        bool binary_chart_skipped;          // binary BEGIN for an unknown chart slot, until its END
     } v2;
+
+    struct parser_user_object_spill {
+        bool skip;                          // the record of the child spill has already been applied, until its END
+    } spill;
 } PARSER_USER_OBJECT;
 
 typedef void (*parser_deferred_action_t)(struct parser *parser, void *action_data);
@@ -171,6 +176,10 @@ bool parser_reconstruct_node(BUFFER *wb, void *ptr);
 bool parser_reconstruct_instance(BUFFER *wb, void *ptr);
 bool parser_reconstruct_context(BUFFER *wb, void *ptr);
 
+// decodes a frame produced by buffered_reader_next_frame_or_line()
+// returns non-zero when the parser has to stop, like parser_action()
+int parser_binary_frame(PARSER *parser, const char *frame, size_t len);
+
 static inline int parser_action(PARSER *parser, char *input) {
 #ifdef NETDATA_LOG_STREAM_RECEIVER
     char line[1024];
@@ -6,6 +6,10 @@
 #include "streaming/stream-waiting-list.h"
 #include "web/api/queries/backfill.h"
 #include "database/rrddim-collection.h"
+#include "streaming/protocol/command-begin-set-end-binary.h"
+
+// the name of binary page records in the logs
+#define PLUGINSD_REPLAY_PAGE "RPAGE"
 
 static bool backfill_callback(size_t successful_dims __maybe_unused, size_t failed_dims __maybe_unused, struct backfill_request_data *brd) {
     if(!object_state_acquire(&brd->host->state_id, brd->host_state_id)) {
@@ -479,3 +483,105 @@ ALWAYS_INLINE PARSER_RC pluginsd_replay_end(char **words, size_t num_words, PARS
 
     return ok ? PARSER_RC_OK : PARSER_RC_ERROR;
 }
+
+// ----------------------------------------------------------------------------
+// whole pages of a dimension (STREAM_CAP_REPLAY_PAGES)
+
+struct replay_page_store {
+    RRDDIM *rd;
+    time_t after;                   // points up to this time are already stored
+    size_t points;
+};
+
+static void pluginsd_replay_page_points_cb(void *data, STORAGE_POINT *points, size_t entries) {
+    struct replay_page_store *rps = data;
+
+    for(size_t i = 0; i < entries ; i++) {
+        STORAGE_POINT *sp = &points[i];
+
+        // the same points RSET would get
+        if(sp->end_time_s <= rps->after || storage_point_is_unset(*sp) || storage_point_is_gap(*sp))
+            continue;
+
+        rrddim_store_metric(rps->rd, (usec_t)sp->end_time_s * USEC_PER_SEC, sp->sum, sp->flags);
+        rps->points++;
+    }
+}
+
+PARSER_RC pluginsd_replay_page_binary(PARSER *parser, const char **s, const char *e) {
+    uint64_t slot, id_len, update_every, first_time, entries, size;
+    char id[RRD_ID_LENGTH_MAX + 1];
+
+    if(unlikely(!stream_has_capability(&parser->user, STREAM_CAP_REPLAY_PAGES)))
+        return PLUGINSD_DISABLE_PLUGIN(parser, PLUGINSD_REPLAY_PAGE, "page records have not been negotiated");
+
+    if(unlikely(!stream_binary_get_varint(s, e, &slot) ||
+                !stream_binary_get_varint(s, e, &id_len) ||
+                id_len > RRD_ID_LENGTH_MAX || (uint64_t)(e - *s) <= id_len))
+        return PLUGINSD_DISABLE_PLUGIN(parser, PLUGINSD_REPLAY_PAGE, "truncated binary record");
+
+    memcpy(id, *s, id_len);
+    id[id_len] = '\0';
+    *s += id_len;
+
+    uint8_t type = (uint8_t)*(*s)++;
+
+    if(unlikely(!stream_binary_get_varint(s, e, &update_every) ||
+                !stream_binary_get_varint(s, e, &first_time) ||
+                !stream_binary_get_varint(s, e, &entries) ||
+                !stream_binary_get_varint(s, e, &size) ||
+                (uint64_t)(e - *s) < size))
+        return PLUGINSD_DISABLE_PLUGIN(parser, PLUGINSD_REPLAY_PAGE, "truncated binary record");
+
+    void *data = (void *)*s;
+    *s += size;
+
+    RRDHOST *host = pluginsd_require_scope_host(parser, PLUGINSD_REPLAY_PAGE);
+    if(!host) return PLUGINSD_DISABLE_PLUGIN(parser, NULL, NULL);
+
+    RRDSET *st = pluginsd_require_scope_chart(parser, PLUGINSD_REPLAY_PAGE, PLUGINSD_KEYWORD_REPLAY_BEGIN);
+    if(!st) return PLUGINSD_DISABLE_PLUGIN(parser, NULL, NULL);
+
+    RRDDIM *rd = pluginsd_acquire_dimension(host, st, id, (ssize_t)slot, PLUGINSD_REPLAY_PAGE);
+    if(!rd) return PLUGINSD_DISABLE_PLUGIN(parser, NULL, NULL);
+
+    st->pluginsd.set = true;
+
+    STORAGE_PAGE page = {
+        .type = type,
+        .update_every_s = (uint32_t)update_every,
+        .entries = (uint32_t)entries,
+        .first_time_s = (time_t)first_time,
+        .last_time_s = (time_t)(first_time + (entries ? entries - 1 : 0) * update_every),
+    };
+
+    struct replay_page_store rps = {
+        .rd = rd,
+        .after = rd->collector.last_collected_time.tv_sec,
+        .points = 0,
+    };
+
+    time_t tolerance = st->update_every + 5;
+    if(!update_every || update_every > 86400 || !entries || entries > UINT32_MAX || !first_time ||
+        page.last_time_s > now_realtime_sec() + tolerance ||
+        !storage_engine_page_points(&page, data, size, pluginsd_replay_page_points_cb, &rps)) {
+        nd_log_limit_static_thread_var(erl, 1, 0);
+        nd_log_limit(&erl, NDLS_DAEMON, NDLP_ERR,
+                     "PLUGINSD REPLAY ERROR: 'host:%s/chart:%s/dim:%s' got an invalid page "
+                     "(type %u, %llu entries, update every %llu, %llu bytes, from %llu). Ignoring it.",
+                     rrdhost_hostname(host), rrdset_id(st), rrddim_id(rd),
+                     (unsigned)type, (unsigned long long)entries, (unsigned long long)update_every,
+                     (unsigned long long)size, (unsigned long long)first_time);
+
+        // the rest of the stream is fine
+        return PARSER_RC_OK;
+    }
+
+    if(page.last_time_s > rps.after) {
+        rd->collector.last_collected_time.tv_sec = page.last_time_s;
+        rd->collector.last_collected_time.tv_usec = 0;
+    }
+    rd->collector.counter += rps.points;
+
+    return PARSER_RC_OK;
+}
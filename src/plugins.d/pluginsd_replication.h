@@ -10,6 +10,7 @@ PARSER_RC pluginsd_replay_set(char **words, size_t num_words, PARSER *parser);
 PARSER_RC pluginsd_replay_rrddim_collection_state(char **words, size_t num_words, PARSER *parser);
 PARSER_RC pluginsd_replay_rrdset_collection_state(char **words, size_t num_words, PARSER *parser);
 PARSER_RC pluginsd_replay_end(char **words, size_t num_words, PARSER *parser);
+PARSER_RC pluginsd_replay_page_binary(PARSER *parser, const char **s, const char *e);
 PARSER_RC pluginsd_chart_definition_end(char **words, size_t num_words, PARSER *parser);
 
 #endif //NETDATA_PLUGINSD_REPLICATION_H
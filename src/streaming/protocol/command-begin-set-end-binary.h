@@ -0,0 +1,137 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef NETDATA_STREAMING_PROTOCOL_COMMAND_BEGIN_SET_END_BINARY_H
+#define NETDATA_STREAMING_PROTOCOL_COMMAND_BEGIN_SET_END_BINARY_H
+
+#include "libnetdata/libnetdata.h"
+
+// ----------------------------------------------------------------------------
+// binary BEGIN2 / SET2 / END2 (STREAM_CAP_BINARY_FRAMES)
+//
+// The records are packed into frames that travel inside the normal text stream:
+//
+//   BUFFERED_READER_FRAME_MARKER | payload length (uint32 LE) | payload
+//
+// The marker can never start a text line, so the receiver can tell frames and
+// lines apart without any other negotiation, and frames survive compression
+// and chunking exactly like lines do.
+//
+// Charts and dimensions are identified by their slots only (STREAM_CAP_SLOTS is
+// required), integers are varints, the collected value is zigzag encoded and
+// the stored value is an IEEE754 double that is omitted when it equals the
+// collected value.
+//
+// Replication uses the same frames to send whole dbengine pages of a dimension
+// (STREAM_CAP_REPLAY_PAGES), one page per frame, within the RBEGIN / REND of the
+// chart. The page carries its on-disk data, so it is sent without decoding it.
+
+#define STREAM_BINARY_FRAME_MAX_PAYLOAD (16 * 1024)
+
+typedef enum __attribute__((packed)) {
+    STREAM_BINARY_RECORD_BEGIN  = 1, // chart slot, update every, end time, wall clock - end time (zigzag)
+    STREAM_BINARY_RECORD_SET    = 2, // dimension slot, collected (zigzag), record flags, [double]
+    STREAM_BINARY_RECORD_END    = 3, // no payload
+
+    // dimension slot, dimension id length, dimension id, page type (byte),
+    // update every, first point end time, entries, page size, page data
+    STREAM_BINARY_RECORD_REPLAY_PAGE = 4,
+} STREAM_BINARY_RECORD;
+
+typedef enum __attribute__((packed)) {
+    STREAM_BINARY_SET_NOT_ANOMALOUS = (1 << 0),
+    STREAM_BINARY_SET_RESET         = (1 << 1),
+    STREAM_BINARY_SET_EMPTY         = (1 << 2),
+    STREAM_BINARY_SET_HAS_VALUE     = (1 << 3), // a double follows, else value = collected
+} STREAM_BINARY_SET_FLAGS;
+
+// the largest possible record: type + 4 varints (BEGIN)
+#define STREAM_BINARY_RECORD_MAX_SIZE (1 + 4 * 10)
+
+static inline size_t stream_binary_put_varint(char *dst, uint64_t v) {
+    uint8_t *d = (uint8_t *)dst;
+    size_t i = 0;
+
+    while(v >= 0x80) {
+        d[i++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    d[i++] = (uint8_t)v;
+
+    return i;
+}
+
+static inline size_t stream_binary_put_zigzag(char *dst, int64_t v) {
+    return stream_binary_put_varint(dst, ((uint64_t)v << 1) ^ (uint64_t)(v >> 63));
+}
+
+static inline size_t stream_binary_put_double(char *dst, NETDATA_DOUBLE n) {
+    double d = (double)n;
+    uint64_t u;
+    memcpy(&u, &d, sizeof(u));
+    u = htole64(u);
+    memcpy(dst, &u, sizeof(u));
+    return sizeof(u);
+}
+
+// the decoders return false when the payload ends before the value does
+
+static inline bool stream_binary_get_varint(const char **src, const char *end, uint64_t *v) {
+    const uint8_t *s = (const uint8_t *)*src;
+    const uint8_t *e = (const uint8_t *)end;
+    uint64_t r = 0;
+
+    for(unsigned shift = 0; s < e && shift < 64; shift += 7) {
+        uint8_t c = *s++;
+        r |= (uint64_t)(c & 0x7f) << shift;
+
+        if(!(c & 0x80)) {
+            *src = (const char *)s;
+            *v = r;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static inline bool stream_binary_get_zigzag(const char **src, const char *end, int64_t *v) {
+    uint64_t u;
+    if(unlikely(!stream_binary_get_varint(src, end, &u)))
+        return false;
+
+    *v = (int64_t)(u >> 1) ^ -(int64_t)(u & 1);
+    return true;
+}
+
+static inline bool stream_binary_get_double(const char **src, const char *end, NETDATA_DOUBLE *n) {
+    uint64_t u;
+    if(unlikely(end - *src < (ssize_t)sizeof(u)))
+        return false;
+
+    memcpy(&u, *src, sizeof(u));
+    u = le64toh(u);
+    *src += sizeof(u);
+
+    double d;
+    memcpy(&d, &u, sizeof(d));
+    *n = (NETDATA_DOUBLE)d;
+    return true;
+}
+
+static inline uint8_t stream_binary_set_flags_from_sn_flags(SN_FLAGS flags) {
+    if(flags == SN_EMPTY_SLOT)
+        return STREAM_BINARY_SET_EMPTY;
+
+    return ((flags & SN_FLAG_NOT_ANOMALOUS) ? STREAM_BINARY_SET_NOT_ANOMALOUS : 0) |
+           ((flags & SN_FLAG_RESET) ? STREAM_BINARY_SET_RESET : 0);
+}
+
+static inline SN_FLAGS stream_binary_set_flags_to_sn_flags(uint8_t flags) {
+    if(flags & STREAM_BINARY_SET_EMPTY)
+        return SN_EMPTY_SLOT;
+
+    return (SN_FLAGS)(((flags & STREAM_BINARY_SET_NOT_ANOMALOUS) ? SN_FLAG_NOT_ANOMALOUS : SN_FLAG_NONE) |
+                      ((flags & STREAM_BINARY_SET_RESET) ? SN_FLAG_RESET : SN_FLAG_NONE));
+}
+
+#endif //NETDATA_STREAMING_PROTOCOL_COMMAND_BEGIN_SET_END_BINARY_H
@@ -4,10 +4,97 @@
 #include "../stream-sender-internals.h"
 #include "plugins.d/pluginsd_internals.h"
 
+// ----------------------------------------------------------------------------
+// binary frames
+
+void stream_send_binary_frame_close(RRDSET_STREAM_BUFFER *rsb) {
+    if(!rsb->binary_frame_open)
+        return;
+
+    BUFFER *wb = rsb->wb;
+    uint32_t len = htole32((uint32_t)(wb->len - rsb->binary_frame_pos - BUFFERED_READER_FRAME_HEADER_SIZE));
+    memcpy(&wb->buffer[rsb->binary_frame_pos + 1], &len, sizeof(len));
+    rsb->binary_frame_open = false;
+}
+
+static ALWAYS_INLINE char *stream_binary_record_start(RRDSET_STREAM_BUFFER *rsb) {
+    BUFFER *wb = rsb->wb;
+
+    if(rsb->binary_frame_open &&
+        wb->len - rsb->binary_frame_pos - BUFFERED_READER_FRAME_HEADER_SIZE >= STREAM_BINARY_FRAME_MAX_PAYLOAD)
+        stream_send_binary_frame_close(rsb);
+
+    buffer_need_bytes(wb, BUFFERED_READER_FRAME_HEADER_SIZE + STREAM_BINARY_RECORD_MAX_SIZE + 1);
+
+    if(!rsb->binary_frame_open) {
+        // the payload length is filled in when the frame is closed
+        rsb->binary_frame_pos = wb->len;
+        wb->buffer[wb->len] = BUFFERED_READER_FRAME_MARKER;
+        wb->len += BUFFERED_READER_FRAME_HEADER_SIZE;
+        rsb->binary_frame_open = true;
+    }
+
+    return &wb->buffer[wb->len];
+}
+
+static ALWAYS_INLINE void stream_binary_record_finish(RRDSET_STREAM_BUFFER *rsb, char *end) {
+    BUFFER *wb = rsb->wb;
+    wb->len = end - wb->buffer;
+    wb->buffer[wb->len] = '\0';
+}
+
+void stream_send_rrdset_begin_v2_binary(RRDSET_STREAM_BUFFER *rsb, RRDSET *st, time_t update_every, time_t point_end_time_s, time_t wall_clock_time) {
+    char *d = stream_binary_record_start(rsb);
+    *d++ = STREAM_BINARY_RECORD_BEGIN;
+    d += stream_binary_put_varint(d, st->stream.snd.chart_slot);
+    d += stream_binary_put_varint(d, (uint64_t)update_every);
+    d += stream_binary_put_varint(d, (uint64_t)point_end_time_s);
+    d += stream_binary_put_zigzag(d, (int64_t)(wall_clock_time - point_end_time_s));
+    stream_binary_record_finish(rsb, d);
+}
+
+void stream_send_rrddim_set_v2_binary(RRDSET_STREAM_BUFFER *rsb, RRDDIM *rd, collected_number collected_value, NETDATA_DOUBLE n, SN_FLAGS flags) {
+    uint8_t set_flags = stream_binary_set_flags_from_sn_flags(flags);
+    if((NETDATA_DOUBLE)collected_value != n)
+        set_flags |= STREAM_BINARY_SET_HAS_VALUE;
+
+    char *d = stream_binary_record_start(rsb);
+    *d++ = STREAM_BINARY_RECORD_SET;
+    d += stream_binary_put_varint(d, rd->stream.snd.dim_slot);
+    d += stream_binary_put_zigzag(d, collected_value);
+    *d++ = (char)set_flags;
+    if(set_flags & STREAM_BINARY_SET_HAS_VALUE)
+        d += stream_binary_put_double(d, n);
+    stream_binary_record_finish(rsb, d);
+}
+
+void stream_send_rrdset_end_v2_binary(RRDSET_STREAM_BUFFER *rsb) {
+    char *d = stream_binary_record_start(rsb);
+    *d++ = STREAM_BINARY_RECORD_END;
+    stream_binary_record_finish(rsb, d);
+}
+
+// ----------------------------------------------------------------------------
+
 void stream_send_rrddim_metrics_v2(RRDSET_STREAM_BUFFER *rsb, RRDDIM *rd, usec_t point_end_time_ut, NETDATA_DOUBLE n, SN_FLAGS flags) {
     if(!rsb->wb || !rsb->v2 || !netdata_double_isnumber(n) || !does_storage_number_exist(flags))
         return;
 
+    if(rsb->binary) {
+        time_t point_end_time_s = (time_t)(point_end_time_ut / USEC_PER_SEC);
+        if(unlikely(rsb->last_point_end_time_s != point_end_time_s)) {
+            if(unlikely(rsb->begin_v2_added))
+                stream_send_rrdset_end_v2_binary(rsb);
+
+            stream_send_rrdset_begin_v2_binary(rsb, rd->rrdset, rd->rrdset->update_every, point_end_time_s, rsb->wall_clock_time);
+            rsb->last_point_end_time_s = point_end_time_s;
+            rsb->begin_v2_added = true;
+        }
+
+        stream_send_rrddim_set_v2_binary(rsb, rd, rd->collector.last_collected_value, n, flags);
+        return;
+    }
+
     bool with_slots = stream_has_capability(rsb, STREAM_CAP_SLOTS) ? true : false;
     NUMBER_ENCODING integer_encoding = stream_has_capability(rsb, STREAM_CAP_IEEE754) ? NUMBER_ENCODING_BASE64 : NUMBER_ENCODING_HEX;
     NUMBER_ENCODING doubles_encoding = stream_has_capability(rsb, STREAM_CAP_IEEE754) ? NUMBER_ENCODING_BASE64 : NUMBER_ENCODING_DECIMAL;
@@ -70,12 +157,19 @@ ALWAYS_INLINE void stream_send_rrdset_metrics_finished(RRDSET_STREAM_BUFFER *rsb
         return;
 
     if(rsb->v2 && rsb->begin_v2_added) {
-        if(unlikely(rsb->rrdset_flags & RRDSET_FLAG_UPSTREAM_SEND_VARIABLES))
+        if(unlikely(rsb->rrdset_flags & RRDSET_FLAG_UPSTREAM_SEND_VARIABLES)) {
+            stream_send_binary_frame_close(rsb);
             rrdvar_print_to_streaming_custom_chart_variables(st, rsb->wb);
+        }
 
-        buffer_fast_strcat(rsb->wb, PLUGINSD_KEYWORD_END_V2 "\n", sizeof(PLUGINSD_KEYWORD_END_V2) - 1 + 1);
+        if(rsb->binary)
+            stream_send_rrdset_end_v2_binary(rsb);
+        else
+            buffer_fast_strcat(rsb->wb, PLUGINSD_KEYWORD_END_V2 "\n", sizeof(PLUGINSD_KEYWORD_END_V2) - 1 + 1);
     }
 
+    stream_send_binary_frame_close(rsb);
+
     sender_commit(st->rrdhost->sender, rsb->wb, STREAM_TRAFFIC_TYPE_DATA);
 
     *rsb = (RRDSET_STREAM_BUFFER){ .wb = NULL, };
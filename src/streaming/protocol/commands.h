@@ -5,11 +5,15 @@
 
 #include "database/rrd.h"
 #include "../stream.h"
+#include "command-begin-set-end-binary.h"
 
 typedef struct rrdset_stream_buffer {
     STREAM_CAPABILITIES capabilities;
     bool v2;
     bool begin_v2_added;
+    bool binary;                // BEGIN2/SET2/END2 are sent as binary frames
+    bool binary_frame_open;
+    size_t binary_frame_pos;    // the offset of the open frame in wb
     time_t wall_clock_time;
     RRDSET_FLAGS rrdset_flags;
     time_t last_point_end_time_s;
@@ -38,4 +42,9 @@ void stream_send_rrdset_metrics_v1(RRDSET_STREAM_BUFFER *rsb, RRDSET *st);
 void stream_send_rrddim_metrics_v2(RRDSET_STREAM_BUFFER *rsb, RRDDIM *rd, usec_t point_end_time_ut, NETDATA_DOUBLE n, SN_FLAGS flags);
 void stream_send_rrdset_metrics_finished(RRDSET_STREAM_BUFFER *rsb, RRDSET *st);
 
+void stream_send_rrdset_begin_v2_binary(RRDSET_STREAM_BUFFER *rsb, RRDSET *st, time_t update_every, time_t point_end_time_s, time_t wall_clock_time);
+void stream_send_rrddim_set_v2_binary(RRDSET_STREAM_BUFFER *rsb, RRDDIM *rd, collected_number collected_value, NETDATA_DOUBLE n, SN_FLAGS flags);
+void stream_send_rrdset_end_v2_binary(RRDSET_STREAM_BUFFER *rsb);
+void stream_send_binary_frame_close(RRDSET_STREAM_BUFFER *rsb);
+
 #endif //NETDATA_STREAMING_PROTCOL_COMMANDS_H
@@ -36,6 +36,10 @@ static struct {
     {STREAM_CAP_PROGRESS,     "PROGRESS" },
     {STREAM_CAP_NODE_ID,      "NODEID" },
     {STREAM_CAP_PATHS,        "PATHS" },
+    {STREAM_CAP_BINARY_FRAMES,"BINFRAMES" },
+    {STREAM_CAP_REPLAY_PAGES, "RPAGES" },
+    {STREAM_CAP_ZSTD_DICT,    "ZSTDDICT" },
+    {STREAM_CAP_SPILL_SEQ,    "SPILLSEQ" },
 
     // terminator
     {0 , NULL },
@@ -139,6 +143,12 @@ STREAM_CAPABILITIES stream_our_capabilities(RRDHOST *host, bool sender) {
             STREAM_CAP_PATHS |
             STREAM_CAP_IEEE754 |
             STREAM_CAP_ML_MODELS |
+            STREAM_CAP_BINARY_FRAMES |
+#ifdef ENABLE_DBENGINE
+            STREAM_CAP_REPLAY_PAGES |
+#endif
+            STREAM_CAP_ZSTD_DICT_AVAILABLE |
+            STREAM_CAP_SPILL_SEQ |
             0) & ~disabled_capabilities;
 }
 
@@ -167,6 +177,15 @@ STREAM_CAPABILITIES convert_stream_version_to_capabilities(int32_t version, RRDH
         // DATA WITH ML requires INTERPOLATED
         common_caps &= ~(STREAM_CAP_ML_MODELS);
 
+    const STREAM_CAPABILITIES pages_require = STREAM_CAP_BINARY_FRAMES | STREAM_CAP_SLOTS | STREAM_CAP_INTERPOLATED;
+    if((common_caps & pages_require) != pages_require)
+        // pages are sent in binary frames, with the flags of the points
+        common_caps &= ~(STREAM_CAP_REPLAY_PAGES);
+
+    if(!(common_caps & STREAM_CAP_ZSTD))
+        // the dictionary is used only by zstd
+        common_caps &= ~(STREAM_CAP_ZSTD_DICT);
+
     return common_caps;
 }
 
@@ -178,8 +197,14 @@ int32_t stream_capabilities_to_vn(uint32_t caps) {
 
 void check_local_streaming_capabilities(void) {
     ieee754_doubles = is_system_ieee754_double();
+    // binary frames carry raw IEEE754 doubles
     if(!ieee754_doubles)
-        globally_disabled_capabilities |= STREAM_CAP_IEEE754;
+        globally_disabled_capabilities |= (STREAM_CAP_IEEE754 | STREAM_CAP_BINARY_FRAMES);
     else
-        globally_disabled_capabilities &= ~STREAM_CAP_IEEE754;
+        globally_disabled_capabilities &= ~(STREAM_CAP_IEEE754 | STREAM_CAP_BINARY_FRAMES);
+
+    // dbengine pages are in the byte order of the system that stored them
+#if __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+    globally_disabled_capabilities |= STREAM_CAP_REPLAY_PAGES;
+#endif
 }
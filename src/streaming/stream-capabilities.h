@@ -18,9 +18,13 @@
 typedef enum {
     STREAM_CAP_NONE             = 0,
 
-    // do not use the first 3 bits
+    // do not use the first 2 bits
     // they used to be versions 1, 2 and 3
     // before we introduce capabilities
+    // bit 2 is reused: peers negotiating capabilities never set it,
+    // and it is always sent together with VCAPS, so it is never taken for a version
+
+    STREAM_CAP_SPILL_SEQ        = (1 << 2), // the records of the sender spill carry sequence numbers the parent acknowledges
 
     STREAM_CAP_V1               = (1 << 3), // v1 = the oldest protocol
     STREAM_CAP_V2               = (1 << 4), // v2 = the second version of the protocol (with host labels)
@@ -49,6 +53,9 @@ typedef enum {
     STREAM_CAP_NODE_ID          = (1 << 24), // support for sending NODE_ID back to the child
     STREAM_CAP_PATHS            = (1 << 25), // support for sending PATHS upstream and downstream
     STREAM_CAP_ML_MODELS        = (1 << 26), // support for sending MODELS upstream
+    STREAM_CAP_BINARY_FRAMES    = (1 << 27), // BEGIN2/SET2/END2 can be sent as binary frames
+    STREAM_CAP_REPLAY_PAGES     = (1 << 28), // replication can send whole dbengine pages in binary frames
+    STREAM_CAP_ZSTD_DICT        = (1 << 29), // ZSTD is primed with the built-in dictionary (version 1)
 
     STREAM_CAP_INVALID          = (1 << 30), // used as an invalid value for capabilities when this is set
     // this must be signed int, so don't use the last bit
@@ -65,8 +72,10 @@ typedef enum {
 
 #ifdef ENABLE_ZSTD
 #define STREAM_CAP_ZSTD_AVAILABLE STREAM_CAP_ZSTD
+#define STREAM_CAP_ZSTD_DICT_AVAILABLE STREAM_CAP_ZSTD_DICT
 #else
 #define STREAM_CAP_ZSTD_AVAILABLE 0
+#define STREAM_CAP_ZSTD_DICT_AVAILABLE 0
 #endif  // ENABLE_ZSTD
 
 #ifdef ENABLE_BROTLI
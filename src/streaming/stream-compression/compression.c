@@ -84,6 +84,10 @@ void stream_select_receiver_compression_algorithm(struct receiver_state *rpt) {
             }
         }
     }
+
+    if(!(rpt->capabilities & STREAM_CAP_ZSTD))
+        // the dictionary is used only by zstd
+        rpt->capabilities &= ~STREAM_CAP_ZSTD_DICT;
 }
 
 bool stream_compression_initialize(struct sender_state *s) {
@@ -105,6 +109,12 @@ bool stream_compression_initialize(struct sender_state *s) {
 
     if(s->thread.compressor.algorithm != COMPRESSION_ALGORITHM_NONE) {
         s->thread.compressor.level = stream_send.compression.levels[s->thread.compressor.algorithm];
+
+        if(s->thread.compressor.algorithm == COMPRESSION_ALGORITHM_ZSTD) {
+            s->thread.compressor.window_log = stream_send.compression.zstd_window_log;
+            s->thread.compressor.dictionary = stream_has_capability(s, STREAM_CAP_ZSTD_DICT);
+        }
+
         stream_compressor_init(&s->thread.compressor);
         return true;
     }
@@ -130,6 +140,10 @@ bool stream_decompression_initialize(struct receiver_state *rpt) {
         rpt->thread.compressed.decompressor.algorithm = COMPRESSION_ALGORITHM_NONE;
 
     if(rpt->thread.compressed.decompressor.algorithm != COMPRESSION_ALGORITHM_NONE) {
+        rpt->thread.compressed.decompressor.dictionary =
+            rpt->thread.compressed.decompressor.algorithm == COMPRESSION_ALGORITHM_ZSTD &&
+            stream_has_capability(rpt, STREAM_CAP_ZSTD_DICT);
+
         stream_decompressor_init(&rpt->thread.compressed.decompressor);
         return true;
     }
@@ -473,16 +487,21 @@ void unittest_generate_message(BUFFER *wb, time_t now_s, size_t counter) {
     buffer_fast_strcat(wb, PLUGINSD_KEYWORD_END_V2 "\n", sizeof(PLUGINSD_KEYWORD_END_V2) - 1 + 1);
 }
 
-int unittest_stream_compression_speed(compression_algorithm_t algorithm, const char *name) {
-    fprintf(stderr, "\nTesting streaming compression speed with %s\n", name);
+int unittest_stream_compression_speed(compression_algorithm_t algorithm, const char *name, int level, int window_log, bool dictionary) {
+    fprintf(stderr, "\nTesting streaming compression speed with %s (level %d, window log %d, dictionary %s)\n",
+            name, level, window_log, dictionary ? "yes" : "no");
 
     struct compressor_state cctx =  {
             .initialized = false,
             .algorithm = algorithm,
+            .level = level,
+            .window_log = window_log,
+            .dictionary = dictionary,
     };
     struct decompressor_state dctx = {
             .initialized = false,
             .algorithm = algorithm,
+            .dictionary = dictionary,
     };
 
     stream_compressor_init(&cctx);
@@ -576,10 +595,14 @@ cleanup:
         fprintf(stderr, "Compression with %s: FAILED (%d errors)\n", name, errors);
     else
         fprintf(stderr, "Compression with %s: OK "
-                        "(compression %llu usec, decompression %llu usec, bytes raw %zu, compressed %zu, savings ratio %0.2f%%)\n",
+                        "(compression %llu usec, decompression %llu usec, bytes raw %zu, compressed %zu, savings ratio %0.2f%%, "
+                        "compression ratio %0.2f, compression %0.2f MB/s, decompression %0.2f MB/s)\n",
                         name, (long long unsigned)compression_ut, (long long unsigned)decompression_ut,
                         bytes_uncompressed, bytes_compressed,
-                        100.0 - (double)bytes_compressed * 100.0 / (double)bytes_uncompressed);
+                        100.0 - (double)bytes_compressed * 100.0 / (double)bytes_uncompressed,
+                        (double)bytes_uncompressed / (double)MAX(bytes_compressed, 1),
+                        (double)bytes_uncompressed / (double)MAX(compression_ut, 1),
+                        (double)bytes_uncompressed / (double)MAX(decompression_ut, 1));
 
     return errors;
 }
@@ -689,10 +712,14 @@ int unittest_stream_compressions(void) {
     ret += unittest_stream_compression(COMPRESSION_ALGORITHM_BROTLI, "BROTLI");
     ret += unittest_stream_compression(COMPRESSION_ALGORITHM_GZIP, "GZIP");
 
-    ret += unittest_stream_compression_speed(COMPRESSION_ALGORITHM_ZSTD, "ZSTD");
-    ret += unittest_stream_compression_speed(COMPRESSION_ALGORITHM_LZ4, "LZ4");
-    ret += unittest_stream_compression_speed(COMPRESSION_ALGORITHM_BROTLI, "BROTLI");
-    ret += unittest_stream_compression_speed(COMPRESSION_ALGORITHM_GZIP, "GZIP");
+    ret += unittest_stream_compression_speed(COMPRESSION_ALGORITHM_ZSTD, "ZSTD", 1, 0, false);
+    ret += unittest_stream_compression_speed(COMPRESSION_ALGORITHM_ZSTD, "ZSTD", 3, 0, false);
+    ret += unittest_stream_compression_speed(COMPRESSION_ALGORITHM_ZSTD, "ZSTD", 3, 0, true);
+    ret += unittest_stream_compression_speed(COMPRESSION_ALGORITHM_ZSTD, "ZSTD", 3, 23, true);
+    ret += unittest_stream_compression_speed(COMPRESSION_ALGORITHM_ZSTD, "ZSTD", 6, 23, true);
+    ret += unittest_stream_compression_speed(COMPRESSION_ALGORITHM_LZ4, "LZ4", 1, 0, false);
+    ret += unittest_stream_compression_speed(COMPRESSION_ALGORITHM_BROTLI, "BROTLI", 3, 0, false);
+    ret += unittest_stream_compression_speed(COMPRESSION_ALGORITHM_GZIP, "GZIP", 3, 0, false);
 
     return ret;
 }
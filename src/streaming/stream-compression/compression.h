@@ -35,6 +35,11 @@ typedef enum {
 // this defines the order the algorithms will be selected by the receiver (parent)
 #define STREAM_COMPRESSION_ALGORITHMS_ORDER "zstd lz4 brotli gzip"
 
+// the zstd window of the senders is limited to what the zstd decompressors
+// of the receivers accept by default (128MiB)
+#define STREAM_ZSTD_WINDOW_LOG_MIN 10
+#define STREAM_ZSTD_WINDOW_LOG_MAX 27
+
 // ----------------------------------------------------------------------------
 
 typedef struct simple_ring_buffer {
@@ -84,6 +89,8 @@ struct compressor_state {
     SIMPLE_RING_BUFFER output;
 
     int level;
+    int window_log;                 // zstd, 0 = the window of the level
+    bool dictionary;                // zstd, prime the stream with the built-in dictionary
     void *stream;
 
     struct {
@@ -110,6 +117,7 @@ struct decompressor_state {
 
     SIMPLE_RING_BUFFER output;
 
+    bool dictionary;                // zstd, prime the stream with the built-in dictionary
     void *stream;
 };
 
@@ -5,6 +5,71 @@
 #ifdef ENABLE_ZSTD
 #include <zstd.h>
 
+// The built-in dictionary of the stream (version 1).
+//
+// A connection is a single endless zstd frame, so everything sent is already
+// history for the messages that follow, as long as it is within the window.
+// What the history lacks is the beginning of the connection: the chart
+// definitions and the replication of every chart are compressed without any
+// history. The dictionary primes the history of both sides with the keywords
+// and the ids most nodes send, so these messages compress as if the connection
+// had been running for a while.
+//
+// It is raw content (not a zstd dictionary with entropy tables), loaded by both
+// sides when STREAM_CAP_ZSTD_DICT has been negotiated.
+// NEVER CHANGE IT - a different dictionary needs a different capability.
+// The most frequent strings are at the end, where their offsets are smaller.
+static const char stream_zstd_dictionary_v1[] =
+    "HOST_DEFINE HOST_DEFINE_END HOST_LABEL HOST "
+    "FUNCTION GLOBAL \"systemd-journal\" 60 \"View, search and analyze systemd journal entries.\" \"logs\" 0x0001 100\n"
+    "FUNCTION GLOBAL \"network-connections\" 60 \"Shows active network connections\" \"top\" 0x0001 100\n"
+    "FUNCTION GLOBAL \"processes\" 10 \"Detailed information on the currently running processes.\" \"top\" 0x0001 100\n"
+    "FUNCTION_RESULT_BEGIN FUNCTION_RESULT_END FUNCTION_PROGRESS "
+    "CONFIG go.d:collector: add template dyncfg "
+    "CLABEL \"_collect_plugin\" \"go.d.plugin\" 1\nCLABEL \"_collect_module\" \"\" 1\n"
+    "CLABEL \"_collect_plugin\" \"apps.plugin\" 1\nCLABEL \"app_group\" \"\" 1\n"
+    "CLABEL \"_collect_plugin\" \"cgroups.plugin\" 1\nCLABEL \"cgroup_name\" \"\" 1\nCLABEL \"image\" \"\" 1\n"
+    "CLABEL \"_collect_plugin\" \"ebpf.plugin\" 1\nCLABEL \"_collect_plugin\" \"netdata\" 1\n"
+    "CLABEL \"_collect_plugin\" \"diskspace.plugin\" 1\nCLABEL \"mount_point\" \"/\" 1\nCLABEL \"filesystem\" \"ext4\" 1\nCLABEL \"mount_root\" \"/\" 1\n"
+    "CLABEL \"_collect_plugin\" \"proc.plugin\" 1\nCLABEL \"_collect_module\" \"/proc/net/dev\" 1\n"
+    "CLABEL \"device\" \"eth0\" 1\nCLABEL \"interface_type\" \"real\" 1\nCLABEL \"device_type\" \"physical\" 1\n"
+    "CLABEL \"cpu\" \"cpu0\" 1\nCLABEL \"mount_point\" \"\" 1\nCLABEL_COMMIT\n"
+    "CHART \"netdata.\" \"\" \"Netdata \" \"\" \"netdata\" \"netdata.\" \"line\" 130000 1 \"\" \"netdata\" \"pulse\"\n"
+    "CHART \"apps.\" \"\" \"\" \"\" \"\" \"app.\" \"stacked\" 140000 1 \"\" \"apps.plugin\" \"\"\n"
+    "CHART \"cgroup_\" \"\" \"\" \"\" \"\" \"cgroup.\" \"line\" 43000 1 \"\" \"cgroups.plugin\" \"/sys/fs/cgroup\"\n"
+    "CHART \"disk_space._\" \"\" \"Disk Space Usage\" \"GiB\" \"/\" \"disk.space\" \"stacked\" 2023 1 \"\" \"diskspace.plugin\" \"\"\n"
+    "CHART \"disk.sda\" \"sda\" \"Disk I/O Bandwidth\" \"KiB/s\" \"sda\" \"disk.io\" \"area\" 2000 1 \"\" \"proc.plugin\" \"/proc/diskstats\"\n"
+    "CHART \"net.eth0\" \"eth0\" \"Bandwidth\" \"kilobits/s\" \"eth0\" \"net.net\" \"area\" 7000 1 \"\" \"proc.plugin\" \"/proc/net/dev\"\n"
+    "CHART \"mem.\" \"\" \"\" \"\" \"\" \"mem.\" \"line\" 1000 1 \"\" \"proc.plugin\" \"/proc/meminfo\"\n"
+    "CHART \"system.ram\" \"\" \"System RAM\" \"MiB\" \"ram\" \"system.ram\" \"stacked\" 200 1 \"\" \"proc.plugin\" \"/proc/meminfo\"\n"
+    "CHART \"cpu.cpu0\" \"\" \"Core utilization\" \"percentage\" \"utilization\" \"cpu.cpu\" \"stacked\" 1000 1 \"\" \"proc.plugin\" \"/proc/stat\"\n"
+    "CHART \"system.cpu\" \"\" \"Total CPU utilization\" \"percentage\" \"cpu\" \"system.cpu\" \"stacked\" 100 1 \"\" \"proc.plugin\" \"/proc/stat\"\n"
+    "DIMENSION \"received\" \"received\" \"incremental\" 8 1000 \"\"\nDIMENSION \"sent\" \"sent\" \"incremental\" -8 1000 \"\"\n"
+    "DIMENSION \"reads\" \"reads\" \"incremental\" 512 1024 \"\"\nDIMENSION \"writes\" \"writes\" \"incremental\" -512 1024 \"\"\n"
+    "DIMENSION \"avail\" \"avail\" \"absolute\" 1 1073741824 \"\"\nDIMENSION \"used\" \"used\" \"absolute\" 1 1073741824 \"\"\n"
+    "DIMENSION \"free\" \"free\" \"absolute\" 1 1048576 \"\"\nDIMENSION \"cached\" \"cached\" \"absolute\" 1 1048576 \"\"\n"
+    "DIMENSION \"buffers\" \"buffers\" \"absolute\" 1 1048576 \"\"\n"
+    "DIMENSION \"guest_nice\" \"guest_nice\" \"percentage-of-incremental-row\" 1 1 \"\"\n"
+    "DIMENSION \"guest\" \"guest\" \"percentage-of-incremental-row\" 1 1 \"\"\n"
+    "DIMENSION \"steal\" \"steal\" \"percentage-of-incremental-row\" 1 1 \"\"\n"
+    "DIMENSION \"softirq\" \"softirq\" \"percentage-of-incremental-row\" 1 1 \"\"\n"
+    "DIMENSION \"irq\" \"irq\" \"percentage-of-incremental-row\" 1 1 \"\"\n"
+    "DIMENSION \"user\" \"user\" \"percentage-of-incremental-row\" 1 1 \"\"\n"
+    "DIMENSION \"system\" \"system\" \"percentage-of-incremental-row\" 1 1 \"\"\n"
+    "DIMENSION \"nice\" \"nice\" \"percentage-of-incremental-row\" 1 1 \"\"\n"
+    "DIMENSION \"iowait\" \"iowait\" \"percentage-of-incremental-row\" 1 1 \"\"\n"
+    "DIMENSION \"idle\" \"idle\" \"percentage-of-incremental-row\" 1 1 \"hidden\"\n"
+    "CHART_DEFINITION_END 1 1 1\n"
+    "REPLAY_CHART \"system.cpu\" \"true\" 0 0\n"
+    "RSSTATE 1 1 1 1\nRDSTATE 1 1 1 1\n"
+    "RBEGIN \"\" 1 1 1\nRSET \"\" # # #\nREND 1 1 1 1 1\n"
+    "BEGIN2 SLOT:1 'system.cpu' 1 1 #\n"
+    "SET2 SLOT:1 'user' 1 # \"\"\nSET2 SLOT:2 'system' 1 # \"\"\n"
+    "SET2 SLOT:3 'received' 1 # \"\"\nSET2 SLOT:4 'sent' 1 # \"\"\n"
+    "END2\n"
+    "BEGIN2 SLOT: ' 1 #\nSET2 SLOT: ' # \"\"\nEND2\n"
+    ;
+
 void stream_compressor_init_zstd(struct compressor_state *state) {
     if(!state->initialized) {
         state->initialized = true;
@@ -22,6 +87,24 @@ void stream_compressor_init_zstd(struct compressor_state *state) {
 
         // ZSTD_CCtx_setParameter(state->stream, ZSTD_c_compressionLevel, 1);
         // ZSTD_CCtx_setParameter(state->stream, ZSTD_c_strategy, ZSTD_fast);
+
+        // ZSTD_initCStream() resets the parameters and the dictionary, so these go after it
+
+        if(state->window_log) {
+            state->window_log = MAX(state->window_log, STREAM_ZSTD_WINDOW_LOG_MIN);
+            state->window_log = MIN(state->window_log, STREAM_ZSTD_WINDOW_LOG_MAX);
+
+            ret = ZSTD_CCtx_setParameter(state->stream, ZSTD_c_windowLog, state->window_log);
+            if(ZSTD_isError(ret))
+                netdata_log_error("STREAM_COMPRESS: ZSTD_CCtx_setParameter(windowLog = %d) returned error: %s",
+                                  state->window_log, ZSTD_getErrorName(ret));
+        }
+
+        if(state->dictionary) {
+            ret = ZSTD_CCtx_loadDictionary(state->stream, stream_zstd_dictionary_v1, sizeof(stream_zstd_dictionary_v1) - 1);
+            if(ZSTD_isError(ret))
+                netdata_log_error("STREAM_COMPRESS: ZSTD_CCtx_loadDictionary() returned error: %s", ZSTD_getErrorName(ret));
+        }
     }
 }
 
@@ -101,6 +184,12 @@ void stream_decompressor_init_zstd(struct decompressor_state *state) {
         if(ZSTD_isError(ret))
             netdata_log_error("STREAM_DECOMPRESS: ZSTD_initDStream() returned error: %s", ZSTD_getErrorName(ret));
 
+        if(state->dictionary) {
+            ret = ZSTD_DCtx_loadDictionary(state->stream, stream_zstd_dictionary_v1, sizeof(stream_zstd_dictionary_v1) - 1);
+            if(ZSTD_isError(ret))
+                netdata_log_error("STREAM_DECOMPRESS: ZSTD_DCtx_loadDictionary() returned error: %s", ZSTD_getErrorName(ret));
+        }
+
         simple_ring_buffer_make_room(&state->output, MAX(COMPRESSION_MAX_CHUNK, ZSTD_DStreamOutSize()));
     }
 }
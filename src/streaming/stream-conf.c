@@ -39,6 +39,7 @@ struct _stream_send stream_send = {
     .initial_clock_resync_iterations = 60,
 
     .buffer_max_size = CBUFFER_INITIAL_MAX_SIZE,
+    .buffer_spill_max_size = 0,
 
     .replication = {
         .prefetch = 0,
@@ -63,7 +64,8 @@ struct _stream_send stream_send = {
             [COMPRESSION_ALGORITHM_LZ4]     = 1,    // 1 (smaller) -  9 (faster)
             [COMPRESSION_ALGORITHM_BROTLI]  = 3,    // 0 (faster)  - 11 (smaller)
             [COMPRESSION_ALGORITHM_GZIP]    = 3,    // 1 (faster)  -  9 (smaller)
-        }
+        },
+        .zstd_window_log = 0,                       // 10 - 27, larger windows need more memory on both sides
     },
 };
 
@@ -181,6 +183,10 @@ void stream_conf_load() {
         &stream_config, CONFIG_SECTION_STREAM, "buffer size",
         stream_send.buffer_max_size);
 
+    stream_send.buffer_spill_max_size = (uint64_t)inicfg_get_size_bytes(
+        &stream_config, CONFIG_SECTION_STREAM, "buffer spill to disk size",
+        stream_send.buffer_spill_max_size);
+
     stream_send.parents.reconnect_delay_s = (unsigned int)inicfg_get_duration_seconds(
         &stream_config, CONFIG_SECTION_STREAM, "reconnect delay",
         stream_send.parents.reconnect_delay_s);
@@ -199,6 +205,10 @@ void stream_conf_load() {
         &stream_config, CONFIG_SECTION_STREAM, "zstd compression level",
         stream_send.compression.levels[COMPRESSION_ALGORITHM_ZSTD]);
 
+    stream_send.compression.zstd_window_log = (int)inicfg_get_number_range(
+        &stream_config, CONFIG_SECTION_STREAM, "zstd compression window log",
+        stream_send.compression.zstd_window_log, 0, STREAM_ZSTD_WINDOW_LOG_MAX);
+
     stream_send.compression.levels[COMPRESSION_ALGORITHM_LZ4] = (int)inicfg_get_number(
         &stream_config, CONFIG_SECTION_STREAM, "lz4 compression acceleration",
         stream_send.compression.levels[COMPRESSION_ALGORITHM_LZ4]);
@@ -24,6 +24,7 @@ struct _stream_send {
     uint16_t initial_clock_resync_iterations;
 
     uint32_t buffer_max_size;
+    uint64_t buffer_spill_max_size;
 
     struct {
         size_t prefetch;
@@ -43,6 +44,7 @@ struct _stream_send {
     struct {
         bool enabled;
         int levels[COMPRESSION_ALGORITHM_MAX];
+        int zstd_window_log;            // 0 = the window of the zstd level
     } compression;
 };
 extern struct _stream_send stream_send;
@@ -3,6 +3,7 @@
 #include "stream.h"
 #include "stream-thread.h"
 #include "stream-receiver-internals.h"
+#include "plugins.d/pluginsd_internals.h"
 
 #ifdef NETDATA_LOG_STREAM_RECEIVER
 void stream_receiver_log_payload(struct receiver_state *rpt, const char *payload, STREAM_TRAFFIC_TYPE type __maybe_unused, bool inbound) {
@@ -588,6 +589,60 @@ static bool stream_receiver_dequeue_senders(struct stream_thread *sth, struct re
     return true;
 }
 
+// the records replayed from the spill of the child are wrapped in SPILL_BEGIN/SPILL_END,
+// so that we apply them once, even when a new connection replays them again
+// returns true when it consumed the line
+static bool receiver_parse_spill_marker(PARSER *parser, BUFFER *line) {
+    const char *s = line->buffer;
+
+    bool begin = strncmp(s, PLUGINSD_KEYWORD_SPILL_BEGIN " ", sizeof(PLUGINSD_KEYWORD_SPILL_BEGIN)) == 0;
+    bool end = !begin && strncmp(s, PLUGINSD_KEYWORD_SPILL_END " ", sizeof(PLUGINSD_KEYWORD_SPILL_END)) == 0;
+
+    if(!begin && !end) {
+        if(!parser->user.spill.skip)
+            return false;
+
+        // a line or a binary frame of a record we have already applied
+        parser->line.count++;
+        return true;
+    }
+
+    parser->line.count++;
+
+    char *e;
+    s += begin ? sizeof(PLUGINSD_KEYWORD_SPILL_BEGIN) : sizeof(PLUGINSD_KEYWORD_SPILL_END);
+    uint64_t id = strtoull(s, &e, 10);
+    uint64_t seq = strtoull(e, NULL, 10);
+
+    STREAM_SPILL_APPLIED *applied = &parser->user.host->stream.rcv.spill;
+
+    if(begin) {
+        parser->user.spill.skip = stream_spill_applied(applied, id, seq);
+        return true;
+    }
+
+    if(!parser->user.spill.skip)
+        stream_spill_applied_set(applied, id, seq);
+
+    parser->user.spill.skip = false;
+
+    char buf[100];
+    snprintfz(buf, sizeof(buf), PLUGINSD_KEYWORD_SPILL_ACK " %llu %llu\n", (unsigned long long)id, (unsigned long long)seq);
+    send_to_plugin(buf, parser, STREAM_TRAFFIC_TYPE_METADATA);
+
+    return true;
+}
+
+static ALWAYS_INLINE int receiver_parse_frame_or_line(PARSER *parser, BUFFER *line) {
+    if(unlikely(stream_has_capability(&parser->user, STREAM_CAP_SPILL_SEQ) && receiver_parse_spill_marker(parser, line)))
+        return 0;
+
+    if(unlikely(line->buffer[0] == BUFFERED_READER_FRAME_MARKER))
+        return parser_binary_frame(parser, line->buffer, line->len);
+
+    return parser_action(parser, line->buffer);
+}
+
 static ssize_t
 stream_receive_and_process(struct stream_thread *sth, struct receiver_state *rpt, PARSER *parser, usec_t now_ut __maybe_unused, bool *removed) {
     internal_fatal(sth->tid != gettid_cached(), "Function %s() should only be used by the dispatcher thread", __FUNCTION__);
@@ -613,8 +668,8 @@ stream_receive_and_process(struct stream_thread *sth, struct receiver_state *rpt
                     if (likely(decompress_rc == DECOMPRESS_OK)) {
                         // loop through all the complete lines found in the uncompressed buffer
 
-                        while (buffered_reader_next_line(&rpt->thread.uncompressed, rpt->thread.line_buffer)) {
-                            if (unlikely(parser_action(parser, rpt->thread.line_buffer->buffer))) {
+                        while (buffered_reader_next_frame_or_line(&rpt->thread.uncompressed, rpt->thread.line_buffer)) {
+                            if (unlikely(receiver_parse_frame_or_line(parser, rpt->thread.line_buffer))) {
                                 stream_receiver_remove(sth, rpt, STREAM_HANDSHAKE_RCV_DISCONNECT_PARSER_FAILED);
                                 *removed = true;
                                 return -1;
@@ -654,8 +709,8 @@ stream_receive_and_process(struct stream_thread *sth, struct receiver_state *rpt
         if(rc <= 0)
             return rc;
 
-        while(buffered_reader_next_line(&rpt->thread.uncompressed, rpt->thread.line_buffer)) {
-            if(unlikely(parser_action(parser, rpt->thread.line_buffer->buffer))) {
+        while(buffered_reader_next_frame_or_line(&rpt->thread.uncompressed, rpt->thread.line_buffer)) {
+            if(unlikely(receiver_parse_frame_or_line(parser, rpt->thread.line_buffer))) {
                 stream_receiver_remove(sth, rpt, STREAM_HANDSHAKE_RCV_DISCONNECT_PARSER_FAILED);
                 *removed = true;
                 return -1;
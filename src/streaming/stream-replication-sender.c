@@ -189,7 +189,7 @@ static struct replication_query *replication_query_prepare(
 
         stream_control_replication_query_started();
         storage_engine_query_init(q->backend, rd->tiers[0].smh, &d->handle,
-                                  q->query.after, q->query.before, priority);
+                                  q->query.after, q->query.before, priority, QUERY_SOURCE_REPLICATION);
         d->enabled = true;
         d->skip = false;
         count++;
@@ -322,9 +322,85 @@ static void replication_query_align_to_optimal_before(struct replication_query *
         q->query.before = expanded_before;
 }
 
+// ----------------------------------------------------------------------------
+// sending whole pages (STREAM_CAP_REPLAY_PAGES)
+
+// the largest page that fits in a frame, together with the record header
+#define REPLICATION_PAGE_MAX_SIZE (STREAM_BINARY_FRAME_MAX_PAYLOAD - (2 + 6 * 10 + RRD_ID_LENGTH_MAX))
+
+static void replication_send_page(BUFFER *wb, RRDDIM *rd, const STORAGE_PAGE *page, const void *data, size_t size) {
+    size_t id_len = string_strlen(rd->id);
+    buffer_need_bytes(wb, BUFFERED_READER_FRAME_HEADER_SIZE + 2 + 6 * 10 + id_len + size + 1);
+
+    size_t frame_pos = wb->len;
+    char *payload = &wb->buffer[frame_pos + BUFFERED_READER_FRAME_HEADER_SIZE];
+    char *d = payload;
+
+    *d++ = STREAM_BINARY_RECORD_REPLAY_PAGE;
+    d += stream_binary_put_varint(d, rd->stream.snd.dim_slot);
+    d += stream_binary_put_varint(d, id_len);
+    memcpy(d, rrddim_id(rd), id_len);
+    d += id_len;
+    *d++ = (char)page->type;
+    d += stream_binary_put_varint(d, page->update_every_s);
+    d += stream_binary_put_varint(d, (uint64_t)page->first_time_s);
+    d += stream_binary_put_varint(d, page->entries);
+    d += stream_binary_put_varint(d, size);
+    memcpy(d, data, size);
+    d += size;
+
+    uint32_t len = htole32((uint32_t)(d - payload));
+    wb->buffer[frame_pos] = BUFFERED_READER_FRAME_MARKER;
+    memcpy(&wb->buffer[frame_pos + 1], &len, sizeof(len));
+
+    wb->len = d - wb->buffer;
+    wb->buffer[wb->len] = '\0';
+}
+
+// send the pages that are not collected anymore, at the beginning of the query of each dimension
+// the point by point query continues after them
+// returns the end time of the last point sent in pages
+static time_t replication_query_send_pages(BUFFER *wb, struct replication_query *q, size_t max_msg_size) {
+    if(!(q->query.capabilities & STREAM_CAP_REPLAY_PAGES) || q->backend != STORAGE_ENGINE_BACKEND_DBENGINE)
+        return 0;
+
+    time_t pages_until = 0;
+    size_t points = 0;
+    void *data = mallocz(REPLICATION_PAGE_MAX_SIZE);
+
+    for (size_t i = 0; i < q->dimensions; i++) {
+        struct replication_dimension *d = &q->data[i];
+        if(unlikely(!d->enabled)) continue;
+
+        STORAGE_PAGE page;
+        size_t size;
+
+        // leave room in the message for the points of the open pages
+        while(buffer_strlen(wb) < max_msg_size / 2 &&
+               (size = storage_engine_query_next_page(&d->handle, q->query.before, &page, data, REPLICATION_PAGE_MAX_SIZE))) {
+            replication_send_page(wb, d->rd, &page, data, size);
+            points += page.entries;
+
+            if(page.last_time_s > pages_until)
+                pages_until = page.last_time_s;
+        }
+    }
+
+    freez(data);
+
+    q->points_read += points;
+    q->points_generated += points;
+
+    return pages_until;
+}
+
 static bool replication_query_execute(BUFFER *wb, struct replication_query *q, size_t max_msg_size) {
     replication_query_align_to_optimal_before(q);
 
+    // the dimensions may advance at different times with pages,
+    // so the message is not interrupted before all of them reach the last page sent
+    time_t pages_until = replication_query_send_pages(wb, q, max_msg_size);
+
     bool with_slots = (q->query.capabilities & STREAM_CAP_SLOTS) ? true : false;
     NUMBER_ENCODING integer_encoding = (q->query.capabilities & STREAM_CAP_IEEE754) ? NUMBER_ENCODING_BASE64 : NUMBER_ENCODING_DECIMAL;
     time_t after = q->query.after;
@@ -440,7 +516,7 @@ static bool replication_query_execute(BUFFER *wb, struct replication_query *q, s
             actual_before = min_end_time;
 #endif
 
-            if(buffer_strlen(wb) > max_msg_size && last_end_time_in_buffer) {
+            if(buffer_strlen(wb) > max_msg_size && last_end_time_in_buffer && last_end_time_in_buffer >= pages_until) {
                 q->query.before = last_end_time_in_buffer;
                 q->query.enable_streaming = false;
 
@@ -541,7 +617,7 @@ static bool replication_query_execute(BUFFER *wb, struct replication_query *q, s
     q->points_read += points_read;
     q->points_generated += points_generated;
 
-    if(last_end_time_in_buffer < before - q->st->update_every)
+    if(MAX(last_end_time_in_buffer, pages_until) < before - q->st->update_every)
         finished_with_gap = true;
 
     return finished_with_gap;
@@ -15,6 +15,20 @@ bool stream_sender_has_compression(struct rrdhost *host) {
     return host && host->sender && host->sender->thread.compressor.initialized;
 }
 
+// called by the spill worker - wake up the dispatcher to replay the messages read back,
+// or reconnect, like on buffer overflow, when the spilled messages are lost
+static void stream_sender_spill_cb(void *data, bool failed) {
+    struct sender_state *s = data;
+
+    stream_sender_lock(s);
+    struct stream_opcode msg = s->thread.msg;
+    stream_sender_unlock(s);
+
+    msg.opcode = failed ? STREAM_OPCODE_SENDER_BUFFER_OVERFLOW : STREAM_OPCODE_SENDER_POLLOUT;
+    msg.reason = failed ? STREAM_HANDSHAKE_DISCONNECT_BUFFER_OVERFLOW : 0;
+    stream_sender_send_opcode(s, msg);
+}
+
 void stream_sender_structures_init(RRDHOST *host, bool stream, STRING *parents, STRING *api_key, STRING *send_charts_matching) {
     if(rrdhost_flag_check(host, RRDHOST_FLAG_STREAM_SENDER_INITIALIZED))
         return;
@@ -46,6 +60,14 @@ void stream_sender_structures_init(RRDHOST *host, bool stream, STRING *parents,
     spinlock_init(&host->sender->spinlock);
     replication_sender_init(host->sender);
 
+    if(stream_send.buffer_spill_max_size) {
+        char filename[FILENAME_MAX + 1];
+        snprintfz(filename, FILENAME_MAX, "%s/stream-spill-%s.bin", netdata_configured_cache_dir, host->machine_guid);
+        host->sender->spill.sp = stream_spill_create(
+            filename, stream_send.buffer_spill_max_size, stream_send.buffer_max_size,
+            &host->sender->spinlock, stream_sender_spill_cb, host->sender);
+    }
+
     // gracefully swap destination
     if(host->stream.snd.destination != parents) {
         STRING *t = string_dup(parents);
@@ -81,6 +103,8 @@ void stream_sender_structures_free(struct rrdhost *host) {
     stream_sender_signal_to_stop_and_wait(host, STREAM_HANDSHAKE_SND_DISCONNECT_HOST_CLEANUP, true);
     stream_circular_buffer_destroy(host->sender->scb);
     host->sender->scb = NULL;
+    stream_spill_destroy(host->sender->spill.sp);
+    host->sender->spill.sp = NULL;
     waitq_destroy(&host->sender->waitq);
     stream_compressor_destroy(&host->sender->thread.compressor);
 
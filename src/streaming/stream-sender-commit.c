@@ -66,48 +66,14 @@ BUFFER *sender_host_buffer_with_trace(struct rrdhost *host, const char *func) {
     return sender_commit_start_with_trace(host->sender, &host->stream.snd.commit, HOST_THREAD_BUFFER_INITIAL_SIZE, func);
 }
 
-// Collector thread finishing a transmission
-void sender_buffer_commit(struct sender_state *s, BUFFER *wb, struct sender_buffer *commit, STREAM_TRAFFIC_TYPE type) {
-    struct stream_opcode msg;
-
-    char *src = (char *)buffer_tostring(wb);
-    size_t src_len = buffer_strlen(wb);
-
-    if (unlikely(!src || !src_len))
-        return;
-
-    waitq_acquire(&s->waitq, (rrdhost_is_this_a_stream_thread(s->host)) ? WAITQ_PRIO_HIGH : WAITQ_PRIO_NORMAL);
-    stream_sender_lock(s);
-
-    // copy the sequence number of sender buffer recreates, while having our lock
-    STREAM_CIRCULAR_BUFFER_STATS *stats = stream_circular_buffer_stats_unsafe(s->scb);
-    if(commit)
-        commit->sender_recreates = stats->recreates;
-
-    if (!s->thread.msg.session) {
-        // the dispatcher is not there anymore - ignore these data
-
-        if(commit)
-            sender_buffer_destroy(commit);
-
-        stream_sender_unlock(s);
-        waitq_release(&s->waitq);
-        return;
-    }
-
-    if (unlikely(stream_circular_buffer_set_max_size_unsafe(
-            s->scb, src_len * STREAM_CIRCULAR_BUFFER_ADAPT_TO_TIMES_MAX_SIZE, false))) {
-        // adaptive sizing of the circular buffer
-        nd_log(NDLS_DAEMON, NDLP_NOTICE,
-               "STREAM SND '%s' [to %s]: Increased max buffer size to %u (message size %zu).",
-               rrdhost_hostname(s->host), s->remote_ip, stats->bytes_max_size, src_len + 1);
-    }
-
-    stream_sender_log_payload(s, wb, type, false);
-
-    // if there are data already in the buffer, we don't need to send an opcode
-    bool enable_sending = stats->bytes_outstanding == 0;
-
+typedef enum {
+    SENDER_BUFFER_ADD_OK = 0,
+    SENDER_BUFFER_ADD_OVERFLOW,
+    SENDER_BUFFER_ADD_COMPRESSION_FAILED,
+} SENDER_BUFFER_ADD;
+
+// add a message to the sending buffer, compressing it when the session is compressed
+static SENDER_BUFFER_ADD sender_buffer_add_unsafe(struct sender_state *s, const char *src, size_t src_len, STREAM_TRAFFIC_TYPE type) {
     if (s->thread.compressor.initialized) {
         // compressed traffic
         if(rrdhost_is_this_a_stream_thread(s->host))
@@ -147,7 +113,7 @@ void sender_buffer_commit(struct sender_state *s, BUFFER *wb, struct sender_buff
                 stream_compression_initialize(s);
                 dst_len = stream_compress(&s->thread.compressor, src, size_to_compress, &dst);
                 if (!dst_len)
-                    goto compression_failed_with_lock;
+                    return SENDER_BUFFER_ADD_COMPRESSION_FAILED;
             }
 
             stream_compression_signature_t signature = stream_compress_encode_signature(dst_len);
@@ -167,7 +133,7 @@ void sender_buffer_commit(struct sender_state *s, BUFFER *wb, struct sender_buff
                                                    sizeof(signature), type, false) ||
                 !stream_circular_buffer_add_unsafe(s->scb, dst, dst_len,
                                                    size_to_compress, type, false))
-                goto overflow_with_lock;
+                return SENDER_BUFFER_ADD_OVERFLOW;
 
             src = src + size_to_compress;
             src_len -= size_to_compress;
@@ -178,7 +144,121 @@ void sender_buffer_commit(struct sender_state *s, BUFFER *wb, struct sender_buff
 
         if (!stream_circular_buffer_add_unsafe(s->scb, src, src_len,
                                                src_len, type, false))
+            return SENDER_BUFFER_ADD_OVERFLOW;
+    }
+
+    return SENDER_BUFFER_ADD_OK;
+}
+
+// move the messages read back from the spill to the sending buffer, while they fit
+// returns false when they cannot be added to it
+bool stream_sender_spill_replay_unsafe(struct sender_state *s) {
+    if(!s->spill.sp || !s->thread.msg.session)
+        return true;
+
+    STREAM_CIRCULAR_BUFFER_STATS *stats = stream_circular_buffer_stats_unsafe(s->scb);
+    bool acks = stream_has_capability(s, STREAM_CAP_SPILL_SEQ);
+
+    const char *data;
+    size_t len;
+    uint64_t seq;
+    STREAM_TRAFFIC_TYPE type;
+    while((data = stream_spill_next_unsafe(s->spill.sp, &len, &seq, &type))) {
+        stream_circular_buffer_set_max_size_unsafe(
+            s->scb, STREAM_SPILL_REPLAY_BOUND(len) * STREAM_CIRCULAR_BUFFER_ADAPT_TO_TIMES_MAX_SIZE, false);
+
+        if(stats->bytes_available <= STREAM_SPILL_REPLAY_BOUND(len))
+            break;
+
+        if(acks) {
+            // the parent drops the records it has already applied, and acknowledges the rest
+            char marker[100];
+            size_t marker_len = snprintfz(marker, sizeof(marker), PLUGINSD_KEYWORD_SPILL_BEGIN " %llu %llu\n",
+                                          (unsigned long long)stream_spill_id(s->spill.sp), (unsigned long long)seq);
+
+            if(sender_buffer_add_unsafe(s, marker, marker_len, type) != SENDER_BUFFER_ADD_OK ||
+                sender_buffer_add_unsafe(s, data, len, type) != SENDER_BUFFER_ADD_OK)
+                return false;
+
+            marker_len = snprintfz(marker, sizeof(marker), PLUGINSD_KEYWORD_SPILL_END " %llu %llu\n",
+                                   (unsigned long long)stream_spill_id(s->spill.sp), (unsigned long long)seq);
+
+            if(sender_buffer_add_unsafe(s, marker, marker_len, type) != SENDER_BUFFER_ADD_OK)
+                return false;
+        }
+        else if(sender_buffer_add_unsafe(s, data, len, type) != SENDER_BUFFER_ADD_OK)
+            return false;
+
+        stream_spill_replayed_unsafe(s->spill.sp, acks);
+    }
+
+    replication_sender_recalculate_buffer_used_ratio_unsafe(s);
+    return true;
+}
+
+// Collector thread finishing a transmission
+void sender_buffer_commit(struct sender_state *s, BUFFER *wb, struct sender_buffer *commit, STREAM_TRAFFIC_TYPE type) {
+    struct stream_opcode msg;
+
+    char *src = (char *)buffer_tostring(wb);
+    size_t src_len = buffer_strlen(wb);
+
+    if (unlikely(!src || !src_len))
+        return;
+
+    waitq_acquire(&s->waitq, (rrdhost_is_this_a_stream_thread(s->host)) ? WAITQ_PRIO_HIGH : WAITQ_PRIO_NORMAL);
+    stream_sender_lock(s);
+
+    // copy the sequence number of sender buffer recreates, while having our lock
+    STREAM_CIRCULAR_BUFFER_STATS *stats = stream_circular_buffer_stats_unsafe(s->scb);
+    if(commit)
+        commit->sender_recreates = stats->recreates;
+
+    if (!s->thread.msg.session) {
+        // the dispatcher is not there anymore - ignore these data
+
+        if(commit)
+            sender_buffer_destroy(commit);
+
+        stream_sender_unlock(s);
+        waitq_release(&s->waitq);
+        return;
+    }
+
+    if (unlikely(stream_circular_buffer_set_max_size_unsafe(
+            s->scb, src_len * STREAM_CIRCULAR_BUFFER_ADAPT_TO_TIMES_MAX_SIZE, false))) {
+        // adaptive sizing of the circular buffer
+        nd_log(NDLS_DAEMON, NDLP_NOTICE,
+               "STREAM SND '%s' [to %s]: Increased max buffer size to %u (message size %zu).",
+               rrdhost_hostname(s->host), s->remote_ip, stats->bytes_max_size, src_len + 1);
+    }
+
+    stream_sender_log_payload(s, wb, type, false);
+
+    if (s->spill.sp && (stream_spill_has_queued_unsafe(s->spill.sp) ||
+                        stats->bytes_available <= STREAM_SPILL_REPLAY_BOUND(src_len))) {
+        // the buffer is full, or older messages are in the spill and have to be sent first
+        // the spill worker wakes up the dispatcher when they can be replayed
+        if (!stream_spill_queue_unsafe(s->spill.sp, src, src_len, type))
             goto overflow_with_lock;
+
+        stream_sender_unlock(s);
+        waitq_release(&s->waitq);
+        return;
+    }
+
+    // if there are data already in the buffer, we don't need to send an opcode
+    bool enable_sending = stats->bytes_outstanding == 0;
+
+    switch(sender_buffer_add_unsafe(s, src, src_len, type)) {
+        case SENDER_BUFFER_ADD_OK:
+            break;
+
+        case SENDER_BUFFER_ADD_OVERFLOW:
+            goto overflow_with_lock;
+
+        case SENDER_BUFFER_ADD_COMPRESSION_FAILED:
+            goto compression_failed_with_lock;
     }
 
     replication_sender_recalculate_buffer_used_ratio_unsafe(s);
@@ -312,6 +312,18 @@ void stream_sender_execute_commands(struct sender_state *s) {
 
             stream_sender_get_node_and_claim_id_from_parent(s, claim_id_str, node_id_str, url);
         }
+        else if(command && strcmp(command, PLUGINSD_KEYWORD_SPILL_ACK) == 0) {
+            worker_is_busy(WORKER_SENDER_JOB_EXECUTE_META);
+
+            char *id = get_word(s->thread.rbuf.line.words, s->thread.rbuf.line.num_words, 1);
+            char *seq = get_word(s->thread.rbuf.line.words, s->thread.rbuf.line.num_words, 2);
+
+            // the parent has applied the records up to seq, they are not replayed again
+            stream_sender_lock(s);
+            if(s->spill.sp && id && seq)
+                stream_spill_ack_unsafe(s->spill.sp, strtoull(id, NULL, 10), strtoull(seq, NULL, 10));
+            stream_sender_unlock(s);
+        }
         else if(command && strcmp(command, PLUGINSD_KEYWORD_JSON) == 0) {
             worker_is_busy(WORKER_SENDER_JOB_EXECUTE_META);
 
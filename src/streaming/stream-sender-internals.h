@@ -43,6 +43,11 @@ struct sender_state {
     time_t last_state_since_t;                  // the timestamp of the last state (online/offline) change
     STREAM_CIRCULAR_BUFFER *scb;                // sender buffer
 
+    struct {
+        STREAM_SPILL *sp;                       // the sender buffer spilled to disk - protected by sender_lock()
+        STREAM_CAPABILITIES capabilities;       // the capabilities the messages in the spill have been encoded with
+    } spill;
+
     struct {
         struct stream_opcode msg;   // the template for sending a message to the dispatcher - protected by sender_lock()
 
@@ -137,6 +142,7 @@ bool stream_connect(struct sender_state *s, uint16_t default_port, time_t timeou
 bool stream_sender_is_host_stopped(struct sender_state *s);
 
 void stream_sender_send_opcode(struct sender_state *s, struct stream_opcode msg);
+bool stream_sender_spill_replay_unsafe(struct sender_state *s);
 
 void stream_sender_add_to_queue(struct sender_state *s);
 
@@ -0,0 +1,756 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "stream.h"
+#include "stream-sender-spill.h"
+
+// The records flow: pending (memory) -> file -> ready (memory) -> sending buffer.
+// They stay in the file until they are acknowledged, so that a new connection
+// can replay them. The sequence numbers are never reset while the agent runs.
+// The order of the records is always: acknowledged, replayed, ready, file, pending.
+
+#define STREAM_SPILL_RECORD_MAGIC 0x4C495053 // "SPIL"
+
+struct stream_spill_record_header {
+    uint32_t magic;
+    uint32_t type;
+    uint64_t seq;
+    uint64_t len;
+};
+
+#define STREAM_SPILL_RECORD_SIZE(len) (sizeof(struct stream_spill_record_header) + (len))
+
+struct stream_spill_record {
+    uint64_t seq;
+    size_t len;
+    STREAM_TRAFFIC_TYPE type;
+    struct stream_spill_record *prev;
+    struct stream_spill_record *next;
+    char data[];
+};
+
+struct stream_spill {
+    char *filename;
+    uint64_t max_size;                  // the max bytes of records in the spill
+    size_t max_memory;                  // the max bytes waiting in memory, to be written or replayed
+    uint64_t id;
+
+    SPINLOCK *spinlock;
+    stream_spill_cb_t cb;
+    void *cb_data;
+
+    // protected by the spinlock
+    struct {
+        struct stream_spill_record *pending;    // to be written to the file
+        size_t pending_bytes;
+
+        struct stream_spill_record *ready;      // read back from the file, to be replayed
+        size_t ready_bytes;
+
+        uint64_t next_seq;              // the sequence number of the next record queued
+        uint64_t replay_seq;            // the sequence number of the next record to be replayed
+        uint64_t acked_seq;             // all the records before it have been acknowledged
+
+        uint64_t outstanding;           // the record bytes not reclaimed from the file (or going to it)
+
+        uint32_t rewinds;               // incremented when the connection is reset
+        uint32_t discards;              // incremented when all the data are discarded
+        bool discard;                   // the file has to be discarded by the worker
+    } q;
+
+    // used only by the worker, under the mutex
+    struct {
+        netdata_mutex_t mutex;
+        int fd;
+
+        uint64_t head;                  // the bytes written to the file
+        uint64_t read;                  // the bytes read back from the file
+        uint64_t tail;                  // the bytes reclaimed from the file
+
+        uint64_t read_seq;              // the sequence number of the record at read
+        uint64_t tail_seq;              // the sequence number of the record at tail
+
+        uint32_t rewinds;               // the rewinds of the queue applied to the file
+    } file;
+
+    // protected by the spinlock of the worker
+    struct {
+        bool queued;
+        struct stream_spill *prev;
+        struct stream_spill *next;
+    } worker;
+};
+
+// --------------------------------------------------------------------------------------------------------------------
+// the worker
+
+static struct {
+    SPINLOCK spinlock;
+    ND_THREAD *thread;
+    struct completion completion;
+
+    STREAM_SPILL *queue;                // the spills having work to do
+    STREAM_SPILL *running;              // the spill the worker is servicing now
+} spill_worker = {
+    .spinlock = SPINLOCK_INITIALIZER,
+};
+
+static void stream_spill_worker_thread(void *ptr __maybe_unused) {
+    worker_register("STREAMSPILL");
+    worker_register_job_name(0, "spill");
+
+    unsigned job_id = 0;
+    while(!nd_thread_signaled_to_cancel() && service_running(SERVICE_STREAMING)) {
+        worker_is_idle();
+        job_id = completion_wait_for_a_job_with_timeout(&spill_worker.completion, job_id, 1000);
+
+        while(true) {
+            spinlock_lock(&spill_worker.spinlock);
+            STREAM_SPILL *sp = spill_worker.queue;
+            if(sp) {
+                DOUBLE_LINKED_LIST_REMOVE_ITEM_UNSAFE(spill_worker.queue, sp, worker.prev, worker.next);
+                sp->worker.queued = false;
+            }
+            spill_worker.running = sp;
+            spinlock_unlock(&spill_worker.spinlock);
+
+            if(!sp)
+                break;
+
+            worker_is_busy(0);
+            stream_spill_service(sp);
+        }
+    }
+
+    worker_unregister();
+}
+
+static void stream_spill_worker_start(void) {
+    spinlock_lock(&spill_worker.spinlock);
+    if(!spill_worker.thread) {
+        completion_init(&spill_worker.completion);
+        spill_worker.thread = nd_thread_create(THREAD_TAG_STREAM_SENDER "-SPILL", NETDATA_THREAD_OPTION_DEFAULT,
+                                               stream_spill_worker_thread, NULL);
+        if(!spill_worker.thread)
+            nd_log_daemon(NDLP_ERR, "STREAM SPILL: failed to create the spill worker thread.");
+    }
+    spinlock_unlock(&spill_worker.spinlock);
+}
+
+void stream_spill_cancel_threads(void) {
+    nd_thread_signal_cancel(spill_worker.thread);
+}
+
+// give the spill to the worker - the caller may hold the spinlock of the spill
+static void stream_spill_schedule(STREAM_SPILL *sp) {
+    if(!sp->cb)
+        return;
+
+    spinlock_lock(&spill_worker.spinlock);
+    bool signal = !sp->worker.queued;
+    if(signal) {
+        DOUBLE_LINKED_LIST_APPEND_ITEM_UNSAFE(spill_worker.queue, sp, worker.prev, worker.next);
+        sp->worker.queued = true;
+    }
+    spinlock_unlock(&spill_worker.spinlock);
+
+    if(signal)
+        completion_mark_complete_a_job(&spill_worker.completion);
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+
+STREAM_SPILL *stream_spill_create(const char *filename, uint64_t max_size, size_t max_memory,
+                                  SPINLOCK *spinlock, stream_spill_cb_t cb, void *cb_data) {
+    STREAM_SPILL *sp = callocz(1, sizeof(*sp));
+    sp->filename = strdupz(filename);
+    sp->max_size = max_size;
+    sp->max_memory = max_memory;
+    sp->spinlock = spinlock;
+    sp->cb = cb;
+    sp->cb_data = cb_data;
+    sp->file.fd = -1;
+    netdata_mutex_init(&sp->file.mutex);
+
+    // the parent remembers the records it has applied per id, so zero is never used
+    do {
+        sp->id = os_random64();
+    } while(!sp->id);
+
+    // a file left by a previous run belongs to another id
+    unlink(sp->filename);
+
+    if(cb)
+        stream_spill_worker_start();
+
+    return sp;
+}
+
+static void stream_spill_records_free(struct stream_spill_record *base) {
+    while(base) {
+        struct stream_spill_record *r = base;
+        DOUBLE_LINKED_LIST_REMOVE_ITEM_UNSAFE(base, r, prev, next);
+        freez(r);
+    }
+}
+
+// the caller holds the mutex of the file (or is the only user of the spill)
+static void stream_spill_file_reset(STREAM_SPILL *sp) {
+    if(sp->file.fd != -1) {
+        close(sp->file.fd);
+        sp->file.fd = -1;
+
+        // give the disk space back
+        unlink(sp->filename);
+    }
+
+    sp->file.head = sp->file.read = sp->file.tail = 0;
+}
+
+void stream_spill_destroy(STREAM_SPILL *sp) {
+    if(!sp) return;
+
+    // make sure the worker does not use it
+    while(true) {
+        spinlock_lock(&spill_worker.spinlock);
+        if(sp->worker.queued) {
+            DOUBLE_LINKED_LIST_REMOVE_ITEM_UNSAFE(spill_worker.queue, sp, worker.prev, worker.next);
+            sp->worker.queued = false;
+        }
+        bool running = spill_worker.running == sp;
+        spinlock_unlock(&spill_worker.spinlock);
+
+        if(!running)
+            break;
+
+        sleep_usec(10 * USEC_PER_MS);
+    }
+
+    stream_spill_records_free(sp->q.pending);
+    stream_spill_records_free(sp->q.ready);
+    stream_spill_file_reset(sp);
+    netdata_mutex_destroy(&sp->file.mutex);
+    freez(sp->filename);
+    freez(sp);
+}
+
+uint64_t stream_spill_id(STREAM_SPILL *sp) {
+    return sp->id;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// the queue - under the spinlock
+
+// drop everything spilled - memory only, the file is discarded by the worker
+void stream_spill_discard_unsafe(STREAM_SPILL *sp) {
+    stream_spill_records_free(sp->q.pending);
+    stream_spill_records_free(sp->q.ready);
+    sp->q.pending = sp->q.ready = NULL;
+    sp->q.pending_bytes = sp->q.ready_bytes = 0;
+    sp->q.replay_seq = sp->q.acked_seq = sp->q.next_seq;
+    sp->q.outstanding = 0;
+    sp->q.discards++;
+    sp->q.discard = true;
+    stream_spill_schedule(sp);
+}
+
+ALWAYS_INLINE
+bool stream_spill_has_queued_unsafe(STREAM_SPILL *sp) {
+    return sp->q.replay_seq != sp->q.next_seq;
+}
+
+bool stream_spill_queue_unsafe(STREAM_SPILL *sp, const char *data, size_t len, STREAM_TRAFFIC_TYPE type) {
+    if((sp->q.pending && sp->q.pending_bytes + len > sp->max_memory) ||
+        sp->q.outstanding + STREAM_SPILL_RECORD_SIZE(len) > sp->max_size) {
+        // the spill is full - like a full buffer, its data are lost and the connection is restarted,
+        // otherwise every new connection would find it full
+        nd_log_limit_static_global_var(erl, 1, 0);
+        nd_log_limit(&erl, NDLS_DAEMON, NDLP_ERR,
+                     "STREAM SPILL: the spill '%s' is full (%llu bytes spilled, %zu bytes waiting to be written), "
+                     "discarding it",
+                     sp->filename, (unsigned long long)sp->q.outstanding, sp->q.pending_bytes);
+
+        stream_spill_discard_unsafe(sp);
+        return false;
+    }
+
+    struct stream_spill_record *r = mallocz(sizeof(*r) + len);
+    r->seq = sp->q.next_seq++;
+    r->len = len;
+    r->type = type;
+    memcpy(r->data, data, len);
+    DOUBLE_LINKED_LIST_APPEND_ITEM_UNSAFE(sp->q.pending, r, prev, next);
+    sp->q.pending_bytes += len;
+    sp->q.outstanding += STREAM_SPILL_RECORD_SIZE(len);
+
+    pulse_stream_spilled_bytes(len);
+
+    stream_spill_schedule(sp);
+    return true;
+}
+
+const char *stream_spill_next_unsafe(STREAM_SPILL *sp, size_t *len, uint64_t *seq, STREAM_TRAFFIC_TYPE *type) {
+    struct stream_spill_record *r;
+
+    // skip the records the parent has already acknowledged
+    while((r = sp->q.ready) && r->seq < sp->q.acked_seq) {
+        DOUBLE_LINKED_LIST_REMOVE_ITEM_UNSAFE(sp->q.ready, r, prev, next);
+        sp->q.ready_bytes -= r->len;
+        freez(r);
+    }
+
+    if(!r)
+        return NULL;
+
+    *len = r->len;
+    *seq = r->seq;
+    *type = r->type;
+    return r->data;
+}
+
+void stream_spill_replayed_unsafe(STREAM_SPILL *sp, bool acks) {
+    struct stream_spill_record *r = sp->q.ready;
+    if(!r) return;
+
+    DOUBLE_LINKED_LIST_REMOVE_ITEM_UNSAFE(sp->q.ready, r, prev, next);
+    sp->q.ready_bytes -= r->len;
+    sp->q.replay_seq = r->seq + 1;
+
+    if(!acks && sp->q.acked_seq < r->seq + 1)
+        sp->q.acked_seq = r->seq + 1;
+
+    pulse_stream_replayed_bytes(r->len);
+    freez(r);
+
+    // read more from the file
+    if(!sp->q.ready)
+        stream_spill_schedule(sp);
+}
+
+void stream_spill_ack_unsafe(STREAM_SPILL *sp, uint64_t id, uint64_t seq) {
+    if(id != sp->id || seq >= sp->q.next_seq || seq < sp->q.acked_seq)
+        return;
+
+    sp->q.acked_seq = seq + 1;
+    if(sp->q.replay_seq < sp->q.acked_seq)
+        sp->q.replay_seq = sp->q.acked_seq;
+
+    // reclaim them from the file
+    stream_spill_schedule(sp);
+}
+
+void stream_spill_rewind_unsafe(STREAM_SPILL *sp) {
+    // the records read back are read again, from the first one not acknowledged
+    stream_spill_records_free(sp->q.ready);
+    sp->q.ready = NULL;
+    sp->q.ready_bytes = 0;
+    sp->q.replay_seq = sp->q.acked_seq;
+    sp->q.rewinds++;
+
+    if(stream_spill_has_queued_unsafe(sp))
+        stream_spill_schedule(sp);
+}
+
+uint64_t stream_spill_outstanding_unsafe(STREAM_SPILL *sp) {
+    return sp->q.outstanding;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// the file - under the mutex of the file
+
+// write or read at a position of the ring, wrapping around the end of the file
+static bool stream_spill_io(STREAM_SPILL *sp, void *data, size_t len, uint64_t pos, bool write) {
+    char *d = data;
+
+    while(len) {
+        uint64_t offset = pos % sp->max_size;
+        size_t chunk = MIN(len, (size_t)(sp->max_size - offset));
+
+        ssize_t rc = write ? pwrite(sp->file.fd, d, chunk, (off_t)offset) : pread(sp->file.fd, d, chunk, (off_t)offset);
+        if(rc <= 0) {
+            if(rc == -1 && errno == EINTR)
+                continue;
+
+            return false;
+        }
+
+        d += rc;
+        pos += rc;
+        len -= rc;
+    }
+
+    return true;
+}
+
+static bool stream_spill_file_header(STREAM_SPILL *sp, uint64_t pos, uint64_t seq, struct stream_spill_record_header *h) {
+    if(!stream_spill_io(sp, h, sizeof(*h), pos, false) ||
+        h->magic != STREAM_SPILL_RECORD_MAGIC || h->seq != seq ||
+        STREAM_SPILL_RECORD_SIZE(h->len) > sp->file.head - pos) {
+        nd_log(NDLS_DAEMON, NDLP_ERR,
+               "STREAM SPILL: cannot read record %llu of the spill file '%s'",
+               (unsigned long long)seq, sp->filename);
+        return false;
+    }
+
+    return true;
+}
+
+static bool stream_spill_file_write(STREAM_SPILL *sp, struct stream_spill_record *base) {
+    for(struct stream_spill_record *r = base; r ; r = r->next) {
+        if(sp->file.fd == -1) {
+            sp->file.fd = open(sp->filename, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0660);
+            if(sp->file.fd == -1) {
+                nd_log(NDLS_DAEMON, NDLP_ERR, "STREAM SPILL: cannot create the spill file '%s'", sp->filename);
+                return false;
+            }
+        }
+
+        if(sp->file.head == sp->file.tail)
+            sp->file.read_seq = sp->file.tail_seq = r->seq;
+
+        if(sp->file.head + STREAM_SPILL_RECORD_SIZE(r->len) - sp->file.tail > sp->max_size) {
+            nd_log(NDLS_DAEMON, NDLP_ERR, "STREAM SPILL: the spill file '%s' overflowed", sp->filename);
+            return false;
+        }
+
+        struct stream_spill_record_header h = {
+            .magic = STREAM_SPILL_RECORD_MAGIC,
+            .type = (uint32_t)r->type,
+            .seq = r->seq,
+            .len = r->len,
+        };
+
+        if(!stream_spill_io(sp, &h, sizeof(h), sp->file.head, true) ||
+            !stream_spill_io(sp, r->data, r->len, sp->file.head + sizeof(h), true)) {
+            nd_log(NDLS_DAEMON, NDLP_ERR, "STREAM SPILL: cannot write to the spill file '%s'", sp->filename);
+            return false;
+        }
+
+        sp->file.head += STREAM_SPILL_RECORD_SIZE(r->len);
+    }
+
+    return true;
+}
+
+// drop from the file the records acknowledged
+static bool stream_spill_file_reclaim(STREAM_SPILL *sp, uint64_t acked_seq, uint64_t *reclaimed) {
+    while(sp->file.tail != sp->file.head && sp->file.tail_seq < acked_seq) {
+        struct stream_spill_record_header h;
+        if(!stream_spill_file_header(sp, sp->file.tail, sp->file.tail_seq, &h))
+            return false;
+
+        sp->file.tail += STREAM_SPILL_RECORD_SIZE(h.len);
+        sp->file.tail_seq++;
+        *reclaimed += STREAM_SPILL_RECORD_SIZE(h.len);
+    }
+
+    if(sp->file.read < sp->file.tail) {
+        sp->file.read = sp->file.tail;
+        sp->file.read_seq = sp->file.tail_seq;
+    }
+
+    if(sp->file.tail == sp->file.head)
+        stream_spill_file_reset(sp);
+
+    return true;
+}
+
+// read back the records that fit in the given bytes (at least one)
+static bool stream_spill_file_read(STREAM_SPILL *sp, size_t bytes, struct stream_spill_record **base) {
+    while(bytes && sp->file.read != sp->file.head) {
+        struct stream_spill_record_header h;
+        if(!stream_spill_file_header(sp, sp->file.read, sp->file.read_seq, &h))
+            return false;
+
+        if(*base && h.len > bytes)
+            break;
+
+        struct stream_spill_record *r = mallocz(sizeof(*r) + h.len);
+        r->seq = h.seq;
+        r->len = h.len;
+        r->type = (STREAM_TRAFFIC_TYPE)h.type;
+        DOUBLE_LINKED_LIST_APPEND_ITEM_UNSAFE(*base, r, prev, next);
+
+        if(!stream_spill_io(sp, r->data, h.len, sp->file.read + sizeof(h), false)) {
+            nd_log(NDLS_DAEMON, NDLP_ERR, "STREAM SPILL: cannot read from the spill file '%s'", sp->filename);
+            return false;
+        }
+
+        sp->file.read += STREAM_SPILL_RECORD_SIZE(h.len);
+        sp->file.read_seq++;
+        bytes = h.len < bytes ? bytes - h.len : 0;
+    }
+
+    return true;
+}
+
+void stream_spill_service(STREAM_SPILL *sp) {
+    netdata_mutex_lock(&sp->file.mutex);
+
+    // take the work, under the spinlock
+    spinlock_lock(sp->spinlock);
+    uint32_t rewinds = sp->q.rewinds;
+    uint32_t discards = sp->q.discards;
+    bool discard = sp->q.discard;
+    sp->q.discard = false;
+
+    // they keep their place in the order, in the file
+    struct stream_spill_record *write = sp->q.pending;
+    sp->q.pending = NULL;
+    sp->q.pending_bytes = 0;
+
+    uint64_t acked_seq = sp->q.acked_seq;
+    size_t readable = sp->q.ready_bytes < sp->max_memory ? sp->max_memory - sp->q.ready_bytes : 0;
+    spinlock_unlock(sp->spinlock);
+
+    // the file I/O, without the spinlock
+
+    if(discard)
+        stream_spill_file_reset(sp);
+
+    if(sp->file.rewinds != rewinds) {
+        sp->file.rewinds = rewinds;
+        sp->file.read = sp->file.tail;
+        sp->file.read_seq = sp->file.tail_seq;
+    }
+
+    struct stream_spill_record *read = NULL;
+    uint64_t reclaimed = 0;
+    bool ok = stream_spill_file_write(sp, write) &&
+              stream_spill_file_reclaim(sp, acked_seq, &reclaimed) &&
+              stream_spill_file_read(sp, readable, &read);
+
+    stream_spill_records_free(write);
+
+    // give the records read back, under the spinlock
+    bool ready = false;
+    spinlock_lock(sp->spinlock);
+    if(discards == sp->q.discards) {
+        sp->q.outstanding -= reclaimed;
+
+        if(rewinds == sp->q.rewinds && read) {
+            for(struct stream_spill_record *r = read; r ; r = r->next)
+                sp->q.ready_bytes += r->len;
+
+            DOUBLE_LINKED_LIST_APPEND_LIST_UNSAFE(sp->q.ready, read, prev, next);
+            read = NULL;
+            ready = true;
+        }
+
+        if(!ok)
+            stream_spill_discard_unsafe(sp);
+    }
+    else
+        // the data we worked on have been discarded while we were working
+        ok = true;
+    spinlock_unlock(sp->spinlock);
+
+    stream_spill_records_free(read);
+
+    netdata_mutex_unlock(&sp->file.mutex);
+
+    if(sp->cb && (ready || !ok))
+        sp->cb(sp->cb_data, !ok);
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// unittest
+
+// the data are a stream of bytes that depend on their position, so that any
+// loss, duplication or reordering is detected by the consumer
+static inline char stream_spill_unittest_byte(uint64_t pos) {
+    return (char)((pos * 131) ^ (pos >> 9));
+}
+
+struct stream_spill_unittest_parent {
+    STREAM_SPILL_APPLIED applied;
+    uint64_t consumed;
+    size_t duplicates;
+    size_t errors;
+};
+
+// replay up to max records to a parent, which applies them once
+// the parent acknowledges the first ack_max of them (SIZE_MAX for all)
+static size_t stream_spill_unittest_replay(STREAM_SPILL *sp, SPINLOCK *spinlock, struct stream_spill_unittest_parent *p,
+                                           size_t max, size_t ack_max, bool acks) {
+    size_t records = 0;
+
+    spinlock_lock(spinlock);
+    const char *data;
+    size_t len;
+    uint64_t seq;
+    STREAM_TRAFFIC_TYPE type;
+    while(records < max && (data = stream_spill_next_unsafe(sp, &len, &seq, &type))) {
+        if(stream_spill_applied(&p->applied, stream_spill_id(sp), seq))
+            p->duplicates++;
+        else {
+            for(size_t i = 0; i < len ; i++) {
+                if(data[i] != stream_spill_unittest_byte(p->consumed + i)) {
+                    if(!p->errors++)
+                        fprintf(stderr, "STREAM SPILL: wrong byte at position %llu\n",
+                                (unsigned long long)(p->consumed + i));
+                    break;
+                }
+            }
+
+            p->consumed += len;
+            stream_spill_applied_set(&p->applied, stream_spill_id(sp), seq);
+        }
+
+        stream_spill_replayed_unsafe(sp, acks);
+
+        if(acks && records < ack_max)
+            stream_spill_ack_unsafe(sp, stream_spill_id(sp), seq);
+
+        records++;
+    }
+    spinlock_unlock(spinlock);
+
+    return records;
+}
+
+static bool stream_spill_unittest_produce(STREAM_SPILL *sp, SPINLOCK *spinlock, uint64_t *produced, size_t len) {
+    char data[4096];
+    len = MIN(len, sizeof(data));
+    for(size_t b = 0; b < len ; b++)
+        data[b] = stream_spill_unittest_byte(*produced + b);
+
+    spinlock_lock(spinlock);
+    bool ret = stream_spill_queue_unsafe(sp, data, len, STREAM_TRAFFIC_TYPE_DATA);
+    spinlock_unlock(spinlock);
+
+    if(ret)
+        *produced += len;
+
+    return ret;
+}
+
+int stream_sender_spill_unittest(void) {
+    size_t errors = 0;
+    char filename[FILENAME_MAX + 1];
+    snprintfz(filename, FILENAME_MAX, "%s/stream-spill-unittest-%d.bin", netdata_configured_cache_dir, (int)getpid());
+
+    SPINLOCK spinlock;
+    spinlock_init(&spinlock);
+
+    // ordering and ring wraparound: produce faster than we consume, so that
+    // the file is never drained and its ring wraps around many times
+
+    {
+        STREAM_SPILL *sp = stream_spill_create(filename, 256 * 1024, 32 * 1024, &spinlock, NULL, NULL);
+        struct stream_spill_unittest_parent p = { 0 };
+        uint64_t produced = 0;
+        bool wrapped = false;
+
+        for(size_t i = 0; i < 5000 ; i++) {
+            // when the spill is full, the producer retries later
+            for(size_t r = 0; r < 3 ; r++) {
+                if(sp->q.outstanding + 4096 > sp->max_size)
+                    break;
+
+                if(!stream_spill_unittest_produce(sp, &spinlock, &produced, 10 + ((i * 3 + r) * 37) % 3000)) {
+                    fprintf(stderr, "STREAM SPILL: cannot queue to the spill\n");
+                    errors++;
+                }
+            }
+
+            stream_spill_service(sp);
+
+            if(sp->file.head > sp->max_size)
+                wrapped = true;
+
+            stream_spill_unittest_replay(sp, &spinlock, &p, 2, SIZE_MAX, false);
+        }
+
+        // drain everything
+        for(size_t i = 0; i < 100000 && p.consumed < produced ; i++) {
+            stream_spill_service(sp);
+            stream_spill_unittest_replay(sp, &spinlock, &p, SIZE_MAX, SIZE_MAX, false);
+        }
+        stream_spill_service(sp);
+
+        if(p.consumed != produced || p.duplicates) {
+            fprintf(stderr, "STREAM SPILL: produced %llu bytes, consumed %llu bytes, with %zu duplicate records\n",
+                    (unsigned long long)produced, (unsigned long long)p.consumed, p.duplicates);
+            errors++;
+        }
+
+        if(!wrapped) {
+            fprintf(stderr, "STREAM SPILL: the file did not wrap around\n");
+            errors++;
+        }
+
+        if(sp->q.outstanding || stream_spill_has_queued_unsafe(sp) || access(filename, F_OK) == 0) {
+            fprintf(stderr, "STREAM SPILL: the spill is not empty after draining it\n");
+            errors++;
+        }
+
+        errors += p.errors;
+        stream_spill_destroy(sp);
+    }
+
+    // a new session replays the spill in order, from the first record not acknowledged,
+    // and the parent drops the records it has already applied
+
+    {
+        STREAM_SPILL *sp = stream_spill_create(filename, 256 * 1024, 32 * 1024, &spinlock, NULL, NULL);
+        struct stream_spill_unittest_parent p = { 0 };
+        uint64_t produced = 0;
+
+        for(size_t i = 0; i < 40 ; i++)
+            stream_spill_unittest_produce(sp, &spinlock, &produced, 100 + i * 10);
+
+        stream_spill_service(sp);
+
+        // the parent applies 10 records, but only 4 acknowledgements reach us before the connection breaks
+        stream_spill_unittest_replay(sp, &spinlock, &p, 10, 4, true);
+        stream_spill_service(sp);
+
+        spinlock_lock(&spinlock);
+        stream_spill_rewind_unsafe(sp);
+        spinlock_unlock(&spinlock);
+
+        // these are queued while the new session replays the old records
+        for(size_t i = 0; i < 10 ; i++)
+            stream_spill_unittest_produce(sp, &spinlock, &produced, 50 + i);
+
+        if(access(filename, F_OK) != 0) {
+            fprintf(stderr, "STREAM SPILL: the spill file was not kept across the sessions\n");
+            errors++;
+        }
+
+        for(size_t i = 0; i < 1000 && p.consumed < produced ; i++) {
+            stream_spill_service(sp);
+            stream_spill_unittest_replay(sp, &spinlock, &p, SIZE_MAX, SIZE_MAX, true);
+        }
+        stream_spill_service(sp);
+
+        if(p.consumed != produced || p.duplicates != 10 - 4) {
+            fprintf(stderr, "STREAM SPILL: after a new session, produced %llu bytes, consumed %llu bytes, "
+                            "with %zu duplicate records (expected %d)\n",
+                    (unsigned long long)produced, (unsigned long long)p.consumed, p.duplicates, 10 - 4);
+            errors++;
+        }
+
+        if(sp->q.outstanding || access(filename, F_OK) == 0) {
+            fprintf(stderr, "STREAM SPILL: the acknowledged records are not reclaimed from the file\n");
+            errors++;
+        }
+
+        // a full spill discards its data
+        while(stream_spill_unittest_produce(sp, &spinlock, &produced, 4000)) ;
+        stream_spill_service(sp);
+
+        if(sp->q.outstanding || stream_spill_has_queued_unsafe(sp) || access(filename, F_OK) == 0) {
+            fprintf(stderr, "STREAM SPILL: a full spill was not discarded\n");
+            errors++;
+        }
+
+        errors += p.errors;
+        stream_spill_destroy(sp);
+    }
+
+    unlink(filename);
+
+    fprintf(stderr, "STREAM SPILL: %zu errors\n", errors);
+    return errors ? 1 : 0;
+}
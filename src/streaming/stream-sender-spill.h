@@ -0,0 +1,97 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef NETDATA_STREAM_SENDER_SPILL_H
+#define NETDATA_STREAM_SENDER_SPILL_H
+
+#include "libnetdata/libnetdata.h"
+#include "stream-traffic-types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// the spill of a sender
+// When the sending buffer is full, the uncompressed messages are appended to a file
+// (a bounded ring of records with sequence numbers), and they are replayed in order
+// as the buffer is drained. The messages are compressed by the session replaying them,
+// so the file survives reconnects: it is replayed from the first record the parent
+// has not acknowledged (STREAM_CAP_SPILL_SEQ), or not received (without it).
+//
+// The queue of the spill is protected by the spinlock given (the sender spinlock).
+// The file I/O is done by a worker thread, under a mutex of the file.
+
+struct stream_spill;
+typedef struct stream_spill STREAM_SPILL;
+
+// called by the worker when records are ready to be replayed, or when the spill failed
+// and its data have been discarded (failed = true) - it is called without any locks held
+typedef void (*stream_spill_cb_t)(void *data, bool failed);
+
+// the data of a record are compressed in pieces, each with a signature
+// this is the max size a record may need in the sending buffer
+#define STREAM_SPILL_REPLAY_BOUND(len) ((len) + (len) / 64 + 1024)
+
+// without a callback there is no worker, and stream_spill_service() has to be called by the caller
+STREAM_SPILL *stream_spill_create(const char *filename, uint64_t max_size, size_t max_memory,
+                                  SPINLOCK *spinlock, stream_spill_cb_t cb, void *cb_data);
+void stream_spill_destroy(STREAM_SPILL *sp);
+
+// the random id of the spill, the parent keeps the sequence numbers it has applied per id
+uint64_t stream_spill_id(STREAM_SPILL *sp);
+
+// does the file work - called by the worker, WITHOUT holding the spinlock
+void stream_spill_service(STREAM_SPILL *sp);
+
+void stream_spill_cancel_threads(void);
+
+// --------------------------------------------------------------------------------------------------------------------
+// the caller holds the spinlock of the spill
+
+// true when there are spilled messages not replayed yet - new messages have to follow them
+bool stream_spill_has_queued_unsafe(STREAM_SPILL *sp);
+
+// append a message to the spill, returns false when the spill is full
+bool stream_spill_queue_unsafe(STREAM_SPILL *sp, const char *data, size_t len, STREAM_TRAFFIC_TYPE type);
+
+// the next record to be replayed, or NULL when none is read back from the file yet
+const char *stream_spill_next_unsafe(STREAM_SPILL *sp, size_t *len, uint64_t *seq, STREAM_TRAFFIC_TYPE *type);
+
+// the record returned by stream_spill_next_unsafe() has been added to the sending buffer
+// without acknowledgements from the parent it is acknowledged now
+void stream_spill_replayed_unsafe(STREAM_SPILL *sp, bool acks);
+
+// the parent has applied all records up to and including seq
+void stream_spill_ack_unsafe(STREAM_SPILL *sp, uint64_t id, uint64_t seq);
+
+// the connection is reset - replay again all the records not acknowledged
+void stream_spill_rewind_unsafe(STREAM_SPILL *sp);
+
+// drop all the records
+void stream_spill_discard_unsafe(STREAM_SPILL *sp);
+
+// the bytes of the records in the spill
+uint64_t stream_spill_outstanding_unsafe(STREAM_SPILL *sp);
+
+// --------------------------------------------------------------------------------------------------------------------
+// the parent side - the records of the spill of a child that have been applied
+
+typedef struct stream_spill_applied {
+    uint64_t id;                        // the id of the spill of the child
+    uint64_t next_seq;                  // the first record not applied yet
+} STREAM_SPILL_APPLIED;
+
+// true when the record has already been applied, so it has to be dropped
+static inline bool stream_spill_applied(STREAM_SPILL_APPLIED *a, uint64_t id, uint64_t seq) {
+    return a->id == id && seq < a->next_seq;
+}
+
+static inline void stream_spill_applied_set(STREAM_SPILL_APPLIED *a, uint64_t id, uint64_t seq) {
+    a->id = id;
+    a->next_seq = seq + 1;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //NETDATA_STREAM_SENDER_SPILL_H
@@ -126,6 +126,31 @@ static void stream_sender_on_connect_and_disconnect(struct sender_state *s) {
     stream_sender_unlock(s);
 }
 
+// the capabilities that change how the spilled messages are encoded - compression is applied when they are replayed
+#define STREAM_SPILL_ENCODING_CAPABILITIES \
+    (~(STREAM_CAP_LZ4 | STREAM_CAP_ZSTD | STREAM_CAP_GZIP | STREAM_CAP_BROTLI | STREAM_CAP_ZSTD_DICT | STREAM_CAP_SPILL_SEQ))
+
+// the new connection replays the spill from the first message the parent has not acknowledged
+static void stream_sender_spill_on_connect_unsafe(struct sender_state *s) {
+    if(!s->spill.sp)
+        return;
+
+    STREAM_CAPABILITIES capabilities = s->capabilities & STREAM_SPILL_ENCODING_CAPABILITIES;
+
+    if(s->spill.capabilities != capabilities && stream_spill_outstanding_unsafe(s->spill.sp)) {
+        // the messages have been encoded for a parent with other capabilities
+        nd_log(NDLS_DAEMON, NDLP_NOTICE,
+               "STREAM SND '%s' [to %s]: the capabilities of the parent changed, discarding %llu bytes spilled to disk.",
+               rrdhost_hostname(s->host), s->remote_ip,
+               (unsigned long long)stream_spill_outstanding_unsafe(s->spill.sp));
+
+        stream_spill_discard_unsafe(s->spill.sp);
+    }
+
+    s->spill.capabilities = capabilities;
+    stream_spill_rewind_unsafe(s->spill.sp);
+}
+
 void stream_sender_on_connect(struct sender_state *s) {
     nd_log(NDLS_DAEMON, NDLP_DEBUG,
            "STREAM SND [%s]: running on-connect hooks...",
@@ -238,12 +263,15 @@ void stream_sender_handle_op(struct stream_thread *sth, struct sender_state *s,
         stream_sender_lock(s);
         // copy the statistics
         STREAM_CIRCULAR_BUFFER_STATS stats = *stream_circular_buffer_stats_unsafe(s->scb);
+        uint64_t spilled = s->spill.sp ? stream_spill_outstanding_unsafe(s->spill.sp) : 0;
         stream_sender_unlock(s);
         nd_log(NDLS_DAEMON, NDLP_ERR,
-               "STREAM SND[%zu] '%s' [to %s]: send buffer is full (buffer size %u, max %u, used %u, available %u). "
+               "STREAM SND[%zu] '%s' [to %s]: send buffer is full (buffer size %u, max %u, used %u, available %u, "
+               "spilled to disk %llu). "
                "Restarting connection.",
                sth->id, rrdhost_hostname(s->host), s->remote_ip,
-               stats.bytes_size, stats.bytes_max_size, stats.bytes_outstanding, stats.bytes_available);
+               stats.bytes_size, stats.bytes_max_size, stats.bytes_outstanding, stats.bytes_available,
+               (unsigned long long)spilled);
 
         stream_sender_move_running_to_connector_or_remove(
             sth, s, STREAM_HANDSHAKE_DISCONNECT_BUFFER_OVERFLOW, 0, true);
@@ -338,6 +366,7 @@ void stream_sender_move_queue_to_running_unsafe(struct stream_thread *sth) {
 
         stream_circular_buffer_flush_unsafe(s->scb, stream_send.buffer_max_size);
         replication_sender_recalculate_buffer_used_ratio_unsafe(s);
+        stream_sender_spill_on_connect_unsafe(s);
         stream_sender_unlock(s);
 
         internal_fatal(META_GET(&sth->run.meta, (Word_t)&s->thread.meta) != NULL, "Sender already exists in meta list");
@@ -464,6 +493,13 @@ static void stream_sender_move_running_to_connector_or_remove_internal(struct st
         s, reconnect && !stream_connector_is_signaled_to_stop(s) ? STRCNT_CMD_CONNECT : STRCNT_CMD_REMOVE);
 }
 
+// the spilled messages cannot be added to the sending buffer - reconnect, like on buffer overflow
+static void stream_sender_spill_overflow(struct sender_state *s, struct stream_opcode msg) {
+    msg.opcode = STREAM_OPCODE_SENDER_BUFFER_OVERFLOW;
+    msg.reason = STREAM_HANDSHAKE_DISCONNECT_BUFFER_OVERFLOW;
+    stream_sender_send_opcode(s, msg);
+}
+
 void stream_sender_check_all_nodes_from_poll(struct stream_thread *sth, usec_t now_ut) {
     internal_fatal(sth->tid != gettid_cached(), "Function %s() should only be used by the dispatcher thread", __FUNCTION__ );
 
@@ -479,10 +515,16 @@ void stream_sender_check_all_nodes_from_poll(struct stream_thread *sth, usec_t n
         struct sender_state *s = m->s;
 
         stream_sender_lock(s);
+        // replay the spilled messages the worker has read back, if the buffer had no room for them
+        bool replayed = stream_sender_spill_replay_unsafe(s);
+        struct stream_opcode msg = s->thread.msg;
         // copy the statistics
         STREAM_CIRCULAR_BUFFER_STATS stats = *stream_circular_buffer_stats_unsafe(s->scb);
         stream_sender_unlock(s);
 
+        if(unlikely(!replayed))
+            stream_sender_spill_overflow(s, msg);
+
         if (stats.buffer_ratio > overall_buffer_ratio)
             overall_buffer_ratio = stats.buffer_ratio;
 
@@ -648,9 +690,18 @@ bool stream_sender_send_data(struct stream_thread *sth, struct sender_state *s,
 
     EVLOOP_STATUS status = EVLOOP_STATUS_CONTINUE;
     while(status == EVLOOP_STATUS_CONTINUE) {
+        bool replay_failed = false;
+        struct stream_opcode msg;
+
         waitq_acquire(&s->waitq, WAITQ_PRIO_URGENT);
         stream_sender_lock(s);
 
+        // move the spilled messages read back by the worker to the buffer
+        if(unlikely(!stream_sender_spill_replay_unsafe(s))) {
+            replay_failed = true;
+            msg = s->thread.msg;
+        }
+
         STREAM_CIRCULAR_BUFFER_STATS *stats = stream_circular_buffer_stats_unsafe(s->scb);
         char *chunk;
         size_t outstanding = stream_circular_buffer_get_unsafe(s->scb, &chunk);
@@ -659,6 +710,10 @@ bool stream_sender_send_data(struct stream_thread *sth, struct sender_state *s,
             status = EVLOOP_STATUS_NO_MORE_DATA;
             stream_sender_unlock(s);
             waitq_release(&s->waitq);
+
+            if(unlikely(replay_failed))
+                stream_sender_spill_overflow(s, msg);
+
             continue;
         }
 
@@ -666,6 +721,13 @@ bool stream_sender_send_data(struct stream_thread *sth, struct sender_state *s,
         if (likely(rc > 0)) {
             pulse_stream_sent_bytes(rc);
             stream_circular_buffer_del_unsafe(s->scb, rc, now_ut);
+
+            // refill the buffer from the spill, as it is drained
+            if(unlikely(!replay_failed && !stream_sender_spill_replay_unsafe(s))) {
+                replay_failed = true;
+                msg = s->thread.msg;
+            }
+
             replication_sender_recalculate_buffer_used_ratio_unsafe(s);
             s->thread.last_traffic_ut = now_ut;
             sth->snd.bytes_sent += rc;
@@ -695,6 +757,9 @@ bool stream_sender_send_data(struct stream_thread *sth, struct sender_state *s,
         stream_sender_unlock(s);
         waitq_release(&s->waitq);
 
+        if(unlikely(replay_failed))
+            stream_sender_spill_overflow(s, msg);
+
         if (status == EVLOOP_STATUS_SOCKET_ERROR || status == EVLOOP_STATUS_SOCKET_CLOSED) {
             const char *disconnect_reason = NULL;
             STREAM_HANDSHAKE reason;
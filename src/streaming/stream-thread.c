@@ -784,6 +784,7 @@ void stream_sender_add_to_queue(struct sender_state *s) {
 
 void stream_threads_cancel(void) {
     stream_connector_cancel_threads();
+    stream_spill_cancel_threads();
     for(size_t i = 0; i < STREAM_MAX_THREADS ;i++)
         nd_thread_signal_cancel(stream_thread_globals.threads[i].thread);
 }
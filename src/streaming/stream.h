@@ -14,6 +14,7 @@ struct receiver_state;
 #include "stream-handshake.h"
 #include "stream-capabilities.h"
 #include "stream-parents.h"
+#include "stream-sender-spill.h"
 
 // starting and stopping senders
 void stream_sender_start_localhost(void *ptr);
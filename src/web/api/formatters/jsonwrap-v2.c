@@ -530,10 +530,21 @@ void rrdr_json_wrapper_end2(RRDR *r, BUFFER *wb) {
     }
     buffer_json_object_close(wb); // view
 
+    // the agents and the timings are specific to each request,
+    // so the query cache keeps the response up to here and renders them again
+    qt->tail.offset = buffer_strlen(wb);
+    qt->tail.json = wb->json;
+
+    rrdr_json_wrapper_tail2(qt, wb);
+    json_keys_reset();
+}
+
+void rrdr_json_wrapper_tail2(QUERY_TARGET *qt, BUFFER *wb) {
+    RRDR_OPTIONS options = qt->window.options;
+
     if(!(options & RRDR_OPTION_MINIMAL_STATS)) {
-        buffer_json_agents_v2(wb, &r->internal.qt->timings, 0, false, true, rrdr_options_to_contexts_options(options));
-        buffer_json_cloud_timings(wb, "timings", &r->internal.qt->timings);
+        buffer_json_agents_v2(wb, &qt->timings, 0, false, true, rrdr_options_to_contexts_options(options));
+        buffer_json_cloud_timings(wb, "timings", &qt->timings);
     }
     buffer_json_finalize(wb);
-    json_keys_reset();
 }
@@ -14,6 +14,8 @@ void rrdr_json_wrapper_end(RRDR *r, BUFFER *wb);
 
 void rrdr_json_wrapper_begin2(RRDR *r, BUFFER *wb);
 void rrdr_json_wrapper_end2(RRDR *r, BUFFER *wb);
+struct query_target;
+void rrdr_json_wrapper_tail2(struct query_target *qt, BUFFER *wb);
 
 struct query_versions;
 void version_hashes_api_v2(BUFFER *wb, struct query_versions *versions);
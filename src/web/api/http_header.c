@@ -1,6 +1,7 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 
 #include "http_header.h"
+#include "web/server/web_client_compression.h"
 
 static void web_client_enable_deflate(struct web_client *w, bool gzip) {
     if(gzip)
@@ -94,15 +95,59 @@ static void http_header_host(struct web_client *w, const char *v, size_t len) {
     w->server_host = strdupz(buffer);
 }
 
-static void http_header_accept_encoding(struct web_client *w, const char *v, size_t len __maybe_unused) {
-    if(web_enable_gzip) {
-        if(strcasestr(v, "gzip"))
-            web_client_enable_deflate(w, true);
+// returns the encodings the client accepts (q > 0), as WEB_CLIENT_ENCODING_* flags
+static WEB_CLIENT_FLAGS http_header_accepted_encodings(const char *v) {
+    WEB_CLIENT_FLAGS accepted = 0;
+
+    while(*v) {
+        while(*v == ' ' || *v == '\t' || *v == ',') v++;
+
+        const char *name = v;
+        while(*v && *v != ',' && *v != ';' && *v != ' ' && *v != '\t') v++;
+        size_t name_len = v - name;
+
+        // the parameters of this encoding, we care only about q=0
+        bool refused = false;
+        while(*v && *v != ',') {
+            if((*v == 'q' || *v == 'Q') && v[1] == '=') {
+                char *end;
+                refused = str2ndd(&v[2], &end) <= 0.0;
+                v = end;
+                continue;
+            }
+            v++;
+        }
+
+        if(!name_len || refused)
+            continue;
 
-        // does not seem to work
-        // else if(strcasestr(v, "deflate"))
-        //  web_client_enable_deflate(w, 0);
+        if(name_len == 4 && strncasecmp(name, "gzip", 4) == 0)
+            accepted |= WEB_CLIENT_ENCODING_GZIP;
+        else if(name_len == 4 && strncasecmp(name, "zstd", 4) == 0)
+            accepted |= WEB_CLIENT_ENCODING_ZSTD;
+        else if(name_len == 2 && strncasecmp(name, "br", 2) == 0)
+            accepted |= WEB_CLIENT_ENCODING_BROTLI;
     }
+
+    return accepted;
+}
+
+static void http_header_accept_encoding(struct web_client *w, const char *v, size_t len __maybe_unused) {
+    WEB_CLIENT_FLAGS accepted = http_header_accepted_encodings(v);
+
+    // our preference: zstd, brotli, gzip
+    if(web_enable_zstd && (accepted & WEB_CLIENT_ENCODING_ZSTD) && web_client_enable_zstd(w))
+        return;
+
+    if(web_enable_brotli && (accepted & WEB_CLIENT_ENCODING_BROTLI) && web_client_enable_brotli(w))
+        return;
+
+    if(web_enable_gzip && (accepted & WEB_CLIENT_ENCODING_GZIP))
+        web_client_enable_deflate(w, true);
+
+    // deflate does not seem to work
+    // else if(strcasestr(v, "deflate"))
+    //  web_client_enable_deflate(w, 0);
 }
 
 static void http_header_x_forwarded_host(struct web_client *w, const char *v, size_t len) {
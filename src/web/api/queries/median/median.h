@@ -12,15 +12,25 @@ struct tg_median {
     NETDATA_DOUBLE percent;
 
     NETDATA_DOUBLE *series;
+    TDIGEST *td;                // when approximate, instead of series
 };
 
 static inline void tg_median_create_internal(RRDR *r, const char *options, NETDATA_DOUBLE def) {
     long entries = r->view.group;
     if(entries < 10) entries = 10;
 
+    bool approximate;
+    options = time_grouping_options_approximate(options, &approximate);
+
     struct tg_median *g = (struct tg_median *)onewayalloc_callocz(r->internal.owa, 1, sizeof(struct tg_median));
-    g->series = onewayalloc_mallocz(r->internal.owa, entries * sizeof(NETDATA_DOUBLE));
-    g->series_size = (size_t)entries;
+    if(approximate) {
+        g->td = onewayalloc_mallocz(r->internal.owa, sizeof(TDIGEST));
+        tdigest_reset(g->td);
+    }
+    else {
+        g->series = onewayalloc_mallocz(r->internal.owa, entries * sizeof(NETDATA_DOUBLE));
+        g->series_size = (size_t)entries;
+    }
 
     g->percent = def;
     if(options && *options) {
@@ -67,11 +77,17 @@ static inline void tg_median_create_trimmed_25(RRDR *r, const char *options) {
 static inline void tg_median_reset(RRDR *r) {
     struct tg_median *g = (struct tg_median *)r->time_grouping.data;
     g->next_pos = 0;
+
+    if(g->td)
+        tdigest_reset(g->td);
 }
 
 static inline void tg_median_free(RRDR *r) {
     struct tg_median *g = (struct tg_median *)r->time_grouping.data;
-    if(g) onewayalloc_freez(r->internal.owa, g->series);
+    if(g) {
+        onewayalloc_freez(r->internal.owa, g->series);
+        onewayalloc_freez(r->internal.owa, g->td);
+    }
 
     onewayalloc_freez(r->internal.owa, r->time_grouping.data);
     r->time_grouping.data = NULL;
@@ -80,6 +96,11 @@ static inline void tg_median_free(RRDR *r) {
 static inline void tg_median_add(RRDR *r, NETDATA_DOUBLE value) {
     struct tg_median *g = (struct tg_median *)r->time_grouping.data;
 
+    if(g->td) {
+        tdigest_add(g->td, value);
+        return;
+    }
+
     if(unlikely(g->next_pos >= g->series_size)) {
         g->series = onewayalloc_doublesize( r->internal.owa, g->series, g->series_size * sizeof(NETDATA_DOUBLE));
         g->series_size *= 2;
@@ -88,9 +109,55 @@ static inline void tg_median_add(RRDR *r, NETDATA_DOUBLE value) {
     g->series[g->next_pos++] = value;
 }
 
+static inline void tg_median_add_batch(RRDR *r, const NETDATA_DOUBLE *values, size_t n) {
+    struct tg_median *g = (struct tg_median *)r->time_grouping.data;
+
+    if(g->td) {
+        for(size_t i = 0; i < n ;i++)
+            tdigest_add(g->td, values[i]);
+        return;
+    }
+
+    while(unlikely(g->next_pos + n > g->series_size)) {
+        g->series = onewayalloc_doublesize( r->internal.owa, g->series, g->series_size * sizeof(NETDATA_DOUBLE));
+        g->series_size *= 2;
+    }
+
+    memcpy(&g->series[g->next_pos], values, n * sizeof(NETDATA_DOUBLE));
+    g->next_pos += n;
+}
+
+static inline NETDATA_DOUBLE tg_median_flush_approximate(struct tg_median *g, RRDR_VALUE_FLAGS *rrdr_value_options_ptr) {
+    NETDATA_DOUBLE value;
+
+    if(unlikely(tdigest_weight(g->td) == 0.0))
+        value = NAN;
+    else if(g->percent > 0.0) {
+        // the median of the values between the trimmed min and max
+        NETDATA_DOUBLE delta = (g->td->max - g->td->min) * g->percent;
+        NETDATA_DOUBLE from = tdigest_cdf(g->td, g->td->min + delta);
+        NETDATA_DOUBLE to = tdigest_cdf(g->td, g->td->max - delta);
+        value = tdigest_quantile(g->td, (from + to) / 2.0);
+    }
+    else
+        value = tdigest_quantile(g->td, 0.5);
+
+    if(unlikely(!netdata_double_isnumber(value))) {
+        value = 0.0;
+        *rrdr_value_options_ptr |= RRDR_VALUE_EMPTY;
+    }
+
+    tdigest_reset(g->td);
+
+    return value;
+}
+
 static inline NETDATA_DOUBLE tg_median_flush(RRDR *r, RRDR_VALUE_FLAGS *rrdr_value_options_ptr) {
     struct tg_median *g = (struct tg_median *)r->time_grouping.data;
 
+    if(g->td)
+        return tg_median_flush_approximate(g, rrdr_value_options_ptr);
+
     size_t available_slots = g->next_pos;
     NETDATA_DOUBLE value;
 
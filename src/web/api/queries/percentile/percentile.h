@@ -12,15 +12,25 @@ struct tg_percentile {
     NETDATA_DOUBLE percent;
 
     NETDATA_DOUBLE *series;
+    TDIGEST *td;                // when approximate, instead of series
 };
 
 static inline void tg_percentile_create_internal(RRDR *r, const char *options, NETDATA_DOUBLE def) {
     long entries = r->view.group;
     if(entries < 10) entries = 10;
 
+    bool approximate;
+    options = time_grouping_options_approximate(options, &approximate);
+
     struct tg_percentile *g = (struct tg_percentile *)onewayalloc_callocz(r->internal.owa, 1, sizeof(struct tg_percentile));
-    g->series = onewayalloc_mallocz(r->internal.owa, entries * sizeof(NETDATA_DOUBLE));
-    g->series_size = (size_t)entries;
+    if(approximate) {
+        g->td = onewayalloc_mallocz(r->internal.owa, sizeof(TDIGEST));
+        tdigest_reset(g->td);
+    }
+    else {
+        g->series = onewayalloc_mallocz(r->internal.owa, entries * sizeof(NETDATA_DOUBLE));
+        g->series_size = (size_t)entries;
+    }
 
     g->percent = def;
     if(options && *options) {
@@ -67,11 +77,17 @@ static inline void tg_percentile_create_99(RRDR *r, const char *options) {
 static inline void tg_percentile_reset(RRDR *r) {
     struct tg_percentile *g = (struct tg_percentile *)r->time_grouping.data;
     g->next_pos = 0;
+
+    if(g->td)
+        tdigest_reset(g->td);
 }
 
 static inline void tg_percentile_free(RRDR *r) {
     struct tg_percentile *g = (struct tg_percentile *)r->time_grouping.data;
-    if(g) onewayalloc_freez(r->internal.owa, g->series);
+    if(g) {
+        onewayalloc_freez(r->internal.owa, g->series);
+        onewayalloc_freez(r->internal.owa, g->td);
+    }
 
     onewayalloc_freez(r->internal.owa, r->time_grouping.data);
     r->time_grouping.data = NULL;
@@ -80,6 +96,11 @@ static inline void tg_percentile_free(RRDR *r) {
 static inline void tg_percentile_add(RRDR *r, NETDATA_DOUBLE value) {
     struct tg_percentile *g = (struct tg_percentile *)r->time_grouping.data;
 
+    if(g->td) {
+        tdigest_add(g->td, value);
+        return;
+    }
+
     if(unlikely(g->next_pos >= g->series_size)) {
         g->series = onewayalloc_doublesize( r->internal.owa, g->series, g->series_size * sizeof(NETDATA_DOUBLE));
         g->series_size *= 2;
@@ -88,9 +109,50 @@ static inline void tg_percentile_add(RRDR *r, NETDATA_DOUBLE value) {
     g->series[g->next_pos++] = value;
 }
 
+static inline void tg_percentile_add_batch(RRDR *r, const NETDATA_DOUBLE *values, size_t n) {
+    struct tg_percentile *g = (struct tg_percentile *)r->time_grouping.data;
+
+    if(g->td) {
+        for(size_t i = 0; i < n ;i++)
+            tdigest_add(g->td, values[i]);
+        return;
+    }
+
+    while(unlikely(g->next_pos + n > g->series_size)) {
+        g->series = onewayalloc_doublesize( r->internal.owa, g->series, g->series_size * sizeof(NETDATA_DOUBLE));
+        g->series_size *= 2;
+    }
+
+    memcpy(&g->series[g->next_pos], values, n * sizeof(NETDATA_DOUBLE));
+    g->next_pos += n;
+}
+
+static inline NETDATA_DOUBLE tg_percentile_flush_approximate(struct tg_percentile *g, RRDR_VALUE_FLAGS *rrdr_value_options_ptr) {
+    NETDATA_DOUBLE value;
+
+    if(unlikely(tdigest_weight(g->td) == 0.0))
+        value = NAN;
+    else if(g->td->min >= 0.0 && g->td->max >= 0.0)
+        value = tdigest_mean_below(g->td, g->percent);
+    else
+        value = tdigest_mean_above(g->td, g->percent);
+
+    if(unlikely(!netdata_double_isnumber(value))) {
+        value = 0.0;
+        *rrdr_value_options_ptr |= RRDR_VALUE_EMPTY;
+    }
+
+    tdigest_reset(g->td);
+
+    return value;
+}
+
 static inline NETDATA_DOUBLE tg_percentile_flush(RRDR *r, RRDR_VALUE_FLAGS *rrdr_value_options_ptr) {
     struct tg_percentile *g = (struct tg_percentile *)r->time_grouping.data;
 
+    if(g->td)
+        return tg_percentile_flush_approximate(g, rrdr_value_options_ptr);
+
     NETDATA_DOUBLE value;
     size_t available_slots = g->next_pos;
 
@@ -0,0 +1,508 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "daemon/common.h"
+
+uint64_t query_cache_max_size_bytes = 32 * 1024 * 1024;
+time_t query_cache_max_age_s = 60;
+
+typedef struct query_cache_entry {
+    uint64_t hash;
+    char *key;                              // the normalized query
+    size_t key_len;
+
+    char *data;                             // the response, without the agents and the timings when tail is set
+    size_t data_len;
+    HTTP_CONTENT_TYPE content_type;
+    bool tail;                              // render the agents and the timings on every hit
+    struct buffer_json_state json;          // the json state at the end of data, when tail is set
+    time_t latest_timestamp;
+    int ret;
+
+    time_t expires_s;
+    int32_t refcount;                       // the readers copying the response
+    bool deleted;                           // not in the index any more, the last reader frees it
+
+    struct query_cache_entry *hash_next;    // the other entries with the same hash
+
+    struct query_cache_entry *prev;         // LRU, the head is the most recently used
+    struct query_cache_entry *next;
+} QUERY_CACHE_ENTRY;
+
+static struct {
+    SPINLOCK spinlock;
+    ARAL *ar;
+
+    Pvoid_t JudyL;                          // hash -> QUERY_CACHE_ENTRY
+    QUERY_CACHE_ENTRY *lru;
+
+    size_t entries;
+    size_t memory;
+
+    struct {
+        uint64_t hits;
+        uint64_t misses;
+        uint64_t evictions;
+        uint64_t expirations;
+    } atomic;
+} query_cache = {
+    .spinlock = SPINLOCK_INITIALIZER,
+};
+
+// ----------------------------------------------------------------------------
+// the key
+
+static inline void query_cache_key_str(BUFFER *wb, const char *s) {
+    if(s) buffer_strcat(wb, s);
+    buffer_putc(wb, '\x1f');
+}
+
+static inline void query_cache_key_u64(BUFFER *wb, uint64_t v) {
+    buffer_print_uint64_hex(wb, v);
+    buffer_putc(wb, '\x1f');
+}
+
+static void query_cache_key(BUFFER *wb, QUERY_TARGET *qt, HTTP_ACCESS access) {
+    QUERY_TARGET_REQUEST *qtr = &qt->request;
+
+    query_cache_key_u64(wb, qtr->version);
+    query_cache_key_u64(wb, (uint64_t)access);
+
+    query_cache_key_str(wb, qtr->scope_nodes);
+    query_cache_key_str(wb, qtr->scope_contexts);
+    query_cache_key_str(wb, qtr->scope_instances);
+    query_cache_key_str(wb, qtr->scope_labels);
+    query_cache_key_str(wb, qtr->scope_dimensions);
+    query_cache_key_str(wb, qtr->nodes);
+    query_cache_key_str(wb, qtr->contexts);
+    query_cache_key_str(wb, qtr->instances);
+    query_cache_key_str(wb, qtr->dimensions);
+    query_cache_key_str(wb, qtr->chart_label_key);
+    query_cache_key_str(wb, qtr->labels);
+    query_cache_key_str(wb, qtr->alerts);
+
+    for(size_t g = 0; g < MAX_QUERY_GROUP_BY_PASSES ;g++) {
+        query_cache_key_u64(wb, qtr->group_by[g].group_by);
+        query_cache_key_str(wb, qtr->group_by[g].group_by_label);
+        query_cache_key_u64(wb, qtr->group_by[g].aggregation);
+    }
+
+    query_cache_key_u64(wb, qtr->format);
+    query_cache_key_u64(wb, qtr->cardinality_limit);
+    query_cache_key_u64(wb, qtr->resampling_time);
+
+    // the resolved window
+    query_cache_key_u64(wb, qt->window.after);
+    query_cache_key_u64(wb, qt->window.before);
+    query_cache_key_u64(wb, qt->window.points);
+    query_cache_key_u64(wb, qt->window.group);
+    query_cache_key_u64(wb, qt->window.tier);
+    query_cache_key_u64(wb, qt->window.options);
+    query_cache_key_u64(wb, qt->window.time_group_method);
+    query_cache_key_str(wb, qt->window.time_group_options);
+
+    // any change to the contexts or the alerts of the nodes queried
+    query_cache_key_u64(wb, qt->versions.contexts_hard_hash);
+    query_cache_key_u64(wb, qt->versions.alerts_hard_hash);
+    query_cache_key_u64(wb, qt->versions.alerts_soft_hash);
+}
+
+// ----------------------------------------------------------------------------
+// the index
+
+static inline size_t query_cache_entry_memory(QUERY_CACHE_ENTRY *e) {
+    return sizeof(*e) + e->key_len + e->data_len;
+}
+
+static void query_cache_entry_free(QUERY_CACHE_ENTRY *e) {
+    freez(e->key);
+    freez(e->data);
+    aral_freez(query_cache.ar, e);
+}
+
+static QUERY_CACHE_ENTRY *query_cache_find_unsafe(uint64_t hash, const char *key, size_t key_len) {
+    Pvoid_t *PValue = JudyLGet(query_cache.JudyL, hash, PJE0);
+    if(!PValue)
+        return NULL;
+
+    for(QUERY_CACHE_ENTRY *e = *PValue; e ; e = e->hash_next) {
+        if(e->key_len == key_len && memcmp(e->key, key, key_len) == 0)
+            return e;
+    }
+
+    return NULL;
+}
+
+static void query_cache_unlink_unsafe(QUERY_CACHE_ENTRY *e) {
+    Pvoid_t *PValue = JudyLGet(query_cache.JudyL, e->hash, PJE0);
+    if(PValue) {
+        QUERY_CACHE_ENTRY **pe = (QUERY_CACHE_ENTRY **)PValue;
+        while(*pe && *pe != e)
+            pe = &(*pe)->hash_next;
+
+        if(*pe)
+            *pe = e->hash_next;
+
+        if(!*PValue)
+            JudyLDel(&query_cache.JudyL, e->hash, PJE0);
+    }
+
+    DOUBLE_LINKED_LIST_REMOVE_ITEM_UNSAFE(query_cache.lru, e, prev, next);
+    query_cache.entries--;
+    query_cache.memory -= query_cache_entry_memory(e);
+
+    if(e->refcount)
+        e->deleted = true;
+    else
+        query_cache_entry_free(e);
+}
+
+static void query_cache_link_unsafe(QUERY_CACHE_ENTRY *e) {
+    Pvoid_t *PValue = JudyLIns(&query_cache.JudyL, e->hash, PJE0);
+    if(!PValue || PValue == PJERR)
+        fatal("QUERY CACHE: corrupted JudyL array");
+
+    e->hash_next = *PValue;
+    *PValue = e;
+
+    DOUBLE_LINKED_LIST_PREPEND_ITEM_UNSAFE(query_cache.lru, e, prev, next);
+    query_cache.entries++;
+    query_cache.memory += query_cache_entry_memory(e);
+}
+
+// ----------------------------------------------------------------------------
+// the API
+
+bool query_cache_get(QUERY_TARGET *qt, HTTP_ACCESS access, BUFFER *wb, time_t *latest_timestamp, int *ret) {
+    if(!query_cache_max_size_bytes)
+        return false;
+
+    CLEAN_BUFFER *key = buffer_create(1024, NULL);
+    query_cache_key(key, qt, access);
+    uint64_t hash = XXH3_64bits(buffer_tostring(key), buffer_strlen(key));
+
+    spinlock_lock(&query_cache.spinlock);
+
+    QUERY_CACHE_ENTRY *e = query_cache_find_unsafe(hash, buffer_tostring(key), buffer_strlen(key));
+    if(e && e->expires_s <= now_realtime_sec()) {
+        query_cache_unlink_unsafe(e);
+        __atomic_add_fetch(&query_cache.atomic.expirations, 1, __ATOMIC_RELAXED);
+        e = NULL;
+    }
+
+    if(e) {
+        e->refcount++;
+
+        // make it the most recently used
+        DOUBLE_LINKED_LIST_REMOVE_ITEM_UNSAFE(query_cache.lru, e, prev, next);
+        DOUBLE_LINKED_LIST_PREPEND_ITEM_UNSAFE(query_cache.lru, e, prev, next);
+    }
+
+    spinlock_unlock(&query_cache.spinlock);
+
+    if(!e) {
+        __atomic_add_fetch(&query_cache.atomic.misses, 1, __ATOMIC_RELAXED);
+        return false;
+    }
+
+    // copy the response without holding the lock
+    buffer_memcat(wb, e->data, e->data_len);
+    wb->content_type = e->content_type;
+
+    bool tail = e->tail;
+    if(tail)
+        wb->json = e->json;
+
+    if(latest_timestamp)
+        *latest_timestamp = e->latest_timestamp;
+
+    *ret = e->ret;
+
+    spinlock_lock(&query_cache.spinlock);
+    if(!--e->refcount && e->deleted)
+        query_cache_entry_free(e);
+    spinlock_unlock(&query_cache.spinlock);
+
+    if(tail) {
+        // the response is rendered now, without executing the query
+        qt->timings.executed_ut = now_monotonic_usec();
+        qt->timings.finished_ut = 0;
+        rrdr_json_wrapper_tail2(qt, wb);
+    }
+
+    __atomic_add_fetch(&query_cache.atomic.hits, 1, __ATOMIC_RELAXED);
+    return true;
+}
+
+void query_cache_add(QUERY_TARGET *qt, HTTP_ACCESS access, BUFFER *wb, time_t latest_timestamp, int ret) {
+    if(!query_cache_max_size_bytes || ret != HTTP_RESP_OK || !buffer_strlen(wb) ||
+        buffer_strlen(wb) > query_cache_max_size_bytes / 4)
+        return;
+
+    time_t now_s = now_realtime_sec();
+    time_t view_update_every_s = MAX((time_t)query_view_update_every(qt), 1);
+
+    time_t max_age_s;
+    if(qt->window.before + 2 * view_update_every_s < now_s)
+        max_age_s = query_cache_max_age_s;
+    else
+        // the last point may still change
+        max_age_s = MIN(view_update_every_s, query_cache_max_age_s);
+
+    if(max_age_s <= 0)
+        return;
+
+    CLEAN_BUFFER *key = buffer_create(1024, NULL);
+    query_cache_key(key, qt, access);
+
+    spinlock_lock(&query_cache.spinlock);
+
+    if(unlikely(!query_cache.ar))
+        query_cache.ar = aral_create("query-cache", sizeof(QUERY_CACHE_ENTRY), 0, 0,
+                                     NULL, NULL, NULL, false, false, true);
+
+    spinlock_unlock(&query_cache.spinlock);
+
+    QUERY_CACHE_ENTRY *e = aral_callocz(query_cache.ar);
+    e->hash = XXH3_64bits(buffer_tostring(key), buffer_strlen(key));
+    e->key_len = buffer_strlen(key);
+    e->key = mallocz(e->key_len);
+    memcpy(e->key, buffer_tostring(key), e->key_len);
+    e->data_len = buffer_strlen(wb);
+
+    // the agents and the timings are not cached
+    if(qt->tail.offset && qt->tail.offset <= e->data_len) {
+        e->data_len = qt->tail.offset;
+        e->tail = true;
+        e->json = qt->tail.json;
+    }
+
+    e->data = mallocz(e->data_len);
+    memcpy(e->data, buffer_tostring(wb), e->data_len);
+    e->content_type = wb->content_type;
+    e->latest_timestamp = latest_timestamp;
+    e->ret = ret;
+    e->expires_s = now_s + max_age_s;
+
+    spinlock_lock(&query_cache.spinlock);
+
+    // another thread may have added the same query meanwhile
+    QUERY_CACHE_ENTRY *old = query_cache_find_unsafe(e->hash, e->key, e->key_len);
+    if(old)
+        query_cache_unlink_unsafe(old);
+
+    query_cache_link_unsafe(e);
+
+    while(query_cache.memory > query_cache_max_size_bytes && query_cache.lru && query_cache.lru->prev != e) {
+        query_cache_unlink_unsafe(query_cache.lru->prev);
+        __atomic_add_fetch(&query_cache.atomic.evictions, 1, __ATOMIC_RELAXED);
+    }
+
+    spinlock_unlock(&query_cache.spinlock);
+}
+
+void query_cache_statistics(struct query_cache_statistics *stats) {
+    stats->hits = __atomic_load_n(&query_cache.atomic.hits, __ATOMIC_RELAXED);
+    stats->misses = __atomic_load_n(&query_cache.atomic.misses, __ATOMIC_RELAXED);
+    stats->evictions = __atomic_load_n(&query_cache.atomic.evictions, __ATOMIC_RELAXED);
+    stats->expirations = __atomic_load_n(&query_cache.atomic.expirations, __ATOMIC_RELAXED);
+
+    spinlock_lock(&query_cache.spinlock);
+    stats->entries = query_cache.entries;
+    stats->memory = query_cache.memory;
+    spinlock_unlock(&query_cache.spinlock);
+}
+
+// ----------------------------------------------------------------------------
+// unittest
+
+static QUERY_CACHE_ENTRY *query_cache_unittest_find(QUERY_TARGET *qt) {
+    CLEAN_BUFFER *key = buffer_create(1024, NULL);
+    query_cache_key(key, qt, HTTP_ACCESS_ALL);
+    uint64_t hash = XXH3_64bits(buffer_tostring(key), buffer_strlen(key));
+
+    spinlock_lock(&query_cache.spinlock);
+    QUERY_CACHE_ENTRY *e = query_cache_find_unsafe(hash, buffer_tostring(key), buffer_strlen(key));
+    spinlock_unlock(&query_cache.spinlock);
+
+    return e;
+}
+
+static bool query_cache_unittest_same_key(QUERY_TARGET *qt1, QUERY_TARGET *qt2) {
+    CLEAN_BUFFER *k1 = buffer_create(1024, NULL);
+    CLEAN_BUFFER *k2 = buffer_create(1024, NULL);
+    query_cache_key(k1, qt1, HTTP_ACCESS_ALL);
+    query_cache_key(k2, qt2, HTTP_ACCESS_ALL);
+    return buffer_strlen(k1) == buffer_strlen(k2) && memcmp(buffer_tostring(k1), buffer_tostring(k2), buffer_strlen(k1)) == 0;
+}
+
+// render a response with a request specific member after the tail offset
+static void query_cache_unittest_response(QUERY_TARGET *qt, BUFFER *wb, const char *tail_value) {
+    buffer_flush(wb);
+    buffer_json_initialize(wb, "\"", "\"", 0, true, BUFFER_JSON_OPTIONS_DEFAULT);
+    buffer_json_member_add_uint64(wb, "api", 2);
+    buffer_json_member_add_string(wb, "data", "cached");
+
+    qt->tail.offset = buffer_strlen(wb);
+    qt->tail.json = wb->json;
+
+    if(tail_value)
+        buffer_json_member_add_string(wb, "timings", tail_value);
+
+    buffer_json_finalize(wb);
+}
+
+int query_cache_unittest(void) {
+    int errors = 0;
+    time_t now_s = now_realtime_sec();
+
+    uint64_t old_max_size = query_cache_max_size_bytes;
+    time_t old_max_age = query_cache_max_age_s;
+    query_cache_max_size_bytes = 1024 * 1024;
+    query_cache_max_age_s = 60;
+
+    QUERY_TARGET *qt1 = callocz(1, sizeof(*qt1));
+    QUERY_TARGET *qt2 = callocz(1, sizeof(*qt2));
+
+    // a historical window, with the agents and the timings excluded by MINIMAL_STATS
+    qt1->request.version = 2;
+    qt1->request.contexts = "system.cpu";
+    qt1->request.format = DATASOURCE_JSON2;
+    qt1->window.after = now_s - 7200;
+    qt1->window.before = now_s - 3600;
+    qt1->window.points = 60;
+    qt1->window.group = 60;
+    qt1->window.query_granularity = 1;
+    qt1->window.options = RRDR_OPTION_JSON_WRAP | RRDR_OPTION_MINIMAL_STATS;
+
+    // the key
+    *qt2 = *qt1;
+    if(!query_cache_unittest_same_key(qt1, qt2)) {
+        fprintf(stderr, "QUERY CACHE: identical queries have different keys\n");
+        errors++;
+    }
+
+    qt2->request.contexts = "system.load";
+    if(query_cache_unittest_same_key(qt1, qt2)) {
+        fprintf(stderr, "QUERY CACHE: queries of different contexts have the same key\n");
+        errors++;
+    }
+
+    *qt2 = *qt1;
+    qt2->window.after += 60;
+    qt2->window.before += 60;
+    if(query_cache_unittest_same_key(qt1, qt2)) {
+        fprintf(stderr, "QUERY CACHE: queries of different windows have the same key\n");
+        errors++;
+    }
+
+    *qt2 = *qt1;
+    qt2->versions.contexts_hard_hash++;
+    if(query_cache_unittest_same_key(qt1, qt2)) {
+        fprintf(stderr, "QUERY CACHE: queries of different contexts versions have the same key\n");
+        errors++;
+    }
+
+    // a hit renders the request specific part again
+    CLEAN_BUFFER *wb = buffer_create(1024, NULL);
+    CLEAN_BUFFER *expected = buffer_create(1024, NULL);
+    query_cache_unittest_response(qt1, wb, "of the first request");
+    query_cache_unittest_response(qt1, expected, NULL);
+    query_cache_add(qt1, HTTP_ACCESS_ALL, wb, now_s - 3600, HTTP_RESP_OK);
+
+    QUERY_CACHE_ENTRY *e = query_cache_unittest_find(qt1);
+    if(!e || !e->tail || e->data_len != qt1->tail.offset) {
+        fprintf(stderr, "QUERY CACHE: the response is not cached without its tail\n");
+        errors++;
+    }
+    else if(e->expires_s < now_s + query_cache_max_age_s || e->expires_s > now_s + query_cache_max_age_s + 1) {
+        fprintf(stderr, "QUERY CACHE: a historical window expires in %lld seconds, expected %lld\n",
+                (long long)(e->expires_s - now_s), (long long)query_cache_max_age_s);
+        errors++;
+    }
+
+    time_t latest_timestamp = 0;
+    int ret = 0;
+    buffer_flush(wb);
+    if(!query_cache_get(qt1, HTTP_ACCESS_ALL, wb, &latest_timestamp, &ret)) {
+        fprintf(stderr, "QUERY CACHE: a cached query is not found\n");
+        errors++;
+    }
+    else {
+        if(ret != HTTP_RESP_OK || latest_timestamp != now_s - 3600) {
+            fprintf(stderr, "QUERY CACHE: a hit returned ret %d, latest timestamp %lld\n", ret, (long long)latest_timestamp);
+            errors++;
+        }
+
+        if(strcmp(buffer_tostring(wb), buffer_tostring(expected)) != 0) {
+            fprintf(stderr, "QUERY CACHE: a hit returned '%s', expected '%s'\n",
+                    buffer_tostring(wb), buffer_tostring(expected));
+            errors++;
+        }
+    }
+
+    // the expiry
+    struct query_cache_statistics before, after;
+    query_cache_statistics(&before);
+
+    e = query_cache_unittest_find(qt1);
+    if(e) {
+        spinlock_lock(&query_cache.spinlock);
+        e->expires_s = now_s - 1;
+        spinlock_unlock(&query_cache.spinlock);
+    }
+
+    buffer_flush(wb);
+    if(query_cache_get(qt1, HTTP_ACCESS_ALL, wb, &latest_timestamp, &ret)) {
+        fprintf(stderr, "QUERY CACHE: an expired query is found\n");
+        errors++;
+    }
+
+    query_cache_statistics(&after);
+    if(after.expirations != before.expirations + 1 || after.entries != before.entries - 1) {
+        fprintf(stderr, "QUERY CACHE: an expired query is not removed\n");
+        errors++;
+    }
+
+    // a window reaching the present is cached for one point only
+    *qt2 = *qt1;
+    qt2->window.after = now_s - 600;
+    qt2->window.before = now_s;
+    qt2->window.group = 5;
+    query_cache_unittest_response(qt2, wb, NULL);
+    query_cache_add(qt2, HTTP_ACCESS_ALL, wb, now_s, HTTP_RESP_OK);
+
+    e = query_cache_unittest_find(qt2);
+    if(!e || e->expires_s < now_s + 5 || e->expires_s > now_s + 5 + 1) {
+        fprintf(stderr, "QUERY CACHE: a window reaching the present expires in %lld seconds, expected 5\n",
+                e ? (long long)(e->expires_s - now_s) : -1LL);
+        errors++;
+    }
+
+    // the next relative query moves the window, so it misses
+    *qt1 = *qt2;
+    qt1->window.after += 5;
+    qt1->window.before += 5;
+    buffer_flush(wb);
+    if(query_cache_get(qt1, HTTP_ACCESS_ALL, wb, &latest_timestamp, &ret)) {
+        fprintf(stderr, "QUERY CACHE: a moved relative window is found\n");
+        errors++;
+    }
+
+    // failed queries are not cached
+    *qt1 = *qt2;
+    qt1->request.contexts = "system.io";
+    query_cache_add(qt1, HTTP_ACCESS_ALL, wb, now_s, HTTP_RESP_NOT_FOUND);
+    if(query_cache_unittest_find(qt1)) {
+        fprintf(stderr, "QUERY CACHE: a failed query is cached\n");
+        errors++;
+    }
+
+    freez(qt1);
+    freez(qt2);
+
+    query_cache_max_size_bytes = old_max_size;
+    query_cache_max_age_s = old_max_age;
+
+    fprintf(stderr, "QUERY CACHE: %d errors\n", errors);
+    return errors;
+}
@@ -0,0 +1,44 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef NETDATA_API_QUERY_CACHE_H
+#define NETDATA_API_QUERY_CACHE_H
+
+#include "libnetdata/libnetdata.h"
+
+struct query_target;
+
+// A cache of rendered /api/v2 and /api/v3 data responses.
+//
+// The key is the normalized query target: the request (scope, selectors,
+// group-by, time grouping, points, options, format) together with the
+// resolved (aligned) after/before window and the versions of the contexts
+// and alerts involved, so that any change in the metrics or alerts queried
+// produces a different key.
+//
+// Windows reaching the present are cached for one point (the view update every),
+// since their last point may still change. Historical windows are cached for
+// the configured max age.
+
+extern uint64_t query_cache_max_size_bytes;     // 0 disables the cache
+extern time_t query_cache_max_age_s;
+
+// when true, the response has been copied to wb, and *latest_timestamp and *ret are set
+bool query_cache_get(struct query_target *qt, HTTP_ACCESS access, BUFFER *wb, time_t *latest_timestamp, int *ret);
+
+// store the response rendered to wb
+void query_cache_add(struct query_target *qt, HTTP_ACCESS access, BUFFER *wb, time_t latest_timestamp, int ret);
+
+struct query_cache_statistics {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+    uint64_t expirations;
+    size_t entries;
+    size_t memory;
+};
+
+void query_cache_statistics(struct query_cache_statistics *stats);
+
+int query_cache_unittest(void);
+
+#endif //NETDATA_API_QUERY_CACHE_H
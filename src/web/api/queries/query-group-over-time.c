@@ -786,6 +786,79 @@ void time_grouping_add(RRDR *r, NETDATA_DOUBLE value, const RRDR_TIME_GROUPING a
     }
 }
 
+// Add many values into the calculation, as if time_grouping_add() was called
+// for each of them in order. The method is dispatched once per batch.
+ALWAYS_INLINE_HOT_FLATTEN
+void time_grouping_add_batch(RRDR *r, const NETDATA_DOUBLE *values, size_t n, const RRDR_TIME_GROUPING add_flush) {
+    switch(add_flush) {
+        case RRDR_GROUPING_AVERAGE:
+            tg_average_add_batch(r, values, n);
+            break;
+
+        case RRDR_GROUPING_SUM:
+            tg_sum_add_batch(r, values, n);
+            break;
+
+        case RRDR_GROUPING_MEDIAN:
+            tg_median_add_batch(r, values, n);
+            break;
+
+        case RRDR_GROUPING_PERCENTILE:
+            tg_percentile_add_batch(r, values, n);
+            break;
+
+        case RRDR_GROUPING_TRIMMED_MEAN:
+            tg_trimmed_mean_add_batch(r, values, n);
+            break;
+
+        case RRDR_GROUPING_MAX:
+            for(size_t i = 0; i < n ; i++)
+                tg_max_add(r, values[i]);
+            break;
+
+        case RRDR_GROUPING_MIN:
+            for(size_t i = 0; i < n ; i++)
+                tg_min_add(r, values[i]);
+            break;
+
+        case RRDR_GROUPING_STDDEV:
+        case RRDR_GROUPING_CV:
+            for(size_t i = 0; i < n ; i++)
+                tg_stddev_add(r, values[i]);
+            break;
+
+        case RRDR_GROUPING_COUNTIF:
+            for(size_t i = 0; i < n ; i++)
+                tg_countif_add(r, values[i]);
+            break;
+
+        case RRDR_GROUPING_EXTREMES:
+            for(size_t i = 0; i < n ; i++)
+                tg_extremes_add(r, values[i]);
+            break;
+
+        case RRDR_GROUPING_SES:
+            for(size_t i = 0; i < n ; i++)
+                tg_ses_add(r, values[i]);
+            break;
+
+        case RRDR_GROUPING_DES:
+            for(size_t i = 0; i < n ; i++)
+                tg_des_add(r, values[i]);
+            break;
+
+        case RRDR_GROUPING_INCREMENTAL_SUM:
+            for(size_t i = 0; i < n ; i++)
+                tg_incremental_sum_add(r, values[i]);
+            break;
+
+        default:
+            for(size_t i = 0; i < n ; i++)
+                r->time_grouping.add(r, values[i]);
+            break;
+    }
+}
+
 ALWAYS_INLINE_HOT_FLATTEN
 NETDATA_DOUBLE time_grouping_flush(RRDR *r, RRDR_VALUE_FLAGS *rrdr_value_options_ptr, const RRDR_TIME_GROUPING add_flush) {
     switch(add_flush) {
@@ -835,3 +908,43 @@ NETDATA_DOUBLE time_grouping_flush(RRDR *r, RRDR_VALUE_FLAGS *rrdr_value_options
             return r->time_grouping.flush(r, rrdr_value_options_ptr);
     }
 }
+
+int time_grouping_options_unittest(void) {
+    struct {
+        const char *options;
+        bool approximate;
+        NETDATA_DOUBLE number;          // NAN when there is no number
+    } tests[] = {
+        { .options = NULL,              .approximate = false,   .number = NAN },
+        { .options = "",                .approximate = false,   .number = NAN },
+        { .options = "95",              .approximate = false,   .number = 95.0 },
+        { .options = "approximate",     .approximate = true,    .number = NAN },
+        { .options = "95,approximate",  .approximate = true,    .number = 95.0 },
+        { .options = "approximate,95",  .approximate = true,    .number = 95.0 },
+        { .options = "approximate 5",   .approximate = true,    .number = 5.0 },
+        { .options = "approximate,",    .approximate = true,    .number = NAN },
+    };
+
+    int errors = 0;
+    size_t elements = sizeof(tests) / sizeof(tests[0]);
+    for(size_t i = 0; i < elements; i++) {
+        bool approximate;
+        const char *number = time_grouping_options_approximate(tests[i].options, &approximate);
+
+        bool ok = approximate == tests[i].approximate;
+        if(isnan(tests[i].number))
+            ok = ok && !number;
+        else
+            ok = ok && number && str2ndd(number, NULL) == tests[i].number;
+
+        if(!ok) {
+            fprintf(stderr, "TIME GROUPING OPTIONS: '%s' gave approximate %s, number '%s'\n",
+                    tests[i].options ? tests[i].options : "(null)", approximate ? "true" : "false",
+                    number ? number : "(null)");
+            errors++;
+        }
+    }
+
+    fprintf(stderr, "TIME GROUPING OPTIONS: %d errors\n", errors);
+    return errors;
+}
@@ -40,6 +40,8 @@ typedef struct query_point {
 #define query_point_set_id(point, point_id) debug_dummy()
 #endif
 
+#define QUERY_ENGINE_OPS_BATCH_POINTS 32
+
 typedef struct query_engine_ops {
     // configuration
     RRDR *r;
@@ -59,7 +61,17 @@ typedef struct query_engine_ops {
     struct query_metric_tier *tier_ptr;
     struct storage_engine_query_handle *seqh;
 
+    // points read-ahead from the storage engine, in batches
+    // it is reset every time a plan is activated
+    struct {
+        size_t pos;
+        size_t used;
+        STORAGE_POINT points[QUERY_ENGINE_OPS_BATCH_POINTS];
+    } batch;
+
     // aggregating points over time
+    size_t group_values_used;                                   // values waiting to be added to the time grouping
+    NETDATA_DOUBLE group_values[QUERY_ENGINE_OPS_BATCH_POINTS];
     size_t group_points_non_zero;
     size_t group_points_added;
     STORAGE_POINT group_point;          // aggregates min, max, sum, count, anomaly count for each group point
@@ -92,6 +104,7 @@ void rrd2rrdr_query_ops_freeall(RRDR *r);
 
 // time aggregation
 void time_grouping_add(RRDR *r, NETDATA_DOUBLE value, const RRDR_TIME_GROUPING add_flush);
+void time_grouping_add_batch(RRDR *r, const NETDATA_DOUBLE *values, size_t n, const RRDR_TIME_GROUPING add_flush);
 NETDATA_DOUBLE time_grouping_flush(RRDR *r, RRDR_VALUE_FLAGS *rrdr_value_options_ptr, const RRDR_TIME_GROUPING add_flush);
 void rrdr_set_grouping_function(RRDR *r, RRDR_TIME_GROUPING group_method);
 
@@ -252,7 +252,8 @@ static void query_planer_initialize_plans(QUERY_ENGINE_OPS *ops) {
         struct query_metric_tier *tier_ptr = &qm->tiers[tier];
         STORAGE_ENGINE *eng = query_metric_storage_engine(ops->r->internal.qt, qm, tier);
         storage_engine_query_init(eng->seb, tier_ptr->smh, &ops->plans[p].handle,
-                                  after, before, ops->r->internal.qt->request.priority);
+                                  after, before, ops->r->internal.qt->request.priority,
+                                  ops->r->internal.qt->request.query_source);
 
         ops->plans[p].initialized = true;
         ops->plans[p].finalized = false;
@@ -289,6 +290,7 @@ static void query_planer_activate_plan(QUERY_ENGINE_OPS *ops, size_t plan_id, ti
     ops->tier_ptr = &qm->tiers[ops->tier];
     ops->seqh = &ops->plans[plan_id].handle;
     ops->current_plan = plan_id;
+    ops->batch.pos = ops->batch.used = 0;
 
     if(plan_id + 1 < qm->plan.used && qm->plan.array[plan_id + 1].after < qm->plan.array[plan_id].before)
         ops->current_plan_expire_time = qm->plan.array[plan_id + 1].after;
@@ -51,6 +51,34 @@ static long rrdr_line_init(RRDR *r __maybe_unused, time_t t __maybe_unused, long
         }                                                               \
 } while(0)
 
+// values are staged in ops and given to the time grouping in batches,
+// so the grouping method is dispatched once per batch, not once per point
+static ALWAYS_INLINE void query_group_values_flush(RRDR *r, QUERY_ENGINE_OPS *ops, const RRDR_TIME_GROUPING add_flush) {
+    if(ops->group_values_used) {
+        time_grouping_add_batch(r, ops->group_values, ops->group_values_used, add_flush);
+        ops->group_values_used = 0;
+    }
+}
+
+// storage points are read from the storage engine in batches,
+// with the same semantics as storage_engine_query_next_metric()
+static ALWAYS_INLINE bool query_engine_ops_is_finished(QUERY_ENGINE_OPS *ops) {
+    return ops->batch.pos >= ops->batch.used && storage_engine_query_is_finished(ops->seqh);
+}
+
+static ALWAYS_INLINE STORAGE_POINT query_engine_ops_next_point(QUERY_ENGINE_OPS *ops) {
+    if(unlikely(ops->batch.pos >= ops->batch.used)) {
+        ops->batch.pos = 0;
+        ops->batch.used = storage_engine_query_next_metric_batch(ops->seqh, ops->batch.points, QUERY_ENGINE_OPS_BATCH_POINTS);
+
+        if(unlikely(!ops->batch.used))
+            // the query is finished, but we are still asked for points
+            return storage_engine_query_next_metric(ops->seqh);
+    }
+
+    return ops->batch.points[ops->batch.pos++];
+}
+
 #define query_add_point_to_group(r, point, ops, add_flush)        do {  \
     if(likely(netdata_double_isnumber((point).value))) {                \
         if(likely(fpclassify((point).value) != FP_ZERO))                \
@@ -59,7 +87,9 @@ static long rrdr_line_init(RRDR *r __maybe_unused, time_t t __maybe_unused, long
         if(unlikely((point).sp.flags & SN_FLAG_RESET))                  \
             (ops)->group_value_flags |= RRDR_VALUE_RESET;               \
                                                                         \
-        time_grouping_add(r, (point).value, add_flush);                 \
+        (ops)->group_values[(ops)->group_values_used++] = (point).value;\
+        if(unlikely((ops)->group_values_used >= QUERY_ENGINE_OPS_BATCH_POINTS)) \
+            query_group_values_flush(r, ops, add_flush);                \
                                                                         \
         storage_point_merge_to((ops)->group_point, (point).sp);         \
         if(!(point).added)                                              \
@@ -127,7 +157,7 @@ NOT_INLINE_HOT static void rrd2rrdr_query_execute(RRDR *r, size_t dim_id_in_rrdr
                 last1_point = new_point;
             }
 
-            if(unlikely(storage_engine_query_is_finished(ops->seqh))) {
+            if(unlikely(query_engine_ops_is_finished(ops))) {
                 query_is_finished_counter++;
 
                 if(count_same_end_time != 0) {
@@ -150,7 +180,7 @@ NOT_INLINE_HOT static void rrd2rrdr_query_execute(RRDR *r, size_t dim_id_in_rrdr
                 STORAGE_POINT sp;
                 if(likely(storage_point_is_unset(next1_point))) {
                     db_points_read_since_plan_switch++;
-                    sp = storage_engine_query_next_metric(ops->seqh);
+                    sp = query_engine_ops_next_point(ops);
                     ops->db_points_read_per_tier[ops->tier]++;
                     ops->db_total_points_read++;
 
@@ -176,7 +206,7 @@ NOT_INLINE_HOT static void rrd2rrdr_query_execute(RRDR *r, size_t dim_id_in_rrdr
                     // A. the entire point of the previous plan is to the future of point from the next plan
                     // B. part of the point of the previous plan overlaps with the point from the next plan
 
-                    STORAGE_POINT sp2 = storage_engine_query_next_metric(ops->seqh);
+                    STORAGE_POINT sp2 = query_engine_ops_next_point(ops);
                     ops->db_points_read_per_tier[ops->tier]++;
                     ops->db_total_points_read++;
 
@@ -394,6 +424,7 @@ NOT_INLINE_HOT static void rrd2rrdr_query_execute(RRDR *r, size_t dim_id_in_rrdr
             *rrdr_value_options_ptr = ops->group_value_flags;
 
             // store the group value
+            query_group_values_flush(r, ops, add_flush);
             NETDATA_DOUBLE group_value = time_grouping_flush(r, rrdr_value_options_ptr, add_flush);
             r->v[rrdr_o_v_index] = group_value;
 
@@ -426,6 +457,7 @@ NOT_INLINE_HOT static void rrd2rrdr_query_execute(RRDR *r, size_t dim_id_in_rrdr
         // so, let's undo the last iteration of this loop
         now_end_time -= ops->view_update_every;
     }
+    query_group_values_flush(r, ops, add_flush);
     query_planer_finalize_remaining_plans(ops);
 
     qm->query_points = ops->query_point;
@@ -57,6 +57,34 @@ void time_grouping_init(void);
 RRDR_TIME_GROUPING time_grouping_parse(const char *name, RRDR_TIME_GROUPING def);
 const char *time_grouping_tostring(RRDR_TIME_GROUPING group);
 
+// percentile and median accept the keyword "approximate" in their options,
+// before or after their number (e.g. "95,approximate" or "approximate,95"),
+// to use a t-digest instead of sorting all the values of each group.
+// Returns the options to parse as a number, or NULL when there is no number.
+static inline const char *time_grouping_options_approximate(const char *options, bool *approximate) {
+    *approximate = false;
+
+    if(!options || !*options)
+        return NULL;
+
+    const char *s = strstr(options, "approximate");
+    if(s) {
+        *approximate = true;
+        if(s == options) {
+            // the number, if any, follows the keyword
+            s += sizeof("approximate") - 1;
+            while(*s == ',' || *s == ' ' || *s == '|')
+                s++;
+
+            return *s ? s : NULL;
+        }
+    }
+
+    return options;
+}
+
+int time_grouping_options_unittest(void);
+
 typedef enum rrdr_group_by {
     RRDR_GROUP_BY_NONE      = 0,
     RRDR_GROUP_BY_SELECTED  = (1 << 0),
@@ -34,6 +34,17 @@ static inline void tg_sum_add(RRDR *r, NETDATA_DOUBLE value) {
     g->count++;
 }
 
+static inline void tg_sum_add_batch(RRDR *r, const NETDATA_DOUBLE *values, size_t n) {
+    struct tg_sum *g = (struct tg_sum *)r->time_grouping.data;
+    // keep the summation order of tg_sum_add(), so that results are identical
+    NETDATA_DOUBLE sum = g->sum;
+    for(size_t i = 0; i < n ; i++)
+        sum += values[i];
+
+    g->sum = sum;
+    g->count += n;
+}
+
 static inline NETDATA_DOUBLE tg_sum_flush(RRDR *r, RRDR_VALUE_FLAGS *rrdr_value_options_ptr) {
     struct tg_sum *g = (struct tg_sum *)r->time_grouping.data;
 
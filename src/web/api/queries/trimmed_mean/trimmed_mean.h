@@ -85,6 +85,18 @@ static inline void tg_trimmed_mean_add(RRDR *r, NETDATA_DOUBLE value) {
     g->series[g->next_pos++] = value;
 }
 
+static inline void tg_trimmed_mean_add_batch(RRDR *r, const NETDATA_DOUBLE *values, size_t n) {
+    struct tg_trimmed_mean *g = (struct tg_trimmed_mean *)r->time_grouping.data;
+
+    while(unlikely(g->next_pos + n > g->series_size)) {
+        g->series = onewayalloc_doublesize( r->internal.owa, g->series, g->series_size * sizeof(NETDATA_DOUBLE));
+        g->series_size *= 2;
+    }
+
+    memcpy(&g->series[g->next_pos], values, n * sizeof(NETDATA_DOUBLE));
+    g->next_pos += n;
+}
+
 static inline NETDATA_DOUBLE tg_trimmed_mean_flush(RRDR *r, RRDR_VALUE_FLAGS *rrdr_value_options_ptr) {
     struct tg_trimmed_mean *g = (struct tg_trimmed_mean *)r->time_grouping.data;
 
@@ -290,8 +290,16 @@ static int api_v23_data_internal(RRDHOST *host __maybe_unused, struct web_client
         buffer_strcat(w->response.data, "(");
     }
 
-    owa = onewayalloc_create(0);
-    ret = data_query_execute(owa, w->response.data, qt, &last_timestamp_in_data);
+    // JSONP responses wrap the data with request specific callbacks
+    bool cacheable = format != DATASOURCE_DATATABLE_JSONP && format != DATASOURCE_JSONP;
+
+    if(!cacheable || !query_cache_get(qt, w->access, w->response.data, &last_timestamp_in_data, &ret)) {
+        owa = onewayalloc_create(0);
+        ret = data_query_execute(owa, w->response.data, qt, &last_timestamp_in_data);
+
+        if(cacheable)
+            query_cache_add(qt, w->access, w->response.data, last_timestamp_in_data, ret);
+    }
 
     if(format == DATASOURCE_DATATABLE_JSONP) {
         if(google_timestamp < last_timestamp_in_data)
@@ -16,6 +16,7 @@ struct web_client;
 #include "web/api/http_auth.h"
 #include "web/api/formatters/rrd2json.h"
 #include "web/api/queries/weights.h"
+#include "web/api/queries/query-cache.h"
 #include "libnetdata/user-auth/user-auth.h"
 
 void nd_web_api_init(void);
@@ -1,6 +1,7 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 
 #include "web_client.h"
+#include "web_client_compression.h"
 #include "web/websocket/websocket.h"
 
 // this is an async I/O implementation of the web server request parser
@@ -184,12 +185,18 @@ static void web_client_reset_allocations(struct web_client *w, bool free_all) {
         web_client_flag_clear(w, WEB_CLIENT_CHUNKED_TRANSFER);
     }
 
+    // release zstd/brotli compression (the zstd context is kept for the next request)
+    if(web_client_flag_check(w, WEB_CLIENT_ENCODING_ZSTD | WEB_CLIENT_ENCODING_BROTLI))
+        web_client_flag_clear(w, WEB_CLIENT_CHUNKED_TRANSFER);
+
+    web_client_compression_end(w, free_all);
+
     memset(w->transaction, 0, sizeof(w->transaction));
     memset(&w->auth, 0, sizeof(w->auth));
     memset(&w->user_auth, 0, sizeof(w->user_auth));
 
     web_client_reset_permissions(w);
-    web_client_flag_clear(w, WEB_CLIENT_ENCODING_GZIP|WEB_CLIENT_ENCODING_DEFLATE);
+    web_client_flag_clear(w, WEB_CLIENT_ENCODING_GZIP|WEB_CLIENT_ENCODING_DEFLATE|WEB_CLIENT_ENCODING_ZSTD|WEB_CLIENT_ENCODING_BROTLI);
     web_client_reset_path_flags(w);
 }
 
@@ -198,7 +205,9 @@ void web_client_log_completed_request(struct web_client *w, bool update_web_stat
     now_monotonic_high_precision_timeval(&tv);
 
     size_t size = w->response.data->len;
-    size_t sent = w->response.zoutput ? (size_t)w->response.zstream.total_out : size;
+    size_t sent = size;
+    if(w->response.zoutput)
+        sent = w->response.zinitialized ? (size_t)w->response.zstream.total_out : w->response.ztotal_out;
 
     usec_t prep_ut = w->timings.tv_ready.tv_sec ? dt_usec(&w->timings.tv_ready, &w->timings.tv_in) : 0;
     usec_t sent_ut = w->timings.tv_ready.tv_sec ? dt_usec(&tv, &w->timings.tv_ready) : 0;
@@ -246,9 +255,17 @@ void web_client_log_completed_request(struct web_client *w, bool update_web_stat
     if(likely(buffer_strlen(w->url_as_received))) {
         nd_log(NDLS_ACCESS, prio, NULL);
 
-        if(update_web_stats)
+        if(update_web_stats) {
             pulse_web_request_completed(
                 dt_usec(&tv, &w->timings.tv_in), w->statistics.received_bytes, w->statistics.sent_bytes, size, sent);
+
+            if(w->response.zoutput)
+                pulse_web_response_compressed(
+                    web_client_flag_check(w, WEB_CLIENT_ENCODING_ZSTD) ? PULSE_WEB_ENCODING_ZSTD :
+                    web_client_flag_check(w, WEB_CLIENT_ENCODING_BROTLI) ? PULSE_WEB_ENCODING_BROTLI :
+                                                                           PULSE_WEB_ENCODING_GZIP,
+                    size, sent, w->response.zcpu_ut);
+        }
     }
 }
 
@@ -891,8 +908,16 @@ void web_client_build_http_header(struct web_client *w) {
         buffer_strcat(w->response.header_output, buffer_tostring(w->response.header));
 
     // headers related to the transfer method
-    if(likely(w->response.zoutput))
-        buffer_strcat(w->response.header_output, "Content-Encoding: gzip\r\n");
+    if(likely(w->response.zoutput)) {
+        if(web_client_flag_check(w, WEB_CLIENT_ENCODING_ZSTD))
+            buffer_strcat(w->response.header_output, "Content-Encoding: zstd\r\n");
+        else if(web_client_flag_check(w, WEB_CLIENT_ENCODING_BROTLI))
+            buffer_strcat(w->response.header_output, "Content-Encoding: br\r\n");
+        else
+            buffer_strcat(w->response.header_output, "Content-Encoding: gzip\r\n");
+
+        buffer_strcat(w->response.header_output, "Vary: Accept-Encoding\r\n");
+    }
 
     if(likely(w->flags & WEB_CLIENT_CHUNKED_TRANSFER))
         buffer_strcat(w->response.header_output, "Transfer-Encoding: chunked\r\n");
@@ -1655,11 +1680,13 @@ ssize_t web_client_send_deflate(struct web_client *w)
         }
 
         // compress
+        usec_t started_ut = now_monotonic_high_precision_usec();
         if(deflate(&w->response.zstream, flush) == Z_STREAM_ERROR) {
             netdata_log_error("%llu: Compression failed. Closing down client.", w->id);
             web_client_request_done(w);
             return(-1);
         }
+        w->response.zcpu_ut += now_monotonic_high_precision_usec() - started_ut;
 
         w->response.zhave = NETDATA_WEB_RESPONSE_ZLIB_CHUNK_SIZE - w->response.zstream.avail_out;
         w->response.zsent = 0;
@@ -1697,8 +1724,124 @@ ssize_t web_client_send_deflate(struct web_client *w)
     return(len);
 }
 
+// the same as web_client_send_deflate(), for zstd and brotli
+ssize_t web_client_send_compressed(struct web_client *w)
+{
+    ssize_t len = 0, t = 0;
+
+    // when using compression,
+    // w->response.sent is the amount of bytes passed through compression
+
+    netdata_log_debug(D_DEFLATE,
+        "%llu: web_client_send_compressed(): w->response.data->len = %zu, w->response.sent = %zu, w->response.zhave = %zu, w->response.zsent = %zu, w->response.zin = %zu, w->response.zmore = %d, w->response.ztotal_out = %zu.",
+        w->id, (size_t)w->response.data->len, w->response.sent, w->response.zhave, w->response.zsent, w->response.zin, w->response.zmore, w->response.ztotal_out);
+
+    if(w->response.data->len - w->response.sent == 0 && w->response.zin == 0 && w->response.zhave == w->response.zsent && !w->response.zmore) {
+        // there is nothing to send
+
+        netdata_log_debug(D_WEB_CLIENT, "%llu: Out of output data.", w->id);
+
+        // finalize the chunk
+        if(w->response.zhave != 0) {
+            t = web_client_send_chunk_finalize(w);
+            if(t < 0) return t;
+        }
+
+        if(unlikely(!web_client_has_keepalive(w))) {
+            netdata_log_debug(D_WEB_CLIENT, "%llu: Closing (keep-alive is not enabled). %zu bytes sent.", w->id, w->response.sent);
+            WEB_CLIENT_IS_DEAD(w);
+            return t;
+        }
+
+        // reset the client
+        web_client_request_done(w);
+        netdata_log_debug(D_WEB_CLIENT, "%llu: Done sending all data on socket.", w->id);
+        return t;
+    }
+
+    if(w->response.zhave == w->response.zsent) {
+        // compress more input data
+
+        // give the compressor all the data not consumed by the compressor yet
+        const char *src = &w->response.data->buffer[w->response.sent - w->response.zin];
+        size_t size = w->response.zin + (w->response.data->len - w->response.sent);
+
+        // ask to finish the stream if we have all the input
+        bool finish = (w->mode == HTTP_REQUEST_MODE_GET ||
+                       w->mode == HTTP_REQUEST_MODE_POST ||
+                       w->mode == HTTP_REQUEST_MODE_PUT ||
+                       w->mode == HTTP_REQUEST_MODE_DELETE);
+
+        netdata_log_debug(D_DEFLATE, "%llu: Compressing %zu bytes (%s).", w->id, size, finish ? "finish" : "flush");
+
+        // compress
+        size_t consumed = 0, produced = 0;
+        bool more = false;
+        usec_t started_ut = now_monotonic_high_precision_usec();
+        if(!web_client_compress(w, src, size, finish, &consumed, &produced, &more)) {
+            netdata_log_error("%llu: Compression failed. Closing down client.", w->id);
+            web_client_request_done(w);
+            return(-1);
+        }
+        w->response.zcpu_ut += now_monotonic_high_precision_usec() - started_ut;
+
+        w->response.zin = size - consumed;
+        w->response.zmore = more && produced;
+        w->response.ztotal_out += produced;
+
+        // keep track of the bytes passed through the compressor
+        w->response.sent = w->response.data->len;
+
+        netdata_log_debug(D_DEFLATE, "%llu: Compression produced %zu bytes.", w->id, produced);
+
+        // an empty chunk would terminate the response, keep the previous one open
+        if(!produced)
+            return t;
+
+        // close the previous open chunk
+        if(w->response.zhave != 0) {
+            t = web_client_send_chunk_close(w);
+            if(t < 0) return t;
+        }
+
+        w->response.zhave = produced;
+        w->response.zsent = 0;
+
+        // open a new chunk
+        ssize_t t2 = web_client_send_chunk_header(w, w->response.zhave);
+        if(t2 < 0) return t2;
+        t += t2;
+    }
+
+    netdata_log_debug(D_WEB_CLIENT, "%llu: Sending %zu bytes of data (+%zd of chunk header).", w->id, w->response.zhave - w->response.zsent, t);
+
+    len = web_client_send_data(w,&w->response.zbuffer[w->response.zsent], (size_t) (w->response.zhave - w->response.zsent), MSG_DONTWAIT);
+    if(len > 0) {
+        w->statistics.sent_bytes += len;
+        w->response.zsent += len;
+        len += t;
+        netdata_log_debug(D_WEB_CLIENT, "%llu: Sent %zd bytes.", w->id, len);
+    }
+    else if(len == 0) {
+        netdata_log_debug(D_WEB_CLIENT, "%llu: Did not send any bytes to the client (zhave = %zu, zsent = %zu, need to send = %zu).",
+            w->id, w->response.zhave, w->response.zsent, w->response.zhave - w->response.zsent);
+
+    }
+    else {
+        netdata_log_debug(D_WEB_CLIENT, "%llu: Failed to send data to client.", w->id);
+        WEB_CLIENT_IS_DEAD(w);
+    }
+
+    return(len);
+}
+
 ssize_t web_client_send(struct web_client *w) {
-    if(likely(w->response.zoutput)) return web_client_send_deflate(w);
+    if(likely(w->response.zoutput)) {
+        if(web_client_flag_check(w, WEB_CLIENT_ENCODING_ZSTD | WEB_CLIENT_ENCODING_BROTLI))
+            return web_client_send_compressed(w);
+
+        return web_client_send_deflate(w);
+    }
 
     ssize_t bytes;
 
@@ -1847,6 +1990,9 @@ void web_client_reuse_from_cache(struct web_client *w) {
 
     NETDATA_SSL ssl = w->ssl;
 
+    // the zstd context is reused by the next client
+    void *zstd = w->response.zstd;
+
     size_t use_count = w->use_count;
     size_t *statistics_memory_accounting = w->statistics.memory_accounting;
 
@@ -1858,6 +2004,7 @@ void web_client_reuse_from_cache(struct web_client *w) {
     w->use_count = use_count;
 
     w->ssl = ssl;
+    w->response.zstd = zstd;
 
     // restore the pointers of the buffers
     w->response.data = b1;
@@ -66,6 +66,10 @@ typedef enum __attribute__((packed)) {
     // websocket flags
     WEB_CLIENT_FLAG_WEBSOCKET_CLIENT        = (1 << 23), // this is a websocket client
     WEB_CLIENT_FLAG_WEBSOCKET_HANDSHAKE     = (1 << 24), // websocket handshake detected
+
+    // compression (continued)
+    WEB_CLIENT_ENCODING_ZSTD                = (1 << 25),
+    WEB_CLIENT_ENCODING_BROTLI              = (1 << 26),
 } WEB_CLIENT_FLAGS;
 
 #define WEB_CLIENT_FLAG_PATH_WITH_VERSION (WEB_CLIENT_FLAG_PATH_IS_V0|WEB_CLIENT_FLAG_PATH_IS_V1|WEB_CLIENT_FLAG_PATH_IS_V2|WEB_CLIENT_FLAG_PATH_IS_V3)
@@ -146,8 +150,14 @@ struct response {
     short int code;         // the HTTP response code
     bool has_cookies;
     bool zoutput;           // if set to 1, web_client_send() will send compressed data
-    bool zinitialized;
+    bool zinitialized;      // the zlib stream is initialized (gzip)
+    bool zmore;             // zstd/brotli: the compressor has more output to give
     z_stream zstream;                                    // zlib stream for sending compressed output to client
+    void *zstd;                                          // zstd context, reused across requests
+    void *brotli;                                        // brotli encoder of the current response
+    size_t zin;                                          // zstd/brotli: the input bytes not consumed by the compressor yet
+    size_t ztotal_out;                                   // zstd/brotli: the compressed bytes of the current response
+    usec_t zcpu_ut;                                      // the time spent compressing the current response
     size_t zsent;                                        // the compressed bytes we have sent to the client
     size_t zhave;                                        // the compressed bytes that we have received from zlib
     Bytef zbuffer[NETDATA_WEB_RESPONSE_ZLIB_CHUNK_SIZE]; // temporary buffer for storing compressed output
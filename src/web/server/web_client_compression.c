@@ -0,0 +1,195 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "web_client_compression.h"
+
+#ifdef ENABLE_ZSTD
+#include <zstd.h>
+#endif
+
+#ifdef ENABLE_BROTLI
+#include <brotli/encode.h>
+#endif
+
+int web_enable_zstd = 1, web_zstd_level = 3;
+int web_enable_brotli = 1, web_brotli_level = 3;
+
+static bool web_client_compression_can_be_enabled(struct web_client *w) {
+    // cloud accepts only gzip
+    if(!web_client_check_conn_unix(w) && !web_client_check_conn_tcp(w))
+        return false;
+
+    if(unlikely(w->response.zoutput)) {
+        // compression has already been initialized for this client.
+        return false;
+    }
+
+    if(unlikely(w->response.sent)) {
+        netdata_log_error("%llu: Cannot enable compression in the middle of a conversation.", w->id);
+        return false;
+    }
+
+    return true;
+}
+
+static void web_client_compression_enabled(struct web_client *w, WEB_CLIENT_FLAGS encoding) {
+    web_client_flag_set(w, encoding | WEB_CLIENT_CHUNKED_TRANSFER);
+
+    w->response.zsent = 0;
+    w->response.zhave = 0;
+    w->response.zin = 0;
+    w->response.zmore = false;
+    w->response.zoutput = true;
+
+    netdata_log_debug(D_DEFLATE, "%llu: Initialized %s compression.", w->id,
+                      (encoding & WEB_CLIENT_ENCODING_ZSTD) ? "zstd" : "brotli");
+}
+
+// ----------------------------------------------------------------------------
+// zstd
+
+bool web_client_enable_zstd(struct web_client *w) {
+#ifdef ENABLE_ZSTD
+    if(!web_client_compression_can_be_enabled(w))
+        return false;
+
+    if(!w->response.zstd) {
+        ZSTD_CCtx *cctx = ZSTD_createCCtx();
+        if(!cctx) {
+            netdata_log_error("%llu: Failed to create a zstd context. Proceeding without zstd compression.", w->id);
+            return false;
+        }
+
+        size_t ret = ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel, web_zstd_level);
+        if(ZSTD_isError(ret)) {
+            netdata_log_error("%llu: ZSTD_CCtx_setParameter() returned error: %s", w->id, ZSTD_getErrorName(ret));
+            ZSTD_freeCCtx(cctx);
+            return false;
+        }
+
+        w->response.zstd = cctx;
+    }
+    else
+        ZSTD_CCtx_reset(w->response.zstd, ZSTD_reset_session_only);
+
+    web_client_compression_enabled(w, WEB_CLIENT_ENCODING_ZSTD);
+    return true;
+#else
+    (void)w;
+    return false;
+#endif
+}
+
+#ifdef ENABLE_ZSTD
+static bool web_client_compress_zstd(struct web_client *w, const char *src, size_t size, bool finish, size_t *consumed, size_t *produced, bool *more) {
+    ZSTD_inBuffer in = {
+        .src = src,
+        .size = size,
+        .pos = 0,
+    };
+
+    ZSTD_outBuffer out = {
+        .dst = w->response.zbuffer,
+        .size = NETDATA_WEB_RESPONSE_ZLIB_CHUNK_SIZE,
+        .pos = 0,
+    };
+
+    size_t remaining = ZSTD_compressStream2(w->response.zstd, &out, &in, finish ? ZSTD_e_end : ZSTD_e_flush);
+    if(ZSTD_isError(remaining)) {
+        netdata_log_error("%llu: ZSTD_compressStream2() returned error: %s", w->id, ZSTD_getErrorName(remaining));
+        return false;
+    }
+
+    *consumed = in.pos;
+    *produced = out.pos;
+    *more = remaining != 0;
+    return true;
+}
+#endif
+
+// ----------------------------------------------------------------------------
+// brotli
+
+bool web_client_enable_brotli(struct web_client *w) {
+#ifdef ENABLE_BROTLI
+    if(!web_client_compression_can_be_enabled(w))
+        return false;
+
+    BrotliEncoderState *state = BrotliEncoderCreateInstance(NULL, NULL, NULL);
+    if(!state) {
+        netdata_log_error("%llu: Failed to create a brotli encoder. Proceeding without brotli compression.", w->id);
+        return false;
+    }
+
+    BrotliEncoderSetParameter(state, BROTLI_PARAM_QUALITY, web_brotli_level);
+    BrotliEncoderSetParameter(state, BROTLI_PARAM_MODE, BROTLI_MODE_TEXT);
+
+    w->response.brotli = state;
+    web_client_compression_enabled(w, WEB_CLIENT_ENCODING_BROTLI);
+    return true;
+#else
+    (void)w;
+    return false;
+#endif
+}
+
+#ifdef ENABLE_BROTLI
+static bool web_client_compress_brotli(struct web_client *w, const char *src, size_t size, bool finish, size_t *consumed, size_t *produced, bool *more) {
+    size_t available_in = size;
+    const uint8_t *next_in = (const uint8_t *)src;
+    size_t available_out = NETDATA_WEB_RESPONSE_ZLIB_CHUNK_SIZE;
+    uint8_t *next_out = (uint8_t *)w->response.zbuffer;
+
+    if(!BrotliEncoderCompressStream(w->response.brotli, finish ? BROTLI_OPERATION_FINISH : BROTLI_OPERATION_FLUSH,
+                                    &available_in, &next_in, &available_out, &next_out, NULL)) {
+        netdata_log_error("%llu: BrotliEncoderCompressStream() failed.", w->id);
+        return false;
+    }
+
+    *consumed = size - available_in;
+    *produced = NETDATA_WEB_RESPONSE_ZLIB_CHUNK_SIZE - available_out;
+    *more = available_in || BrotliEncoderHasMoreOutput(w->response.brotli) ||
+            (finish && !BrotliEncoderIsFinished(w->response.brotli));
+    return true;
+}
+#endif
+
+// ----------------------------------------------------------------------------
+
+bool web_client_compress(struct web_client *w, const char *src, size_t size, bool finish, size_t *consumed, size_t *produced, bool *more) {
+#ifdef ENABLE_ZSTD
+    if(web_client_flag_check(w, WEB_CLIENT_ENCODING_ZSTD))
+        return web_client_compress_zstd(w, src, size, finish, consumed, produced, more);
+#endif
+
+#ifdef ENABLE_BROTLI
+    if(web_client_flag_check(w, WEB_CLIENT_ENCODING_BROTLI))
+        return web_client_compress_brotli(w, src, size, finish, consumed, produced, more);
+#endif
+
+    (void)src; (void)size; (void)finish; (void)consumed; (void)produced; (void)more;
+    netdata_log_error("%llu: No compressor is initialized for this response.", w->id);
+    return false;
+}
+
+void web_client_compression_end(struct web_client *w, bool free_contexts) {
+#ifdef ENABLE_BROTLI
+    if(w->response.brotli) {
+        BrotliEncoderDestroyInstance(w->response.brotli);
+        w->response.brotli = NULL;
+    }
+#endif
+
+#ifdef ENABLE_ZSTD
+    if(free_contexts && w->response.zstd) {
+        ZSTD_freeCCtx(w->response.zstd);
+        w->response.zstd = NULL;
+    }
+#else
+    (void)free_contexts;
+#endif
+
+    w->response.zin = 0;
+    w->response.zmore = false;
+    w->response.ztotal_out = 0;
+    w->response.zcpu_ut = 0;
+}
@@ -0,0 +1,32 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef NETDATA_WEB_CLIENT_COMPRESSION_H
+#define NETDATA_WEB_CLIENT_COMPRESSION_H
+
+#include "libnetdata/libnetdata.h"
+#include "web_client.h"
+
+// zstd and brotli compression of web responses
+// gzip is handled by zlib directly (see web_client_send_deflate()), and it is
+// the only encoding offered to Netdata Cloud, which decompresses only gzip.
+//
+// The zstd context is kept per web_client and is reused across requests and
+// across the web client cache. Brotli has no way to reset an encoder, so its
+// state is created for every response.
+
+extern int web_enable_zstd, web_zstd_level;
+extern int web_enable_brotli, web_brotli_level;
+
+bool web_client_enable_zstd(struct web_client *w);
+bool web_client_enable_brotli(struct web_client *w);
+
+// compress src into w->response.zbuffer
+// consumed is the input used, produced is the output generated,
+// more is true when the compressor has more output to give
+bool web_client_compress(struct web_client *w, const char *src, size_t size, bool finish, size_t *consumed, size_t *produced, bool *more);
+
+// end the compression of the current response
+// when free_contexts is true, the reusable contexts are released too
+void web_client_compression_end(struct web_client *w, bool free_contexts);
+
+#endif //NETDATA_WEB_CLIENT_COMPRESSION_H